@@ -2,6 +2,9 @@
 #include "mpi-log.h"
 
 #include "ns3/core-module.h"
+#include "ns3/dependency-player.h"
+#include "ns3/fct-collector.h"
+#include "ns3/hybrid-simulator-impl.h"
 #include "ns3/internet-stack-helper.h"
 #include "ns3/ipv4-address-helper.h"
 #include "ns3/ipv4-global-routing-helper.h"
@@ -13,18 +16,23 @@
 #include "ns3/on-off-helper.h"
 #include "ns3/packet-sink-helper.h"
 #include "ns3/packet-sink.h"
+#include "ns3/phase-checkpoint.h"
+#include "ns3/phase-engine.h"
 #include "ns3/point-to-point-helper.h"
+#include "ns3/topology-partitioner.h"
+#include "ns3/workload-trace.h"
 #include <mpi.h>
+#include <atomic>
 #include <chrono>
 #include <vector>
 #include <string>
 #include <map>
+#include <mutex>
+#include <set>
 
 using namespace ns3;
 
 
-std::map<uint16_t, double> phaseStartTimes;
-
 const int NS_COLOR = 1;
 const int NOT_NS_COLOR = NS_COLOR + 1;
 
@@ -57,55 +65,83 @@ uint16_t SPINE=2;
 uint16_t LEAF=4;
 uint16_t SERVER=8;
 uint16_t DST=2; //进程数
+//链路和应用参数, 建拓扑和计算理想FCT共用
+DataRate linkRate("25Mbps");//所有链路的速率
+Time linkDelay=MicroSeconds(2);//所有链路的传播时延
+DataRate appRate("2Mbps");//OnOff应用的发送速率
+const uint32_t PACKET_SIZE=1448;//UDP负载
+const uint32_t HEADER_SIZE=30;//UDP, IP和PPP头
 std::vector<NodeContainer> serverNodes;
 std::vector<Ipv4InterfaceContainer> serverInterfaces;
-uint32_t packets=0;
-struct FlowInfo{//流量信息结构体
-    char type[32];
-    uint32_t srcNodeId;
-    uint16_t srcPort;
-    uint32_t dstNodeId; 
-    uint16_t dstPort;
-    uint8_t priority;
-    uint64_t msgLen;
-};
-std::vector<std::vector<FlowInfo>> flowInfos;
-u_int16_t BatchCur=0;
-u_int32_t flowCom=0;
+//--hybrid时每个线程各自加载phase, 计数按线程分开
+thread_local uint32_t packets=0;
+std::vector<std::vector<WorkloadFlow>> flowInfos;
+WorkloadTrace trace;//二进制流量文件, 按phase从映射中读取本进程的流
+std::mutex traceMutex;//--hybrid时保护trace
+uint32_t nPhases=0;
+thread_local u_int16_t BatchCur=0;
+thread_local u_int32_t flowCom=0;
+std::atomic<uint32_t> loadedPhase{0};//最近打印过的phase
+std::string checkpointPrefix;//每个phase结束时写入检查点
+uint32_t restorePhase=0;//从该phase的检查点恢复, 0表示从头运行
+bool fctStats=false;//统计流完成时间和slowdown分布
 void flowRx_cb(const ns3::Ptr<const ns3::Packet> packet,
                     const ns3::Address& srcAddress,
                     const ns3::Address& destAddress);
-void LoadWait();
+void startPhases(double startTime);
+
+uint32_t ServerSystemId(uint32_t nodeId){//服务器节点所在的进程
+    return serverNodes[nodeId / SERVER].Get(nodeId % SERVER)->GetSystemId();
+}
+
+bool IsLocal(uint32_t nodeId){//服务器节点在本进程, 且--hybrid时在当前线程
+    Ptr<Node> node = serverNodes[nodeId / SERVER].Get(nodeId % SERVER);
+    return node->GetSystemId() == MpiInterface::GetSystemId() &&
+           HybridSimulatorImpl::GetThread(node->GetId()) ==
+               HybridSimulatorImpl::GetThread(Simulator::GetContext());
+}
 
-void CreateFlow(const FlowInfo& flow, double startTime){//跨进程流量创建(单条)
+//DAG模式: 按依赖关系回放trafficGen.py生成的通信组
+Ptr<DependencyPlayer> player;
+std::map<uint16_t, uint32_t> stepOfPort;//端口对应的step
+std::map<uint32_t, uint32_t> stepPackets;//各step本进程待接收的包数
+
+void CreateFlow(const WorkloadFlow& flow, double startTime, bool sink = true){//跨进程流量创建(单条)
     ApplicationContainer apps;
-    // 获取系统进程ID
-    uint32_t systemId = MpiInterface::GetSystemId();
-    // 源节点和目标节点所在的进程
-    uint32_t srcSystemId = flow.srcNodeId / (SERVER*LEAF/DST);
-    uint32_t dstSystemId = flow.dstNodeId / (SERVER*LEAF/DST);
-    uint16_t srcLeaf = flow.srcNodeId / SERVER;
-    uint16_t dstLeaf = flow.dstNodeId / SERVER;
-    uint16_t srcServer = flow.srcNodeId % SERVER;
-    uint16_t dstServer = flow.dstNodeId % SERVER;
+    // 源节点和目标节点是否在本进程(和本线程)
+    bool srcLocal = IsLocal(flow.src);
+    bool dstLocal = IsLocal(flow.dst);
+    uint16_t srcLeaf = flow.src / SERVER;
+    uint16_t dstLeaf = flow.dst / SERVER;
+    uint16_t srcServer = flow.src % SERVER;
+    uint16_t dstServer = flow.dst % SERVER;
     bool send = false;
     bool recv = false;
     // 发送端配置（仅在源节点所在进程创建）
-    if (systemId == srcSystemId) {
+    if (srcLocal) {
         OnOffHelper clientHelper("ns3::UdpSocketFactory", Address());
         clientHelper.SetAttribute("OnTime", StringValue("ns3::ConstantRandomVariable[Constant=1]"));
         clientHelper.SetAttribute("OffTime",StringValue("ns3::ConstantRandomVariable[Constant=0]"));
-        clientHelper.SetAttribute("MaxBytes", UintegerValue(flow.msgLen));
+        clientHelper.SetAttribute("MaxBytes", UintegerValue(flow.size));
         AddressValue remoteAddress(InetSocketAddress(
             serverInterfaces[dstLeaf].GetAddress(dstServer), flow.dstPort));
         clientHelper.SetAttribute("Remote", remoteAddress);
         apps.Add(clientHelper.Install(serverNodes[srcLeaf].Get(srcServer)));
         send=true;
-        // logMessage("流量发送 源节点 "+std::to_string(flow.srcNodeId)+" 目标节点 "+ 
-                // std::to_string(flow.dstNodeId)+" 流量大小 "+std::to_string(flow.msgLen));
+        // logMessage("流量发送 源节点 "+std::to_string(flow.src)+" 目标节点 "+ 
+                // std::to_string(flow.dst)+" 流量大小 "+std::to_string(flow.size));
+    }
+    if (dstLocal && fctStats) {
+        //理想FCT: 按应用速率发完整条流, 加上路径上各跳的传播和一个包的发送时延
+        uint32_t hops = srcLeaf == dstLeaf ? 2 : 4;
+        Time latency = hops * (linkDelay + linkRate.CalculateBytesTxTime(PACKET_SIZE + HEADER_SIZE));
+        Time ideal = FctCollector::GetIdealFct(flow.size, appRate, latency);
+        FctCollector::Get()->ExpectFlow(serverInterfaces[srcLeaf].GetAddress(srcServer),
+                                        serverInterfaces[dstLeaf].GetAddress(dstServer),
+                                        flow.dstPort, flow.size, Simulator::Now(), ideal);
     }
     // 接收端配置（仅在目标节点所在进程创建）
-    if (systemId == dstSystemId) {
+    if (dstLocal && sink) {
         // 创建PacketSink
         PacketSinkHelper sinkHelper("ns3::UdpSocketFactory",
                              InetSocketAddress(Ipv4Address::GetAny(), flow.dstPort));
@@ -116,66 +152,75 @@ void CreateFlow(const FlowInfo& flow, double startTime){//跨进程流量创建(
                                             MakeCallback(&SinkTracer::SinkTrace));
         sink->TraceConnectWithoutContext("RxWithAddresses",
                                             MakeCallback(flowRx_cb));
+        if (fctStats)
+            sink->TraceConnectWithoutContext("RxWithAddresses",
+                                                MakeCallback(&FctCollector::SinkRx));
         recv=true;
     }   
     apps.Start(Seconds(0));
     apps.Stop(Seconds(100000));
     if(send&&recv)
-        std::cout << " from " << flow.srcNodeId << " to " << flow.dstNodeId <<
+        std::cout << " from " << flow.src << " to " << flow.dst <<
                 " fromportNumber " << 1 <<
                 " destportNumder " << 1 <<
-                " time " << Simulator::Now().GetSeconds() << " flowsize "<< flow.msgLen << std::endl;
+                " time " << Simulator::Now().GetSeconds() << " flowsize "<< flow.size << std::endl;
 }
 
-void LoadFlow(double startTime = 0){//加载当前的一个phase  
-    phaseStartTimes[BatchCur] = Simulator::Now().GetSeconds();
-    for(FlowInfo flow:flowInfos[BatchCur]){
-        CreateFlow(flow,startTime);
-        if(MpiInterface::GetSystemId()==(flow.dstNodeId / (SERVER*LEAF/DST)))
-            packets+=(flow.msgLen/1448+((flow.msgLen%1448)>0?1:0));
+void LoadFlow(uint32_t phase){//加载一个phase, 由PhaseEngine在各进程约定的时间调用
+    BatchCur = phase;
+    flowCom = 0;
+    packets = 0;
+    if(phase > 0 && loadedPhase.exchange(phase) != phase)//各线程都加载, 只打印一次
+        RANK0COUT("Loading phase " << phase << std::endl);
+    auto load = [phase](WorkloadFlow flow){
+        flow.dstPort = phase + 1;
+        CreateFlow(flow, 0);
+        if(IsLocal(flow.dst))
+            packets+=(flow.size/PACKET_SIZE+((flow.size%PACKET_SIZE)>0?1:0));
+    };
+    if(trace.GetNPhases() > 0){//只读取本进程的流, 并释放上一个phase的页
+        //--hybrid时各线程共用trace的过滤缓冲, 加锁取出本线程的流
+        std::vector<WorkloadFlow> flows;
+        {
+            std::lock_guard<std::mutex> lock(traceMutex);
+            if(phase > 0)
+                trace.Release(phase - 1);
+            for(const WorkloadFlow& flow:trace.GetFlows(phase))
+                if(IsLocal(flow.src) || IsLocal(flow.dst))
+                    flows.push_back(flow);
+        }
+        for(const WorkloadFlow& flow:flows)
+            load(flow);
+    }
+    else{
+        for(const WorkloadFlow& flow:flowInfos[phase])
+            load(flow);
     }
     if(packets==0)
-        LoadWait();
+        PhaseEngine::NotifyLocalDone();
 }
 
-void LoadWait(){
-    uint32_t localDone = 1;
-    // MPI全局归约操作检测所有进程完成状态
-    uint32_t globalDone = 0;
-    MPI_Allreduce(&localDone, &globalDone, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
-    // 只有所有进程都完成时才进入下一阶段
-    if(globalDone == MpiInterface::GetSize()){
-        double phaseEndTime = Simulator::Now().GetSeconds();
-        double phaseStartTime = phaseStartTimes[BatchCur];
-        double phaseDuration = phaseEndTime - phaseStartTime;
-        rank0log("phase "+std::to_string(BatchCur)+" 完成, FCT: "+std::to_string(phaseDuration)+" 秒");
-        RANK0COUT("All flows completed in phase " << BatchCur << std::endl);
-        // 停止当前仿真
+void PhaseDone(uint32_t phase, Time fct){//所有进程都完成了当前phase
+    rank0log("phase "+std::to_string(phase)+" 完成, FCT: "+std::to_string(fct.GetSeconds())+" 秒");
+    RANK0COUT("All flows completed in phase " << phase << std::endl);
+    if(phase + 1 == nPhases){
+        RANK0COUT("All phases completed" << std::endl);
         Simulator::Stop();
-        // 准备下一阶段
-        BatchCur++;
-        if(BatchCur < flowInfos.size()){
-            // 重置计数器
-            flowCom = 0;
-            packets = 0;
-            // 加载新流量（需同步）
-            MPI_Barrier(MPI_COMM_WORLD);
-            if(MpiInterface::GetSystemId() == 0)
-                RANK0COUT("Loading phase " << BatchCur << std::endl);
-            // 各进程并行加载
-            LoadFlow();
-            // 全局同步确保所有进程加载完成
-            MPI_Barrier(MPI_COMM_WORLD);
-            // 重启仿真
-            Simulator::Run();
-        }
-        else
-            RANK0COUT("All phases completed" << std::endl);
     }
 }
+
 void flowRx_cb(const ns3::Ptr<const ns3::Packet> packet,
                     const ns3::Address& srcAddress,
                     const ns3::Address& destAddress){
+    if(player){//DAG模式按端口区分step
+        uint16_t port = InetSocketAddress::ConvertFrom(destAddress).GetPort();
+        uint32_t step = stepOfPort[port];
+        if(--stepPackets[step] == 0){
+            stepPackets.erase(step);
+            player->NotifyLocalDone(step);
+        }
+        return;
+    }
     flowCom++;
     
     // logMessage("phase " + std::to_string(BatchCur) + " 源地址" + SinkTracer::FormatAddress(srcAddress) + " " +
@@ -183,8 +228,8 @@ void flowRx_cb(const ns3::Ptr<const ns3::Packet> packet,
     //            "数据包大小"+std::to_string(packet->GetSize()));
     //std::cout<<"rank "<<MpiInterface::GetSystemId() <<" phase "<<BatchCur<<" flow "<< flowCom<<" "<<Simulator::Now().GetSeconds()<<std::endl;
     
-    if(flowCom >= packets)
-        LoadWait();
+    if(flowCom == packets)
+        PhaseEngine::NotifyLocalDone();
 }
 
 void workLoad (){
@@ -206,40 +251,123 @@ void workLoad (){
             if(batch < 0)
                 startTime += phase/1e6;
             batch ++;
-            flowInfos.emplace_back(std::vector<FlowInfo> {});
+            flowInfos.emplace_back(std::vector<WorkloadFlow> {});
             continue;//to be changed
         }
-        FlowInfo flow;
-        ss >> type_str >> flow.type;
-        ss >> type_str >> flow.srcNodeId;
-        ss >> type_str >> flow.srcPort;
-        ss >> type_str >> flow.dstNodeId;
-        ss >> type_str >> flow.dstPort;
-        ss >> type_str >> flow.priority;
-        ss >> type_str >> flow.msgLen;
-        flow.dstPort = batch + 1;
-        flowInfos[batch].emplace_back(flow);
+        WorkloadFlow flow;
+        if(WorkloadTrace::ParseFlow(line, flow))
+            flowInfos[batch].emplace_back(flow);
     }
-    LoadFlow(startTime);
     flowInput.close();
+    nPhases = flowInfos.size();
+    startPhases(startTime);
+}
+
+void startPhases(double startTime){
+    //phase的切换在Simulator::Run()内完成, 完成检测借助LBTS同步
+    PhaseEngine::SetPhaseStartCallback(MakeCallback(&LoadFlow));
+    PhaseEngine::SetPhaseEndCallback(MakeCallback(&PhaseDone));
+    //检查点保存各进程已接收的包数, 拓扑和路由由脚本重建
+    PhaseCheckpoint::AddSection("sinkCount", MakeCallback(&SinkTracer::SaveSinkCount),
+                                MakeCallback(&SinkTracer::RestoreSinkCount));
+    PhaseEngine::SetCheckpoint(checkpointPrefix);
+    if(restorePhase > 0){
+        if(!PhaseEngine::Restore(checkpointPrefix, restorePhase))
+            NS_ABORT_MSG("unable to restore phase " << restorePhase << " from " << checkpointPrefix);
+        RANK0COUT("Restored phase " << restorePhase << std::endl);
+    }
+    else
+        PhaseEngine::Start(nPhases, Seconds(startTime));
+}
+
+void traceWorkLoad(const std::string& traceFile){//二进制流量文件, 不存在时由0号进程从文本转换
+    std::vector<uint32_t> assignment(LEAF*SERVER);
+    for(uint32_t i=0;i<assignment.size();i++)
+        assignment[i]=ServerSystemId(i);
+    if(MpiInterface::GetSystemId()==0 && !std::ifstream(traceFile).good()){
+        RANK0COUT("Converting flow info to " << traceFile << std::endl);
+        if(!WorkloadTrace::Convert("scratch/rdma_operate.txt", traceFile, assignment))
+            std::cout << "unable to convert flowInputFile!" << std::endl;
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+    if(!trace.Open(traceFile, MpiInterface::GetSystemId(), assignment))
+        std::cout << "unable to open trace " << traceFile << std::endl;
+    RANK0COUT("Mapped " << trace.GetNPhases() << " phases"
+              << (trace.IsPartitioned() ? "" : ", filtering for this partition") << std::endl);
+    nPhases = trace.GetNPhases();
+    startPhases(0);
+}
+
+void LoadStep(uint32_t step){//DAG模式下加载一个step, 同一step的流共用一个端口
+    uint16_t port = 1 + step % 60000;
+    stepOfPort[port] = step;
+    std::set<uint32_t> sinks;
+    uint32_t expected = 0;
+    for(const WorkloadFlow& f:player->GetFlows(step)){
+        WorkloadFlow flow = f;
+        flow.dstPort = port;
+        CreateFlow(flow, 0, sinks.insert(f.dst).second);
+        if(IsLocal(f.dst))
+            expected+=(f.size/PACKET_SIZE+((f.size%PACKET_SIZE)>0?1:0));
+    }
+    if(expected > 0)
+        stepPackets[step] = expected;
+}
+
+void GroupDone(uint32_t group, Time fct){
+    rank0log("group "+std::to_string(group)+" 完成, FCT: "+std::to_string(fct.GetSeconds())+" 秒");
+}
+
+void dagWorkLoad(const std::string& flowPrefix, const std::string& dependencies){
+    player = CreateObject<DependencyPlayer>();
+    uint32_t groups = player->ReadGroups(flowPrefix);
+    if(!player->ReadDependencies(dependencies))
+        std::cout << "unable to open dependency file!" << std::endl;
+    RANK0COUT("Read " << groups << " groups, " << player->GetNSteps() << " steps" << std::endl);
+    player->SetStepStartCallback(MakeCallback(&LoadStep));
+    player->SetGroupEndCallback(MakeCallback(&GroupDone));
+    player->Start();
 }
 
 int main(int argc, char* argv[]){
     bool nix = true;
     bool tracing = false;
+    bool partition = false;
+    uint32_t hybrid = 0;
     uint8_t topo_select=1;
     // Parse command line
     CommandLine cmd(__FILE__);
     cmd.AddValue("nix", "Enable the use of nix-vector or global routing", nix);
     cmd.AddValue("tracing", "Enable pcap tracing", tracing);
     cmd.AddValue("topo", "topo select", topo_select);
+    cmd.AddValue("partition", "Assign nodes to ranks with the topology partitioner", partition);
+    cmd.AddValue("hybrid", "Run the nodes of each rank on this many threads, by leaf", hybrid);
+    std::string dagFlows;
+    std::string dagDependencies = "scratch/TrafficGenerator/dependence.txt";
+    cmd.AddValue("dag", "Play the groups in <dag>0.txt, <dag>1.txt, ... by their dependencies", dagFlows);
+    cmd.AddValue("dependencies", "Dependencies between the groups", dagDependencies);
+    std::string traceFile;
+    cmd.AddValue("trace", "Read the phases from a binary trace, converted from scratch/rdma_operate.txt if missing", traceFile);
+    cmd.AddValue("checkpoint", "Write a checkpoint of every rank between two phases, to <checkpoint>-<phase>-<rank>.ckpt", checkpointPrefix);
+    cmd.AddValue("restore", "Restart from the checkpoint of this phase", restorePhase);
+    cmd.AddValue("linkRate", "Data rate of every link", linkRate);
+    cmd.AddValue("linkDelay", "Propagation delay of every link", linkDelay);
+    cmd.AddValue("appRate", "Sending rate of every flow", appRate);
+    cmd.AddValue("fct", "Write the flow completion time and slowdown percentiles to fct_summary.txt", fctStats);
     cmd.Parse(argc, argv);
 
     SPINE=topo[topo_select][0];
     LEAF=topo[topo_select][1];
     SERVER=topo[topo_select][2];
     // Distributed simulation setup; by default use granted time window algorithm.
-    GlobalValue::Bind("SimulatorImplementationType",StringValue("ns3::DistributedSimulatorImpl"));
+    if(hybrid > 1){
+        //nix-vector由各节点按需计算, 不能在线程间共享; DAG模式的step计数不分线程
+        NS_ABORT_MSG_IF(!dagFlows.empty(), "--dag does not support --hybrid");
+        nix = false;
+        GlobalValue::Bind("SimulatorImplementationType",StringValue("ns3::HybridSimulatorImpl"));
+    }
+    else
+        GlobalValue::Bind("SimulatorImplementationType",StringValue("ns3::DistributedSimulatorImpl"));
 
     MpiInterface::Enable(&argc, &argv);
     SinkTracer::Init();
@@ -294,6 +422,7 @@ int main(int argc, char* argv[]){
     RANK0COUT("\n");
     RANK0COUT("Configuration:\n");
     RANK0COUT("Routing:           " << (nix ? "nix-vector" : "global") << "\n");
+    RANK0COUT("Threads per rank:  " << std::max(hybrid, 1u) << "\n");
     RANK0COUT("ns-3 Communicator: " << ns3Ranks << "\n");
     RANK0COUT("PCAP tracing:      " << (tracing ? "" : "not") << " enabled\n");
     RANK0COUT("\n");
@@ -312,44 +441,80 @@ int main(int argc, char* argv[]){
     uint32_t systemId = MpiInterface::GetSystemId();
     //uint32_t systemCount = MpiInterface::GetSize();
     // 默认UDP流量设置
-    Config::SetDefault("ns3::OnOffApplication::PacketSize", UintegerValue(1448));
-    Config::SetDefault("ns3::OnOffApplication::DataRate", StringValue("2Mbps"));
-    Config::SetDefault("ns3::OnOffApplication::MaxBytes", UintegerValue(1448));
+    Config::SetDefault("ns3::OnOffApplication::PacketSize", UintegerValue(PACKET_SIZE));
+    Config::SetDefault("ns3::OnOffApplication::DataRate", DataRateValue(appRate));
+    Config::SetDefault("ns3::OnOffApplication::MaxBytes", UintegerValue(PACKET_SIZE));
 
     //接下来要在不同进程下根据拓扑配置创建节点
     //那么首先要分配节点给不同的进程
-    uint16_t leafP=LEAF/DST;//一个进程有几个leaf
-    double spineP=(double)SPINE/DST;//一个进程有几个spine
+    //节点按创建顺序编号: 服务器(按leaf), leaf, spine
+    std::vector<uint32_t> sid(LEAF*SERVER+LEAF+SPINE);
+    if(partition){
+        //由分区器根据拓扑分配进程, spine分散到各进程
+        TopologyPartitioner partitioner;
+        for(uint32_t i=0;i<sid.size();i++)
+            partitioner.AddNode();
+        for(uint32_t i=0;i<LEAF;i++){
+            for(uint32_t j=0;j<SERVER;j++)
+                partitioner.AddLink(i*SERVER+j, LEAF*SERVER+i, linkDelay);
+            for(uint32_t j=0;j<SPINE;j++)
+                partitioner.AddLink(LEAF*SERVER+i, LEAF*SERVER+LEAF+j, linkDelay,
+                                    std::min(1.0, (double)SERVER/SPINE));
+        }
+        sid=partitioner.Partition(DST);
+        RANK0COUT("Partition: " << partitioner.GetCutLinks(sid) << " remote links, imbalance "
+                  << partitioner.GetImbalance(sid) << std::endl);
+    }
+    else{
+        uint16_t leafP=LEAF/DST;//一个进程有几个leaf
+        double spineP=(double)SPINE/DST;//一个进程有几个spine
+        for(uint32_t i=0;i<LEAF;i++){
+            for(uint32_t j=0;j<SERVER;j++)
+                sid[i*SERVER+j]=i/leafP;
+            sid[LEAF*SERVER+i]=i/leafP;
+        }
+        for(uint32_t i=0;i<SPINE;i++)
+            sid[LEAF*SERVER+LEAF+i]=(uint16_t)(i/spineP);
+    }
     //首先创建服务器节点
     serverNodes.resize(LEAF);
     for(uint16_t i=0;i<LEAF;i++){
-        serverNodes[i].Create(SERVER, i/leafP);
-        if(systemId==i/leafP)
-            std::cout<<"process:" << systemId << " Create server nodes:" << serverNodes[i].GetN() << std::endl;
+        for(uint16_t j=0;j<SERVER;j++)
+            serverNodes[i].Add(CreateObject<Node>(sid[i*SERVER+j]));
     }
     NodeContainer routerNodes;//记录所有交换机节点 spine + leaf
     //然后创建leaf节点
     std::vector<Ptr<Node>> leafNodes(LEAF);
     for(uint16_t i=0;i<LEAF;i++){
-        leafNodes[i]=CreateObject<Node>(i/leafP);
-        if(systemId==i/leafP)
+        leafNodes[i]=CreateObject<Node>(sid[LEAF*SERVER+i]);
+        if(systemId==leafNodes[i]->GetSystemId())
             std::cout<<"process:" << systemId << " Create a leaf node id:" << leafNodes[i]->GetId() << std::endl;
         routerNodes.Add(leafNodes[i]);
     }
     //然后创建spine节点
     std::vector<Ptr<Node>> spineNodes(SPINE);
     for(uint16_t i=0;i<SPINE;i++){
-        spineNodes[i]=CreateObject<Node>((uint16_t)(i/spineP));
-        if(systemId==(uint16_t)(i/spineP))
+        spineNodes[i]=CreateObject<Node>(sid[LEAF*SERVER+LEAF+i]);
+        if(systemId==spineNodes[i]->GetSystemId())
             std::cout<<"process:" << systemId << " Create a spine node id:" << spineNodes[i]->GetId() << std::endl;
         routerNodes.Add(spineNodes[i]);
     }
+    if(hybrid > 1){
+        //每个进程的leaf轮流分给各线程, 服务器跟随其leaf, spine留在0号线程
+        std::map<uint32_t, uint32_t> leaves;//各进程已分配的leaf数
+        for(uint16_t i=0;i<LEAF;i++){
+            uint32_t thread = leaves[leafNodes[i]->GetSystemId()]++ % hybrid;
+            HybridSimulatorImpl::SetThread(leafNodes[i]->GetId(), thread);
+            for(uint16_t j=0;j<SERVER;j++)
+                HybridSimulatorImpl::SetThread(serverNodes[i].Get(j)->GetId(), thread);
+        }
+    }
 
     //那么接下来要创建链路了
     //首先创建server到leaf的链路
     PointToPointHelper leafLink;
-    leafLink.SetDeviceAttribute("DataRate", StringValue("25Mbps"));
-    leafLink.SetChannelAttribute("Delay", StringValue("2us"));
+    leafLink.SetDeviceAttribute("DataRate", DataRateValue(linkRate));
+    leafLink.SetChannelAttribute("Delay", TimeValue(linkDelay));
     std::vector<NetDeviceContainer> leafDevices(LEAF);
     std::vector<NetDeviceContainer> serverDevices(LEAF);
     for(int i=0;i<LEAF;i++){
@@ -362,8 +527,8 @@ int main(int argc, char* argv[]){
     
     //然后创建leaf到spine的链路
     PointToPointHelper spineLink;
-    spineLink.SetDeviceAttribute("DataRate", StringValue("25Mbps"));
-    spineLink.SetChannelAttribute("Delay", StringValue("2us"));
+    spineLink.SetDeviceAttribute("DataRate", DataRateValue(linkRate));
+    spineLink.SetChannelAttribute("Delay", TimeValue(linkDelay));
     std::vector<NetDeviceContainer> spineToLeaf(SPINE*LEAF);
     for(int i=0;i<SPINE;i++){
         for(int j=0;j<LEAF;j++)
@@ -390,8 +555,9 @@ int main(int argc, char* argv[]){
     Ipv4AddressHelper routerAddress;
     int i=0;
     for(i=0;i<LEAF;i++){
+        //每条服务器链路一个/30子网, 否则全局路由在leaf上分不清同一网段的服务器
         std::string address = "10." + std::to_string(i + 1) + ".1.0";
-        serverAddresses[i].SetBase(address.c_str(), "255.255.255.0");
+        serverAddresses[i].SetBase(address.c_str(), "255.255.255.252");
     }
     routerAddress.SetBase("10.0.1.0", "255.255.255.0");
     //交换机链路 interfaces
@@ -420,8 +586,8 @@ int main(int argc, char* argv[]){
             Ipv4InterfaceContainer ifc = serverAddresses[i].Assign(ndc);
             serverInterfaces[i].Add(ifc.Get(0));
             leafInterfaces[i].Add(ifc.Get(1));
+            serverAddresses[i].NewNetwork();
         }
-        serverAddresses[i].NewNetwork();
     }
 
     if (!nix)
@@ -432,13 +598,21 @@ int main(int argc, char* argv[]){
     RANK0COUT("topo Created"<<std::endl);
     rank0log("拓扑创建完毕 拓扑规模:"+ std::to_string(LEAF*SERVER)+" 进程分配:"+std::to_string(DST));
     MPI_Barrier(MPI_COMM_WORLD);
-    workLoad();
+    if(!dagFlows.empty())
+        dagWorkLoad(dagFlows, dagDependencies);
+    else if(!traceFile.empty())
+        traceWorkLoad(traceFile);
+    else
+        workLoad();
     RANK0COUT("workload Created"<<std::endl);
     MPI_Barrier(MPI_COMM_WORLD);
     rank0log("流量加载完毕");
-    Simulator::Stop(Seconds(100000));
+    if(checkpointPrefix.empty())//挂起的Stop事件会阻止写入检查点, 最后一个phase结束时会Stop
+        Simulator::Stop(Seconds(100000));
     auto start = std::chrono::high_resolution_clock::now();
     Simulator::Run();
+    if(fctStats)
+        FctCollector::Get()->Report();
     Simulator::Destroy();
     if (freeComm)
         MPI_Comm_free(&splitComm);
@@ -31,7 +31,7 @@
 namespace ns3
 {
 
-unsigned long SinkTracer::m_sinkCount = 0;
+std::atomic<unsigned long> SinkTracer::m_sinkCount{0};
 unsigned long SinkTracer::m_line = 0;
 int SinkTracer::m_worldRank = -1;
 int SinkTracer::m_worldSize = -1;
@@ -57,11 +57,12 @@ void
 SinkTracer::Verify()
 {
     unsigned long globalCount;
+    unsigned long localCount = m_sinkCount;
 
 #ifdef NS3_MPI
-    MPI_Reduce(&m_sinkCount, &globalCount, 1, MPI_UNSIGNED_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&localCount, &globalCount, 1, MPI_UNSIGNED_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
 #else
-    globalCount = m_sinkCount;
+    globalCount = localCount;
 #endif
     RANK0COUT("Observed sink traces (" << globalCount << ")\n");
 }
@@ -1,6 +1,7 @@
 #ifndef MPI_TEST_FIXTURES_H
 #define MPI_TEST_FIXTURES_H
 
+#include <atomic>
 #include <iomanip>
 #include <ios>
 #include <sstream>
@@ -132,11 +133,30 @@ class SinkTracer
         return m_line++;
     }
 
+    /**
+     * Get the sink trace count of this rank, to save it in a checkpoint.
+     * \return the sink trace count.
+     */
+    static std::string SaveSinkCount()
+    {
+        return std::to_string(m_sinkCount.load());
+    }
+
+    /**
+     * Set the sink trace count of this rank, from a checkpoint.
+     * \param [in] count The saved sink trace count.
+     */
+    static void RestoreSinkCount(const std::string& count)
+    {
+        m_sinkCount = std::stoul(count);
+    }
+
   private:
-    static unsigned long m_sinkCount; //!< Running sum of number of SinkTrace calls observed
-    static unsigned long m_line;      //!< Current output line number for ordering output
-    static int m_worldRank;           //!< MPI CommWorld rank
-    static int m_worldSize;           //!< MPI CommWorld size
+    /** Running sum of number of SinkTrace calls observed, by every thread */
+    static std::atomic<unsigned long> m_sinkCount;
+    static unsigned long m_line; //!< Current output line number for ordering output
+    static int m_worldRank;      //!< MPI CommWorld rank
+    static int m_worldSize;      //!< MPI CommWorld size
 };
 
 } // namespace ns3
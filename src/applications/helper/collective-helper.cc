@@ -0,0 +1,77 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "collective-helper.h"
+
+#include "ns3/abort.h"
+#include "ns3/enum.h"
+#include "ns3/ipv4.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
+namespace ns3
+{
+
+CollectiveHelper::CollectiveHelper(CollectiveApplication::Operation operation,
+                                   CollectiveApplication::Algorithm algorithm,
+                                   uint64_t messageSize)
+{
+    m_factory.SetTypeId("ns3::CollectiveApplication");
+    m_factory.Set("Operation", EnumValue(operation));
+    m_factory.Set("Algorithm", EnumValue(algorithm));
+    m_factory.Set("MessageSize", UintegerValue(messageSize));
+}
+
+void
+CollectiveHelper::SetAttribute(std::string name, const AttributeValue& value)
+{
+    m_factory.Set(name, value);
+}
+
+ApplicationContainer
+CollectiveHelper::Install(NodeContainer group) const
+{
+    std::vector<Ipv4Address> addresses;
+    for (NodeContainer::Iterator i = group.Begin(); i != group.End(); ++i)
+    {
+        Ptr<Ipv4> ipv4 = (*i)->GetObject<Ipv4>();
+        NS_ABORT_MSG_IF(!ipv4 || ipv4->GetNInterfaces() < 2,
+                        "node " << (*i)->GetId() << " has no IPv4 interface");
+        addresses.push_back(ipv4->GetAddress(1, 0).GetLocal());
+    }
+    return Install(group, addresses);
+}
+
+ApplicationContainer
+CollectiveHelper::Install(NodeContainer group, const std::vector<Ipv4Address>& addresses) const
+{
+    NS_ABORT_MSG_IF(addresses.size() != group.GetN(), "one address per member");
+    ApplicationContainer apps;
+    for (uint32_t i = 0; i < group.GetN(); i++)
+    {
+        Ptr<Node> node = group.Get(i);
+        if (node->GetSystemId() != Simulator::GetSystemId())
+        {
+            continue;
+        }
+        Ptr<CollectiveApplication> app = m_factory.Create<CollectiveApplication>();
+        app->SetGroup(addresses, i);
+        node->AddApplication(app);
+        apps.Add(app);
+    }
+    return apps;
+}
+
+} // namespace ns3
@@ -0,0 +1,90 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef COLLECTIVE_HELPER_H
+#define COLLECTIVE_HELPER_H
+
+#include "ns3/application-container.h"
+#include "ns3/attribute.h"
+#include "ns3/collective-application.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/node-container.h"
+#include "ns3/object-factory.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup collective
+ * \brief A helper to make it easier to run a collective operation on a
+ * group of nodes with ns3::CollectiveApplication.
+ */
+class CollectiveHelper
+{
+  public:
+    /**
+     * Create a CollectiveHelper to make it easier to work with
+     * CollectiveApplications.
+     *
+     * \param operation the collective operation
+     * \param algorithm the algorithm of the operation
+     * \param messageSize the size of the buffer of every member in bytes
+     */
+    CollectiveHelper(CollectiveApplication::Operation operation,
+                     CollectiveApplication::Algorithm algorithm,
+                     uint64_t messageSize);
+
+    /**
+     * Helper function used to set the underlying application attributes.
+     *
+     * \param name the name of the application attribute to set
+     * \param value the value of the application attribute to set
+     */
+    void SetAttribute(std::string name, const AttributeValue& value);
+
+    /**
+     * Install the members of a collective on a group of nodes, identified
+     * by the address of their first IPv4 interface.
+     *
+     * In a distributed simulation only the members on the nodes of this
+     * rank are installed; every rank must install the same group.
+     *
+     * \param group the nodes of the group, in the order of their index
+     * \returns Container of Ptr to the applications installed.
+     */
+    ApplicationContainer Install(NodeContainer group) const;
+
+    /**
+     * Install the members of a collective on a group of nodes, for
+     * instance RDMA servers without an IPv4 stack.
+     *
+     * \param group the nodes of the group, in the order of their index
+     * \param addresses the address of every node of the group
+     * \returns Container of Ptr to the applications installed.
+     */
+    ApplicationContainer Install(NodeContainer group,
+                                 const std::vector<Ipv4Address>& addresses) const;
+
+  private:
+    ObjectFactory m_factory; //!< Object factory.
+};
+
+} // namespace ns3
+
+#endif /* COLLECTIVE_HELPER_H */
@@ -0,0 +1,582 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "collective-application.h"
+
+#include "ns3/abort.h"
+#include "ns3/boolean.h"
+#include "ns3/enum.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/rdma-driver.h"
+#include "ns3/seq-ts-header.h"
+#include "ns3/simulator.h"
+#include "ns3/socket-factory.h"
+#include "ns3/socket.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("CollectiveApplication");
+
+NS_OBJECT_ENSURE_REGISTERED(CollectiveApplication);
+
+TypeId
+CollectiveApplication::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::CollectiveApplication")
+            .SetParent<Application>()
+            .SetGroupName("Applications")
+            .AddConstructor<CollectiveApplication>()
+            .AddAttribute("Operation",
+                          "The collective operation",
+                          EnumValue(ALL_REDUCE),
+                          MakeEnumAccessor(&CollectiveApplication::m_operation),
+                          MakeEnumChecker(ALL_REDUCE,
+                                          "AllReduce",
+                                          ALL_GATHER,
+                                          "AllGather",
+                                          ALL_TO_ALL,
+                                          "AllToAll"))
+            .AddAttribute("Algorithm",
+                          "The algorithm of the operation",
+                          EnumValue(RING),
+                          MakeEnumAccessor(&CollectiveApplication::m_algorithm),
+                          MakeEnumChecker(RING,
+                                          "Ring",
+                                          TREE,
+                                          "Tree",
+                                          HALVING_DOUBLING,
+                                          "HalvingDoubling",
+                                          HIERARCHICAL,
+                                          "Hierarchical",
+                                          PAIRWISE,
+                                          "Pairwise"))
+            .AddAttribute("Transport",
+                          "The transport of the transfers",
+                          EnumValue(UDP),
+                          MakeEnumAccessor(&CollectiveApplication::m_transport),
+                          MakeEnumChecker(UDP, "Udp", RDMA, "Rdma"))
+            .AddAttribute("MessageSize",
+                          "The size of the buffer of every member in bytes",
+                          UintegerValue(1048576),
+                          MakeUintegerAccessor(&CollectiveApplication::m_bytes),
+                          MakeUintegerChecker<uint64_t>())
+            .AddAttribute("LocalSize",
+                          "The number of consecutive members of a group of the "
+                          "Hierarchical algorithm",
+                          UintegerValue(1),
+                          MakeUintegerAccessor(&CollectiveApplication::m_localSize),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("Port",
+                          "The port of the members; RDMA queue pairs are sent "
+                          "from the following ports",
+                          UintegerValue(1000),
+                          MakeUintegerAccessor(&CollectiveApplication::m_port),
+                          MakeUintegerChecker<uint16_t>())
+            .AddAttribute("SegmentSize",
+                          "The payload of a UDP datagram",
+                          UintegerValue(1448),
+                          MakeUintegerAccessor(&CollectiveApplication::m_segmentSize),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("DataRate",
+                          "The rate the UDP datagrams are sent at",
+                          DataRateValue(DataRate("1Gb/s")),
+                          MakeDataRateAccessor(&CollectiveApplication::m_rate),
+                          MakeDataRateChecker())
+            .AddAttribute("PriorityGroup",
+                          "The priority group of the RDMA queue pairs",
+                          UintegerValue(3),
+                          MakeUintegerAccessor(&CollectiveApplication::m_pg),
+                          MakeUintegerChecker<uint16_t>())
+            .AddAttribute("Window",
+                          "Bound the RDMA queue pairs to one BDP in flight",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&CollectiveApplication::m_window),
+                          MakeBooleanChecker())
+            .AddAttribute("BaseRtt",
+                          "The base RTT of the RDMA queue pairs in nanoseconds",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&CollectiveApplication::m_baseRtt),
+                          MakeUintegerChecker<uint64_t>())
+            .AddTraceSource("Step",
+                            "A step of this member is over",
+                            MakeTraceSourceAccessor(&CollectiveApplication::m_stepTrace),
+                            "ns3::CollectiveApplication::StepTracedCallback")
+            .AddTraceSource("Done",
+                            "The operation is over on this member",
+                            MakeTraceSourceAccessor(&CollectiveApplication::m_doneTrace),
+                            "ns3::CollectiveApplication::DoneTracedCallback");
+    return tid;
+}
+
+CollectiveApplication::CollectiveApplication()
+    : m_rank(0),
+      m_step(0),
+      m_pendingSends(0),
+      m_next(0),
+      m_running(false)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+CollectiveApplication::~CollectiveApplication()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+CollectiveApplication::SetGroup(const std::vector<Ipv4Address>& group, uint32_t rank)
+{
+    NS_LOG_FUNCTION(this << group.size() << rank);
+    NS_ABORT_MSG_IF(rank >= group.size(), "member " << rank << " is not in the group");
+    m_group = group;
+    m_rank = rank;
+}
+
+uint32_t
+CollectiveApplication::GetStepsDone() const
+{
+    return m_step;
+}
+
+void
+CollectiveApplication::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    m_socket = nullptr;
+    Application::DoDispose();
+}
+
+/**
+ * \param bytes the size of a buffer
+ * \param parts the number of chunks of the buffer
+ * \param i the index of a chunk
+ * \return the size of the chunk, the first ones one byte larger if the
+ *         buffer does not divide evenly
+ */
+static uint64_t
+GetChunk(uint64_t bytes, uint32_t parts, uint32_t i)
+{
+    return bytes / parts + (i < bytes % parts ? 1 : 0);
+}
+
+/**
+ * Add the steps of a ring reduce-scatter or all-gather.  In step s the
+ * member at position p sends chunk (p + first - s) to the next member and
+ * receives chunk (p + first - s - 1) from the previous one.
+ *
+ * \param steps the steps of the member
+ * \param ring the members of the ring, in order
+ * \param p the position of the member in the ring
+ * \param bytes the size of the buffer
+ * \param first 0 for a reduce-scatter or a plain all-gather, 1 for the
+ *        all-gather after a reduce-scatter
+ */
+static void
+AddRing(std::vector<CollectiveApplication::Step>& steps,
+        const std::vector<uint32_t>& ring,
+        uint32_t p,
+        uint64_t bytes,
+        uint32_t first)
+{
+    uint32_t k = ring.size();
+    for (uint32_t s = 0; s + 1 < k; s++)
+    {
+        CollectiveApplication::Step step;
+        uint32_t sent = (p + first + 2 * k - s) % k;
+        uint32_t received = (p + first + 2 * k - s - 1) % k;
+        step.sends.push_back({ring[(p + 1) % k], GetChunk(bytes, k, sent)});
+        step.receives.push_back({ring[(p + k - 1) % k], GetChunk(bytes, k, received)});
+        steps.push_back(step);
+    }
+}
+
+std::vector<CollectiveApplication::Step>
+CollectiveApplication::GetSchedule(Operation operation,
+                                   Algorithm algorithm,
+                                   uint32_t size,
+                                   uint32_t rank,
+                                   uint64_t bytes,
+                                   uint32_t localSize)
+{
+    NS_ABORT_MSG_IF(rank >= size, "member " << rank << " is not in the group");
+    std::vector<Step> steps;
+    std::vector<uint32_t> all(size);
+    for (uint32_t i = 0; i < size; i++)
+    {
+        all[i] = i;
+    }
+    bool powerOfTwo = (size & (size - 1)) == 0;
+
+    if (operation == ALL_REDUCE && algorithm == RING)
+    {
+        AddRing(steps, all, rank, bytes, 0);
+        AddRing(steps, all, rank, bytes, 1);
+    }
+    else if (operation == ALL_GATHER && algorithm == RING)
+    {
+        AddRing(steps, all, rank, bytes, 0);
+    }
+    else if (operation == ALL_REDUCE && algorithm == TREE)
+    {
+        // Binary tree rooted at member 0: in the reduce step t the members
+        // of depth D - t send to their parent, in the broadcast step D + t
+        // the members of depth t send to their children
+        auto depth = [](uint32_t r) {
+            uint32_t d = 0;
+            for (r++; r > 1; r >>= 1)
+            {
+                d++;
+            }
+            return d;
+        };
+        uint32_t maxDepth = depth(size - 1);
+        uint32_t mine = depth(rank);
+        steps.resize(2 * maxDepth);
+        for (uint32_t child = 2 * rank + 1; child <= 2 * rank + 2 && child < size; child++)
+        {
+            steps[maxDepth - mine - 1].receives.push_back({child, bytes});
+            steps[maxDepth + mine].sends.push_back({child, bytes});
+        }
+        if (rank > 0)
+        {
+            steps[maxDepth - mine].sends.push_back({(rank - 1) / 2, bytes});
+            steps[maxDepth + mine - 1].receives.push_back({(rank - 1) / 2, bytes});
+        }
+    }
+    else if (operation == ALL_REDUCE && algorithm == HALVING_DOUBLING)
+    {
+        NS_ABORT_MSG_IF(!powerOfTwo, "halving-doubling needs a power of two members");
+        // Recursive halving reduce-scatter keeps half of the range at every
+        // step, the doubling all-gather mirrors it
+        uint64_t lo = 0;
+        uint64_t hi = bytes;
+        std::vector<Step> halving;
+        for (uint32_t d = size / 2; d >= 1; d /= 2)
+        {
+            uint64_t mid = lo + (hi - lo) / 2;
+            uint64_t lower = mid - lo;
+            uint64_t upper = hi - mid;
+            bool keepLower = (rank & d) == 0;
+            Step step;
+            step.sends.push_back({rank ^ d, keepLower ? upper : lower});
+            step.receives.push_back({rank ^ d, keepLower ? lower : upper});
+            halving.push_back(step);
+            (keepLower ? hi : lo) = mid;
+        }
+        steps = halving;
+        for (auto it = halving.rbegin(); it != halving.rend(); ++it)
+        {
+            Step step;
+            step.sends.push_back({it->receives[0].peer, it->receives[0].bytes});
+            step.receives.push_back({it->sends[0].peer, it->sends[0].bytes});
+            steps.push_back(step);
+        }
+    }
+    else if (operation == ALL_GATHER && algorithm == HALVING_DOUBLING)
+    {
+        NS_ABORT_MSG_IF(!powerOfTwo, "recursive doubling needs a power of two members");
+        // Recursive doubling: in the step of distance d every member holds
+        // the chunks of its aligned block of d members, and swaps it with
+        // the neighbouring block
+        for (uint32_t d = 1; d < size; d *= 2)
+        {
+            auto block = [bytes, size, d](uint32_t r) {
+                uint64_t total = 0;
+                for (uint32_t i = r & ~(d - 1); i < (r & ~(d - 1)) + d; i++)
+                {
+                    total += GetChunk(bytes, size, i);
+                }
+                return total;
+            };
+            Step step;
+            step.sends.push_back({rank ^ d, block(rank)});
+            step.receives.push_back({rank ^ d, block(rank ^ d)});
+            steps.push_back(step);
+        }
+    }
+    else if (operation == ALL_REDUCE && algorithm == HIERARCHICAL)
+    {
+        NS_ABORT_MSG_IF(size % localSize != 0,
+                        "the groups of " << localSize << " members do not divide " << size);
+        // Reduce-scatter in the group, all-reduce of the chunk owned with
+        // the members of the same position in the other groups, all-gather
+        // in the group
+        uint32_t groups = size / localSize;
+        uint32_t position = rank % localSize;
+        std::vector<uint32_t> local(localSize);
+        for (uint32_t i = 0; i < localSize; i++)
+        {
+            local[i] = rank - position + i;
+        }
+        std::vector<uint32_t> across(groups);
+        for (uint32_t j = 0; j < groups; j++)
+        {
+            across[j] = j * localSize + position;
+        }
+        uint64_t owned = GetChunk(bytes, localSize, (position + 1) % localSize);
+        AddRing(steps, local, position, bytes, 0);
+        AddRing(steps, across, rank / localSize, owned, 0);
+        AddRing(steps, across, rank / localSize, owned, 1);
+        AddRing(steps, local, position, bytes, 1);
+    }
+    else if (operation == ALL_TO_ALL && algorithm == PAIRWISE)
+    {
+        for (uint32_t s = 1; s < size; s++)
+        {
+            Step step;
+            uint32_t dst = (rank + s) % size;
+            step.sends.push_back({dst, GetChunk(bytes, size, dst)});
+            step.receives.push_back({(rank + size - s) % size, GetChunk(bytes, size, rank)});
+            steps.push_back(step);
+        }
+    }
+    else
+    {
+        NS_FATAL_ERROR("algorithm " << algorithm << " does not implement operation " << operation);
+    }
+
+    // Empty transfers, from buffers smaller than the group, are not sent
+    for (Step& step : steps)
+    {
+        for (std::vector<Transfer>* transfers : {&step.sends, &step.receives})
+        {
+            transfers->erase(std::remove_if(transfers->begin(),
+                                            transfers->end(),
+                                            [](const Transfer& t) { return t.bytes == 0; }),
+                             transfers->end());
+        }
+    }
+    return steps;
+}
+
+void
+CollectiveApplication::StartApplication()
+{
+    NS_LOG_FUNCTION(this);
+    NS_ABORT_MSG_IF(m_group.empty(), "the group of the collective is not set");
+
+    m_steps = GetSchedule(m_operation, m_algorithm, m_group.size(), m_rank, m_bytes, m_localSize);
+    NS_ABORT_MSG_IF(m_transport == RDMA && m_port + 1 + m_steps.size() > 65536,
+                    "the ports of the " << m_steps.size() << " steps overflow");
+    m_expected.assign(m_steps.size(), 0);
+    m_received.assign(m_steps.size(), 0);
+    for (uint32_t i = 0; i < m_steps.size(); i++)
+    {
+        for (const Transfer& transfer : m_steps[i].receives)
+        {
+            m_expected[i] += transfer.bytes;
+        }
+    }
+
+    if (m_transport == UDP)
+    {
+        if (!m_socket)
+        {
+            m_socket = Socket::CreateSocket(GetNode(), UdpSocketFactory::GetTypeId());
+            if (m_socket->Bind(InetSocketAddress(Ipv4Address::GetAny(), m_port)) == -1)
+            {
+                NS_FATAL_ERROR("Failed to bind socket");
+            }
+        }
+        m_socket->SetRecvCallback(MakeCallback(&CollectiveApplication::HandleRead, this));
+    }
+    else
+    {
+        Ptr<RdmaDriver> rdma = GetNode()->GetObject<RdmaDriver>();
+        NS_ABORT_MSG_IF(!rdma, "node " << GetNode()->GetId() << " has no RdmaDriver");
+        rdma->m_rdma->TraceConnectWithoutContext(
+            "RxData",
+            MakeCallback(&CollectiveApplication::HandleRdmaData, this));
+    }
+
+    m_running = true;
+    m_start = Simulator::Now();
+    StartStep(0);
+}
+
+void
+CollectiveApplication::StopApplication()
+{
+    NS_LOG_FUNCTION(this);
+    if (!m_running)
+    {
+        return;
+    }
+    m_running = false;
+    Simulator::Cancel(m_sendEvent);
+    if (m_socket)
+    {
+        m_socket->Close();
+        m_socket->SetRecvCallback(MakeNullCallback<void, Ptr<Socket>>());
+    }
+    if (m_transport == RDMA)
+    {
+        GetNode()->GetObject<RdmaDriver>()->m_rdma->TraceDisconnectWithoutContext(
+            "RxData",
+            MakeCallback(&CollectiveApplication::HandleRdmaData, this));
+    }
+}
+
+void
+CollectiveApplication::StartStep(uint32_t step)
+{
+    NS_LOG_FUNCTION(this << step);
+    m_step = step;
+    if (step == m_steps.size())
+    {
+        NS_LOG_INFO("member " << m_rank << " done in " << (Simulator::Now() - m_start).As(Time::S));
+        m_running = false;
+        m_doneTrace(Simulator::Now() - m_start);
+        return;
+    }
+
+    m_stepStart = Simulator::Now();
+    m_pendingSends = m_steps[step].sends.size();
+    if (m_transport == UDP)
+    {
+        m_unsent = m_steps[step].sends;
+        m_next = 0;
+        if (!m_unsent.empty())
+        {
+            SendDatagram();
+            return;
+        }
+    }
+    else
+    {
+        for (const Transfer& transfer : m_steps[step].sends)
+        {
+            GetNode()->GetObject<RdmaDriver>()->AddQueuePair(
+                transfer.bytes,
+                m_pg,
+                m_group[m_rank],
+                m_group[transfer.peer],
+                m_port + 1 + step,
+                m_port,
+                m_window ? 1 : 0,
+                m_baseRtt,
+                MakeCallback(&CollectiveApplication::SendDone, this),
+                Simulator::GetMaximumSimulationTime());
+        }
+    }
+    CheckStep();
+}
+
+void
+CollectiveApplication::CheckStep()
+{
+    if (!m_running || m_pendingSends > 0 || m_received[m_step] < m_expected[m_step])
+    {
+        return;
+    }
+    m_stepTrace(m_step, Simulator::Now() - m_stepStart);
+    StartStep(m_step + 1);
+}
+
+void
+CollectiveApplication::SendDatagram()
+{
+    NS_LOG_FUNCTION(this);
+
+    // Serve the sends of the step in turn
+    Transfer& transfer = m_unsent[m_next];
+    uint32_t payload = std::min<uint64_t>(m_segmentSize, transfer.bytes);
+    Ptr<Packet> packet = Create<Packet>(payload);
+    SeqTsHeader header;
+    header.SetSeq(m_step);
+    packet->AddHeader(header);
+    m_socket->SendTo(packet, 0, InetSocketAddress(m_group[transfer.peer], m_port));
+    transfer.bytes -= payload;
+    if (transfer.bytes == 0)
+    {
+        m_pendingSends--;
+    }
+    if (m_pendingSends == 0)
+    {
+        CheckStep();
+        return;
+    }
+    do
+    {
+        m_next = (m_next + 1) % m_unsent.size();
+    } while (m_unsent[m_next].bytes == 0);
+    // IPv4 and UDP headers
+    Time gap = m_rate.CalculateBytesTxTime(packet->GetSize() + 28);
+    m_sendEvent = Simulator::Schedule(gap, &CollectiveApplication::SendDatagram, this);
+}
+
+void
+CollectiveApplication::SendDone()
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT(m_pendingSends > 0);
+    m_pendingSends--;
+    CheckStep();
+}
+
+void
+CollectiveApplication::HandleRead(Ptr<Socket> socket)
+{
+    NS_LOG_FUNCTION(this << socket);
+    Ptr<Packet> packet;
+    while ((packet = socket->Recv()))
+    {
+        SeqTsHeader header;
+        if (packet->GetSize() < header.GetSerializedSize())
+        {
+            continue;
+        }
+        packet->RemoveHeader(header);
+        Receive(header.GetSeq(), packet->GetSize());
+    }
+}
+
+void
+CollectiveApplication::HandleRdmaData(uint32_t sip, uint16_t sport, uint16_t dport, uint32_t bytes)
+{
+    NS_LOG_FUNCTION(this << Ipv4Address(sip) << sport << dport << bytes);
+    if (dport != m_port || sport <= m_port)
+    {
+        return;
+    }
+    Receive(sport - m_port - 1, bytes);
+}
+
+void
+CollectiveApplication::Receive(uint32_t step, uint64_t bytes)
+{
+    NS_LOG_FUNCTION(this << step << bytes);
+    if (step >= m_received.size())
+    {
+        return;
+    }
+    m_received[step] += bytes;
+    if (step == m_step)
+    {
+        CheckStep();
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,256 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef COLLECTIVE_APPLICATION_H
+#define COLLECTIVE_APPLICATION_H
+
+#include "ns3/application.h"
+#include "ns3/data-rate.h"
+#include "ns3/event-id.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/ptr.h"
+#include "ns3/traced-callback.h"
+
+#include <vector>
+
+namespace ns3
+{
+
+class Socket;
+class Packet;
+class Address;
+
+/**
+ * \ingroup applications
+ * \defgroup collective CollectiveApplication
+ *
+ * This traffic generator plays one member of a collective operation
+ * (all-reduce, all-gather or all-to-all) of a group of nodes, generating
+ * the transfers of the chosen algorithm on the fly.
+ */
+
+/**
+ * \ingroup collective
+ *
+ * \brief One member of a collective operation
+ *
+ * The operation and its algorithm expand, for every member of the group,
+ * into the same numbered sequence of steps.  In each step a member sends
+ * some bytes to some members and receives some bytes from some members;
+ * a transfer appears in the same step of its sender and its receiver.  A
+ * member starts a step once its previous step is over, that is once all
+ * its sends are done and all its receives have arrived, so the data
+ * dependencies of the algorithm are kept without a global barrier.
+ *
+ * The MessageSize is the size of the buffer of every member: the vector
+ * reduced by an all-reduce, the output of an all-gather (every member
+ * contributes a chunk of it), and the data every member sends to the
+ * others in an all-to-all.
+ *
+ * The transfers go over UDP, paced at DataRate and tagged with their step
+ * in a SeqTsHeader, or as RDMA queue pairs of the RdmaDriver aggregated
+ * to the node; the queue pair of step s goes from port Port + 1 + s to
+ * Port, and the receiver counts the bytes of the RdmaHw RxData trace.
+ * UDP datagrams are not retransmitted: a member that loses one never ends
+ * its step, so the UDP transport needs a path without losses.
+ */
+class CollectiveApplication : public Application
+{
+  public:
+    /** The collective operation. */
+    enum Operation
+    {
+        ALL_REDUCE, //!< every member ends with the reduction of all the buffers
+        ALL_GATHER, //!< every member ends with the chunks of all the members
+        ALL_TO_ALL  //!< every member sends a distinct chunk to every other
+    };
+
+    /** The algorithm of the operation. */
+    enum Algorithm
+    {
+        RING,             //!< ring reduce-scatter and all-gather (all-reduce, all-gather)
+        TREE,             //!< binary tree reduce then broadcast (all-reduce)
+        HALVING_DOUBLING, //!< recursive halving and doubling (all-reduce, all-gather)
+        HIERARCHICAL,     //!< rings inside and across groups of LocalSize members (all-reduce)
+        PAIRWISE          //!< one peer per step, shifted by one every step (all-to-all)
+    };
+
+    /** The transport of the transfers. */
+    enum Transport
+    {
+        UDP, //!< paced UDP datagrams
+        RDMA //!< RDMA queue pairs
+    };
+
+    /** A transfer of a step. */
+    struct Transfer
+    {
+        uint32_t peer;  //!< index of the other member
+        uint64_t bytes; //!< size of the transfer
+    };
+
+    /** The transfers of a member in one step. */
+    struct Step
+    {
+        std::vector<Transfer> sends;    //!< transfers sent in the step
+        std::vector<Transfer> receives; //!< transfers received in the step
+    };
+
+    /**
+     * TracedCallback signature for the end of a step.
+     *
+     * \param [in] step the index of the step
+     * \param [in] time the time the step took
+     */
+    typedef void (*StepTracedCallback)(uint32_t step, Time time);
+
+    /**
+     * TracedCallback signature for the end of the operation.
+     *
+     * \param [in] time the time the operation took on this member
+     */
+    typedef void (*DoneTracedCallback)(Time time);
+
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    CollectiveApplication();
+
+    ~CollectiveApplication() override;
+
+    /**
+     * \param group the address of every member of the group, in the order
+     *        of their index
+     * \param rank the index of this member
+     */
+    void SetGroup(const std::vector<Ipv4Address>& group, uint32_t rank);
+
+    /**
+     * Expand an operation into the steps of one member.
+     *
+     * \param operation the operation
+     * \param algorithm the algorithm
+     * \param size the number of members
+     * \param rank the index of the member
+     * \param bytes the MessageSize
+     * \param localSize the number of consecutive members of a group of
+     *        the HIERARCHICAL algorithm, a divisor of size
+     * \return the steps of the member, the same number for every member
+     */
+    static std::vector<Step> GetSchedule(Operation operation,
+                                         Algorithm algorithm,
+                                         uint32_t size,
+                                         uint32_t rank,
+                                         uint64_t bytes,
+                                         uint32_t localSize = 1);
+
+    /**
+     * \return the number of steps finished by this member
+     */
+    uint32_t GetStepsDone() const;
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    void StartApplication() override;
+    void StopApplication() override;
+
+    /**
+     * Start a step, or end the operation after the last one.
+     *
+     * \param step the index of the step
+     */
+    void StartStep(uint32_t step);
+
+    /**
+     * Start the next step if the current one is over.
+     */
+    void CheckStep();
+
+    /**
+     * Send the next UDP datagram of the current step.
+     */
+    void SendDatagram();
+
+    /**
+     * Count a send of the current step as done.
+     */
+    void SendDone();
+
+    /**
+     * Receive the UDP datagrams.
+     *
+     * \param socket the socket
+     */
+    void HandleRead(Ptr<Socket> socket);
+
+    /**
+     * Count the bytes received by an RDMA queue pair.
+     *
+     * \param sip the remote address
+     * \param sport the remote port
+     * \param dport the local port
+     * \param bytes the bytes received in order
+     */
+    void HandleRdmaData(uint32_t sip, uint16_t sport, uint16_t dport, uint32_t bytes);
+
+    /**
+     * Count bytes received for a step.
+     *
+     * \param step the index of the step of the transfer
+     * \param bytes the bytes received
+     */
+    void Receive(uint32_t step, uint64_t bytes);
+
+    Operation m_operation;            //!< the operation
+    Algorithm m_algorithm;            //!< the algorithm
+    Transport m_transport;            //!< the transport
+    uint64_t m_bytes;                 //!< the MessageSize
+    uint32_t m_localSize;             //!< members per group of the HIERARCHICAL algorithm
+    uint16_t m_port;                  //!< the port of the members
+    uint32_t m_segmentSize;           //!< payload of a UDP datagram
+    DataRate m_rate;                  //!< pacing rate of the UDP datagrams
+    uint16_t m_pg;                    //!< priority group of the RDMA queue pairs
+    bool m_window;                    //!< window the RDMA queue pairs
+    uint64_t m_baseRtt;               //!< base RTT of the RDMA queue pairs (ns)
+    std::vector<Ipv4Address> m_group; //!< the address of every member
+    uint32_t m_rank;                  //!< the index of this member
+
+    std::vector<Step> m_steps;        //!< the steps of this member
+    std::vector<uint64_t> m_expected; //!< bytes to receive in every step
+    std::vector<uint64_t> m_received; //!< bytes received for every step
+    uint32_t m_step;                  //!< the current step
+    uint32_t m_pendingSends;          //!< sends of the current step not done yet
+    Time m_start;                     //!< start of the operation
+    Time m_stepStart;                 //!< start of the current step
+    Ptr<Socket> m_socket;             //!< the UDP socket
+    std::vector<Transfer> m_unsent;   //!< bytes left to send of the UDP sends of the step
+    uint32_t m_next;                  //!< the next UDP send served
+    EventId m_sendEvent;              //!< the next UDP datagram
+    bool m_running;                   //!< started and not over
+
+    /// Traced Callback: end of a step
+    TracedCallback<uint32_t, Time> m_stepTrace;
+    /// Traced Callback: end of the operation
+    TracedCallback<Time> m_doneTrace;
+};
+
+} // namespace ns3
+
+#endif /* COLLECTIVE_APPLICATION_H */
@@ -0,0 +1,365 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/boolean.h"
+#include "ns3/collective-application.h"
+#include "ns3/collective-helper.h"
+#include "ns3/data-rate.h"
+#include "ns3/enum.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/neighbor-cache-helper.h"
+#include "ns3/node-container.h"
+#include "ns3/qbb-helper.h"
+#include "ns3/rdma-driver.h"
+#include "ns3/rdma-hw.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/simulator.h"
+#include "ns3/switch-node.h"
+#include "ns3/test.h"
+#include "ns3/uinteger.h"
+
+#include <map>
+#include <tuple>
+
+/**
+ * \file
+ * \ingroup applications-test
+ * CollectiveApplication test suite
+ */
+
+using namespace ns3;
+
+/**
+ * \ingroup applications-test
+ * \brief Check that the schedules of all the members of a group match
+ */
+class CollectiveScheduleTest : public TestCase
+{
+  public:
+    /**
+     * \param operation the operation
+     * \param algorithm the algorithm
+     * \param size the number of members
+     * \param bytes the message size
+     * \param localSize the members per group of the hierarchical algorithm
+     */
+    CollectiveScheduleTest(CollectiveApplication::Operation operation,
+                           CollectiveApplication::Algorithm algorithm,
+                           uint32_t size,
+                           uint64_t bytes,
+                           uint32_t localSize = 1);
+
+  private:
+    void DoRun() override;
+
+    CollectiveApplication::Operation m_operation; //!< the operation
+    CollectiveApplication::Algorithm m_algorithm; //!< the algorithm
+    uint32_t m_size;                              //!< the number of members
+    uint64_t m_bytes;                             //!< the message size
+    uint32_t m_localSize;                         //!< members per group
+};
+
+CollectiveScheduleTest::CollectiveScheduleTest(CollectiveApplication::Operation operation,
+                                               CollectiveApplication::Algorithm algorithm,
+                                               uint32_t size,
+                                               uint64_t bytes,
+                                               uint32_t localSize)
+    : TestCase("Match the sends and receives of operation " + std::to_string(operation) +
+               ", algorithm " + std::to_string(algorithm) + ", " + std::to_string(size) +
+               " members, " + std::to_string(bytes) + " bytes"),
+      m_operation(operation),
+      m_algorithm(algorithm),
+      m_size(size),
+      m_bytes(bytes),
+      m_localSize(localSize)
+{
+}
+
+void
+CollectiveScheduleTest::DoRun()
+{
+    // bytes sent and received by (step, sender, receiver)
+    std::map<std::tuple<uint32_t, uint32_t, uint32_t>, uint64_t> sent;
+    std::map<std::tuple<uint32_t, uint32_t, uint32_t>, uint64_t> received;
+    uint64_t total = 0;
+    uint32_t nSteps = 0;
+    for (uint32_t rank = 0; rank < m_size; rank++)
+    {
+        std::vector<CollectiveApplication::Step> steps =
+            CollectiveApplication::GetSchedule(m_operation,
+                                               m_algorithm,
+                                               m_size,
+                                               rank,
+                                               m_bytes,
+                                               m_localSize);
+        if (rank == 0)
+        {
+            nSteps = steps.size();
+        }
+        NS_TEST_ASSERT_MSG_EQ(steps.size(), nSteps, "member " << rank << " has other steps");
+        for (uint32_t s = 0; s < steps.size(); s++)
+        {
+            for (const CollectiveApplication::Transfer& t : steps[s].sends)
+            {
+                NS_TEST_EXPECT_MSG_NE(t.peer, rank, "member " << rank << " sends to itself");
+                sent[{s, rank, t.peer}] += t.bytes;
+                total += t.bytes;
+            }
+            for (const CollectiveApplication::Transfer& t : steps[s].receives)
+            {
+                received[{s, t.peer, rank}] += t.bytes;
+            }
+        }
+    }
+    NS_TEST_EXPECT_MSG_EQ((sent == received), true, "sends and receives do not match");
+
+    // An all-reduce moves the buffer 2 (n - 1) times, an all-gather and an
+    // all-to-all n - 1 times
+    uint64_t expected = (m_size - 1) * m_bytes;
+    if (m_operation == CollectiveApplication::ALL_REDUCE)
+    {
+        expected *= 2;
+    }
+    NS_TEST_EXPECT_MSG_EQ(total, expected, "wrong volume");
+}
+
+/**
+ * \ingroup applications-test
+ * \brief Run a collective to completion over UDP or RDMA
+ */
+class CollectiveRunTest : public TestCase
+{
+  public:
+    /**
+     * \param algorithm the all-reduce algorithm
+     * \param transport the transport
+     */
+    CollectiveRunTest(CollectiveApplication::Algorithm algorithm,
+                      CollectiveApplication::Transport transport);
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Build four hosts on a SimpleChannel with an IPv4 stack.
+     *
+     * \param nodes the hosts
+     * \return the address of every host
+     */
+    std::vector<Ipv4Address> BuildUdp(NodeContainer& nodes);
+
+    /**
+     * Build four RDMA servers around a qbb switch.
+     *
+     * \param nodes the servers
+     * \return the address of every server
+     */
+    std::vector<Ipv4Address> BuildRdma(NodeContainer& nodes);
+
+    /**
+     * Record the end of the operation on a member.
+     *
+     * \param time the time the operation took
+     */
+    void Done(Time time);
+
+    CollectiveApplication::Algorithm m_algorithm; //!< the algorithm
+    CollectiveApplication::Transport m_transport; //!< the transport
+    std::vector<Time> m_done;                     //!< time of every member
+};
+
+CollectiveRunTest::CollectiveRunTest(CollectiveApplication::Algorithm algorithm,
+                                     CollectiveApplication::Transport transport)
+    : TestCase(std::string("Run an all-reduce over ") +
+               (transport == CollectiveApplication::UDP ? "UDP" : "RDMA") + ", algorithm " +
+               std::to_string(algorithm)),
+      m_algorithm(algorithm),
+      m_transport(transport)
+{
+}
+
+void
+CollectiveRunTest::Done(Time time)
+{
+    m_done.push_back(time);
+}
+
+std::vector<Ipv4Address>
+CollectiveRunTest::BuildUdp(NodeContainer& nodes)
+{
+    nodes.Create(4);
+    SimpleNetDeviceHelper simple;
+    simple.SetDeviceAttribute("DataRate", DataRateValue(DataRate("1Gb/s")));
+    NetDeviceContainer devices = simple.Install(nodes);
+    InternetStackHelper internet;
+    internet.Install(nodes);
+    Ipv4AddressHelper ipv4;
+    ipv4.SetBase("10.1.1.0", "255.255.255.0");
+    Ipv4InterfaceContainer interfaces = ipv4.Assign(devices);
+    // a datagram lost waiting for ARP would stall the collective
+    NeighborCacheHelper neighbors;
+    neighbors.PopulateNeighborCache(devices);
+    std::vector<Ipv4Address> addresses;
+    for (uint32_t i = 0; i < nodes.GetN(); i++)
+    {
+        addresses.push_back(interfaces.GetAddress(i));
+    }
+    return addresses;
+}
+
+std::vector<Ipv4Address>
+CollectiveRunTest::BuildRdma(NodeContainer& nodes)
+{
+    // servers first so their node id is their index, as RdmaHw expects
+    nodes.Create(4);
+    Ptr<SwitchNode> sw = CreateObject<SwitchNode>();
+    InternetStackHelper internet;
+    internet.Install(NodeContainer(sw));
+    QbbHelper qbb;
+    qbb.SetDeviceAttribute("DataRate", DataRateValue(DataRate("10Gb/s")));
+    qbb.SetChannelAttribute("Delay", TimeValue(MicroSeconds(1)));
+    std::vector<Ipv4Address> addresses;
+    for (uint32_t i = 0; i < nodes.GetN(); i++)
+    {
+        qbb.Install(nodes.Get(i), sw);
+        addresses.push_back(Ipv4Address(0x0b000001 + (nodes.Get(i)->GetId() << 8)));
+    }
+    Ptr<Ipv4> ipv4 = sw->GetObject<Ipv4>();
+    for (uint32_t j = 1; j < sw->GetNDevices(); j++)
+    {
+        ipv4->AddInterface(sw->GetDevice(j));
+        ipv4->AddAddress(j,
+                         Ipv4InterfaceAddress(Ipv4Address(0x0a000000 + (sw->GetId() << 8) + j),
+                                              Ipv4Mask("255.255.255.0")));
+        sw->m_mmu->ConfigEcn(j, 100, 400, 0.2);
+        sw->m_mmu->ConfigHdrm(j, 100000);
+        sw->AddTableEntry(addresses[j - 1], j);
+    }
+    sw->m_mmu->ConfigEcnUnit(1048);
+    sw->m_mmu->ConfigNPort(sw->GetNDevices() - 1);
+    sw->m_mmu->ConfigBufferSize(4 * 1024 * 1024);
+
+    for (uint32_t i = 0; i < nodes.GetN(); i++)
+    {
+        Ptr<RdmaHw> rdmaHw = CreateObject<RdmaHw>();
+        rdmaHw->SetAttribute("Mtu", UintegerValue(1000));
+        rdmaHw->SetAttribute("L2AckInterval", UintegerValue(1));
+        Ptr<RdmaDriver> rdma = CreateObject<RdmaDriver>();
+        rdma->SetNode(nodes.Get(i));
+        rdma->SetRdmaHw(rdmaHw);
+        nodes.Get(i)->AggregateObject(rdma);
+        rdma->Init();
+        for (uint32_t j = 0; j < nodes.GetN(); j++)
+        {
+            if (j != i)
+            {
+                rdmaHw->AddTableEntry(addresses[j], 0);
+            }
+        }
+    }
+    return addresses;
+}
+
+void
+CollectiveRunTest::DoRun()
+{
+    NodeContainer nodes;
+    std::vector<Ipv4Address> addresses =
+        m_transport == CollectiveApplication::UDP ? BuildUdp(nodes) : BuildRdma(nodes);
+
+    CollectiveHelper helper(CollectiveApplication::ALL_REDUCE, m_algorithm, 100000);
+    helper.SetAttribute("Transport", EnumValue(m_transport));
+    helper.SetAttribute("DataRate", DataRateValue(DataRate("100Mb/s")));
+    helper.SetAttribute("LocalSize", UintegerValue(2));
+    ApplicationContainer apps = helper.Install(nodes, addresses);
+    NS_TEST_ASSERT_MSG_EQ(apps.GetN(), 4, "one member per node");
+    for (uint32_t i = 0; i < apps.GetN(); i++)
+    {
+        apps.Get(i)->TraceConnectWithoutContext("Done",
+                                                MakeCallback(&CollectiveRunTest::Done, this));
+    }
+    apps.Start(MicroSeconds(10));
+    Simulator::Stop(Seconds(10));
+    Simulator::Run();
+
+    NS_TEST_EXPECT_MSG_EQ(m_done.size(), 4, "not every member is done");
+    uint32_t nSteps = CollectiveApplication::GetSchedule(CollectiveApplication::ALL_REDUCE,
+                                                         m_algorithm,
+                                                         4,
+                                                         0,
+                                                         1,
+                                                         2)
+                          .size();
+    for (uint32_t i = 0; i < apps.GetN(); i++)
+    {
+        Ptr<CollectiveApplication> app = DynamicCast<CollectiveApplication>(apps.Get(i));
+        NS_TEST_EXPECT_MSG_EQ(app->GetStepsDone(), nSteps, "member " << i << " is not done");
+    }
+    for (const Time& time : m_done)
+    {
+        NS_TEST_EXPECT_MSG_GT(time, Time(0), "the operation took no time");
+    }
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup applications-test
+ * \brief CollectiveApplication TestSuite
+ */
+class CollectiveApplicationTestSuite : public TestSuite
+{
+  public:
+    CollectiveApplicationTestSuite();
+};
+
+CollectiveApplicationTestSuite::CollectiveApplicationTestSuite()
+    : TestSuite("applications-collective", UNIT)
+{
+    using App = CollectiveApplication;
+    for (uint32_t size : {2, 5, 8})
+    {
+        AddTestCase(new CollectiveScheduleTest(App::ALL_REDUCE, App::RING, size, 1000003),
+                    TestCase::QUICK);
+        AddTestCase(new CollectiveScheduleTest(App::ALL_REDUCE, App::TREE, size, 1000003),
+                    TestCase::QUICK);
+        AddTestCase(new CollectiveScheduleTest(App::ALL_GATHER, App::RING, size, 1000003),
+                    TestCase::QUICK);
+        AddTestCase(new CollectiveScheduleTest(App::ALL_TO_ALL, App::PAIRWISE, size, 1000003),
+                    TestCase::QUICK);
+    }
+    for (uint32_t size : {2, 8})
+    {
+        AddTestCase(new CollectiveScheduleTest(App::ALL_REDUCE, App::HALVING_DOUBLING, size, 1001),
+                    TestCase::QUICK);
+        AddTestCase(new CollectiveScheduleTest(App::ALL_GATHER, App::HALVING_DOUBLING, size, 1001),
+                    TestCase::QUICK);
+    }
+    AddTestCase(new CollectiveScheduleTest(App::ALL_REDUCE, App::HIERARCHICAL, 12, 1000003, 4),
+                TestCase::QUICK);
+    // smaller buffers than groups leave some transfers empty
+    AddTestCase(new CollectiveScheduleTest(App::ALL_REDUCE, App::RING, 8, 5), TestCase::QUICK);
+    AddTestCase(new CollectiveScheduleTest(App::ALL_TO_ALL, App::PAIRWISE, 8, 3), TestCase::QUICK);
+
+    for (App::Algorithm algorithm :
+         {App::RING, App::TREE, App::HALVING_DOUBLING, App::HIERARCHICAL})
+    {
+        AddTestCase(new CollectiveRunTest(algorithm, App::UDP), TestCase::QUICK);
+    }
+    AddTestCase(new CollectiveRunTest(App::RING, App::RDMA), TestCase::QUICK);
+}
+
+static CollectiveApplicationTestSuite
+    g_collectiveApplicationTestSuite; //!< Static variable for test initialization
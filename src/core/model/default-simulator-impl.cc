@@ -23,6 +23,7 @@
 #include "log.h"
 #include "scheduler.h"
 #include "simulator.h"
+#include "uinteger.h"
 
 #include <cmath>
 
@@ -48,7 +49,15 @@ DefaultSimulatorImpl::GetTypeId()
     static TypeId tid = TypeId("ns3::DefaultSimulatorImpl")
                             .SetParent<SimulatorImpl>()
                             .SetGroupName("Core")
-                            .AddConstructor<DefaultSimulatorImpl>();
+                            .AddConstructor<DefaultSimulatorImpl>()
+                            .AddAttribute("CompactionThreshold",
+                                          "Number of cancelled events from which they are removed "
+                                          "from the event list, once they are half of it; "
+                                          "0 leaves them in the list until they expire",
+                                          UintegerValue(1024),
+                                          MakeUintegerAccessor(
+                                              &DefaultSimulatorImpl::m_compactionThreshold),
+                                          MakeUintegerChecker<uint32_t>());
     return tid;
 }
 
@@ -61,9 +70,11 @@ DefaultSimulatorImpl::DefaultSimulatorImpl()
     m_currentTs = 0;
     m_currentContext = Simulator::NO_CONTEXT;
     m_unscheduledEvents = 0;
+    m_cancelledEvents = 0;
     m_eventCount = 0;
     m_eventsWithContextEmpty = true;
     m_mainThreadId = std::this_thread::get_id();
+    m_profiler = EventProfiler::Create();
 }
 
 DefaultSimulatorImpl::~DefaultSimulatorImpl()
@@ -100,6 +111,10 @@ DefaultSimulatorImpl::Destroy()
             ev->Invoke();
         }
     }
+    if (m_profiler)
+    {
+        m_profiler->Write();
+    }
 }
 
 void
@@ -136,12 +151,23 @@ DefaultSimulatorImpl::ProcessOneEvent()
     NS_ASSERT(next.key.m_ts >= m_currentTs);
     m_unscheduledEvents--;
     m_eventCount++;
+    if (m_cancelledEvents > 0 && next.impl->IsCancelled())
+    {
+        m_cancelledEvents--;
+    }
 
     NS_LOG_LOGIC("handle " << next.key.m_ts);
     m_currentTs = next.key.m_ts;
     m_currentContext = next.key.m_context;
     m_currentUid = next.key.m_uid;
-    next.impl->Invoke();
+    if (m_profiler)
+    {
+        m_profiler->Invoke(next.impl, m_currentContext);
+    }
+    else
+    {
+        next.impl->Invoke();
+    }
     next.impl->Unref();
 
     ProcessEventsWithContext();
@@ -352,9 +378,63 @@ DefaultSimulatorImpl::Cancel(const EventId& id)
     if (!IsExpired(id))
     {
         id.PeekEventImpl()->Cancel();
+        if (id.GetUid() != EventId::UID::DESTROY)
+        {
+            m_cancelledEvents++;
+            CompactEvents();
+        }
     }
 }
 
+EventId
+DefaultSimulatorImpl::Reschedule(const EventId& id, const Time& delay)
+{
+    NS_ASSERT_MSG(m_mainThreadId == std::this_thread::get_id(),
+                  "Simulator::Reschedule Thread-unsafe invocation!");
+    NS_ASSERT_MSG(delay.IsPositive(), "DefaultSimulatorImpl::Reschedule(): Negative delay");
+
+    Scheduler::Event ev;
+    ev.impl = id.PeekEventImpl();
+    ev.key.m_ts = id.GetTs();
+    ev.key.m_context = id.GetContext();
+    ev.key.m_uid = id.GetUid();
+    Scheduler::EventKey key;
+    key.m_ts = m_currentTs + delay.GetTimeStep();
+    key.m_context = id.GetContext();
+    key.m_uid = m_uid;
+    if (ev.impl != nullptr && ev.key.m_ts == m_currentTs && ev.key.m_uid == m_currentUid &&
+        !ev.impl->IsCancelled())
+    {
+        // the event being executed, inserted again
+        ev.impl->Ref();
+        m_events->Insert(Scheduler::Event{ev.impl, key});
+        m_unscheduledEvents++;
+    }
+    else if (id.GetUid() != EventId::UID::DESTROY && !IsExpired(id))
+    {
+        m_events->Update(ev, key);
+    }
+    else
+    {
+        return EventId();
+    }
+    m_uid++;
+    return EventId(ev.impl, key.m_ts, key.m_context, key.m_uid);
+}
+
+void
+DefaultSimulatorImpl::CompactEvents()
+{
+    if (m_compactionThreshold == 0 || m_cancelledEvents < m_compactionThreshold ||
+        2 * m_cancelledEvents <= static_cast<uint32_t>(m_unscheduledEvents))
+    {
+        return;
+    }
+    NS_LOG_LOGIC("remove " << m_cancelledEvents << " cancelled events of " << m_unscheduledEvents);
+    m_unscheduledEvents -= m_events->RemoveCancelled();
+    m_cancelledEvents = 0;
+}
+
 bool
 DefaultSimulatorImpl::IsExpired(const EventId& id) const
 {
@@ -398,4 +478,19 @@ DefaultSimulatorImpl::GetEventCount() const
     return m_eventCount;
 }
 
+uint32_t
+DefaultSimulatorImpl::GetEventListSize() const
+{
+    return m_unscheduledEvents;
+}
+
+uint32_t
+DefaultSimulatorImpl::RemoveCancelledEvents()
+{
+    NS_LOG_FUNCTION(this);
+    m_unscheduledEvents -= m_events->RemoveCancelled();
+    m_cancelledEvents = 0;
+    return m_unscheduledEvents;
+}
+
 } // namespace ns3
@@ -20,9 +20,11 @@
 #ifndef DEFAULT_SIMULATOR_IMPL_H
 #define DEFAULT_SIMULATOR_IMPL_H
 
+#include "event-profiler.h"
 #include "simulator-impl.h"
 
 #include <list>
+#include <memory>
 #include <mutex>
 #include <thread>
 
@@ -68,6 +70,7 @@ class DefaultSimulatorImpl : public SimulatorImpl
     EventId ScheduleDestroy(EventImpl* event) override;
     void Remove(const EventId& id) override;
     void Cancel(const EventId& id) override;
+    EventId Reschedule(const EventId& id, const Time& delay) override;
     bool IsExpired(const EventId& id) const override;
     void Run() override;
     Time Now() const override;
@@ -78,11 +81,28 @@ class DefaultSimulatorImpl : public SimulatorImpl
     uint32_t GetContext() const override;
     uint64_t GetEventCount() const override;
 
+    /**
+     * \returns The number of events in the event list, including the
+     * cancelled events not yet removed.
+     */
+    uint32_t GetEventListSize() const;
+    /**
+     * Remove all the cancelled events from the event list now.
+     *
+     * \returns The number of events left in the event list.
+     */
+    uint32_t RemoveCancelledEvents();
+
   private:
     void DoDispose() override;
 
     /** Process the next event. */
     void ProcessOneEvent();
+    /**
+     * Remove the cancelled events from the event list, if they are at
+     * least CompactionThreshold and half of the list.
+     */
+    void CompactEvents();
     /** Move events from a different context into the main event queue. */
     void ProcessEventsWithContext();
 
@@ -133,6 +153,12 @@ class DefaultSimulatorImpl : public SimulatorImpl
      *  not counting the Destroy events; this is used for validation
      */
     int m_unscheduledEvents;
+    /** Number of cancelled events in the event list, at most. */
+    uint32_t m_cancelledEvents;
+    /** Smallest number of cancelled events removed from the event list. */
+    uint32_t m_compactionThreshold;
+    /** The event profiler, if the EventProfilerFile GlobalValue is set. */
+    std::unique_ptr<EventProfiler> m_profiler;
 
     /** Main execution thread. */
     std::thread::id m_mainThreadId;
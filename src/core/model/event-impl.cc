@@ -19,6 +19,7 @@
 
 #include "event-impl.h"
 
+#include "event-pool.h"
 #include "log.h"
 
 /**
@@ -67,4 +68,16 @@ EventImpl::IsCancelled()
     return m_cancel;
 }
 
+void*
+EventImpl::operator new(std::size_t size)
+{
+    return EventPool::Allocate(size);
+}
+
+void
+EventImpl::operator delete(void* p, std::size_t size)
+{
+    EventPool::Deallocate(p, size);
+}
+
 } // namespace ns3
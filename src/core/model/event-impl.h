@@ -21,6 +21,7 @@
 
 #include "simple-ref-count.h"
 
+#include <cstddef>
 #include <stdint.h>
 
 /**
@@ -67,6 +68,21 @@ class EventImpl : public SimpleRefCount<EventImpl>
      */
     bool IsCancelled();
 
+    /**
+     * Allocate an event from the EventPool.
+     *
+     * \param [in] size The size of the event.
+     * \returns The storage of the event.
+     */
+    static void* operator new(std::size_t size);
+    /**
+     * Return the storage of an event to the EventPool.
+     *
+     * \param [in] p The storage of the event.
+     * \param [in] size The size of the event.
+     */
+    static void operator delete(void* p, std::size_t size);
+
   protected:
     /**
      * Implementation for Invoke().
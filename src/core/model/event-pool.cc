@@ -0,0 +1,179 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "event-pool.h"
+
+#include "log.h"
+
+#include <atomic>
+#include <new>
+
+/**
+ * \file
+ * \ingroup events
+ * ns3::EventPool implementation.
+ */
+
+namespace ns3
+{
+
+// Note: no logging in Allocate and Deallocate, which are called for
+// every event, possibly after the logging framework is gone.
+NS_LOG_COMPONENT_DEFINE("EventPool");
+
+namespace
+{
+
+/** Number of size classes. */
+constexpr uint32_t N_CLASSES = EventPool::MaxSize / EventPool::Granularity;
+
+/** A free block, linked through its first bytes. */
+struct Block
+{
+    Block* next; /**< The next free block of the size class. */
+};
+
+/** The free lists of a thread. */
+struct Cache
+{
+    Block* head[N_CLASSES];     /**< The first free block of each size class. */
+    uint32_t count[N_CLASSES]; /**< The number of free blocks of each size class. */
+};
+
+/** Whether freed blocks are cached. */
+std::atomic<bool> g_enabled{true};
+
+/** The cache of this thread, created by the first pooled event. */
+thread_local Cache* t_cache = nullptr;
+/** Whether the cache of this thread was released, at thread exit. */
+thread_local bool t_released = false;
+
+/**
+ * Release the cache of a thread when the thread exits.
+ */
+struct CacheReleaser
+{
+    ~CacheReleaser()
+    {
+        Cache* cache = t_cache;
+        t_cache = nullptr;
+        t_released = true;
+        for (uint32_t c = 0; c < N_CLASSES; c++)
+        {
+            while (cache->head[c] != nullptr)
+            {
+                Block* b = cache->head[c];
+                cache->head[c] = b->next;
+                ::operator delete(b);
+            }
+        }
+        delete cache;
+    }
+};
+
+/**
+ * \returns The cache of this thread, nullptr once it is released.
+ */
+Cache*
+GetCache()
+{
+    if (t_cache == nullptr && !t_released)
+    {
+        t_cache = new Cache{};
+        // constructed once per thread, destroyed at thread exit
+        static thread_local CacheReleaser releaser;
+    }
+    return t_cache;
+}
+
+/**
+ * \param [in] size The size of an event, bytes, at least 1.
+ * \returns Its size class.
+ */
+inline uint32_t
+GetClass(std::size_t size)
+{
+    return (size - 1) / EventPool::Granularity;
+}
+
+} // unnamed namespace
+
+void*
+EventPool::Allocate(std::size_t size)
+{
+    uint32_t c = GetClass(size);
+    if (c >= N_CLASSES)
+    {
+        return ::operator new(size);
+    }
+    if (g_enabled.load(std::memory_order_relaxed))
+    {
+        Cache* cache = GetCache();
+        if (cache != nullptr && cache->head[c] != nullptr)
+        {
+            Block* b = cache->head[c];
+            cache->head[c] = b->next;
+            cache->count[c]--;
+            return b;
+        }
+    }
+    // a whole block of the size class, so that it can be cached once freed
+    return ::operator new((c + 1) * Granularity);
+}
+
+void
+EventPool::Deallocate(void* p, std::size_t size)
+{
+    uint32_t c = GetClass(size);
+    if (c < N_CLASSES && g_enabled.load(std::memory_order_relaxed))
+    {
+        Cache* cache = GetCache();
+        if (cache != nullptr && cache->count[c] < MaxCached)
+        {
+            Block* b = static_cast<Block*>(p);
+            b->next = cache->head[c];
+            cache->head[c] = b;
+            cache->count[c]++;
+            return;
+        }
+    }
+    ::operator delete(p);
+}
+
+void
+EventPool::Enable(bool enabled)
+{
+    NS_LOG_FUNCTION(enabled);
+    g_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool
+EventPool::IsEnabled()
+{
+    return g_enabled.load(std::memory_order_relaxed);
+}
+
+uint32_t
+EventPool::GetCached(std::size_t size)
+{
+    uint32_t c = GetClass(size);
+    if (c >= N_CLASSES || t_cache == nullptr)
+    {
+        return 0;
+    }
+    return t_cache->count[c];
+}
+
+} // namespace ns3
@@ -0,0 +1,100 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_POOL_H
+#define EVENT_POOL_H
+
+#include <cstddef>
+#include <stdint.h>
+
+/**
+ * \file
+ * \ingroup events
+ * ns3::EventPool declaration.
+ */
+
+namespace ns3
+{
+
+/**
+ * \ingroup events
+ * \brief Size-class pool of the EventImpl storage.
+ *
+ * Every simulation event is allocated by MakeEvent and freed once it is
+ * executed or cancelled and no EventId refers to it anymore, so a busy
+ * simulation spends a good share of its time in the system allocator.
+ * EventImpl routes its operator new and delete here instead.
+ *
+ * The blocks are rounded up to a multiple of Granularity bytes, one size
+ * class per multiple, up to MaxSize bytes; the arguments bound by MakeEvent
+ * are members of the event, so an event and its arguments take a single
+ * block.  A freed block is pushed on the free list of its size class in a
+ * per-thread cache, and the next event of that class reuses it without a
+ * lock.  A block freed by another thread than the one which allocated it,
+ * as with Simulator::ScheduleWithContext from a realtime or a worker
+ * thread, simply joins the cache of the freeing thread.  A cache keeps at
+ * most MaxCached blocks per size class and is released when its thread
+ * exits.  Larger events go to the system allocator.
+ *
+ * The pool is switched by the \c EventPoolEnabled GlobalValue, applied
+ * when the simulator implementation is created, or by Enable.  Every block
+ * is a plain heap block of its size class, so the pool can be switched at
+ * any time, including with events alive.  Disabling it helps memory
+ * checkers, which cannot see a use after free of a cached block.
+ */
+class EventPool
+{
+  public:
+    /** Size class granularity, bytes. */
+    static constexpr std::size_t Granularity = 16;
+    /** Size of the largest pooled block, bytes. */
+    static constexpr std::size_t MaxSize = 256;
+    /** Maximum number of blocks cached per size class and thread. */
+    static constexpr uint32_t MaxCached = 4096;
+
+    /**
+     * Allocate the storage of an event.
+     *
+     * \param [in] size The size of the event, bytes.
+     * \returns The storage.
+     */
+    static void* Allocate(std::size_t size);
+    /**
+     * Free the storage of an event.
+     *
+     * \param [in] p The storage, from Allocate.
+     * \param [in] size The size given to Allocate.
+     */
+    static void Deallocate(void* p, std::size_t size);
+
+    /**
+     * Switch the pool on or off.
+     *
+     * \param [in] enabled Whether freed blocks are cached and reused.
+     */
+    static void Enable(bool enabled);
+    /** \returns Whether the pool is on. */
+    static bool IsEnabled();
+
+    /**
+     * \param [in] size The size of an event, bytes.
+     * \returns The number of blocks of its size class cached by this thread.
+     */
+    static uint32_t GetCached(std::size_t size);
+};
+
+} // namespace ns3
+
+#endif /* EVENT_POOL_H */
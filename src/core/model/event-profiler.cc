@@ -0,0 +1,272 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "event-profiler.h"
+
+#include "global-value.h"
+#include "log.h"
+#include "simulator.h"
+#include "string.h"
+#include "uinteger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <vector>
+
+#if (__GNUC__ >= 3)
+#include <cstdlib>
+#include <cxxabi.h>
+#endif
+
+/**
+ * \file
+ * \ingroup events
+ * ns3::EventProfiler implementation.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("EventProfiler");
+
+/**
+ * \ingroup events
+ * \brief The file of the event profile, empty for no profile.
+ *
+ * Applied when the simulator implementation is created.
+ */
+static GlobalValue g_eventProfilerFile =
+    GlobalValue("EventProfilerFile",
+                "Sample the events executed, and write their profile to this file "
+                "at Simulator::Destroy; empty for no profile",
+                StringValue(""),
+                MakeStringChecker());
+
+/**
+ * \ingroup events
+ * \brief The mean number of events between two samples of the event profile.
+ */
+static GlobalValue g_eventProfilerPeriod =
+    GlobalValue("EventProfilerPeriod",
+                "Mean number of events between two samples of the event profile",
+                UintegerValue(64),
+                MakeUintegerChecker<uint32_t>(1));
+
+namespace
+{
+
+/**
+ * \param [in] mangled A mangled type name.
+ * \returns The demangled name, if the compiler provides it.
+ */
+std::string
+Demangle(const char* mangled)
+{
+#if (__GNUC__ >= 3)
+    int status;
+    char* demangled = abi::__cxa_demangle(mangled, nullptr, nullptr, &status);
+    if (status == 0 && demangled != nullptr)
+    {
+        std::string name(demangled);
+        std::free(demangled);
+        return name;
+    }
+#endif
+    return mangled;
+}
+
+/**
+ * \param [in] type The type of an event, or void for the cancelled events.
+ * \returns The name of its target.
+ */
+std::string
+GetTypeTargetName(const std::type_index& type)
+{
+    if (type == std::type_index(typeid(void)))
+    {
+        return "cancelled";
+    }
+    std::string name = Demangle(type.name());
+    // the classes of MakeEvent are local, named after its template arguments,
+    // the first of which is the type of the method or function
+    const std::string prefix = "MakeEvent<";
+    std::size_t start = name.find(prefix);
+    if (start == std::string::npos)
+    {
+        return name;
+    }
+    start += prefix.size();
+    int depth = 0;
+    std::size_t end = start;
+    for (; end < name.size(); end++)
+    {
+        char c = name[end];
+        if (c == '<' || c == '(' || c == '[' || c == '{')
+        {
+            depth++;
+        }
+        else if (c == '>' || c == ')' || c == ']' || c == '}')
+        {
+            if (depth == 0)
+            {
+                break;
+            }
+            depth--;
+        }
+        else if (c == ',' && depth == 0)
+        {
+            break;
+        }
+    }
+    return name.substr(start, end - start);
+}
+
+} // unnamed namespace
+
+std::unique_ptr<EventProfiler>
+EventProfiler::Create()
+{
+    StringValue fileName;
+    g_eventProfilerFile.GetValue(fileName);
+    if (fileName.Get().empty())
+    {
+        return nullptr;
+    }
+    UintegerValue period;
+    g_eventProfilerPeriod.GetValue(period);
+    return std::make_unique<EventProfiler>(fileName.Get(), period.Get());
+}
+
+EventProfiler::EventProfiler(const std::string& fileName, uint32_t period)
+    : m_fileName(fileName),
+      m_period(std::max<uint32_t>(period, 1)),
+      m_gap(1),
+      m_state(0x853c49e6748fea9bULL),
+      m_events(0),
+      m_samples(0)
+{
+    NS_LOG_FUNCTION(this << fileName << period);
+}
+
+void
+EventProfiler::Sample(EventImpl* event, uint32_t context)
+{
+    // the next gap, uniform in [1, 2 * period - 1]
+    m_state = m_state * 6364136223846793005ULL + 1442695040888963407ULL;
+    m_gap = 1 + (m_state >> 33) % (2 * uint64_t(m_period) - 1);
+
+    std::type_index type = event->IsCancelled() ? typeid(void) : typeid(*event);
+    auto start = std::chrono::steady_clock::now();
+    event->Invoke();
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  std::chrono::steady_clock::now() - start)
+                  .count();
+    Entry& entry = m_entries[Key(type, context)];
+    entry.samples++;
+    entry.ns += ns;
+    m_samples++;
+}
+
+std::unique_ptr<EventProfiler>
+EventProfiler::Fork() const
+{
+    return std::make_unique<EventProfiler>(m_fileName, m_period);
+}
+
+void
+EventProfiler::Merge(const EventProfiler& other)
+{
+    NS_LOG_FUNCTION(this << &other);
+    m_events += other.m_events;
+    m_samples += other.m_samples;
+    for (const auto& [key, entry] : other.m_entries)
+    {
+        Entry& total = m_entries[key];
+        total.samples += entry.samples;
+        total.ns += entry.ns;
+    }
+}
+
+void
+EventProfiler::Write(const std::string& suffix) const
+{
+    NS_LOG_FUNCTION(this << suffix);
+    std::string name = m_fileName + suffix;
+    NS_LOG_INFO("writing the profile of " << m_samples << " samples of " << m_events
+                                          << " events to " << name);
+
+    // one stack per line, the most expensive first
+    struct Line
+    {
+        std::string stack; //!< The target;node stack.
+        uint64_t ns;       //!< Estimated wall clock time, ns.
+        uint64_t count;    //!< Estimated number of events.
+    };
+
+    std::vector<Line> lines;
+    double scale = m_samples > 0 ? double(m_events) / m_samples : 0;
+    std::unordered_map<std::type_index, std::string> targets;
+    for (const auto& [key, entry] : m_entries)
+    {
+        auto it = targets.find(key.first);
+        if (it == targets.end())
+        {
+            it = targets.emplace(key.first, GetTypeTargetName(key.first)).first;
+        }
+        std::string node = key.second == Simulator::NO_CONTEXT
+                               ? std::string("no node")
+                               : "node " + std::to_string(key.second);
+        lines.push_back(Line{it->second + ";" + node,
+                             uint64_t(entry.ns * scale + 0.5),
+                             uint64_t(entry.samples * scale + 0.5)});
+    }
+    std::sort(lines.begin(), lines.end(), [](const Line& a, const Line& b) {
+        return a.ns > b.ns || (a.ns == b.ns && a.stack < b.stack);
+    });
+
+    std::ofstream time(name.c_str(), std::ios::out | std::ios::trunc);
+    std::ofstream count((name + ".count").c_str(), std::ios::out | std::ios::trunc);
+    if (!time || !count)
+    {
+        NS_LOG_WARN("cannot write " << name);
+        return;
+    }
+    for (const Line& line : lines)
+    {
+        time << line.stack << " " << line.ns << "\n";
+        count << line.stack << " " << line.count << "\n";
+    }
+}
+
+uint64_t
+EventProfiler::GetEvents() const
+{
+    return m_events;
+}
+
+uint64_t
+EventProfiler::GetSamples() const
+{
+    return m_samples;
+}
+
+std::string
+EventProfiler::GetTargetName(const EventImpl& event)
+{
+    return GetTypeTargetName(typeid(event));
+}
+
+} // namespace ns3
@@ -0,0 +1,178 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_PROFILER_H
+#define EVENT_PROFILER_H
+
+#include "event-impl.h"
+
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+
+/**
+ * \file
+ * \ingroup events
+ * ns3::EventProfiler declaration.
+ */
+
+namespace ns3
+{
+
+/**
+ * \ingroup events
+ * \brief Sampling profiler of the events executed by the simulator.
+ *
+ * The simulator implementations which support it execute their events
+ * through Invoke when the profiler is on.  About one event in
+ * \c EventProfilerPeriod is timed with the wall clock, the gap between
+ * two sampled events being drawn around the period so that periodic
+ * events are not missed or always hit.  The samples are aggregated by
+ * event target and node context; an event made by MakeEvent from a
+ * class method is attributed to the type of the method, such as
+ * `void (ns3::RdmaHw::*)(ns3::Ptr<ns3::RdmaQueuePair>)`, any other event
+ * to its own type.
+ *
+ * Write dumps the totals, scaled from the samples to all the events, in
+ * the folded stack format of flame graph tools, one `target;node` stack
+ * per line: the estimated wall clock time, in nanoseconds, to the file,
+ * and the estimated number of events to the file with a \c .count suffix.
+ *
+ * The profiler is switched on by a non-empty \c EventProfilerFile
+ * GlobalValue, read when the simulator implementation is created, and
+ * written by its Destroy.  When it is off the simulator only tests a
+ * null pointer per event.  A profiler is not thread safe: a simulator
+ * implementation with several threads gives each one its own, made by
+ * Fork, and merges them back.
+ */
+class EventProfiler
+{
+  public:
+    /**
+     * Create the profiler of a simulator implementation.
+     *
+     * \returns The profiler, null if \c EventProfilerFile is empty.
+     */
+    static std::unique_ptr<EventProfiler> Create();
+
+    /**
+     * Constructor.
+     *
+     * \param [in] fileName The name of the file to write.
+     * \param [in] period The mean number of events between two samples.
+     */
+    EventProfiler(const std::string& fileName, uint32_t period);
+
+    /**
+     * Invoke an event, and sample it.
+     *
+     * \param [in] event The event.
+     * \param [in] context The context of the event.
+     */
+    inline void Invoke(EventImpl* event, uint32_t context);
+
+    /**
+     * Create an empty profiler with the same file and period, for a
+     * thread of a simulator implementation which runs several.
+     *
+     * \returns The new profiler.
+     */
+    std::unique_ptr<EventProfiler> Fork() const;
+
+    /**
+     * Add the events and samples of another profiler to this one.
+     *
+     * \param [in] other The profiler to add, as one made by Fork.
+     */
+    void Merge(const EventProfiler& other);
+
+    /**
+     * Write the profile, to the \c EventProfilerFile and its \c .count
+     * companion.
+     *
+     * \param [in] suffix A suffix to the file name, as the rank of a
+     * distributed simulation.
+     */
+    void Write(const std::string& suffix = "") const;
+
+    /** \returns The number of events executed. */
+    uint64_t GetEvents() const;
+    /** \returns The number of events sampled. */
+    uint64_t GetSamples() const;
+
+    /**
+     * \param [in] event An event.
+     * \returns The name of its target in the profile.
+     */
+    static std::string GetTargetName(const EventImpl& event);
+
+  private:
+    /**
+     * Time and record an event.
+     *
+     * \param [in] event The event.
+     * \param [in] context The context of the event.
+     */
+    void Sample(EventImpl* event, uint32_t context);
+
+    /** Totals of the samples of a target and node. */
+    struct Entry
+    {
+        uint64_t samples{0}; //!< Number of samples.
+        uint64_t ns{0};      //!< Wall clock time of the samples, ns.
+    };
+
+    /** Key of an Entry: the type of the event and its context. */
+    typedef std::pair<std::type_index, uint32_t> Key;
+
+    /** Hash of a Key. */
+    struct KeyHash
+    {
+        /**
+         * \param [in] key The key.
+         * \returns Its hash.
+         */
+        std::size_t operator()(const Key& key) const
+        {
+            return key.first.hash_code() ^ (std::size_t(key.second) * 0x9e3779b97f4a7c15ULL);
+        }
+    };
+
+    std::string m_fileName;                            //!< Output file name.
+    uint32_t m_period;                                 //!< Mean gap between samples.
+    uint32_t m_gap;                                    //!< Events left before the next sample.
+    uint64_t m_state;                                  //!< State of the gap generator.
+    uint64_t m_events;                                 //!< Number of events executed.
+    uint64_t m_samples;                                //!< Number of events sampled.
+    std::unordered_map<Key, Entry, KeyHash> m_entries; //!< Totals per target and node.
+};
+
+void
+EventProfiler::Invoke(EventImpl* event, uint32_t context)
+{
+    m_events++;
+    if (--m_gap > 0)
+    {
+        event->Invoke();
+        return;
+    }
+    Sample(event, context);
+}
+
+} // namespace ns3
+
+#endif /* EVENT_PROFILER_H */
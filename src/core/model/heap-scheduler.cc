@@ -152,10 +152,10 @@ HeapScheduler::IsEmpty() const
 }
 
 void
-HeapScheduler::BottomUp()
+HeapScheduler::BottomUp(std::size_t start)
 {
     NS_LOG_FUNCTION(this);
-    std::size_t index = Last();
+    std::size_t index = start;
     while (!IsRoot(index) && IsLessStrictly(index, Parent(index)))
     {
         Exch(index, Parent(index));
@@ -203,7 +203,7 @@ HeapScheduler::Insert(const Event& ev)
 {
     NS_LOG_FUNCTION(this << &ev);
     m_heap.push_back(ev);
-    BottomUp();
+    BottomUp(Last());
 }
 
 Scheduler::Event
@@ -236,6 +236,30 @@ HeapScheduler::Remove(const Event& ev)
             NS_ASSERT(m_heap[i].impl == ev.impl);
             Exch(i, Last());
             m_heap.pop_back();
+            if (!IsBottom(i))
+            {
+                // the last item may belong above or below i
+                BottomUp(i);
+                TopDown(i);
+            }
+            return;
+        }
+    }
+    NS_ASSERT(false);
+}
+
+void
+HeapScheduler::Update(const Event& ev, const EventKey& key)
+{
+    NS_LOG_FUNCTION(this << ev.impl << key.m_ts << key.m_uid);
+    std::size_t uid = ev.key.m_uid;
+    for (std::size_t i = 1; i < m_heap.size(); i++)
+    {
+        if (uid == m_heap[i].key.m_uid)
+        {
+            NS_ASSERT(m_heap[i].impl == ev.impl);
+            m_heap[i].key = key;
+            BottomUp(i);
             TopDown(i);
             return;
         }
@@ -243,4 +267,30 @@ HeapScheduler::Remove(const Event& ev)
     NS_ASSERT(false);
 }
 
+uint32_t
+HeapScheduler::RemoveCancelled()
+{
+    NS_LOG_FUNCTION(this);
+    std::size_t last = Root();
+    for (std::size_t i = Root(); i < m_heap.size(); i++)
+    {
+        if (m_heap[i].impl->IsCancelled())
+        {
+            m_heap[i].impl->Unref();
+        }
+        else
+        {
+            m_heap[last++] = m_heap[i];
+        }
+    }
+    uint32_t removed = m_heap.size() - last;
+    m_heap.resize(last);
+    // heapify, from the last parent up to the root
+    for (std::size_t i = Parent(Last()); i >= Root(); i--)
+    {
+        TopDown(i);
+    }
+    return removed;
+}
+
 } // namespace ns3
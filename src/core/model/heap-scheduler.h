@@ -62,6 +62,7 @@ namespace ns3
  * PeekNext()   | Constant        | Heap kept sorted
  * Remove()     | Logarithmic     | Search, heapify
  * RemoveNext() | Logarithmic     | Heapify
+ * Update()     | Logarithmic     | Search, heapify
  *
  * \par Memory Complexity
  *
@@ -90,6 +91,8 @@ class HeapScheduler : public Scheduler
     Scheduler::Event PeekNext() const override;
     Scheduler::Event RemoveNext() override;
     void Remove(const Scheduler::Event& ev) override;
+    void Update(const Scheduler::Event& ev, const Scheduler::EventKey& key) override;
+    uint32_t RemoveCancelled() override;
 
   private:
     /** Event list type:  vector of Events, managed as a heap. */
@@ -171,8 +174,12 @@ class HeapScheduler : public Scheduler
      * \param [in] b The second item.
      */
     inline void Exch(std::size_t a, std::size_t b);
-    /** Percolate a newly inserted Last item to its proper position. */
-    void BottomUp();
+    /**
+     * Percolate an item up to its proper position, as a newly inserted Last item.
+     *
+     * \param [in] start Starting entry.
+     */
+    void BottomUp(std::size_t start);
     /**
      * Percolate a deletion bubble down the heap.
      *
@@ -0,0 +1,405 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-scheduler.h"
+
+#include "assert.h"
+#include "event-impl.h"
+#include "log.h"
+#include "type-id.h"
+#include "uinteger.h"
+
+#include <algorithm>
+#include <limits>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler class implementation.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("LadderScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED(LadderScheduler);
+
+TypeId
+LadderScheduler::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::LadderScheduler")
+            .SetParent<Scheduler>()
+            .SetGroupName("Core")
+            .AddConstructor<LadderScheduler>()
+            .AddAttribute("Threshold",
+                          "Largest bucket moved to Bottom without spawning a finer rung",
+                          UintegerValue(50),
+                          MakeUintegerAccessor(&LadderScheduler::m_threshold),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("MaxRungs",
+                          "Maximum number of rungs of the ladder",
+                          UintegerValue(8),
+                          MakeUintegerAccessor(&LadderScheduler::m_maxRungs),
+                          MakeUintegerChecker<uint32_t>(1));
+    return tid;
+}
+
+LadderScheduler::LadderScheduler()
+    : m_topStart(0),
+      m_topMin(std::numeric_limits<uint64_t>::max()),
+      m_topMax(0),
+      m_nRungs(0),
+      m_bottomHead(0),
+      m_spawnSize(0),
+      m_qSize(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+LadderScheduler::~LadderScheduler()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+uint64_t
+LadderScheduler::GetRungEnd(uint32_t level) const
+{
+    if (level == 0)
+    {
+        return m_topStart;
+    }
+    const Rung& above = m_rungs[level - 1];
+    return above.start + above.current * above.width;
+}
+
+LadderScheduler::Rung&
+LadderScheduler::NewRung(uint64_t start, uint64_t end, uint32_t n)
+{
+    NS_LOG_FUNCTION(this << start << end << n);
+    NS_ASSERT(end > start && n > 0);
+    if (m_nRungs == m_rungs.size())
+    {
+        m_rungs.emplace_back();
+    }
+    Rung& rung = m_rungs[m_nRungs++];
+    uint64_t span = end - start;
+    rung.start = start;
+    rung.width = std::max<uint64_t>((span + n - 1) / n, 1);
+    rung.nBuckets = (span + rung.width - 1) / rung.width;
+    rung.current = 0;
+    rung.count = 0;
+    if (rung.buckets.size() < rung.nBuckets)
+    {
+        rung.buckets.resize(rung.nBuckets);
+    }
+    return rung;
+}
+
+void
+LadderScheduler::InsertRung(Rung& rung, const Scheduler::Event& ev)
+{
+    uint64_t index = (ev.key.m_ts - rung.start) / rung.width;
+    NS_ASSERT(index >= rung.current && index < rung.nBuckets);
+    rung.buckets[index].push_back(ev);
+    rung.count++;
+}
+
+void
+LadderScheduler::InsertBottom(const Scheduler::Event& ev)
+{
+    auto it = std::upper_bound(m_bottom.begin() + m_bottomHead, m_bottom.end(), ev);
+    m_bottom.insert(it, ev);
+    if (m_bottom.size() - m_bottomHead > m_spawnSize && m_nRungs < m_maxRungs)
+    {
+        SpawnBottom();
+    }
+}
+
+void
+LadderScheduler::SpawnBottom()
+{
+    NS_LOG_FUNCTION(this);
+    uint32_t n = m_bottom.size() - m_bottomHead;
+    uint64_t start = m_bottom[m_bottomHead].key.m_ts;
+    Rung& rung = NewRung(start, GetRungEnd(m_nRungs), n);
+    for (uint32_t i = m_bottomHead; i < m_bottom.size(); i++)
+    {
+        InsertRung(rung, m_bottom[i]);
+    }
+    m_bottom.clear();
+    m_bottomHead = 0;
+    Refill();
+}
+
+void
+LadderScheduler::Refill()
+{
+    NS_LOG_FUNCTION(this);
+    while (m_bottomHead == m_bottom.size())
+    {
+        m_bottom.clear();
+        m_bottomHead = 0;
+        if (m_nRungs == 0)
+        {
+            PurgeTop();
+            if (m_top.empty())
+            {
+                break;
+            }
+            // the first rung, as many buckets as events over the span of Top
+            Rung& rung = NewRung(m_topMin, m_topMax + 1, m_top.size());
+            for (const Scheduler::Event& ev : m_top)
+            {
+                InsertRung(rung, ev);
+            }
+            m_top.clear();
+            m_topStart = rung.start + rung.nBuckets * rung.width;
+            m_topMin = std::numeric_limits<uint64_t>::max();
+            m_topMax = 0;
+            continue;
+        }
+        uint32_t level = m_nRungs - 1;
+        if (m_rungs[level].count == 0)
+        {
+            m_nRungs--;
+            continue;
+        }
+        Rung* rung = &m_rungs[level];
+        while (rung->buckets[rung->current].empty())
+        {
+            rung->current++;
+        }
+        Bucket& bucket = rung->buckets[rung->current];
+        uint32_t n = bucket.size();
+        rung->count -= n;
+        rung->current++;
+        if (n > m_threshold && rung->width > 1 && m_nRungs < m_maxRungs)
+        {
+            // spread the bucket over a finer rung
+            Bucket events;
+            events.swap(bucket);
+            uint64_t start = rung->start + (rung->current - 1) * rung->width;
+            uint64_t end = start + rung->width;
+            Rung& child = NewRung(start, end, n);
+            for (const Scheduler::Event& ev : events)
+            {
+                InsertRung(child, ev);
+            }
+            // give the storage back to the bucket
+            events.clear();
+            m_rungs[level].buckets[m_rungs[level].current - 1].swap(events);
+            continue;
+        }
+        m_bottom.swap(bucket);
+        // the events of a time step are usually inserted in uid order already
+        if (!std::is_sorted(m_bottom.begin(), m_bottom.end()))
+        {
+            std::sort(m_bottom.begin(), m_bottom.end());
+        }
+    }
+    m_spawnSize = 2 * std::max<uint32_t>(m_threshold, m_bottom.size());
+}
+
+void
+LadderScheduler::Insert(const Scheduler::Event& ev)
+{
+    NS_LOG_FUNCTION(this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+    m_qSize++;
+    uint64_t ts = ev.key.m_ts;
+    if (ts >= m_topStart)
+    {
+        m_top.push_back(ev);
+        m_topMin = std::min(m_topMin, ts);
+        m_topMax = std::max(m_topMax, ts);
+        if (m_bottomHead == m_bottom.size())
+        {
+            Refill();
+        }
+        return;
+    }
+    for (uint32_t i = 0; i < m_nRungs; i++)
+    {
+        Rung& rung = m_rungs[i];
+        if (ts >= rung.start + rung.current * rung.width)
+        {
+            InsertRung(rung, ev);
+            return;
+        }
+    }
+    InsertBottom(ev);
+}
+
+bool
+LadderScheduler::IsEmpty() const
+{
+    return m_qSize == 0;
+}
+
+Scheduler::Event
+LadderScheduler::PeekNext() const
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT(!IsEmpty());
+    return m_bottom[m_bottomHead];
+}
+
+Scheduler::Event
+LadderScheduler::RemoveNext()
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT(!IsEmpty());
+    Scheduler::Event ev = m_bottom[m_bottomHead++];
+    m_qSize--;
+    if (m_bottomHead == m_bottom.size())
+    {
+        Refill();
+    }
+    return ev;
+}
+
+void
+LadderScheduler::Remove(const Scheduler::Event& ev)
+{
+    NS_LOG_FUNCTION(this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+    NS_ASSERT(!IsEmpty());
+    auto erase = [&ev](Bucket& bucket) {
+        for (auto& e : bucket)
+        {
+            if (e.key.m_uid == ev.key.m_uid)
+            {
+                NS_ASSERT(e.impl == ev.impl);
+                e = bucket.back();
+                bucket.pop_back();
+                return true;
+            }
+        }
+        return false;
+    };
+
+    uint64_t ts = ev.key.m_ts;
+    bool found = false;
+    if (ts >= m_topStart)
+    {
+        found = erase(m_top);
+    }
+    else
+    {
+        for (uint32_t i = 0; i < m_nRungs && !found; i++)
+        {
+            Rung& rung = m_rungs[i];
+            if (ts >= rung.start + rung.current * rung.width)
+            {
+                found = erase(rung.buckets[(ts - rung.start) / rung.width]);
+                NS_ASSERT(found);
+                rung.count--;
+            }
+        }
+        if (!found)
+        {
+            auto it = std::lower_bound(m_bottom.begin() + m_bottomHead, m_bottom.end(), ev);
+            found = it != m_bottom.end() && it->key.m_uid == ev.key.m_uid;
+            if (found)
+            {
+                m_bottom.erase(it);
+            }
+        }
+    }
+    NS_ASSERT_MSG(found, "event not in the ladder");
+    m_qSize--;
+    if (m_bottomHead == m_bottom.size())
+    {
+        Refill();
+    }
+}
+
+void
+LadderScheduler::Update(const Scheduler::Event& ev, const Scheduler::EventKey& key)
+{
+    NS_LOG_FUNCTION(this << ev.impl << key.m_ts << key.m_uid);
+    if (ev.key.m_ts < m_topStart || key.m_ts < m_topStart)
+    {
+        Remove(ev);
+        Insert(Scheduler::Event{ev.impl, key});
+        return;
+    }
+    // within Top, which is only sorted when turned into a rung
+    m_stale.insert(ev.key.m_uid);
+    m_top.push_back(Scheduler::Event{ev.impl, key});
+    m_topMin = std::min(m_topMin, key.m_ts);
+    m_topMax = std::max(m_topMax, key.m_ts);
+    if (m_stale.size() > m_threshold && 2 * m_stale.size() > m_top.size())
+    {
+        PurgeTop();
+    }
+}
+
+void
+LadderScheduler::PurgeTop()
+{
+    if (m_stale.empty())
+    {
+        return;
+    }
+    NS_LOG_FUNCTION(this << m_stale.size());
+    auto stale = [this](const Scheduler::Event& ev) { return m_stale.erase(ev.key.m_uid) > 0; };
+    m_top.erase(std::remove_if(m_top.begin(), m_top.end(), stale), m_top.end());
+    NS_ASSERT(m_stale.empty());
+}
+
+uint32_t
+LadderScheduler::RemoveCancelled()
+{
+    NS_LOG_FUNCTION(this);
+    auto cancelled = [](const Scheduler::Event& ev) {
+        if (ev.impl->IsCancelled())
+        {
+            ev.impl->Unref();
+            return true;
+        }
+        return false;
+    };
+    // the bounds of Top and the widths of the rungs remain valid
+    PurgeTop();
+    uint32_t removed = 0;
+    uint32_t n = m_top.size();
+    m_top.erase(std::remove_if(m_top.begin(), m_top.end(), cancelled), m_top.end());
+    removed += n - m_top.size();
+    for (uint32_t i = 0; i < m_nRungs; i++)
+    {
+        Rung& rung = m_rungs[i];
+        for (uint32_t b = rung.current; b < rung.nBuckets; b++)
+        {
+            Bucket& bucket = rung.buckets[b];
+            n = bucket.size();
+            bucket.erase(std::remove_if(bucket.begin(), bucket.end(), cancelled), bucket.end());
+            rung.count -= n - bucket.size();
+            removed += n - bucket.size();
+        }
+    }
+    n = m_bottom.size();
+    m_bottom.erase(std::remove_if(m_bottom.begin() + m_bottomHead, m_bottom.end(), cancelled),
+                   m_bottom.end());
+    removed += n - m_bottom.size();
+    m_qSize -= removed;
+    if (m_bottomHead == m_bottom.size())
+    {
+        Refill();
+    }
+    return removed;
+}
+
+} // namespace ns3
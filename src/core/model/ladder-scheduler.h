@@ -0,0 +1,199 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include "scheduler.h"
+
+#include <stdint.h>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler declaration.
+ */
+
+namespace ns3
+{
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler
+ *
+ * This event scheduler implements the ladder queue of
+ * ["Ladder Queue: An O(1) Priority Queue Structure for Large-Scale
+ * Discrete Event Simulation" by Tang, Goh and Thng][Tang].
+ *
+ * [Tang]: https://doi.org/10.1145/1103323.1103324 "Tang"
+ *
+ * Events are kept in three tiers:
+ *  - Top, an unsorted `std::vector` of the far future events, at or after
+ *    the start time of Top;
+ *  - the Ladder, a stack of rungs of buckets.  The first rung is created
+ *    from Top, with as many buckets as events; a bucket of a rung holding
+ *    more than Threshold events is spawned into a finer rung below it,
+ *    which covers the time span of that bucket only.  Bucket widths thus
+ *    adapt to the local event density, down to one time step;
+ *  - Bottom, a short `std::vector` sorted in increasing order, holding the
+ *    events before the current bucket of the lowest rung.
+ *
+ * An event is inserted in Top if it is after the start of Top, else in the
+ * first rung whose current bucket starts at or before it, else in Bottom.
+ * The next event is taken from the head of Bottom; an empty Bottom is
+ * refilled with the current bucket of the lowest rung, sorted.  When many
+ * events are inserted into Bottom, as when a burst lands within a few
+ * time steps of the current time, Bottom is turned into a new rung.
+ *
+ * Events are sorted by their Scheduler::EventKey, time stamp then uid, so
+ * the order is exactly the order of the other schedulers.
+ *
+ * An event of Top moved by Update to another time of Top, as a timer pushed
+ * back, is not searched for: its new key is added to Top and its old uid
+ * recorded as stale, and the stale entries are dropped when Top is turned
+ * into a rung, or once they are half of Top.
+ *
+ * \par Time Complexity
+ *
+ * Operation    | Amortized %Time | Reason
+ * :----------- | :-------------- | :-----
+ * Insert()     | ~Constant       | Rung lookup; insertion in short Bottom
+ * IsEmpty()    | Constant        | Explicit queue size
+ * PeekNext()   | Constant        | Bottom kept non-empty and sorted
+ * Remove()     | ~Constant       | Search within Top, bucket or Bottom
+ * RemoveNext() | ~Constant       | Possible refill of Bottom
+ * Update()     | ~Constant       | Stale entry left in Top, or Remove() and Insert()
+ * RemoveCancelled() | Linear     | In place, keeping the order of Bottom
+ *
+ * \par Memory Complexity
+ *
+ * Category  | Memory                           | Reason
+ * :-------- | :------------------------------- | :-----
+ * Overhead  | ~`MaxRungs` rungs of bucket vectors | Buckets are reused
+ * Per Event | 0                                | Events stored in `std::vector` directly
+ */
+class LadderScheduler : public Scheduler
+{
+  public:
+    /**
+     *  Register this type.
+     *  \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /** Constructor. */
+    LadderScheduler();
+    /** Destructor. */
+    ~LadderScheduler() override;
+
+    // Inherited
+    void Insert(const Scheduler::Event& ev) override;
+    bool IsEmpty() const override;
+    Scheduler::Event PeekNext() const override;
+    Scheduler::Event RemoveNext() override;
+    void Remove(const Scheduler::Event& ev) override;
+    void Update(const Scheduler::Event& ev, const Scheduler::EventKey& key) override;
+    uint32_t RemoveCancelled() override;
+
+  private:
+    /** A bucket: an unsorted vector of Events. */
+    typedef std::vector<Scheduler::Event> Bucket;
+
+    /** A rung of the ladder. */
+    struct Rung
+    {
+        uint64_t start;               /**< Start time of the first bucket. */
+        uint64_t width;               /**< Time span of a bucket. */
+        uint32_t current;             /**< Index of the current bucket. */
+        uint32_t nBuckets;            /**< Number of buckets in use. */
+        uint32_t count;               /**< Number of events in the rung. */
+        std::vector<Bucket> buckets;  /**< The buckets, reused across rungs. */
+    };
+
+    /**
+     * Start a new lowest rung.
+     *
+     * \param [in] start The start time of the rung.
+     * \param [in] end The end time of the rung, after its last event.
+     * \param [in] n The number of events the rung will get.
+     * \returns The new rung.
+     */
+    Rung& NewRung(uint64_t start, uint64_t end, uint32_t n);
+    /**
+     * Insert an event in a rung.
+     *
+     * \param [in] rung The rung, covering the event.
+     * \param [in] ev The event.
+     */
+    void InsertRung(Rung& rung, const Scheduler::Event& ev);
+    /**
+     * Insert an event in Bottom.
+     *
+     * \param [in] ev The event.
+     */
+    void InsertBottom(const Scheduler::Event& ev);
+    /**
+     * Turn Bottom into a new lowest rung.
+     */
+    void SpawnBottom();
+    /**
+     * Refill an empty Bottom from the ladder, or from Top.
+     */
+    void Refill();
+    /**
+     * Drop the stale entries of Top.
+     */
+    void PurgeTop();
+    /**
+     * \param [in] level The index of the rung.
+     * \returns The end time of the rung: the start of Top for the first rung,
+     * the start of the current bucket of the rung above for the others.
+     */
+    uint64_t GetRungEnd(uint32_t level) const;
+
+    /** Top: events at or after m_topStart. */
+    Bucket m_top;
+    /** Start time of Top. */
+    uint64_t m_topStart;
+    /** Smallest time stamp in Top. */
+    uint64_t m_topMin;
+    /** Largest time stamp in Top. */
+    uint64_t m_topMax;
+    /** Uids of the stale entries of Top, moved by Update. */
+    std::unordered_set<uint32_t> m_stale;
+    /** The rungs, the first m_nRungs of which are in use. */
+    std::vector<Rung> m_rungs;
+    /** Number of rungs in use. */
+    uint32_t m_nRungs;
+    /** Bottom: events sorted in increasing order, from m_bottomHead. */
+    Bucket m_bottom;
+    /** Index of the first event of Bottom. */
+    uint32_t m_bottomHead;
+    /** Size of Bottom above which it is turned into a rung. */
+    uint32_t m_spawnSize;
+    /** Number of events in queue. */
+    uint32_t m_qSize;
+
+    /** Largest bucket moved to Bottom without spawning a rung. */
+    uint32_t m_threshold;
+    /** Maximum number of rungs. */
+    uint32_t m_maxRungs;
+};
+
+} // namespace ns3
+
+#endif /* LADDER_SCHEDULER_H */
@@ -112,4 +112,36 @@ MapScheduler::Remove(const Event& ev)
     m_list.erase(i);
 }
 
+void
+MapScheduler::Update(const Event& ev, const EventKey& key)
+{
+    NS_LOG_FUNCTION(this << ev.impl << key.m_ts << key.m_uid);
+    // move the node itself, without freeing and allocating it
+    EventMap::node_type node = m_list.extract(ev.key);
+    NS_ASSERT(!node.empty() && node.mapped() == ev.impl);
+    node.key() = key;
+    m_list.insert(std::move(node));
+}
+
+uint32_t
+MapScheduler::RemoveCancelled()
+{
+    NS_LOG_FUNCTION(this);
+    uint32_t removed = 0;
+    for (EventMapI i = m_list.begin(); i != m_list.end();)
+    {
+        if (i->second->IsCancelled())
+        {
+            i->second->Unref();
+            i = m_list.erase(i);
+            removed++;
+        }
+        else
+        {
+            i++;
+        }
+    }
+    return removed;
+}
+
 } // namespace ns3
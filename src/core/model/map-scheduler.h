@@ -51,6 +51,7 @@ namespace ns3
  * PeekNext()   | Constant        | `std::map::begin()`
  * Remove()     | Logarithmic     | `std::map::find()`
  * RemoveNext() | Constant        | `std::map::begin()`
+ * Update()     | Logarithmic     | `std::map::extract()`, node reinserted
  *
  * \par Memory Complexity
  *
@@ -80,6 +81,8 @@ class MapScheduler : public Scheduler
     Scheduler::Event PeekNext() const override;
     Scheduler::Event RemoveNext() override;
     void Remove(const Scheduler::Event& ev) override;
+    void Update(const Scheduler::Event& ev, const Scheduler::EventKey& key) override;
+    uint32_t RemoveCancelled() override;
 
   private:
     /** Event list type: a Map from EventKey to EventImpl. */
@@ -142,6 +142,20 @@ RandomVariableStream::GetStream() const
     return m_stream;
 }
 
+void
+RandomVariableStream::GetStreamState(double state[6]) const
+{
+    NS_LOG_FUNCTION(this);
+    m_rng->GetState(state);
+}
+
+void
+RandomVariableStream::SetStreamState(const double state[6])
+{
+    NS_LOG_FUNCTION(this);
+    m_rng->SetState(state);
+}
+
 RngStream*
 RandomVariableStream::Peek() const
 {
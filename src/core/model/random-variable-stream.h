@@ -142,6 +142,20 @@ class RandomVariableStream : public Object
      */
     bool IsAntithetic() const;
 
+    /**
+     * \brief Get the position of the RngStream, e.g. to checkpoint a
+     * simulation.
+     * \param [out] state The state of the RngStream.
+     */
+    void GetStreamState(double state[6]) const;
+
+    /**
+     * \brief Move the RngStream back to a position returned by
+     * GetStreamState().
+     * \param [in] state The state of the RngStream.
+     */
+    void SetStreamState(const double state[6]);
+
     /**
      * \brief Get the next random value drawn from the distribution.
      * \return A random value.
@@ -744,6 +744,47 @@ RealtimeSimulatorImpl::Cancel(const EventId& id)
     }
 }
 
+EventId
+RealtimeSimulatorImpl::Reschedule(const EventId& id, const Time& delay)
+{
+    NS_LOG_FUNCTION(this << delay);
+    NS_ASSERT_MSG(delay.IsPositive(), "RealtimeSimulatorImpl::Reschedule(): Negative delay");
+
+    Scheduler::Event ev;
+    ev.impl = id.PeekEventImpl();
+    ev.key.m_ts = id.GetTs();
+    ev.key.m_context = id.GetContext();
+    ev.key.m_uid = id.GetUid();
+    Scheduler::EventKey key;
+    {
+        std::unique_lock lock{m_mutex};
+
+        key.m_ts = m_currentTs + delay.GetTimeStep();
+        key.m_context = id.GetContext();
+        key.m_uid = m_uid;
+        if (ev.impl != nullptr && ev.key.m_ts == m_currentTs && ev.key.m_uid == m_currentUid &&
+            !ev.impl->IsCancelled())
+        {
+            // the event being executed, inserted again
+            ev.impl->Ref();
+            m_events->Insert(Scheduler::Event{ev.impl, key});
+            m_unscheduledEvents++;
+        }
+        else if (id.GetUid() != EventId::UID::DESTROY && !IsExpired(id))
+        {
+            m_events->Update(ev, key);
+        }
+        else
+        {
+            return EventId();
+        }
+        m_uid++;
+        m_synchronizer->Signal();
+    }
+
+    return EventId(ev.impl, key.m_ts, key.m_context, key.m_uid);
+}
+
 bool
 RealtimeSimulatorImpl::IsExpired(const EventId& id) const
 {
@@ -98,6 +98,7 @@ class RealtimeSimulatorImpl : public SimulatorImpl
     EventId ScheduleDestroy(EventImpl* event) override;
     void Remove(const EventId& ev) override;
     void Cancel(const EventId& ev) override;
+    EventId Reschedule(const EventId& id, const Time& delay) override;
     bool IsExpired(const EventId& ev) const override;
     void Run() override;
     Time Now() const override;
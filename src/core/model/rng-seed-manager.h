@@ -104,6 +104,20 @@ class RngSeedManager
      * \returns The next stream index.
      */
     static uint64_t GetNextStreamIndex();
+
+    /**
+     * Set the next automatically assigned stream index, to restore the
+     * state of a simulation from a checkpoint.
+     * \param [in] next The next stream index.
+     */
+    static void SetNextStreamIndex(uint64_t next);
+
+    /**
+     * Get the next automatically assigned stream index, without
+     * assigning it.
+     * \returns The next stream index.
+     */
+    static uint64_t PeekNextStreamIndex();
 };
 
 /** Alias for compatibility. */
@@ -70,6 +70,18 @@ class RngStream
      * \returns The next random.
      */
     double RandU01();
+    /**
+     * Get the state of the generator, e.g. to save its position.
+     *
+     * \param [out] state The state vector.
+     */
+    void GetState(double state[6]) const;
+    /**
+     * Move the generator to a state returned by GetState().
+     *
+     * \param [in] state The state vector.
+     */
+    void SetState(const double state[6]);
 
   private:
     /**
@@ -20,8 +20,11 @@
 #include "scheduler.h"
 
 #include "assert.h"
+#include "event-impl.h"
 #include "log.h"
 
+#include <vector>
+
 /**
  * \file
  * \ingroup scheduler
@@ -47,4 +50,38 @@ Scheduler::GetTypeId()
     return tid;
 }
 
+void
+Scheduler::Update(const Event& ev, const EventKey& key)
+{
+    NS_LOG_FUNCTION(this << ev.impl << key.m_ts << key.m_uid);
+    Remove(ev);
+    Insert(Event{ev.impl, key});
+}
+
+uint32_t
+Scheduler::RemoveCancelled()
+{
+    NS_LOG_FUNCTION(this);
+    std::vector<Event> events;
+    uint32_t removed = 0;
+    while (!IsEmpty())
+    {
+        Event ev = RemoveNext();
+        if (ev.impl->IsCancelled())
+        {
+            ev.impl->Unref();
+            removed++;
+        }
+        else
+        {
+            events.push_back(ev);
+        }
+    }
+    for (const Event& ev : events)
+    {
+        Insert(ev);
+    }
+    return removed;
+}
+
 } // namespace ns3
@@ -71,6 +71,10 @@ class EventImpl;
  * rely heavily on Scheduler::Cancel, however, and these might benefit
  * from using Scheduler::Remove instead, to reduce the size of the event
  * list, at the time cost of actually removing events from the list.
+ * The simulator also removes the cancelled events all at once, by
+ * Scheduler::RemoveCancelled, when they become half of the event list.
+ * Timers which are pushed back again and again are better moved by
+ * Simulator::Reschedule, which uses Scheduler::Update, than cancelled.
  *
  * A summary of the main characteristics
  * of each SchedulerImpl is provided below.  See the individual
@@ -111,6 +115,14 @@ class EventImpl;
  *      <td class="markdownTableBodyLeft"> 0 </td>
  * </tr>
  * <tr class="markdownTableBody">
+ *      <td class="markdownTableBodyLeft"> LadderScheduler </td>
+ *      <td class="markdownTableBodyLeft"> Rungs of `std::vector` buckets </td>
+ *      <td class="markdownTableBodyLeft"> Constant </td>
+ *      <td class="markdownTableBodyLeft"> Constant </td>
+ *      <td class="markdownTableBodyLeft"> Reused buckets </td>
+ *      <td class="markdownTableBodyLeft"> 0 </td>
+ * </tr>
+ * <tr class="markdownTableBody">
  *      <td class="markdownTableBodyLeft"> ListScheduler </td>
  *      <td class="markdownTableBodyLeft"> `std::list` </td>
  *      <td class="markdownTableBodyLeft"> Linear </td>
@@ -226,6 +238,25 @@ class Scheduler : public Object
      * \param [in] ev The event to remove
      */
     virtual void Remove(const Event& ev) = 0;
+    /**
+     * Move a specific event of the event list to a new key.
+     *
+     * The default implementation removes the event and inserts it
+     * back with the new key.
+     *
+     * \param [in] ev The event to move.
+     * \param [in] key The new key of the event.
+     */
+    virtual void Update(const Event& ev, const EventKey& key);
+    /**
+     * Remove the cancelled events from the event list, and unref them.
+     *
+     * The default implementation empties the event list and inserts
+     * the other events back, in order.
+     *
+     * \returns The number of events removed.
+     */
+    virtual uint32_t RemoveCancelled();
 };
 
 /**
@@ -74,6 +74,8 @@ class SimulatorImpl : public Object
     virtual void Remove(const EventId& id) = 0;
     /** \copydoc Simulator::Cancel */
     virtual void Cancel(const EventId& id) = 0;
+    /** \copydoc Simulator::Reschedule */
+    virtual EventId Reschedule(const EventId& id, const Time& delay) = 0;
     /** \copydoc Simulator::IsExpired */
     virtual bool IsExpired(const EventId& id) const = 0;
     /** \copydoc Simulator::Run */
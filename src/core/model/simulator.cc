@@ -19,8 +19,10 @@
 #include "simulator.h"
 
 #include "assert.h"
+#include "boolean.h"
 #include "des-metrics.h"
 #include "event-impl.h"
+#include "event-pool.h"
 #include "global-value.h"
 #include "log.h"
 #include "map-scheduler.h"
@@ -80,6 +82,19 @@ static GlobalValue g_schedTypeImpl =
                 TypeIdValue(MapScheduler::GetTypeId()),
                 MakeTypeIdChecker());
 
+/**
+ * \ingroup events
+ * \anchor GlobalValueEventPoolEnabled
+ * Whether the storage of the events is cached and reused, see EventPool.
+ *
+ * Applied when the simulator implementation is created.
+ */
+static GlobalValue g_eventPoolEnabled =
+    GlobalValue("EventPoolEnabled",
+                "Cache and reuse the storage of the events",
+                BooleanValue(true),
+                MakeBooleanChecker());
+
 /**
  * \ingroup simulator
  * \brief Get the static SimulatorImpl instance.
@@ -122,6 +137,11 @@ GetImpl()
             factory.SetTypeId(s.Get());
             (*pimpl)->SetScheduler(factory);
         }
+        {
+            BooleanValue b;
+            g_eventPoolEnabled.GetValue(b);
+            EventPool::Enable(b.Get());
+        }
 
         //
         // Note: we call LogSetTimePrinter _after_ creating the implementation
@@ -282,6 +302,16 @@ Simulator::Cancel(const EventId& id)
     return GetImpl()->Cancel(id);
 }
 
+EventId
+Simulator::Reschedule(const EventId& id, const Time& delay)
+{
+    if (*PeekImpl() == nullptr)
+    {
+        return EventId();
+    }
+    return GetImpl()->Reschedule(id, delay);
+}
+
 bool
 Simulator::IsExpired(const EventId& id)
 {
@@ -349,6 +379,9 @@ Simulator::SetImplementation(Ptr<SimulatorImpl> impl)
     g_schedTypeImpl.GetValue(s);
     factory.SetTypeId(s.Get());
     impl->SetScheduler(factory);
+    BooleanValue b;
+    g_eventPoolEnabled.GetValue(b);
+    EventPool::Enable(b.Get());
     //
     // Note: we call LogSetTimePrinter _after_ creating the implementation
     // object because the act of creation can trigger calls to the logging
@@ -419,6 +419,31 @@ class Simulator
      */
     static void Cancel(const EventId& id);
 
+    /**
+     * Move an event to a new time: a cheap Cancel and Schedule of the
+     * same event, for the timers which are pushed back over and over.
+     *
+     * The event keeps its EventImpl and its context, and takes the place
+     * in the event list of a new event scheduled now with this delay.
+     * Its old EventId must not be used anymore: store the returned
+     * EventId in its place.  The event can be pending, or the event
+     * being executed, which is then scheduled again once it returns.
+     * Any other event, expired, cancelled or for the "destroy" time, is
+     * left alone and an empty EventId is returned, for which
+     * EventId::IsExpired is true.
+     *
+     * This method has the complexity of Scheduler::Update, which is that
+     * of Scheduler::Remove: O(log(n)) for the MapScheduler, about constant
+     * for the LadderScheduler, but a linear search for the HeapScheduler.
+     * Unlike Cancel, it does not leave a cancelled event in the event list
+     * nor allocate a new one.
+     *
+     * @param [in] id The event to move.
+     * @param [in] delay The delay, from now, of the event.
+     * @returns The id of the moved event, empty if it could not be moved.
+     */
+    static EventId Reschedule(const EventId& id, const Time& delay);
+
     /**
      * Check if an event has already run or been cancelled.
      *
@@ -0,0 +1,270 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/boolean.h"
+#include "ns3/event-impl.h"
+#include "ns3/event-pool.h"
+#include "ns3/global-value.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+#include <thread>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup core-tests
+ * \ingroup events
+ * \ingroup event-pool-tests
+ * EventPool test suite.
+ */
+
+/**
+ * \ingroup core-tests
+ * \defgroup event-pool-tests EventPool test suite
+ */
+
+namespace ns3
+{
+
+namespace tests
+{
+
+/**
+ * \ingroup event-pool-tests
+ * An event of a known size, which counts its invocations.
+ *
+ * \tparam N The size of its payload, bytes.
+ */
+template <std::size_t N>
+class CountEvent : public EventImpl
+{
+  public:
+    /**
+     * Constructor.
+     * \param [in] count The counter of the invocations.
+     */
+    CountEvent(int* count)
+        : m_count(count)
+    {
+    }
+
+  private:
+    void Notify() override
+    {
+        (*m_count)++;
+    }
+
+    int* m_count;           //!< The counter of the invocations.
+    char m_payload[N] = {}; //!< Payload, to set the size of the event.
+};
+
+/**
+ * \ingroup event-pool-tests
+ * Check the reuse of the freed events, with the pool on and off.
+ */
+class EventPoolReuseTestCase : public TestCase
+{
+  public:
+    /** Constructor. */
+    EventPoolReuseTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+EventPoolReuseTestCase::EventPoolReuseTestCase()
+    : TestCase("Reuse of the storage of the freed events")
+{
+}
+
+void
+EventPoolReuseTestCase::DoRun()
+{
+    typedef CountEvent<8> Small;
+    typedef CountEvent<EventPool::MaxSize> Large;
+    bool enabled = EventPool::IsEnabled();
+    int count = 0;
+
+    EventPool::Enable(true);
+    EventImpl* a = new Small(&count);
+    uint32_t cached = EventPool::GetCached(sizeof(Small));
+    a->Invoke();
+    a->Unref();
+    NS_TEST_ASSERT_MSG_EQ(count, 1, "event not invoked");
+    NS_TEST_ASSERT_MSG_EQ(EventPool::GetCached(sizeof(Small)), cached + 1, "event not cached");
+    EventImpl* b = new Small(&count);
+    NS_TEST_ASSERT_MSG_EQ(b, a, "cached event not reused");
+    NS_TEST_ASSERT_MSG_EQ(EventPool::GetCached(sizeof(Small)), cached, "event still cached");
+
+    // freed with the pool off, though allocated with the pool on
+    EventPool::Enable(false);
+    b->Unref();
+    NS_TEST_ASSERT_MSG_EQ(EventPool::GetCached(sizeof(Small)), cached, "event cached when off");
+    EventImpl* c = new Small(&count);
+    EventPool::Enable(true);
+    c->Unref();
+    NS_TEST_ASSERT_MSG_EQ(EventPool::GetCached(sizeof(Small)), cached + 1, "event not cached");
+
+    // larger than any size class
+    EventImpl* d = new Large(&count);
+    d->Unref();
+    NS_TEST_ASSERT_MSG_EQ(EventPool::GetCached(sizeof(Large)), 0, "large event cached");
+
+    EventPool::Enable(enabled);
+}
+
+/**
+ * \ingroup event-pool-tests
+ * Check events freed by another thread, and the release of its cache.
+ */
+class EventPoolThreadTestCase : public TestCase
+{
+  public:
+    /** Constructor. */
+    EventPoolThreadTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+EventPoolThreadTestCase::EventPoolThreadTestCase()
+    : TestCase("Events freed by another thread")
+{
+}
+
+void
+EventPoolThreadTestCase::DoRun()
+{
+    typedef CountEvent<24> Event;
+    bool enabled = EventPool::IsEnabled();
+    EventPool::Enable(true);
+    int count = 0;
+    const uint32_t n = 1000;
+    std::vector<EventImpl*> events;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        events.push_back(new Event(&count));
+    }
+    uint32_t cached = EventPool::GetCached(sizeof(Event));
+
+    uint32_t otherCached = 0;
+    std::thread other([&events, &otherCached]() {
+        for (EventImpl* ev : events)
+        {
+            ev->Invoke();
+            ev->Unref();
+        }
+        otherCached = EventPool::GetCached(sizeof(Event));
+        // the events of this thread come from its cache
+        for (uint32_t i = 0; i < n; i++)
+        {
+            events[i] = new Event(nullptr);
+        }
+    });
+    other.join();
+    NS_TEST_ASSERT_MSG_EQ(count, n, "events not invoked");
+    NS_TEST_ASSERT_MSG_EQ(otherCached, n, "events not cached by the freeing thread");
+    NS_TEST_ASSERT_MSG_EQ(EventPool::GetCached(sizeof(Event)), cached, "events cached here");
+
+    for (EventImpl* ev : events)
+    {
+        ev->Unref();
+    }
+    NS_TEST_ASSERT_MSG_EQ(EventPool::GetCached(sizeof(Event)), cached + n, "events not cached");
+    EventPool::Enable(enabled);
+}
+
+/**
+ * \ingroup event-pool-tests
+ * Run a simulation with the pool on and off.
+ */
+class EventPoolSimulatorTestCase : public TestCase
+{
+  public:
+    /** Constructor. */
+    EventPoolSimulatorTestCase();
+
+  private:
+    void DoRun() override;
+    /**
+     * Reschedule itself until the count is reached.
+     * \param [in] remaining The number of events left to schedule.
+     */
+    void Step(uint32_t remaining);
+
+    uint32_t m_steps; //!< Number of steps executed.
+};
+
+EventPoolSimulatorTestCase::EventPoolSimulatorTestCase()
+    : TestCase("Simulation with the pool on and off")
+{
+}
+
+void
+EventPoolSimulatorTestCase::Step(uint32_t remaining)
+{
+    m_steps++;
+    if (remaining > 0)
+    {
+        Time delay = NanoSeconds(remaining % 7);
+        Simulator::Schedule(delay, &EventPoolSimulatorTestCase::Step, this, 0);
+        Simulator::Schedule(NanoSeconds(1), &EventPoolSimulatorTestCase::Step, this, remaining - 1);
+        // freed at once by the cancel and the end of the EventId
+        EventId ev = Simulator::Schedule(Seconds(1), &EventPoolSimulatorTestCase::Step, this, 0);
+        ev.Cancel();
+    }
+}
+
+void
+EventPoolSimulatorTestCase::DoRun()
+{
+    for (bool enabled : {false, true})
+    {
+        GlobalValue::Bind("EventPoolEnabled", BooleanValue(enabled));
+        m_steps = 0;
+        Simulator::Schedule(Seconds(0), &EventPoolSimulatorTestCase::Step, this, 10000);
+        NS_TEST_ASSERT_MSG_EQ(EventPool::IsEnabled(), enabled, "EventPoolEnabled not applied");
+        Simulator::Run();
+        NS_TEST_ASSERT_MSG_EQ(m_steps, 20001, "wrong number of steps");
+        Simulator::Destroy();
+    }
+}
+
+/**
+ * \ingroup event-pool-tests
+ * EventPool test suite.
+ */
+class EventPoolTestSuite : public TestSuite
+{
+  public:
+    EventPoolTestSuite()
+        : TestSuite("event-pool")
+    {
+        AddTestCase(new EventPoolReuseTestCase());
+        AddTestCase(new EventPoolThreadTestCase());
+        AddTestCase(new EventPoolSimulatorTestCase());
+    }
+};
+
+/**
+ * \ingroup event-pool-tests
+ * EventPoolTestSuite instance variable.
+ */
+static EventPoolTestSuite g_eventPoolTestSuite;
+
+} // namespace tests
+
+} // namespace ns3
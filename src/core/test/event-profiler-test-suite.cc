@@ -0,0 +1,269 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/event-profiler.h"
+#include "ns3/global-value.h"
+#include "ns3/make-event.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/test.h"
+#include "ns3/uinteger.h"
+
+#include <fstream>
+#include <map>
+#include <sstream>
+
+/**
+ * \file
+ * \ingroup core-tests
+ * \ingroup events
+ * \ingroup event-profiler-tests
+ * EventProfiler test suite.
+ */
+
+/**
+ * \ingroup core-tests
+ * \defgroup event-profiler-tests EventProfiler test suite
+ */
+
+namespace ns3
+{
+
+namespace tests
+{
+
+/**
+ * \ingroup event-profiler-tests
+ * The target of the profiled events.
+ */
+class ProfiledObject
+{
+  public:
+    /**
+     * An event with an argument.
+     * \param [in] value The argument.
+     */
+    void Tick(int value)
+    {
+        m_sum += value;
+    }
+
+    /** An event without argument. */
+    void Tock()
+    {
+        m_sum++;
+    }
+
+    int m_sum{0}; //!< Sum of the events.
+};
+
+/**
+ * \ingroup event-profiler-tests
+ * Check the names of the event targets.
+ */
+class EventProfilerNameTestCase : public TestCase
+{
+  public:
+    /** Constructor. */
+    EventProfilerNameTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+EventProfilerNameTestCase::EventProfilerNameTestCase()
+    : TestCase("Names of the event targets")
+{
+}
+
+void
+EventProfilerNameTestCase::DoRun()
+{
+    ProfiledObject object;
+    EventImpl* tick = MakeEvent(&ProfiledObject::Tick, &object, 1);
+    EventImpl* tock = MakeEvent(&ProfiledObject::Tock, &object);
+    std::string tickName = EventProfiler::GetTargetName(*tick);
+    std::string tockName = EventProfiler::GetTargetName(*tock);
+    tick->Unref();
+    tock->Unref();
+#if (__GNUC__ >= 3)
+    NS_TEST_ASSERT_MSG_EQ(tickName,
+                          "void (ns3::tests::ProfiledObject::*)(int)",
+                          "wrong name of a method with an argument");
+    NS_TEST_ASSERT_MSG_EQ(tockName,
+                          "void (ns3::tests::ProfiledObject::*)()",
+                          "wrong name of a method without argument");
+#else
+    NS_TEST_ASSERT_MSG_NE(tickName, tockName, "methods of different types not distinguished");
+#endif
+}
+
+/**
+ * \ingroup event-profiler-tests
+ * Check the profile of a simulation, with every event sampled.
+ */
+class EventProfilerSimulationTestCase : public TestCase
+{
+  public:
+    /** Constructor. */
+    EventProfilerSimulationTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+EventProfilerSimulationTestCase::EventProfilerSimulationTestCase()
+    : TestCase("Profile of a simulation")
+{
+}
+
+void
+EventProfilerSimulationTestCase::DoRun()
+{
+    std::string fileName = CreateTempDirFilename("event-profile.txt");
+    GlobalValue::Bind("EventProfilerFile", StringValue(fileName));
+    GlobalValue::Bind("EventProfilerPeriod", UintegerValue(1));
+
+    ProfiledObject object;
+    EventImpl* tick = MakeEvent(&ProfiledObject::Tick, &object, 0);
+    EventImpl* tock = MakeEvent(&ProfiledObject::Tock, &object);
+    std::string tickName = EventProfiler::GetTargetName(*tick);
+    std::string tockName = EventProfiler::GetTargetName(*tock);
+    tick->Unref();
+    tock->Unref();
+    for (int i = 0; i < 3; i++)
+    {
+        Simulator::ScheduleWithContext(1, MicroSeconds(i), &ProfiledObject::Tick, &object, i);
+    }
+    Simulator::ScheduleWithContext(2, MicroSeconds(1), &ProfiledObject::Tock, &object);
+    Simulator::ScheduleWithContext(2, MicroSeconds(2), &ProfiledObject::Tock, &object);
+    EventId cancelled = Simulator::Schedule(MicroSeconds(3), &ProfiledObject::Tock, &object);
+    cancelled.Cancel();
+    Simulator::Schedule(MicroSeconds(4), &ProfiledObject::Tick, &object, 10);
+    Simulator::Run();
+    Simulator::Destroy();
+    GlobalValue::Bind("EventProfilerFile", StringValue(""));
+    GlobalValue::Bind("EventProfilerPeriod", UintegerValue(64));
+    NS_TEST_ASSERT_MSG_EQ(object.m_sum, 15, "events not executed");
+
+    std::map<std::string, uint64_t> counts;
+    std::ifstream count(fileName + ".count");
+    std::string line;
+    while (std::getline(count, line))
+    {
+        std::size_t space = line.rfind(' ');
+        std::istringstream(line.substr(space + 1)) >> counts[line.substr(0, space)];
+    }
+    std::map<std::string, uint64_t> expected{
+        {tickName + ";node 1", 3},
+        {tockName + ";node 2", 2},
+        {"cancelled;no node", 1},
+        {tickName + ";no node", 1},
+    };
+    NS_TEST_ASSERT_MSG_EQ(counts.size(), expected.size(), "wrong number of stacks");
+    for (const auto& [stack, n] : expected)
+    {
+        NS_TEST_EXPECT_MSG_EQ(counts[stack], n, "wrong count of " << stack);
+    }
+
+    std::ifstream time(fileName);
+    uint32_t lines = 0;
+    while (std::getline(time, line))
+    {
+        lines++;
+    }
+    NS_TEST_ASSERT_MSG_EQ(lines, expected.size(), "wrong number of stacks in the time profile");
+}
+
+/**
+ * \ingroup event-profiler-tests
+ * Check the merge of the profilers of several threads.
+ */
+class EventProfilerMergeTestCase : public TestCase
+{
+  public:
+    /** Constructor. */
+    EventProfilerMergeTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+EventProfilerMergeTestCase::EventProfilerMergeTestCase()
+    : TestCase("Merge of forked profilers")
+{
+}
+
+void
+EventProfilerMergeTestCase::DoRun()
+{
+    std::string fileName = CreateTempDirFilename("event-profile-merge.txt");
+    EventProfiler profiler(fileName, 1);
+    std::unique_ptr<EventProfiler> first = profiler.Fork();
+    std::unique_ptr<EventProfiler> second = profiler.Fork();
+
+    ProfiledObject object;
+    EventImpl* tock = MakeEvent(&ProfiledObject::Tock, &object);
+    std::string tockName = EventProfiler::GetTargetName(*tock);
+    first->Invoke(tock, 1);
+    first->Invoke(tock, 2);
+    second->Invoke(tock, 1);
+    tock->Unref();
+    NS_TEST_ASSERT_MSG_EQ(object.m_sum, 3, "events not executed");
+
+    profiler.Merge(*first);
+    profiler.Merge(*second);
+    NS_TEST_EXPECT_MSG_EQ(profiler.GetEvents(), 3, "wrong number of events");
+    NS_TEST_EXPECT_MSG_EQ(profiler.GetSamples(), 3, "wrong number of samples");
+    profiler.Write();
+
+    std::map<std::string, uint64_t> counts;
+    std::ifstream count(fileName + ".count");
+    std::string line;
+    while (std::getline(count, line))
+    {
+        std::size_t space = line.rfind(' ');
+        std::istringstream(line.substr(space + 1)) >> counts[line.substr(0, space)];
+    }
+    NS_TEST_ASSERT_MSG_EQ(counts.size(), 2, "wrong number of stacks");
+    NS_TEST_EXPECT_MSG_EQ(counts[tockName + ";node 1"], 2, "wrong count of node 1");
+    NS_TEST_EXPECT_MSG_EQ(counts[tockName + ";node 2"], 1, "wrong count of node 2");
+}
+
+/**
+ * \ingroup event-profiler-tests
+ * EventProfiler test suite.
+ */
+class EventProfilerTestSuite : public TestSuite
+{
+  public:
+    EventProfilerTestSuite()
+        : TestSuite("event-profiler")
+    {
+        AddTestCase(new EventProfilerNameTestCase());
+        AddTestCase(new EventProfilerSimulationTestCase());
+        AddTestCase(new EventProfilerMergeTestCase());
+    }
+};
+
+/**
+ * \ingroup event-profiler-tests
+ * EventProfilerTestSuite instance variable.
+ */
+static EventProfilerTestSuite g_eventProfilerTestSuite;
+
+} // namespace tests
+
+} // namespace ns3
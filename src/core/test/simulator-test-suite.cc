@@ -17,12 +17,17 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "ns3/calendar-scheduler.h"
+#include "ns3/default-simulator-impl.h"
 #include "ns3/heap-scheduler.h"
+#include "ns3/ladder-scheduler.h"
 #include "ns3/list-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/priority-queue-scheduler.h"
 #include "ns3/simulator.h"
 #include "ns3/test.h"
+#include "ns3/uinteger.h"
+
+#include <vector>
 
 using namespace ns3;
 
@@ -707,6 +712,240 @@ SimulatorTemplateTestCase::DoRun()
     Simulator::Destroy();
 }
 
+/**
+ * \ingroup simulator-tests
+ *
+ * \brief Check that a Scheduler returns the events in the order of the MapScheduler.
+ *
+ * The events are bursts within a few time steps of the current time mixed
+ * with far future events, inserted, removed, moved and taken in a random
+ * order.
+ */
+class SchedulerOrderTestCase : public TestCase
+{
+  public:
+    /**
+     * Constructor.
+     * \param schedulerFactory Scheduler factory.
+     */
+    SchedulerOrderTestCase(ObjectFactory schedulerFactory);
+    void DoRun() override;
+
+  private:
+    ObjectFactory m_schedulerFactory; //!< Scheduler factory.
+};
+
+SchedulerOrderTestCase::SchedulerOrderTestCase(ObjectFactory schedulerFactory)
+    : TestCase("Check the event order of " + schedulerFactory.GetTypeId().GetName()),
+      m_schedulerFactory(schedulerFactory)
+{
+}
+
+void
+SchedulerOrderTestCase::DoRun()
+{
+    Ptr<Scheduler> scheduler = m_schedulerFactory.Create<Scheduler>();
+    Ptr<Scheduler> reference = CreateObject<MapScheduler>();
+    std::vector<Scheduler::Event> pending;
+    uint64_t now = 0;
+    uint32_t uid = 0;
+    uint64_t state = 12345;
+    auto random = [&state](uint64_t n) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return (state >> 33) % n;
+    };
+
+    for (uint32_t i = 0; i < 200000; i++)
+    {
+        uint64_t action = random(100);
+        if (action < 55 || reference->IsEmpty())
+        {
+            // same time step, a few steps, a few microseconds or far away
+            uint64_t kind = random(20);
+            uint64_t delay = 0;
+            if (kind >= 19)
+            {
+                delay = random(1000000000);
+            }
+            else if (kind >= 14)
+            {
+                delay = random(10000);
+            }
+            else if (kind >= 6)
+            {
+                delay = random(10);
+            }
+            Scheduler::Event ev;
+            ev.impl = nullptr;
+            ev.key.m_ts = now + delay;
+            ev.key.m_uid = uid++;
+            ev.key.m_context = 0;
+            scheduler->Insert(ev);
+            reference->Insert(ev);
+            pending.push_back(ev);
+        }
+        else if (action < 60)
+        {
+            uint64_t j = random(pending.size());
+            scheduler->Remove(pending[j]);
+            reference->Remove(pending[j]);
+            pending[j] = pending.back();
+            pending.pop_back();
+        }
+        else if (action < 65)
+        {
+            // a timer moved later, or earlier
+            uint64_t j = random(pending.size());
+            Scheduler::EventKey key;
+            key.m_ts = now + random(random(2) == 0 ? 10 : 10000);
+            key.m_uid = uid++;
+            key.m_context = 0;
+            scheduler->Update(pending[j], key);
+            reference->Update(pending[j], key);
+            pending[j].key = key;
+        }
+        else
+        {
+            Scheduler::Event expected = reference->RemoveNext();
+            NS_TEST_ASSERT_MSG_EQ(scheduler->PeekNext().key.m_uid,
+                                  expected.key.m_uid,
+                                  "wrong next event");
+            Scheduler::Event next = scheduler->RemoveNext();
+            NS_TEST_ASSERT_MSG_EQ(next.key.m_uid, expected.key.m_uid, "wrong event");
+            now = next.key.m_ts;
+            for (auto& ev : pending)
+            {
+                if (ev.key.m_uid == next.key.m_uid)
+                {
+                    ev = pending.back();
+                    pending.pop_back();
+                    break;
+                }
+            }
+        }
+        NS_TEST_ASSERT_MSG_EQ(scheduler->IsEmpty(), reference->IsEmpty(), "wrong emptiness");
+    }
+    while (!reference->IsEmpty())
+    {
+        NS_TEST_ASSERT_MSG_EQ(scheduler->RemoveNext().key.m_uid,
+                              reference->RemoveNext().key.m_uid,
+                              "wrong event while draining");
+    }
+    NS_TEST_ASSERT_MSG_EQ(scheduler->IsEmpty(), true, "events left");
+}
+
+/**
+ * \ingroup simulator-tests
+ *
+ * \brief Check Simulator::Reschedule and the removal of the cancelled events.
+ */
+class SimulatorRescheduleTestCase : public TestCase
+{
+  public:
+    /**
+     * Constructor.
+     * \param schedulerFactory Scheduler factory.
+     */
+    SimulatorRescheduleTestCase(ObjectFactory schedulerFactory);
+    void DoRun() override;
+
+  private:
+    /**
+     * Record an event.
+     * \param value The event.
+     */
+    void Record(int value);
+    /**
+     * A periodic timer, which re-arms itself, with its arguments.
+     * \param period The period, ns.
+     */
+    void Timer(uint64_t period);
+
+    std::vector<int> m_order;         //!< The events, in execution order.
+    std::vector<uint64_t> m_times;    //!< The times of the timer, ns.
+    EventId m_timer;                  //!< The timer event.
+    uint32_t m_remaining;             //!< Number of periods of the timer left.
+    ObjectFactory m_schedulerFactory; //!< Scheduler factory.
+};
+
+SimulatorRescheduleTestCase::SimulatorRescheduleTestCase(ObjectFactory schedulerFactory)
+    : TestCase("Check Reschedule with " + schedulerFactory.GetTypeId().GetName()),
+      m_schedulerFactory(schedulerFactory)
+{
+}
+
+void
+SimulatorRescheduleTestCase::Record(int value)
+{
+    m_order.push_back(value);
+}
+
+void
+SimulatorRescheduleTestCase::Timer(uint64_t period)
+{
+    m_times.push_back(Simulator::Now().GetNanoSeconds());
+    if (m_remaining-- > 0)
+    {
+        EventId id = Simulator::Reschedule(m_timer, NanoSeconds(period));
+        NS_TEST_EXPECT_MSG_EQ(id.PeekEventImpl(), m_timer.PeekEventImpl(), "event not re-armed");
+        m_timer = id;
+    }
+}
+
+void
+SimulatorRescheduleTestCase::DoRun()
+{
+    Simulator::SetScheduler(m_schedulerFactory);
+
+    // a pending event, moved later and earlier, keeps the order of a new event
+    EventId a = Simulator::Schedule(NanoSeconds(10), &SimulatorRescheduleTestCase::Record, this, 1);
+    Simulator::Schedule(NanoSeconds(20), &SimulatorRescheduleTestCase::Record, this, 2);
+    EventId c = Simulator::Schedule(NanoSeconds(30), &SimulatorRescheduleTestCase::Record, this, 3);
+    Simulator::Schedule(NanoSeconds(20), &SimulatorRescheduleTestCase::Record, this, 4);
+    EventId movedA = Simulator::Reschedule(a, NanoSeconds(20));
+    EventId movedC = Simulator::Reschedule(c, NanoSeconds(5));
+    NS_TEST_ASSERT_MSG_EQ(movedA.IsExpired(), false, "moved event expired");
+    NS_TEST_ASSERT_MSG_EQ(TimeStep(movedA.GetTs()), NanoSeconds(20), "wrong time");
+    NS_TEST_ASSERT_MSG_EQ(Simulator::GetDelayLeft(movedC), NanoSeconds(5), "wrong delay");
+
+    // cancelled events are not moved
+    EventId d = Simulator::Schedule(NanoSeconds(1), &SimulatorRescheduleTestCase::Record, this, 5);
+    d.Cancel();
+    NS_TEST_ASSERT_MSG_EQ(Simulator::Reschedule(d, NanoSeconds(1)).IsExpired(), true, "moved");
+
+    m_remaining = 3;
+    m_timer = Simulator::Schedule(NanoSeconds(100), &SimulatorRescheduleTestCase::Timer, this, 10);
+    Simulator::Run();
+    std::vector<int> order{3, 2, 4, 1};
+    NS_TEST_ASSERT_MSG_EQ((m_order == order), true, "wrong order of the moved events");
+    std::vector<uint64_t> times{100, 110, 120, 130};
+    NS_TEST_ASSERT_MSG_EQ((m_times == times), true, "wrong times of the timer");
+    NS_TEST_ASSERT_MSG_EQ(Simulator::Reschedule(a, NanoSeconds(1)).IsExpired(), true, "moved");
+    NS_TEST_ASSERT_MSG_EQ(Simulator::Reschedule(movedA, Time(0)).IsExpired(), true, "moved");
+
+    // the cancelled events are removed once they are half of the list
+    Ptr<DefaultSimulatorImpl> impl =
+        DynamicCast<DefaultSimulatorImpl>(Simulator::GetImplementation());
+    NS_TEST_ASSERT_MSG_NE(impl, nullptr, "not the default simulator");
+    impl->SetAttribute("CompactionThreshold", UintegerValue(10));
+    std::vector<EventId> events;
+    for (int i = 0; i < 100; i++)
+    {
+        Time delay = NanoSeconds(1 + i % 7);
+        events.push_back(Simulator::Schedule(delay, &SimulatorRescheduleTestCase::Record, this, i));
+    }
+    for (int i = 0; i < 60; i++)
+    {
+        events[i].Cancel();
+    }
+    // compacted at the 51st cancel, the last 9 left in the list
+    NS_TEST_ASSERT_MSG_EQ(impl->GetEventListSize(), 49, "cancelled events not removed");
+    m_order.clear();
+    Simulator::Run();
+    NS_TEST_ASSERT_MSG_EQ(m_order.size(), 40, "wrong number of events executed");
+    Simulator::Destroy();
+}
+
 /**
  * \ingroup simulator-tests
  *
@@ -722,14 +961,28 @@ class SimulatorTestSuite : public TestSuite
         factory.SetTypeId(ListScheduler::GetTypeId());
 
         AddTestCase(new SimulatorEventsTestCase(factory), TestCase::QUICK);
+        AddTestCase(new SimulatorRescheduleTestCase(factory), TestCase::QUICK);
         factory.SetTypeId(MapScheduler::GetTypeId());
         AddTestCase(new SimulatorEventsTestCase(factory), TestCase::QUICK);
+        AddTestCase(new SimulatorRescheduleTestCase(factory), TestCase::QUICK);
         factory.SetTypeId(HeapScheduler::GetTypeId());
         AddTestCase(new SimulatorEventsTestCase(factory), TestCase::QUICK);
+        AddTestCase(new SimulatorRescheduleTestCase(factory), TestCase::QUICK);
+        AddTestCase(new SchedulerOrderTestCase(factory), TestCase::QUICK);
         factory.SetTypeId(CalendarScheduler::GetTypeId());
         AddTestCase(new SimulatorEventsTestCase(factory), TestCase::QUICK);
+        AddTestCase(new SimulatorRescheduleTestCase(factory), TestCase::QUICK);
+        AddTestCase(new SchedulerOrderTestCase(factory), TestCase::QUICK);
         factory.SetTypeId(PriorityQueueScheduler::GetTypeId());
         AddTestCase(new SimulatorEventsTestCase(factory), TestCase::QUICK);
+        AddTestCase(new SimulatorRescheduleTestCase(factory), TestCase::QUICK);
+        factory.SetTypeId(LadderScheduler::GetTypeId());
+        AddTestCase(new SimulatorEventsTestCase(factory), TestCase::QUICK);
+        AddTestCase(new SimulatorRescheduleTestCase(factory), TestCase::QUICK);
+        AddTestCase(new SchedulerOrderTestCase(factory), TestCase::QUICK);
+        factory.Set("Threshold", UintegerValue(2));
+        factory.Set("MaxRungs", UintegerValue(3));
+        AddTestCase(new SchedulerOrderTestCase(factory), TestCase::QUICK);
     }
 };
 
@@ -31,7 +31,7 @@
 namespace ns3
 {
 
-unsigned long SinkTracer::m_sinkCount = 0;
+std::atomic<unsigned long> SinkTracer::m_sinkCount(0);
 unsigned long SinkTracer::m_line = 0;
 int SinkTracer::m_worldRank = -1;
 int SinkTracer::m_worldSize = -1;
@@ -56,12 +56,13 @@ SinkTracer::SinkTrace(const ns3::Ptr<const ns3::Packet> packet,
 void
 SinkTracer::Verify(unsigned long expectedCount)
 {
+    unsigned long localCount = m_sinkCount;
     unsigned long globalCount;
 
 #ifdef NS3_MPI
-    MPI_Reduce(&m_sinkCount, &globalCount, 1, MPI_UNSIGNED_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&localCount, &globalCount, 1, MPI_UNSIGNED_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
 #else
-    globalCount = m_sinkCount;
+    globalCount = localCount;
 #endif
 
     if (expectedCount == globalCount)
@@ -42,11 +42,16 @@
  *
  * One packet is sent from each left leaf node.  The packet sinks on the
  * right leaf nodes output logging information when they receive the packet.
+ *
+ * With --hybrid, each rank also runs its router and its leaf nodes on
+ * three threads: the router on one thread, the even and odd leaf nodes
+ * on the two others.
  */
 
 #include "mpi-test-fixtures.h"
 
 #include "ns3/core-module.h"
+#include "ns3/hybrid-simulator-impl.h"
 #include "ns3/internet-stack-helper.h"
 #include "ns3/ipv4-address-helper.h"
 #include "ns3/ipv4-global-routing-helper.h"
@@ -69,6 +74,7 @@ main(int argc, char* argv[])
 {
     bool nix = true;
     bool nullmsg = false;
+    bool hybrid = false;
     bool tracing = false;
     bool testing = false;
     bool verbose = false;
@@ -76,6 +82,7 @@ main(int argc, char* argv[])
     CommandLine cmd(__FILE__);
     cmd.AddValue("nix", "Enable the use of nix-vector or global routing", nix);
     cmd.AddValue("nullmsg", "Enable the use of null-message synchronization", nullmsg);
+    cmd.AddValue("hybrid", "Run the nodes of each rank on several threads", hybrid);
     cmd.AddValue("tracing", "Enable pcap tracing", tracing);
     cmd.AddValue("verbose", "verbose output", verbose);
     cmd.AddValue("test", "Enable regression test output", testing);
@@ -87,6 +94,12 @@ main(int argc, char* argv[])
         GlobalValue::Bind("SimulatorImplementationType",
                           StringValue("ns3::NullMessageSimulatorImpl"));
     }
+    else if (hybrid)
+    {
+        GlobalValue::Bind("SimulatorImplementationType", StringValue("ns3::HybridSimulatorImpl"));
+        // The nix-vectors are computed on demand from every node
+        nix = false;
+    }
     else
     {
         GlobalValue::Bind("SimulatorImplementationType",
@@ -137,6 +150,16 @@ main(int argc, char* argv[])
     NodeContainer rightLeafNodes;
     rightLeafNodes.Create(4, 1);
 
+    // The threads must be known before the links are installed
+    if (hybrid)
+    {
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+            HybridSimulatorImpl::SetThread(leftLeafNodes.Get(i)->GetId(), 1 + i % 2);
+            HybridSimulatorImpl::SetThread(rightLeafNodes.Get(i)->GetId(), 1 + i % 2);
+        }
+    }
+
     PointToPointHelper routerLink;
     routerLink.SetDeviceAttribute("DataRate", StringValue("5Mbps"));
     routerLink.SetChannelAttribute("Delay", StringValue("5ms"));
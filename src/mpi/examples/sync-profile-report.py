@@ -0,0 +1,134 @@
+#! /usr/bin/env python3
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License version 2 as
+# published by the Free Software Foundation;
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+"""
+Merge the synchronization profiles written by ns3::SyncProfiler.
+
+Run the simulation with --MpiSyncProfile=<prefix>, then:
+
+    sync-profile-report.py <prefix>
+
+The rank on the critical path is the one that spent the most time
+processing events: the others wait for it at every synchronization round.
+"""
+
+import csv
+import glob
+import json
+import sys
+
+
+def percentile(histogram, fraction):
+    """! Upper bound of the power of two bucket holding a percentile.
+    @param histogram The histogram of a profile.
+    @param fraction The percentile, between 0 and 1.
+    @return The bound, 0 if the histogram is empty.
+    """
+    target = fraction * histogram["count"]
+    seen = 0
+    for i, count in enumerate(histogram["log2Buckets"]):
+        seen += count
+        if count and seen >= target:
+            return (1 << i) - 1 if i else 0
+    return 0
+
+
+def main(argv):
+    if len(argv) != 2:
+        print("usage: %s <prefix>" % argv[0], file=sys.stderr)
+        return 1
+    prefix = argv[1]
+
+    profiles = []
+    for name in glob.glob(prefix + "-*.json"):
+        with open(name) as f:
+            profiles.append(json.load(f))
+    if not profiles:
+        print("no profile matches %s-*.json" % prefix, file=sys.stderr)
+        return 1
+    profiles.sort(key=lambda p: p["rank"])
+    ranks = profiles[0]["ranks"]
+    if len(profiles) != ranks:
+        print("warning: %d profiles for %d ranks" % (len(profiles), ranks), file=sys.stderr)
+
+    print("%s, %d ranks" % (profiles[0]["simulator"], ranks))
+    print(
+        "%5s %8s %10s %9s %9s %9s %9s %6s %12s %10s %10s %10s"
+        % (
+            "rank",
+            "rounds",
+            "events",
+            "run s",
+            "compute",
+            "exchange",
+            "wait",
+            "wait%",
+            "window p50",
+            "tx pkts",
+            "rx pkts",
+            "tx nulls",
+        )
+    )
+    for p in profiles:
+        run = p["runSeconds"]
+        print(
+            "%5d %8d %10d %9.3f %9.3f %9.3f %9.3f %5.1f%% %10dns %10d %10d %10d"
+            % (
+                p["rank"],
+                p["rounds"],
+                p["events"],
+                run,
+                p["computeSeconds"],
+                p["exchangeSeconds"],
+                p["waitSeconds"],
+                100.0 * p["waitSeconds"] / run if run else 0.0,
+                percentile(p["windowNs"], 0.5),
+                p["txPackets"],
+                p["rxPackets"],
+                p["txNullMessages"],
+            )
+        )
+
+    # The busiest pairs of ranks, from the counters of the senders
+    pairs = []
+    for name in glob.glob(prefix + "-*.csv"):
+        with open(name) as f:
+            for row in csv.DictReader(f):
+                if int(row["txPackets"]):
+                    pairs.append(
+                        (int(row["txBytes"]), int(row["txPackets"]), row["rank"], row["peer"])
+                    )
+    pairs.sort(reverse=True)
+    for txBytes, txPackets, src, dst in pairs[:5]:
+        print("rank %s -> %s: %d packets, %d bytes" % (src, dst, txPackets, txBytes))
+
+    critical = max(profiles, key=lambda p: p["computeSeconds"])
+    mean = sum(p["computeSeconds"] for p in profiles) / len(profiles)
+    print(
+        "critical path: rank %d, %.3f s of events (%.2fx the mean), "
+        "%.1f events per window, waited %.3f s"
+        % (
+            critical["rank"],
+            critical["computeSeconds"],
+            critical["computeSeconds"] / mean if mean else 1.0,
+            critical["eventsPerWindow"]["mean"],
+            critical["waitSeconds"],
+        )
+    )
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
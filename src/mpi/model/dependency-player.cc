@@ -0,0 +1,523 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file
+ * \ingroup mpi
+ * Implementation of class ns3::DependencyPlayer.
+ */
+
+#include "dependency-player.h"
+
+#include "distributed-simulator-impl.h"
+#include "mpi-interface.h"
+#include "mpi-receiver.h"
+
+#include "ns3/abort.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/node-list.h"
+#include "ns3/node.h"
+#include "ns3/nstime.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("DependencyPlayer");
+
+NS_OBJECT_ENSURE_REGISTERED(DependencyPlayer);
+
+/** Size of a notification: the step and the end time of the reporter. */
+static const uint32_t NOTIFICATION_SIZE = sizeof(uint32_t) + sizeof(int64_t);
+
+/** Rank without a node to receive notifications. */
+static const uint32_t NO_ANCHOR = 0xffffffff;
+
+TypeId
+DependencyPlayer::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::DependencyPlayer")
+                            .SetParent<Object>()
+                            .SetGroupName("Mpi")
+                            .AddConstructor<DependencyPlayer>()
+                            .AddAttribute("NotificationDelay",
+                                          "The time it takes to notify a rank of the end "
+                                          "of a step; not smaller than the lookahead under MPI.",
+                                          TimeValue(MicroSeconds(2)),
+                                          MakeTimeAccessor(&DependencyPlayer::m_delay),
+                                          MakeTimeChecker(Time(0)));
+    return tid;
+}
+
+DependencyPlayer::DependencyPlayer()
+    : m_systemId(0),
+      m_checkedDelay(false)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+DependencyPlayer::~DependencyPlayer()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+DependencyPlayer::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    m_steps.clear();
+    m_startCallback = MakeNullCallback<void, uint32_t>();
+    m_endCallback = MakeNullCallback<void, uint32_t, Time>();
+    Object::DoDispose();
+}
+
+uint32_t
+DependencyPlayer::AddGroup(const std::vector<std::vector<WorkloadFlow>>& steps)
+{
+    NS_LOG_FUNCTION(this << steps.size());
+
+    uint32_t group = m_firstSteps.size();
+    m_firstSteps.push_back(m_steps.size());
+    for (uint32_t i = 0; i < std::max<std::size_t>(steps.size(), 1); ++i)
+    {
+        Step step;
+        step.group = group;
+        if (i < steps.size())
+        {
+            step.flows = steps[i];
+        }
+        step.nPredecessors = i > 0 ? 1 : 0;
+        step.participant = false;
+        step.finished = false;
+        step.waiting = 0;
+        step.pending = 0;
+        if (i > 0)
+        {
+            m_steps.back().next.push_back(m_steps.size());
+        }
+        m_steps.push_back(step);
+    }
+    return group;
+}
+
+bool
+DependencyPlayer::ReadGroup(const std::string& filename)
+{
+    NS_LOG_FUNCTION(this << filename);
+
+    std::ifstream input(filename);
+    if (!input.is_open())
+    {
+        return false;
+    }
+    std::vector<std::vector<WorkloadFlow>> steps;
+    std::string line;
+    while (std::getline(input, line))
+    {
+        if (line.empty() || line[0] == '#' || line.find("stat") != std::string::npos)
+        {
+            continue;
+        }
+        if (line.find("phase") != std::string::npos)
+        {
+            steps.emplace_back();
+            continue;
+        }
+        WorkloadFlow flow;
+        if (!WorkloadTrace::ParseFlow(line, flow))
+        {
+            NS_LOG_WARN("skipping malformed flow in " << filename << ": " << line);
+            continue;
+        }
+        if (steps.empty())
+        {
+            steps.emplace_back();
+        }
+        steps.back().push_back(flow);
+    }
+    AddGroup(steps);
+    return true;
+}
+
+uint32_t
+DependencyPlayer::ReadGroups(const std::string& prefix)
+{
+    NS_LOG_FUNCTION(this << prefix);
+
+    uint32_t n = 0;
+    while (ReadGroup(prefix + std::to_string(n) + ".txt"))
+    {
+        n++;
+    }
+    return n;
+}
+
+void
+DependencyPlayer::AddDependency(uint32_t group, uint32_t predecessor)
+{
+    NS_LOG_FUNCTION(this << group << predecessor);
+    NS_ASSERT(group < m_firstSteps.size() && predecessor < m_firstSteps.size());
+
+    uint32_t first = m_firstSteps[group];
+    uint32_t last = predecessor + 1 < m_firstSteps.size() ? m_firstSteps[predecessor + 1] - 1
+                                                          : m_steps.size() - 1;
+    m_steps[last].next.push_back(first);
+    m_steps[first].nPredecessors++;
+}
+
+bool
+DependencyPlayer::ReadDependencies(const std::string& filename)
+{
+    NS_LOG_FUNCTION(this << filename);
+
+    std::ifstream input(filename);
+    if (!input.is_open())
+    {
+        return false;
+    }
+    // "a-b" or "a"
+    auto parseRange = [](const std::string& s, uint32_t& first, uint32_t& last) {
+        std::size_t dash = s.find('-');
+        first = std::stoul(s.substr(0, dash));
+        last = dash == std::string::npos ? first : std::stoul(s.substr(dash + 1));
+    };
+    std::string line;
+    while (std::getline(input, line))
+    {
+        std::size_t colon = line.find(':');
+        if (line.empty() || line[0] == '#' || colon == std::string::npos)
+        {
+            continue;
+        }
+        uint32_t first;
+        uint32_t last;
+        uint32_t predFirst;
+        uint32_t predLast;
+        parseRange(line.substr(0, colon), first, last);
+        parseRange(line.substr(colon + 1), predFirst, predLast);
+        for (uint32_t g = first; g <= last; ++g)
+        {
+            for (uint32_t p = predFirst; p <= predLast; ++p)
+            {
+                NS_ABORT_MSG_IF(g >= m_firstSteps.size() || p >= m_firstSteps.size(),
+                                "dependency " << line << " names a group that was not read");
+                AddDependency(g, p);
+            }
+        }
+    }
+    return true;
+}
+
+void
+DependencyPlayer::SetStepStartCallback(Callback<void, uint32_t> cb)
+{
+    m_startCallback = cb;
+}
+
+void
+DependencyPlayer::SetGroupEndCallback(Callback<void, uint32_t, Time> cb)
+{
+    m_endCallback = cb;
+}
+
+void
+DependencyPlayer::Prepare()
+{
+    NS_LOG_FUNCTION(this);
+
+    m_systemId = MpiInterface::GetSystemId();
+    uint32_t nRanks = MpiInterface::IsEnabled() ? MpiInterface::GetSize() : 1;
+
+    // The node of each rank that receives the notifications
+    m_anchors.assign(nRanks, NO_ANCHOR);
+    for (uint32_t i = 0; i < NodeList::GetNNodes(); ++i)
+    {
+        uint32_t rank = NodeList::GetNode(i)->GetSystemId();
+        if (rank < nRanks && m_anchors[rank] == NO_ANCHOR)
+        {
+            m_anchors[rank] = i;
+        }
+    }
+
+    std::vector<std::vector<uint32_t>> participants(m_steps.size());
+    for (uint32_t s = 0; s < m_steps.size(); ++s)
+    {
+        Step& step = m_steps[s];
+        for (const WorkloadFlow& flow : step.flows)
+        {
+            uint32_t src = NodeList::GetNode(flow.src)->GetSystemId();
+            uint32_t dst = NodeList::GetNode(flow.dst)->GetSystemId();
+            participants[s].push_back(src);
+            participants[s].push_back(dst);
+            step.reporters.push_back(dst);
+        }
+        std::sort(step.reporters.begin(), step.reporters.end());
+        step.reporters.erase(std::unique(step.reporters.begin(), step.reporters.end()),
+                             step.reporters.end());
+        std::sort(participants[s].begin(), participants[s].end());
+        participants[s].erase(std::unique(participants[s].begin(), participants[s].end()),
+                              participants[s].end());
+        step.participant =
+            std::binary_search(participants[s].begin(), participants[s].end(), m_systemId);
+        step.finished = false;
+        step.waiting = step.nPredecessors;
+        step.pending = step.reporters.size();
+    }
+
+    // Topological order of the steps
+    std::vector<uint32_t> order;
+    std::vector<uint32_t> waiting(m_steps.size());
+    for (uint32_t s = 0; s < m_steps.size(); ++s)
+    {
+        waiting[s] = m_steps[s].nPredecessors;
+        if (waiting[s] == 0)
+        {
+            order.push_back(s);
+        }
+    }
+    for (uint32_t i = 0; i < order.size(); ++i)
+    {
+        for (uint32_t n : m_steps[order[i]].next)
+        {
+            if (--waiting[n] == 0)
+            {
+                order.push_back(n);
+            }
+        }
+    }
+    NS_ABORT_MSG_IF(order.size() != m_steps.size(), "the dependencies contain a cycle");
+
+    // A rank must hear of the end of a step if it takes part in a step
+    // waiting for it.  A step without flows ends as soon as it starts, so
+    // the ranks that must hear of its end must also hear of the end of
+    // its predecessors.  Rank 0 hears of everything to report the groups.
+    for (auto it = order.rbegin(); it != order.rend(); ++it)
+    {
+        Step& step = m_steps[*it];
+        std::vector<uint32_t> notified(1, 0);
+        for (uint32_t n : step.next)
+        {
+            notified.insert(notified.end(), participants[n].begin(), participants[n].end());
+            if (m_steps[n].reporters.empty())
+            {
+                notified.insert(notified.end(),
+                                m_steps[n].notified.begin(),
+                                m_steps[n].notified.end());
+            }
+        }
+        std::sort(notified.begin(), notified.end());
+        notified.erase(std::unique(notified.begin(), notified.end()), notified.end());
+        step.notified.clear();
+        for (uint32_t rank : notified)
+        {
+            if (rank == m_systemId || m_anchors[rank] != NO_ANCHOR)
+            {
+                step.notified.push_back(rank);
+            }
+        }
+    }
+
+    if (m_anchors[m_systemId] != NO_ANCHOR && nRanks > 1)
+    {
+        Ptr<Node> anchor = NodeList::GetNode(m_anchors[m_systemId]);
+        Ptr<MpiReceiver> receiver = CreateObject<MpiReceiver>();
+        receiver->SetReceiveCallback(MakeCallback(&DependencyPlayer::Receive, this));
+        anchor->AggregateObject(receiver);
+    }
+}
+
+void
+DependencyPlayer::Start(Time start)
+{
+    NS_LOG_FUNCTION(this << start);
+    NS_ASSERT(start >= Simulator::Now());
+
+    Prepare();
+    for (uint32_t s = 0; s < m_steps.size(); ++s)
+    {
+        if (m_steps[s].nPredecessors == 0)
+        {
+            Simulator::Schedule(start - Simulator::Now(), &DependencyPlayer::StartStep, this, s);
+        }
+    }
+}
+
+void
+DependencyPlayer::StartStep(uint32_t step)
+{
+    NS_LOG_FUNCTION(this << step);
+
+    Step& s = m_steps[step];
+    s.start = Simulator::Now();
+    if (s.participant && !m_startCallback.IsNull())
+    {
+        m_startCallback(step);
+    }
+    if (s.reporters.empty())
+    {
+        s.end = s.start;
+        FinishStep(step);
+    }
+}
+
+void
+DependencyPlayer::NotifyLocalDone(uint32_t step)
+{
+    NS_LOG_FUNCTION(this << step);
+    NS_ASSERT(step < m_steps.size());
+
+    Time now = Simulator::Now();
+    uint8_t buffer[NOTIFICATION_SIZE];
+    int64_t t = now.GetTimeStep();
+    std::memcpy(buffer, &step, sizeof(step));
+    std::memcpy(buffer + sizeof(step), &t, sizeof(t));
+
+    for (uint32_t rank : m_steps[step].notified)
+    {
+        if (rank == m_systemId)
+        {
+            Simulator::Schedule(m_delay, &DependencyPlayer::ReporterDone, this, step, now);
+            continue;
+        }
+        if (!m_checkedDelay)
+        {
+            Ptr<DistributedSimulatorImpl> impl =
+                DynamicCast<DistributedSimulatorImpl>(Simulator::GetImplementation());
+            NS_ABORT_MSG_UNLESS(impl, "DependencyPlayer requires ns3::DistributedSimulatorImpl");
+            NS_ABORT_MSG_IF(m_delay < impl->GetLookAhead(),
+                            "NotificationDelay " << m_delay.As(Time::US)
+                                                 << " is smaller than the lookahead "
+                                                 << impl->GetLookAhead().As(Time::US));
+            m_checkedDelay = true;
+        }
+        MpiInterface::SendPacket(Create<Packet>(buffer, NOTIFICATION_SIZE),
+                                 now + m_delay,
+                                 m_anchors[rank],
+                                 MpiReceiver::NODE_RECEIVER);
+    }
+}
+
+void
+DependencyPlayer::Receive(Ptr<Packet> p)
+{
+    NS_LOG_FUNCTION(this << p);
+    NS_ASSERT(p->GetSize() == NOTIFICATION_SIZE);
+
+    uint8_t buffer[NOTIFICATION_SIZE];
+    p->CopyData(buffer, NOTIFICATION_SIZE);
+    uint32_t step;
+    int64_t t;
+    std::memcpy(&step, buffer, sizeof(step));
+    std::memcpy(&t, buffer + sizeof(step), sizeof(t));
+    NS_ASSERT(step < m_steps.size());
+    ReporterDone(step, TimeStep(t));
+}
+
+void
+DependencyPlayer::ReporterDone(uint32_t step, Time end)
+{
+    NS_LOG_FUNCTION(this << step << end);
+
+    Step& s = m_steps[step];
+    NS_ASSERT(s.pending > 0);
+    s.end = Max(s.end, end);
+    if (--s.pending == 0)
+    {
+        FinishStep(step);
+    }
+}
+
+void
+DependencyPlayer::FinishStep(uint32_t step)
+{
+    NS_LOG_FUNCTION(this << step);
+
+    Step& s = m_steps[step];
+    s.finished = true;
+    NS_LOG_INFO("step " << step << " of group " << s.group << " done at " << s.end.As(Time::S));
+
+    if (IsLastStep(step) && m_systemId == 0 && !m_endCallback.IsNull())
+    {
+        m_endCallback(s.group, s.end - m_steps[m_firstSteps[s.group]].start);
+    }
+    for (uint32_t n : s.next)
+    {
+        NS_ASSERT(m_steps[n].waiting > 0);
+        if (--m_steps[n].waiting == 0)
+        {
+            StartStep(n);
+        }
+    }
+}
+
+bool
+DependencyPlayer::IsLastStep(uint32_t step) const
+{
+    return step + 1 == m_steps.size() || m_steps[step + 1].group != m_steps[step].group;
+}
+
+uint32_t
+DependencyPlayer::GetNGroups() const
+{
+    return m_firstSteps.size();
+}
+
+uint32_t
+DependencyPlayer::GetNSteps() const
+{
+    return m_steps.size();
+}
+
+uint32_t
+DependencyPlayer::GetGroup(uint32_t step) const
+{
+    NS_ASSERT(step < m_steps.size());
+    return m_steps[step].group;
+}
+
+const std::vector<WorkloadFlow>&
+DependencyPlayer::GetFlows(uint32_t step) const
+{
+    NS_ASSERT(step < m_steps.size());
+    return m_steps[step].flows;
+}
+
+Time
+DependencyPlayer::GetStepStart(uint32_t step) const
+{
+    NS_ASSERT(step < m_steps.size());
+    return m_steps[step].start;
+}
+
+Time
+DependencyPlayer::GetStepEnd(uint32_t step) const
+{
+    NS_ASSERT(step < m_steps.size());
+    return m_steps[step].end;
+}
+
+bool
+DependencyPlayer::IsStepFinished(uint32_t step) const
+{
+    NS_ASSERT(step < m_steps.size());
+    return m_steps[step].finished;
+}
+
+} // namespace ns3
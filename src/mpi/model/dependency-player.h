@@ -0,0 +1,260 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file
+ * \ingroup mpi
+ * Declaration of class ns3::DependencyPlayer.
+ */
+
+#ifndef NS3_DEPENDENCY_PLAYER_H
+#define NS3_DEPENDENCY_PLAYER_H
+
+#include "workload-trace.h"
+
+#include "ns3/callback.h"
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+#include "ns3/packet.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup mpi
+ *
+ * \brief Play communication groups in the order of their dependencies
+ *
+ * A group is one flow file written by trafficGen.py: a sequence of
+ * steps, each holding the flows between two "phase:" lines.  The steps
+ * of a group run one after the other, and a group starts once all the
+ * groups it depends on are finished, so independent groups overlap.
+ *
+ * Every rank loads the whole workload, since it needs to know which
+ * ranks own the senders and receivers of each step.  A rank calls
+ * NotifyLocalDone() once it has received all its flows of a step; the
+ * player then sends a notification to the ranks that start a step
+ * depending on it, as a packet through MpiInterface::SendPacket ()
+ * delivered NotificationDelay later.  A rank learns that a step is
+ * finished when the notification of the last receiving rank arrives;
+ * the same delay applies to the local notification, so every rank
+ * starts a step at the same simulation time, without any collective.
+ *
+ * Under MPI the notification delay must not be smaller than the
+ * lookahead of DistributedSimulatorImpl; the NullMessageSimulatorImpl
+ * is not supported.  Rank 0 is notified of every step, so it can
+ * report the duration of every group.
+ */
+class DependencyPlayer : public Object
+{
+  public:
+    /**
+     * Register this type.
+     * \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    DependencyPlayer();
+    ~DependencyPlayer() override;
+
+    /**
+     * Add a group.
+     *
+     * \param steps the flows of every step of the group
+     * \return the index of the group
+     */
+    uint32_t AddGroup(const std::vector<std::vector<WorkloadFlow>>& steps);
+
+    /**
+     * Read a group from a flow file in the rdma_operate.txt format.
+     *
+     * \param filename the flow file
+     * \return false if the file cannot be read
+     */
+    bool ReadGroup(const std::string& filename);
+
+    /**
+     * Read the groups from the files prefix0.txt, prefix1.txt, ... as
+     * gathered by merge_rdma.sh.
+     *
+     * \param prefix the path of the files without their index
+     * \return the number of groups read
+     */
+    uint32_t ReadGroups(const std::string& prefix);
+
+    /**
+     * Make a group wait for the end of another one.
+     *
+     * \param group the index of the dependent group
+     * \param predecessor the index of the group it waits for
+     */
+    void AddDependency(uint32_t group, uint32_t predecessor);
+
+    /**
+     * Read the dependencies written by merge_dependency.sh, one
+     * "a-b:c-d" line per edge meaning that each of the groups a to b
+     * waits for all of the groups c to d.
+     *
+     * \param filename the dependency file
+     * \return false if the file cannot be read
+     */
+    bool ReadDependencies(const std::string& filename);
+
+    /**
+     * \param cb invoked on the ranks owning a sender or a receiver of
+     *        a step when the step starts, with the index of the step
+     */
+    void SetStepStartCallback(Callback<void, uint32_t> cb);
+
+    /**
+     * \param cb invoked on rank 0 once a group is finished, with the
+     *        index of the group and its duration
+     */
+    void SetGroupEndCallback(Callback<void, uint32_t, Time> cb);
+
+    /**
+     * Start the groups without dependencies.  Must be invoked on every
+     * rank once the topology is built, before Simulator::Run ().
+     *
+     * \param start the start time of the first groups
+     */
+    void Start(Time start = Seconds(0));
+
+    /**
+     * Report that this rank has received all its flows of a step.
+     *
+     * \param step the index of the step
+     */
+    void NotifyLocalDone(uint32_t step);
+
+    /**
+     * \return the number of groups
+     */
+    uint32_t GetNGroups() const;
+
+    /**
+     * \return the number of steps
+     */
+    uint32_t GetNSteps() const;
+
+    /**
+     * \param step the index of a step
+     * \return the group of the step
+     */
+    uint32_t GetGroup(uint32_t step) const;
+
+    /**
+     * \param step the index of a step
+     * \return the flows of the step
+     */
+    const std::vector<WorkloadFlow>& GetFlows(uint32_t step) const;
+
+    /**
+     * \param step the index of a step
+     * \return the time the step started, as seen by this rank
+     */
+    Time GetStepStart(uint32_t step) const;
+
+    /**
+     * \param step the index of a step
+     * \return the time the last receiver of the step finished, as seen
+     *         by this rank
+     */
+    Time GetStepEnd(uint32_t step) const;
+
+    /**
+     * \param step the index of a step
+     * \return true if this rank knows that the step is finished
+     */
+    bool IsStepFinished(uint32_t step) const;
+
+  private:
+    void DoDispose() override;
+
+    /** A node of the dependency graph. */
+    struct Step
+    {
+        uint32_t group;                  //!< the group of the step
+        std::vector<WorkloadFlow> flows; //!< the flows
+        std::vector<uint32_t> next;      //!< the steps waiting for this one
+        uint32_t nPredecessors;          //!< the number of steps it waits for
+        std::vector<uint32_t> reporters; //!< the ranks receiving flows
+        std::vector<uint32_t> notified;  //!< the ranks told of its end
+        bool participant;                //!< does this rank send or receive
+        bool finished;                   //!< does this rank know it is finished
+        uint32_t waiting;                //!< predecessors not finished yet
+        uint32_t pending;                //!< reporters not heard from yet
+        Time start;                      //!< start time
+        Time end;                        //!< latest end of a reporter
+    };
+
+    /**
+     * Find the ranks involved in every step and the ranks to notify of
+     * its end.
+     */
+    void Prepare();
+
+    /**
+     * Start a step whose predecessors are finished.
+     *
+     * \param step the index of the step
+     */
+    void StartStep(uint32_t step);
+
+    /**
+     * Record the end of a step on a reporter.
+     *
+     * \param step the index of the step
+     * \param end the time the reporter finished
+     */
+    void ReporterDone(uint32_t step, Time end);
+
+    /**
+     * Start the steps waiting for a finished step.
+     *
+     * \param step the index of the step
+     */
+    void FinishStep(uint32_t step);
+
+    /**
+     * Handle a notification from another rank.
+     *
+     * \param p the notification
+     */
+    void Receive(Ptr<Packet> p);
+
+    /**
+     * \param step the index of a step
+     * \return true if the step is the last one of its group
+     */
+    bool IsLastStep(uint32_t step) const;
+
+    std::vector<Step> m_steps;          //!< the steps
+    std::vector<uint32_t> m_firstSteps; //!< the first step of every group
+    std::vector<uint32_t> m_anchors;    //!< a node of every rank receiving notifications
+    uint32_t m_systemId;                //!< this rank
+    Time m_delay;                       //!< the notification delay
+    bool m_checkedDelay;                //!< was the delay checked against the lookahead
+    Callback<void, uint32_t> m_startCallback;      //!< step start callback
+    Callback<void, uint32_t, Time> m_endCallback;  //!< group end callback
+};
+
+} // namespace ns3
+
+#endif /* NS3_DEPENDENCY_PLAYER_H */
@@ -26,8 +26,11 @@
 
 #include "granted-time-window-mpi-interface.h"
 #include "mpi-interface.h"
+#include "phase-engine.h"
+#include "sync-profiler.h"
 
 #include "ns3/assert.h"
+#include "ns3/boolean.h"
 #include "ns3/channel.h"
 #include "ns3/event-impl.h"
 #include "ns3/log.h"
@@ -36,7 +39,9 @@
 #include "ns3/ptr.h"
 #include "ns3/scheduler.h"
 #include "ns3/simulator.h"
+#include "ns3/uinteger.h"
 
+#include <algorithm>
 #include <cmath>
 #include <mpi.h>
 
@@ -52,7 +57,7 @@ LbtsMessage::~LbtsMessage()
 }
 
 Time
-LbtsMessage::GetSmallestTime()
+LbtsMessage::GetSmallestTime() const
 {
     return m_smallestTime;
 }
@@ -81,6 +86,67 @@ LbtsMessage::IsFinished() const
     return m_isFinished;
 }
 
+uint32_t
+LbtsMessage::GetPhaseCount() const
+{
+    return m_phaseCount;
+}
+
+Time
+LbtsMessage::GetPhaseTime() const
+{
+    return m_phaseTime;
+}
+
+Time
+LbtsMessage::GetNow() const
+{
+    return m_now;
+}
+
+Time
+LbtsMessage::GetArrivalTime() const
+{
+    return m_arrivalTime;
+}
+
+void
+LbtsMessage::SetArrivalTime(const Time& t)
+{
+    m_arrivalTime = t;
+}
+
+void
+LbtsMessage::Combine(const LbtsMessage& other)
+{
+    m_txCount += other.m_txCount;
+    m_rxCount += other.m_rxCount;
+    m_smallestTime = Min(m_smallestTime, other.m_smallestTime);
+    m_isFinished = m_isFinished && other.m_isFinished;
+    m_phaseCount = std::min(m_phaseCount, other.m_phaseCount);
+    m_phaseTime = Max(m_phaseTime, other.m_phaseTime);
+    m_now = Max(m_now, other.m_now);
+    m_arrivalTime = Min(m_arrivalTime, other.m_arrivalTime);
+}
+
+/**
+ * MPI user function reducing LbtsMessage elements.
+ *
+ * \param [in] in the messages to fold in
+ * \param [in,out] inout the messages folded into
+ * \param [in] len the number of messages
+ */
+static void
+ReduceLbts(void* in, void* inout, int* len, MPI_Datatype* /* type */)
+{
+    const LbtsMessage* from = static_cast<const LbtsMessage*>(in);
+    LbtsMessage* to = static_cast<LbtsMessage*>(inout);
+    for (int i = 0; i < *len; ++i)
+    {
+        to[i].Combine(from[i]);
+    }
+}
+
 /**
  * Initialize m_lookAhead to maximum, it will be constrained by
  * user supplied time via BoundLookAhead and the
@@ -94,7 +160,30 @@ DistributedSimulatorImpl::GetTypeId()
     static TypeId tid = TypeId("ns3::DistributedSimulatorImpl")
                             .SetParent<SimulatorImpl>()
                             .SetGroupName("Mpi")
-                            .AddConstructor<DistributedSimulatorImpl>();
+                            .AddConstructor<DistributedSimulatorImpl>()
+                            .AddAttribute("OverlapLbts",
+                                          "Reduce the LBTS of the next window with a non-blocking "
+                                          "MPI_Iallreduce while the current window is processed",
+                                          BooleanValue(false),
+                                          MakeBooleanAccessor(
+                                              &DistributedSimulatorImpl::m_overlapLbts),
+                                          MakeBooleanChecker())
+                            .AddAttribute("PerPeerLookAhead",
+                                          "Grant the windows of a rank with the lookahead of every "
+                                          "other rank, through any chain of links, rather than "
+                                          "the smallest delay of its own links",
+                                          BooleanValue(true),
+                                          MakeBooleanAccessor(
+                                              &DistributedSimulatorImpl::m_perPeerLookAhead),
+                                          MakeBooleanChecker())
+                            .AddAttribute("CompactionThreshold",
+                                          "Number of cancelled events from which they are removed "
+                                          "from the event list, once they are half of it; "
+                                          "0 leaves them in the list until they expire",
+                                          UintegerValue(1024),
+                                          MakeUintegerAccessor(
+                                              &DistributedSimulatorImpl::m_compactionThreshold),
+                                          MakeUintegerChecker<uint32_t>());
     return tid;
 }
 
@@ -105,9 +194,14 @@ DistributedSimulatorImpl::DistributedSimulatorImpl()
     m_myId = MpiInterface::GetSystemId();
     m_systemCount = MpiInterface::GetSize();
 
-    // Allocate the LBTS message buffer
-    m_pLBTS = new LbtsMessage[m_systemCount];
     m_grantedTime = Seconds(0);
+    m_overlapLbts = false;
+    m_lbtsType = MPI_DATATYPE_NULL;
+    m_lbtsOp = MPI_OP_NULL;
+    m_lbtsCount = 0;
+    m_perPeerLookAhead = true;
+    m_minPeerLookAhead = Time::Max();
+    m_lookAheadGain = Seconds(0);
 
     m_stop = false;
     m_globalFinished = false;
@@ -116,8 +210,10 @@ DistributedSimulatorImpl::DistributedSimulatorImpl()
     m_currentTs = 0;
     m_currentContext = Simulator::NO_CONTEXT;
     m_unscheduledEvents = 0;
+    m_cancelledEvents = 0;
     m_eventCount = 0;
     m_events = nullptr;
+    m_profiler = EventProfiler::Create();
 }
 
 DistributedSimulatorImpl::~DistributedSimulatorImpl()
@@ -136,7 +232,6 @@ DistributedSimulatorImpl::DoDispose()
         next.impl->Unref();
     }
     m_events = nullptr;
-    delete[] m_pLBTS;
     SimulatorImpl::DoDispose();
 }
 
@@ -156,6 +251,11 @@ DistributedSimulatorImpl::Destroy()
         }
     }
 
+    if (m_profiler)
+    {
+        m_profiler->Write("-" + std::to_string(m_myId));
+    }
+    SyncProfiler::Write();
     MpiInterface::Destroy();
 }
 
@@ -164,6 +264,9 @@ DistributedSimulatorImpl::CalculateLookAhead()
 {
     NS_LOG_FUNCTION(this);
 
+    Time bound = m_lookAhead;
+    std::vector<int64_t> links(m_systemCount, Time::Max().GetInteger());
+
     /* If running sequential simulation can ignore lookahead */
     if (MpiInterface::GetSize() <= 1)
     {
@@ -182,43 +285,37 @@ DistributedSimulatorImpl::CalculateLookAhead()
             for (uint32_t i = 0; i < (*iter)->GetNDevices(); ++i)
             {
                 Ptr<NetDevice> localNetDevice = (*iter)->GetDevice(i);
-                // only works for p2p links currently
-                if (!localNetDevice->IsPointToPoint())
-                {
-                    continue;
-                }
                 Ptr<Channel> channel = localNetDevice->GetChannel();
                 if (!channel)
                 {
                     continue;
                 }
 
-                // grab the adjacent node
-                Ptr<Node> remoteNode;
-                if (channel->GetDevice(0) == localNetDevice)
-                {
-                    remoteNode = (channel->GetDevice(1))->GetNode();
-                }
-                else
-                {
-                    remoteNode = (channel->GetDevice(0))->GetNode();
-                }
-
-                // if it's not remote, don't consider it
-                if (remoteNode->GetSystemId() == MpiInterface::GetSystemId())
+                // any channel with a propagation delay, whatever the device
+                TimeValue delay;
+                if (!channel->GetAttributeFailSafe("Delay", delay))
                 {
                     continue;
                 }
 
-                // compare delay on the channel with current value of
-                // m_lookAhead.  if delay on channel is smaller, make
-                // it the new lookAhead.
-                TimeValue delay;
-                channel->GetAttribute("Delay", delay);
-
-                if (delay.Get() < m_lookAhead)
+                // compare the delay with the links to every remote node
+                // of the channel
+                for (std::size_t j = 0; j < channel->GetNDevices(); ++j)
                 {
-                    m_lookAhead = delay.Get();
+                    Ptr<Node> remoteNode = channel->GetDevice(j)->GetNode();
+                    uint32_t remoteId = remoteNode->GetSystemId();
+                    if (remoteId == MpiInterface::GetSystemId())
+                    {
+                        continue;
+                    }
+                    NS_ASSERT_MSG(remoteId < m_systemCount,
+                                  "node " << remoteNode->GetId() << " on unknown rank "
+                                          << remoteId);
+                    links[remoteId] = std::min(links[remoteId], delay.Get().GetInteger());
+                    if (delay.Get() < m_lookAhead)
+                    {
+                        m_lookAhead = delay.Get();
+                    }
                 }
             }
         }
@@ -268,6 +365,82 @@ DistributedSimulatorImpl::CalculateLookAhead()
         m_lookAhead = Time(recvbuf);
         m_grantedTime = m_lookAhead;
     }
+
+    /* The per-peer lookahead needs links between ranks; the choice is
+     * the same on every rank since recvbuf is.
+     */
+    m_peerLookAhead.clear();
+    m_minPeerLookAhead = m_lookAhead;
+    if (m_perPeerLookAhead && MpiInterface::GetSize() > 1 && recvbuf != 0)
+    {
+        CalculatePeerLookAhead(links, bound);
+    }
+}
+
+void
+DistributedSimulatorImpl::CalculatePeerLookAhead(const std::vector<int64_t>& links,
+                                                 const Time& bound)
+{
+    NS_LOG_FUNCTION(this << bound);
+
+    const uint32_t n = m_systemCount;
+    const int64_t infinity = Time::Max().GetInteger();
+    std::vector<int64_t> all(n * n);
+    MPI_Allgather(links.data(),
+                  n,
+                  MPI_INT64_T,
+                  all.data(),
+                  n,
+                  MPI_INT64_T,
+                  MpiInterface::GetCommunicator());
+    auto link = [&](uint32_t a, uint32_t b) { return std::min(all[a * n + b], all[b * n + a]); };
+    auto add = [&](int64_t a, int64_t b) { return a >= infinity - b ? infinity : a + b; };
+
+    // Dijkstra from this rank, the graph of the ranks is dense
+    std::vector<int64_t> dist(n, infinity);
+    std::vector<bool> done(n, false);
+    dist[m_myId] = 0;
+    while (true)
+    {
+        uint32_t u = n;
+        for (uint32_t v = 0; v < n; ++v)
+        {
+            if (!done[v] && dist[v] != infinity && (u == n || dist[v] < dist[u]))
+            {
+                u = v;
+            }
+        }
+        if (u == n)
+        {
+            break;
+        }
+        done[u] = true;
+        for (uint32_t v = 0; v < n; ++v)
+        {
+            dist[v] = std::min(dist[v], add(dist[u], link(u, v)));
+        }
+    }
+
+    // Events of this rank come back to it through a round trip at best
+    dist[m_myId] = infinity;
+    for (uint32_t v = 0; v < n; ++v)
+    {
+        if (v != m_myId)
+        {
+            dist[m_myId] = std::min(dist[m_myId], add(link(m_myId, v), dist[v]));
+        }
+    }
+
+    // A rank without links advances like the others, see CalculateLookAhead
+    bool isolated = *std::min_element(links.begin(), links.end()) == infinity;
+    m_peerLookAhead.resize(n);
+    m_minPeerLookAhead = Time::Max();
+    for (uint32_t k = 0; k < n; ++k)
+    {
+        m_peerLookAhead[k] = isolated ? m_lookAhead : Min(TimeStep(dist[k]), bound);
+        m_minPeerLookAhead = Min(m_minPeerLookAhead, m_peerLookAhead[k]);
+        NS_LOG_LOGIC("lookahead with rank " << k << " " << m_peerLookAhead[k].As(Time::US));
+    }
 }
 
 void
@@ -284,6 +457,24 @@ DistributedSimulatorImpl::BoundLookAhead(const Time lookAhead)
     }
 }
 
+Time
+DistributedSimulatorImpl::GetLookAhead() const
+{
+    return m_lookAhead;
+}
+
+uint64_t
+DistributedSimulatorImpl::GetLbtsCount() const
+{
+    return m_lbtsCount;
+}
+
+Time
+DistributedSimulatorImpl::GetLookAheadGain() const
+{
+    return m_lookAheadGain;
+}
+
 void
 DistributedSimulatorImpl::SetScheduler(ObjectFactory schedulerFactory)
 {
@@ -314,12 +505,23 @@ DistributedSimulatorImpl::ProcessOneEvent()
     NS_ASSERT(next.key.m_ts >= m_currentTs);
     m_unscheduledEvents--;
     m_eventCount++;
+    if (m_cancelledEvents > 0 && next.impl->IsCancelled())
+    {
+        m_cancelledEvents--;
+    }
 
     NS_LOG_LOGIC("handle " << next.key.m_ts);
     m_currentTs = next.key.m_ts;
     m_currentContext = next.key.m_context;
     m_currentUid = next.key.m_uid;
-    next.impl->Invoke();
+    if (m_profiler)
+    {
+        m_profiler->Invoke(next.impl, m_currentContext);
+    }
+    else
+    {
+        next.impl->Invoke();
+    }
     next.impl->Unref();
 }
 
@@ -362,79 +564,205 @@ DistributedSimulatorImpl::Run()
 {
     NS_LOG_FUNCTION(this);
 
+    StartRun();
+
+    // Overlapping needs windows that grow, i.e. a finite, positive lookahead
+    if (m_overlapLbts && m_lookAhead.IsStrictlyPositive() &&
+        m_lookAhead != GetMaximumSimulationTime())
+    {
+        RunOverlapped();
+    }
+    else
+    {
+        RunBlocking();
+    }
+
+    FinishRun();
+
+    // If the simulator stopped naturally by lack of events, make a
+    // consistency test to check that we didn't lose any events along the way.
+    NS_ASSERT(!m_events->IsEmpty() || m_unscheduledEvents == 0);
+}
+
+void
+DistributedSimulatorImpl::StartRun()
+{
     CalculateLookAhead();
     m_stop = false;
     m_globalFinished = false;
+    m_lbtsCount = 0;
+    m_lookAheadGain = Seconds(0);
+
+    // The LBTS messages are reduced rather than gathered, so the
+    // synchronization costs the same whatever the number of ranks
+    MPI_Type_contiguous(sizeof(LbtsMessage), MPI_BYTE, &m_lbtsType);
+    MPI_Type_commit(&m_lbtsType);
+    MPI_Op_create(&ReduceLbts, 1, &m_lbtsOp);
+
+    SyncProfiler::Enable(m_myId, m_systemCount);
+    SyncProfiler::StartRun();
+}
+
+void
+DistributedSimulatorImpl::FinishRun()
+{
+    SyncProfiler::StopRun();
+    MPI_Op_free(&m_lbtsOp);
+    MPI_Type_free(&m_lbtsType);
+
+    NS_LOG_INFO("rank " << m_myId << ": " << m_lbtsCount << " windows, lookahead "
+                        << m_lookAhead.As(Time::US) << ", per-peer gain "
+                        << m_lookAheadGain.As(Time::US) << " ("
+                        << (m_lbtsCount ? m_lookAheadGain / m_lbtsCount : Seconds(0)).As(Time::US)
+                        << " per window)");
+}
+
+LbtsMessage
+DistributedSimulatorImpl::GetLocalLbts(const Time& smallestTime, const Time& now) const
+{
+    return LbtsMessage(GrantedTimeWindowMpiInterface::GetRxCount(),
+                       GrantedTimeWindowMpiInterface::GetTxCount(),
+                       m_myId,
+                       IsLocalFinished(),
+                       smallestTime,
+                       PhaseEngine::GetLocalDone(),
+                       PhaseEngine::GetLocalDoneTime(),
+                       now);
+}
+
+void
+DistributedSimulatorImpl::ExchangeLbts(const LbtsMessage& local,
+                                       LbtsMessage* global,
+                                       MPI_Request* request)
+{
+    MPI_Comm comm = MpiInterface::GetCommunicator();
+    if (m_peerLookAhead.empty())
+    {
+        if (request)
+        {
+            MPI_Iallreduce(&local, global, 1, m_lbtsType, m_lbtsOp, comm, request);
+        }
+        else
+        {
+            MPI_Allreduce(&local, global, 1, m_lbtsType, m_lbtsOp, comm);
+        }
+        return;
+    }
+
+    // Every rank gets the reduction of the messages sent to it, which
+    // only differ by the arrival times
+    m_lbtsBlocks.assign(m_systemCount, local);
+    Time smallestTime = local.GetSmallestTime();
+    for (uint32_t k = 0; k < m_systemCount; ++k)
+    {
+        Time lookAhead = m_peerLookAhead[k];
+        m_lbtsBlocks[k].SetArrivalTime(smallestTime >= Time::Max() - lookAhead
+                                           ? Time::Max()
+                                           : smallestTime + lookAhead);
+    }
+    if (request)
+    {
+        MPI_Ireduce_scatter_block(m_lbtsBlocks.data(),
+                                  global,
+                                  1,
+                                  m_lbtsType,
+                                  m_lbtsOp,
+                                  comm,
+                                  request);
+    }
+    else
+    {
+        MPI_Reduce_scatter_block(m_lbtsBlocks.data(), global, 1, m_lbtsType, m_lbtsOp, comm);
+    }
+}
+
+void
+DistributedSimulatorImpl::Grant(const LbtsMessage& global)
+{
+    m_lbtsCount++;
+
+    // The totRx and totTx counts insure there are no transient
+    // messages;  If totRx != totTx, there are transients,
+    // so we don't update the granted time.
+    bool noTransients = global.GetRxCount() == global.GetTxCount();
+
+    // Global halting condition is all nodes have empty queue's and
+    // no messages are in-flight.
+    m_globalFinished = global.IsFinished() && noTransients;
+
+    // Once every rank has finished the current workload phase the
+    // next one is scheduled at the same time on all the ranks,
+    // which keeps the simulation going.  Nothing below that time
+    // can have been sent yet, so the window is cut accordingly.
+    Time phaseStart;
+    bool phaseStarted = PhaseEngine::Synchronize(global, phaseStart);
+    m_globalFinished &= !phaseStarted;
+
+    if (noTransients)
+    {
+        // If lookahead is infinite then granted time should be as well.
+        // Covers the edge case if all the tasks have no inter tasks
+        // links, prevents overflow of granted time.
+        if (m_lookAhead == GetMaximumSimulationTime())
+        {
+            m_grantedTime = GetMaximumSimulationTime();
+        }
+        else
+        {
+            // Overflow is possible here if near end of representable time.
+            m_grantedTime = global.GetSmallestTime() + m_lookAhead;
+        }
+        if (!m_peerLookAhead.empty())
+        {
+            // Never earlier, the lookahead of any peer is at least the
+            // delay of one of the links of this rank
+            Time arrival = global.GetArrivalTime();
+            if (arrival != Time::Max() && arrival > m_grantedTime)
+            {
+                m_lookAheadGain += arrival - m_grantedTime;
+            }
+            m_grantedTime = arrival;
+        }
+    }
+    if (phaseStarted && m_lookAhead != GetMaximumSimulationTime())
+    {
+        m_grantedTime = Min(m_grantedTime, phaseStart + m_minPeerLookAhead);
+    }
+}
+
+void
+DistributedSimulatorImpl::RunBlocking()
+{
+    NS_LOG_FUNCTION(this);
+
     while (!m_globalFinished)
     {
         Time nextTime = Next();
 
         // If local event is beyond grantedTime then need to synchronize
         // with other tasks to determine new time window. If local task
-        // is finished then continue to participate in allgather
-        // synchronizations with other tasks until all tasks have
-        // completed.
+        // is finished then continue to participate in the reductions
+        // with other tasks until all tasks have completed.
         if (nextTime > m_grantedTime || IsLocalFinished())
         {
             // Can't process next event, calculate a new LBTS
-            // First receive any pending messages
+            // First send the packets batched during this window
+            int64_t start = SyncProfiler::Now();
+            GrantedTimeWindowMpiInterface::FlushSendBuffers();
+            // Then receive any pending messages
             GrantedTimeWindowMpiInterface::ReceiveMessages();
             // reset next time
             nextTime = Next();
             // And check for send completes
             GrantedTimeWindowMpiInterface::TestSendComplete();
             // Finally calculate the lbts
-            LbtsMessage lMsg(GrantedTimeWindowMpiInterface::GetRxCount(),
-                             GrantedTimeWindowMpiInterface::GetTxCount(),
-                             m_myId,
-                             IsLocalFinished(),
-                             nextTime);
-            m_pLBTS[m_myId] = lMsg;
-            MPI_Allgather(&lMsg,
-                          sizeof(LbtsMessage),
-                          MPI_BYTE,
-                          m_pLBTS,
-                          sizeof(LbtsMessage),
-                          MPI_BYTE,
-                          MpiInterface::GetCommunicator());
-            Time smallestTime = m_pLBTS[0].GetSmallestTime();
-            // The totRx and totTx counts insure there are no transient
-            // messages;  If totRx != totTx, there are transients,
-            // so we don't update the granted time.
-            uint32_t totRx = m_pLBTS[0].GetRxCount();
-            uint32_t totTx = m_pLBTS[0].GetTxCount();
-            m_globalFinished = m_pLBTS[0].IsFinished();
-
-            for (uint32_t i = 1; i < m_systemCount; ++i)
-            {
-                if (m_pLBTS[i].GetSmallestTime() < smallestTime)
-                {
-                    smallestTime = m_pLBTS[i].GetSmallestTime();
-                }
-                totRx += m_pLBTS[i].GetRxCount();
-                totTx += m_pLBTS[i].GetTxCount();
-                m_globalFinished &= m_pLBTS[i].IsFinished();
-            }
-
-            // Global halting condition is all nodes have empty queue's and
-            // no messages are in-flight.
-            m_globalFinished &= totRx == totTx;
-
-            if (totRx == totTx)
-            {
-                // If lookahead is infinite then granted time should be as well.
-                // Covers the edge case if all the tasks have no inter tasks
-                // links, prevents overflow of granted time.
-                if (m_lookAhead == GetMaximumSimulationTime())
-                {
-                    m_grantedTime = GetMaximumSimulationTime();
-                }
-                else
-                {
-                    // Overflow is possible here if near end of representable time.
-                    m_grantedTime = smallestTime + m_lookAhead;
-                }
-            }
+            LbtsMessage lMsg = GetLocalLbts(nextTime, Now());
+            LbtsMessage global;
+            start = SyncProfiler::AddTime(SyncProfiler::EXCHANGE, start);
+            ExchangeLbts(lMsg, &global, nullptr);
+            SyncProfiler::AddTime(SyncProfiler::WAIT, start);
+            Grant(global);
+            SyncProfiler::RecordRound(Now(), m_grantedTime, m_eventCount);
         }
 
         // Execute next event if it is within the current time window.
@@ -444,10 +772,52 @@ DistributedSimulatorImpl::Run()
             ProcessOneEvent();
         }
     }
+}
 
-    // If the simulator stopped naturally by lack of events, make a
-    // consistency test to check that we didn't lose any events along the way.
-    NS_ASSERT(!m_events->IsEmpty() || m_unscheduledEvents == 0);
+void
+DistributedSimulatorImpl::RunOverlapped()
+{
+    NS_LOG_FUNCTION(this);
+
+    while (!m_globalFinished)
+    {
+        // Packets received here were sent at or after the contributions
+        // of the previous reduction, so none is due before the window end
+        int64_t start = SyncProfiler::Now();
+        GrantedTimeWindowMpiInterface::ReceiveMessages();
+        GrantedTimeWindowMpiInterface::TestSendComplete();
+
+        // The phase engine schedules a new phase at the window end at the
+        // earliest, no rank processes anything later in this window.
+        Time windowEnd = m_grantedTime;
+        LbtsMessage lMsg = GetLocalLbts(Next(), windowEnd);
+        LbtsMessage global;
+        MPI_Request request;
+        ExchangeLbts(lMsg, &global, &request);
+        SyncProfiler::AddTime(SyncProfiler::EXCHANGE, start);
+
+        // Process the window, and let MPI progress the reduction meanwhile
+        int done = 0;
+        while (!IsLocalFinished() && Next() < windowEnd)
+        {
+            ProcessOneEvent();
+            if (!done)
+            {
+                MPI_Test(&request, &done, MPI_STATUS_IGNORE);
+            }
+        }
+
+        start = SyncProfiler::Now();
+        GrantedTimeWindowMpiInterface::FlushSendBuffers();
+        start = SyncProfiler::AddTime(SyncProfiler::EXCHANGE, start);
+        if (!done)
+        {
+            MPI_Wait(&request, MPI_STATUS_IGNORE);
+        }
+        SyncProfiler::AddTime(SyncProfiler::WAIT, start);
+        Grant(global);
+        SyncProfiler::RecordRound(windowEnd, m_grantedTime, m_eventCount);
+    }
 }
 
 uint32_t
@@ -586,7 +956,69 @@ DistributedSimulatorImpl::Cancel(const EventId& id)
     if (!IsExpired(id))
     {
         id.PeekEventImpl()->Cancel();
+        if (id.GetUid() != EventId::UID::DESTROY)
+        {
+            m_cancelledEvents++;
+            CompactEvents();
+        }
+    }
+}
+
+EventId
+DistributedSimulatorImpl::Reschedule(const EventId& id, const Time& delay)
+{
+    NS_LOG_FUNCTION(this << delay.GetTimeStep());
+    NS_ASSERT(delay.IsPositive());
+
+    Scheduler::Event ev;
+    ev.impl = id.PeekEventImpl();
+    ev.key.m_ts = id.GetTs();
+    ev.key.m_context = id.GetContext();
+    ev.key.m_uid = id.GetUid();
+    Scheduler::EventKey key;
+    key.m_ts = m_currentTs + delay.GetTimeStep();
+    key.m_context = id.GetContext();
+    key.m_uid = m_uid;
+    if (ev.impl != nullptr && ev.key.m_ts == m_currentTs && ev.key.m_uid == m_currentUid &&
+        !ev.impl->IsCancelled())
+    {
+        // the event being executed, inserted again
+        ev.impl->Ref();
+        m_events->Insert(Scheduler::Event{ev.impl, key});
+        m_unscheduledEvents++;
+    }
+    else if (id.GetUid() != EventId::UID::DESTROY && !IsExpired(id))
+    {
+        m_events->Update(ev, key);
+    }
+    else
+    {
+        return EventId();
+    }
+    m_uid++;
+    return EventId(ev.impl, key.m_ts, key.m_context, key.m_uid);
+}
+
+uint32_t
+DistributedSimulatorImpl::RemoveCancelledEvents()
+{
+    NS_LOG_FUNCTION(this);
+    m_unscheduledEvents -= m_events->RemoveCancelled();
+    m_cancelledEvents = 0;
+    return m_unscheduledEvents;
+}
+
+void
+DistributedSimulatorImpl::CompactEvents()
+{
+    if (m_compactionThreshold == 0 || m_cancelledEvents < m_compactionThreshold ||
+        2 * m_cancelledEvents <= static_cast<uint32_t>(m_unscheduledEvents))
+    {
+        return;
     }
+    NS_LOG_LOGIC("remove " << m_cancelledEvents << " cancelled events of " << m_unscheduledEvents);
+    m_unscheduledEvents -= m_events->RemoveCancelled();
+    m_cancelledEvents = 0;
 }
 
 bool
@@ -26,11 +26,15 @@
 #define NS3_DISTRIBUTED_SIMULATOR_IMPL_H
 
 #include "ns3/event-impl.h"
+#include "ns3/event-profiler.h"
 #include "ns3/ptr.h"
 #include "ns3/scheduler.h"
 #include "ns3/simulator-impl.h"
 
 #include <list>
+#include <memory>
+#include <mpi.h>
+#include <vector>
 
 namespace ns3
 {
@@ -39,6 +43,9 @@ namespace ns3
  * \ingroup mpi
  *
  * \brief Structure used for all-reduce LBTS computation
+ *
+ * Every rank contributes its own message; the reduction over all the
+ * ranks, see Combine(), is what each rank gets back.
  */
 class LbtsMessage
 {
@@ -47,7 +54,10 @@ class LbtsMessage
         : m_txCount(0),
           m_rxCount(0),
           m_myId(0),
-          m_isFinished(false)
+          m_smallestTime(Time::Max()),
+          m_isFinished(false),
+          m_phaseCount(0),
+          m_arrivalTime(Time::Max())
     {
     }
 
@@ -57,13 +67,27 @@ class LbtsMessage
      * \param id mpi rank
      * \param isFinished whether message is finished
      * \param t smallest time
+     * \param phaseCount number of workload phases finished
+     * \param phaseTime time the last workload phase was finished
+     * \param now current time
      */
-    LbtsMessage(uint32_t rxc, uint32_t txc, uint32_t id, bool isFinished, const Time& t)
+    LbtsMessage(uint32_t rxc,
+                uint32_t txc,
+                uint32_t id,
+                bool isFinished,
+                const Time& t,
+                uint32_t phaseCount,
+                const Time& phaseTime,
+                const Time& now)
         : m_txCount(txc),
           m_rxCount(rxc),
           m_myId(id),
           m_smallestTime(t),
-          m_isFinished(isFinished)
+          m_isFinished(isFinished),
+          m_phaseCount(phaseCount),
+          m_phaseTime(phaseTime),
+          m_now(now),
+          m_arrivalTime(Time::Max())
     {
     }
 
@@ -72,7 +96,7 @@ class LbtsMessage
     /**
      * \return smallest time
      */
-    Time GetSmallestTime();
+    Time GetSmallestTime() const;
     /**
      * \return transmitted count
      */
@@ -89,13 +113,48 @@ class LbtsMessage
      * \return true if system is finished
      */
     bool IsFinished() const;
+    /**
+     * \return number of workload phases finished
+     */
+    uint32_t GetPhaseCount() const;
+    /**
+     * \return time the last workload phase was finished
+     */
+    Time GetPhaseTime() const;
+    /**
+     * \return current time of the rank
+     */
+    Time GetNow() const;
+    /**
+     * \return earliest time a message can reach the rank the message
+     *         is reduced for, with per-peer lookahead
+     */
+    Time GetArrivalTime() const;
+    /**
+     * \param t earliest time a message of this rank can reach the rank
+     *        the message is reduced for
+     */
+    void SetArrivalTime(const Time& t);
+
+    /**
+     * Fold the message of another rank into this one: keep the smallest
+     * and arrival times, sum the counts, finished if both are, keep the
+     * fewest phases finished and the latest phase and current times.
+     *
+     * \param other the message of the other rank
+     */
+    void Combine(const LbtsMessage& other);
 
   private:
-    uint32_t m_txCount;  /**< Count of transmitted messages. */
-    uint32_t m_rxCount;  /**< Count of received messages. */
-    uint32_t m_myId;     /**< System Id of the rank sending this LBTS. */
-    Time m_smallestTime; /**< Earliest next event timestamp. */
-    bool m_isFinished;   /**< \c true when this rank has no more events. */
+    uint32_t m_txCount;    /**< Count of transmitted messages. */
+    uint32_t m_rxCount;    /**< Count of received messages. */
+    uint32_t m_myId;       /**< System Id of the rank sending this LBTS. */
+    Time m_smallestTime;   /**< Earliest next event timestamp. */
+    bool m_isFinished;     /**< \c true when this rank has no more events. */
+    uint32_t m_phaseCount; /**< Number of PhaseEngine phases finished. */
+    Time m_phaseTime;      /**< When the last phase was finished. */
+    Time m_now;            /**< Current time of the rank. */
+    Time m_arrivalTime;    /**< Earliest arrival at the destination rank. */
 };
 
 /**
@@ -129,6 +188,7 @@ class DistributedSimulatorImpl : public SimulatorImpl
     EventId ScheduleDestroy(EventImpl* event) override;
     void Remove(const EventId& id) override;
     void Cancel(const EventId& id) override;
+    EventId Reschedule(const EventId& id, const Time& delay) override;
     bool IsExpired(const EventId& id) const override;
     void Run() override;
     Time Now() const override;
@@ -139,6 +199,14 @@ class DistributedSimulatorImpl : public SimulatorImpl
     uint32_t GetContext() const override;
     uint64_t GetEventCount() const override;
 
+    /**
+     * Remove all the cancelled events from the event list now.  Only
+     * called between two windows.
+     *
+     * \returns The number of events left in the event list.
+     */
+    virtual uint32_t RemoveCancelledEvents();
+
     /**
      * Add additional bound to lookahead constraints.
      *
@@ -154,29 +222,122 @@ class DistributedSimulatorImpl : public SimulatorImpl
      */
     virtual void BoundLookAhead(const Time lookAhead);
 
-  private:
+    /**
+     * \return The lookahead of this rank, the smallest delay of its
+     *         links to other ranks; valid once Run() has started.
+     */
+    Time GetLookAhead() const;
+
+    /**
+     * \return The number of LBTS reductions of the last Run().
+     */
+    uint64_t GetLbtsCount() const;
+
+    /**
+     * \return How much the per-peer lookahead extended the granted
+     *         windows of this rank in the last Run(), in total, over
+     *         the smallest link delay of the rank.
+     */
+    Time GetLookAheadGain() const;
+
+  protected:
     // Inherited from Object
     void DoDispose() override;
 
+    /**
+     * Compute the lookahead and prepare the LBTS reductions of a Run().
+     */
+    void StartRun();
+    /**
+     * Release what StartRun() prepared.
+     */
+    void FinishRun();
+
     /**
      * Calculate lookahead constraint based on network latency.
      *
-     * The smallest cross-rank PointToPoint channel delay imposes
-     * a constraint on the conservative PDES time window.  The
-     * user may impose additional constraints on lookahead
-     * using the ConstrainLookAhead() method.
+     * The smallest delay of the channels to other ranks imposes a
+     * constraint on the conservative PDES time window.  Any channel
+     * with a Delay attribute is considered, point-to-point and qbb
+     * ones alike.  The user may impose additional constraints on
+     * lookahead using the BoundLookAhead() method.
      */
     void CalculateLookAhead();
+    /**
+     * Compute the lookahead of this rank with every other rank.
+     *
+     * Gather the smallest channel delay between every pair of ranks and
+     * find the shortest chain of channels from every rank to this one:
+     * a message of rank k cannot reach this rank earlier than that, even
+     * through other ranks.  The channels are symmetric, so the same
+     * delay bounds the messages from this rank to rank k.
+     *
+     * \param links the smallest delay of the channels from this rank to
+     *        every rank, Time::Max() if there are none
+     * \param bound the lookahead set with BoundLookAhead()
+     */
+    void CalculatePeerLookAhead(const std::vector<int64_t>& links, const Time& bound);
     /**
      * Check if this rank is finished.  It's finished when there are
      * no more events or stop has been requested.
      *
      * \returns \c true when this rank is finished.
      */
-    bool IsLocalFinished() const;
+    virtual bool IsLocalFinished() const;
+
+    /**
+     * Synchronize at the end of every granted window, with a blocking
+     * reduction of the LBTS messages.
+     */
+    void RunBlocking();
+    /**
+     * Reduce the LBTS messages of the next window while the current one
+     * is processed.
+     *
+     * Each rank contributes at the start of a window, with its next
+     * event.  The counts only cover the epochs closed before, see
+     * GrantedTimeWindowMpiInterface::FlushSendBuffers: when they match,
+     * nothing a rank processes or sends afterwards is earlier than its
+     * contribution, and packets sent during the window arrive no earlier
+     * than the new granted time.  A granted time is exclusive here, so that packets
+     * sent in the previous window at exactly that time are never needed
+     * in the current one.  The windows are shorter than with
+     * RunBlocking(), since the contributions are taken earlier, but the
+     * reduction is hidden behind the events of the window.
+     */
+    void RunOverlapped();
+    /**
+     * \param smallestTime the smallest time this rank contributes
+     * \param now the current time this rank contributes
+     * \return the LBTS message of this rank
+     */
+    LbtsMessage GetLocalLbts(const Time& smallestTime, const Time& now) const;
+    /**
+     * Reduce the LBTS messages of all the ranks, with the arrival
+     * times of this rank at every other rank if the per-peer lookahead
+     * is used.
+     *
+     * \param local the LBTS message of this rank
+     * \param [out] global the reduced LBTS message
+     * \param [out] request the request of a non-blocking reduction, or
+     *        nullptr to block until done
+     */
+    void ExchangeLbts(const LbtsMessage& local, LbtsMessage* global, MPI_Request* request);
+    /**
+     * Compute the next granted time and the termination from the
+     * reduction of the LBTS messages of all the ranks.
+     *
+     * \param global the reduced LBTS message
+     */
+    void Grant(const LbtsMessage& global);
 
     /** Process the next event. */
     void ProcessOneEvent();
+    /**
+     * Remove the cancelled events from the event list, if they are at
+     * least CompactionThreshold and half of the list.
+     */
+    void CompactEvents();
     /**
      * Get the timestep of the next event.
      *
@@ -219,12 +380,31 @@ class DistributedSimulatorImpl : public SimulatorImpl
      * not counting the "destroy" events; this is used for validation.
      */
     int m_unscheduledEvents;
+    /** Number of cancelled events in the event list, at most. */
+    uint32_t m_cancelledEvents;
+    /** Smallest number of cancelled events removed from the event list. */
+    uint32_t m_compactionThreshold;
+    /** The event profiler, if the EventProfilerFile GlobalValue is set. */
+    std::unique_ptr<EventProfiler> m_profiler;
 
-    /**
-     * Container for Lbts messages, one per rank.
-     * Allocated once we know how many systems there are.
-     */
-    LbtsMessage* m_pLBTS;
+    /** Overlap the LBTS reduction with the events of the window. */
+    bool m_overlapLbts;
+    /** MPI datatype of an LbtsMessage, valid during Run(). */
+    MPI_Datatype m_lbtsType;
+    /** MPI reduction of LbtsMessage::Combine, valid during Run(). */
+    MPI_Op m_lbtsOp;
+    /** Number of LBTS reductions. */
+    uint64_t m_lbtsCount;
+    /** Grant windows with the lookahead of every pair of ranks. */
+    bool m_perPeerLookAhead;
+    /** Lookahead with every rank, empty unless the per-peer lookahead is used. */
+    std::vector<Time> m_peerLookAhead;
+    /** Smallest lookahead with any rank, this one included. */
+    Time m_minPeerLookAhead;
+    /** LBTS messages sent to every rank, kept during a reduction. */
+    std::vector<LbtsMessage> m_lbtsBlocks;
+    /** Total extension of the granted windows by the per-peer lookahead. */
+    Time m_lookAheadGain;
     uint32_t m_myId;         /**< MPI rank. */
     uint32_t m_systemCount;  /**< MPI communicator size. */
     Time m_grantedTime;      /**< End of current window. */
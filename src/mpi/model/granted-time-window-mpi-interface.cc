@@ -28,7 +28,9 @@
 
 #include "mpi-interface.h"
 #include "mpi-receiver.h"
+#include "sync-profiler.h"
 
+#include "ns3/global-value.h"
 #include "ns3/log.h"
 #include "ns3/net-device.h"
 #include "ns3/node-list.h"
@@ -36,11 +38,14 @@
 #include "ns3/nstime.h"
 #include "ns3/simulator-impl.h"
 #include "ns3/simulator.h"
+#include "ns3/uinteger.h"
 
+#include <cstring>
 #include <iomanip>
 #include <iostream>
 #include <list>
 #include <mpi.h>
+#include <new>
 
 namespace ns3
 {
@@ -49,27 +54,88 @@ NS_LOG_COMPONENT_DEFINE("GrantedTimeWindowMpiInterface");
 
 NS_OBJECT_ENSURE_REGISTERED(GrantedTimeWindowMpiInterface);
 
+/**
+ * Size of the record header in front of each packet in a batch:
+ * receive time, destination node, destination device and packet size.
+ */
+const uint32_t PACKET_RECORD_HEADER_SIZE = sizeof(uint64_t) + 3 * sizeof(uint32_t);
+
+/**
+ * Size of the batch header: the epoch the packets were sent in.
+ */
+const uint32_t BATCH_HEADER_SIZE = sizeof(uint32_t);
+
+/**
+ * Size of the ring header in front of each record in a shared memory
+ * ring: the epoch the packet was sent in and the size of the record.
+ */
+const uint32_t RING_HEADER_SIZE = 2 * sizeof(uint32_t);
+
+/**
+ * Alignment of the records in a shared memory ring, so that the space
+ * left before the end of the ring always fits a ring header.
+ */
+const uint32_t RING_ALIGNMENT = 8;
+
+/**
+ * Epoch of the marker telling the reader to go back to the start of the
+ * ring.
+ */
+const uint32_t RING_WRAP = 0xffffffff;
+
+/**
+ * \ingroup mpi
+ * \anchor GlobalValueMpiSharedMemoryRingSize
+ * The capacity of the shared memory ring of each pair of ranks on the
+ * same host, 0 to send all the packets with MPI messages.
+ *
+ * This is accessible as "--MpiSharedMemoryRingSize" from CommandLine.
+ */
+static GlobalValue g_ringSizeValue("MpiSharedMemoryRingSize",
+                                   "The capacity in bytes of the shared memory ring of each "
+                                   "pair of ranks on the same host, 0 to disable the rings",
+                                   UintegerValue(256 * 1024),
+                                   MakeUintegerChecker<uint32_t>());
+
 SentBuffer::SentBuffer()
 {
-    m_buffer = nullptr;
     m_request = nullptr;
 }
 
 SentBuffer::~SentBuffer()
 {
-    delete[] m_buffer;
 }
 
 uint8_t*
 SentBuffer::GetBuffer()
 {
-    return m_buffer;
+    return m_buffer.data();
+}
+
+uint32_t
+SentBuffer::GetSize() const
+{
+    return m_buffer.size();
+}
+
+uint8_t*
+SentBuffer::Append(uint32_t size)
+{
+    std::size_t offset = m_buffer.size();
+    m_buffer.resize(offset + size);
+    return m_buffer.data() + offset;
+}
+
+void
+SentBuffer::Clear()
+{
+    m_buffer.clear();
 }
 
 void
-SentBuffer::SetBuffer(uint8_t* buffer)
+SentBuffer::Swap(SentBuffer& other)
 {
-    m_buffer = buffer;
+    m_buffer.swap(other.m_buffer);
 }
 
 MPI_Request*
@@ -84,12 +150,20 @@ bool GrantedTimeWindowMpiInterface::g_enabled = false;
 bool GrantedTimeWindowMpiInterface::g_mpiInitCalled = false;
 uint32_t GrantedTimeWindowMpiInterface::g_rxCount = 0;
 uint32_t GrantedTimeWindowMpiInterface::g_txCount = 0;
+uint32_t GrantedTimeWindowMpiInterface::g_rxAhead = 0;
+uint32_t GrantedTimeWindowMpiInterface::g_epoch = 0;
+std::vector<SentBuffer> GrantedTimeWindowMpiInterface::g_txBatches;
+MpiReceiveQueue GrantedTimeWindowMpiInterface::g_receiveQueue;
+std::vector<uint8_t> GrantedTimeWindowMpiInterface::g_rxBuffer;
 std::list<SentBuffer> GrantedTimeWindowMpiInterface::g_pendingTx;
+std::list<SentBuffer> GrantedTimeWindowMpiInterface::g_freeTx;
 
-MPI_Request* GrantedTimeWindowMpiInterface::g_requests;
-char** GrantedTimeWindowMpiInterface::g_pRxBuffers;
 MPI_Comm GrantedTimeWindowMpiInterface::g_communicator = MPI_COMM_WORLD;
 bool GrantedTimeWindowMpiInterface::g_freeCommunicator = false;
+uint32_t GrantedTimeWindowMpiInterface::g_ringSize = 0;
+MPI_Win GrantedTimeWindowMpiInterface::g_window = MPI_WIN_NULL;
+std::vector<GrantedTimeWindowMpiInterface::SharedRing> GrantedTimeWindowMpiInterface::g_txRings;
+std::vector<GrantedTimeWindowMpiInterface::SharedRing> GrantedTimeWindowMpiInterface::g_rxRings;
 ;
 
 TypeId
@@ -105,14 +179,10 @@ GrantedTimeWindowMpiInterface::Destroy()
 {
     NS_LOG_FUNCTION(this);
 
-    for (uint32_t i = 0; i < GetSize(); ++i)
-    {
-        delete[] g_pRxBuffers[i];
-    }
-    delete[] g_pRxBuffers;
-    delete[] g_requests;
-
+    g_txBatches.clear();
+    g_rxBuffer.clear();
     g_pendingTx.clear();
+    g_freeTx.clear();
 }
 
 uint32_t
@@ -193,20 +263,106 @@ GrantedTimeWindowMpiInterface::Enable(MPI_Comm communicator)
     g_size = mpiSize;
 
     g_enabled = true;
-    // Post a non-blocking receive for all peers
-    g_pRxBuffers = new char*[g_size];
-    g_requests = new MPI_Request[g_size];
-    for (uint32_t i = 0; i < GetSize(); ++i)
+    g_epoch = 0;
+    g_rxAhead = 0;
+    // One batch per peer; messages are picked up with MPI_Iprobe, since
+    // their size depends on how many packets the window carried.
+    g_txBatches.resize(g_size);
+    EnableSharedMemory();
+}
+
+void
+GrantedTimeWindowMpiInterface::EnableSharedMemory()
+{
+    NS_LOG_FUNCTION_NOARGS();
+
+    g_txRings.assign(g_size, SharedRing{nullptr, nullptr, 0});
+    g_rxRings.assign(g_size, SharedRing{nullptr, nullptr, 0});
+    UintegerValue ringSize;
+    g_ringSizeValue.GetValue(ringSize);
+    g_ringSize = ringSize.Get() / RING_ALIGNMENT * RING_ALIGNMENT;
+    if (g_ringSize == 0 || g_size == 1)
     {
-        g_pRxBuffers[i] = new char[MAX_MPI_MSG_SIZE];
-        MPI_Irecv(g_pRxBuffers[i],
-                  MAX_MPI_MSG_SIZE,
-                  MPI_CHAR,
-                  MPI_ANY_SOURCE,
-                  0,
-                  g_communicator,
-                  &g_requests[i]);
+        g_ringSize = 0;
+        return;
+    }
+
+    MPI_Comm local;
+    MPI_Comm_split_type(g_communicator, MPI_COMM_TYPE_SHARED, g_sid, MPI_INFO_NULL, &local);
+    int localRank;
+    int localSize;
+    MPI_Comm_rank(local, &localRank);
+    MPI_Comm_size(local, &localSize);
+    if (localSize == 1)
+    {
+        MPI_Comm_free(&local);
+        g_ringSize = 0;
+        return;
+    }
+
+    // Every rank allocates the rings it reads from, one per rank of the
+    // host, next to itself: the segments need not be contiguous.
+    std::size_t ringBytes = sizeof(RingHeader) + g_ringSize;
+    MPI_Info info;
+    MPI_Info_create(&info);
+    MPI_Info_set(info, "alloc_shared_noncontig", "true");
+    uint8_t* base;
+    MPI_Win_allocate_shared(localSize * ringBytes, 1, info, local, &base, &g_window);
+    MPI_Info_free(&info);
+    for (int i = 0; i < localSize; ++i)
+    {
+        new (base + i * ringBytes) RingHeader{{0}, {0}};
+    }
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, g_window);
+    MPI_Barrier(local);
+
+    // Find the rank of each process of the host in the communicator
+    std::vector<int> localRanks(localSize);
+    std::vector<int> ranks(localSize);
+    for (int i = 0; i < localSize; ++i)
+    {
+        localRanks[i] = i;
+    }
+    MPI_Group localGroup;
+    MPI_Group group;
+    MPI_Comm_group(local, &localGroup);
+    MPI_Comm_group(g_communicator, &group);
+    MPI_Group_translate_ranks(localGroup, localSize, localRanks.data(), group, ranks.data());
+    MPI_Group_free(&localGroup);
+    MPI_Group_free(&group);
+
+    for (int i = 0; i < localSize; ++i)
+    {
+        if (i == localRank)
+        {
+            continue;
+        }
+        MPI_Aint size;
+        int unit;
+        uint8_t* peer;
+        MPI_Win_shared_query(g_window, i, &size, &unit, &peer);
+        uint8_t* tx = peer + localRank * ringBytes;
+        uint8_t* rx = base + i * ringBytes;
+        g_txRings[ranks[i]] = {reinterpret_cast<RingHeader*>(tx), tx + sizeof(RingHeader), 0};
+        g_rxRings[ranks[i]] = {reinterpret_cast<RingHeader*>(rx), rx + sizeof(RingHeader), 0};
+    }
+    MPI_Comm_free(&local);
+    NS_LOG_INFO("rank " << g_sid << ": " << localSize - 1 << " peers on the same host");
+}
+
+void
+GrantedTimeWindowMpiInterface::DisableSharedMemory()
+{
+    NS_LOG_FUNCTION_NOARGS();
+
+    if (g_window != MPI_WIN_NULL)
+    {
+        MPI_Win_unlock_all(g_window);
+        MPI_Win_free(&g_window);
     }
+    g_txRings.clear();
+    g_rxRings.clear();
+    g_ringSize = 0;
 }
 
 void
@@ -217,35 +373,250 @@ GrantedTimeWindowMpiInterface::SendPacket(Ptr<Packet> p,
 {
     NS_LOG_FUNCTION(this << p << rxTime.GetTimeStep() << node << dev);
 
-    SentBuffer sendBuf;
-    g_pendingTx.push_back(sendBuf);
-    std::list<SentBuffer>::reverse_iterator i = g_pendingTx.rbegin(); // Points to the last element
+    // Find the system id for the destination node
+    Ptr<Node> destNode = NodeList::GetNode(node);
+    BatchPacket(destNode->GetSystemId(), p, rxTime, node, dev);
+}
+
+void
+GrantedTimeWindowMpiInterface::BatchPacket(uint32_t rank,
+                                           Ptr<Packet> p,
+                                           const Time& rxTime,
+                                           uint32_t node,
+                                           uint32_t dev)
+{
+    // Serialize straight into the ring or the batch of the destination
+    // rank; both are published by FlushSendBuffers before the next LBTS
+    // computation, which is the earliest time the receiver would look for
+    // them anyway.
+    g_txCount++;
+    if (SyncProfiler::IsEnabled())
+    {
+        SyncProfiler::RecordSend(rank, p->GetSerializedSize());
+    }
+    if (g_txRings[rank].header && WriteRing(g_txRings[rank], p, rxTime, node, dev))
+    {
+        return;
+    }
+    SentBuffer& batch = g_txBatches[rank];
+    if (batch.GetSize() == 0)
+    {
+        std::memcpy(batch.Append(BATCH_HEADER_SIZE), &g_epoch, sizeof(g_epoch));
+    }
+    WritePacket(batch, p, rxTime, node, dev);
+}
+
+bool
+GrantedTimeWindowMpiInterface::WriteRing(SharedRing& ring,
+                                         Ptr<Packet> p,
+                                         const Time& rxTime,
+                                         uint32_t node,
+                                         uint32_t dev)
+{
+    // A record does not wrap around: if it does not fit before the end
+    // of the ring, a marker sends the reader back to the start.
+    uint32_t serializedSize = p->GetSerializedSize();
+    uint64_t size = RING_HEADER_SIZE + PACKET_RECORD_HEADER_SIZE + serializedSize;
+    size = (size + RING_ALIGNMENT - 1) / RING_ALIGNMENT * RING_ALIGNMENT;
+    uint64_t offset = ring.cursor % g_ringSize;
+    uint64_t skip = offset + size > g_ringSize ? g_ringSize - offset : 0;
+    uint64_t head = ring.header->head.load(std::memory_order_acquire);
+    if (ring.cursor + skip + size - head > g_ringSize)
+    {
+        return false;
+    }
+    if (skip)
+    {
+        std::memcpy(ring.data + offset, &RING_WRAP, sizeof(RING_WRAP));
+        ring.cursor += skip;
+        offset = 0;
+    }
+
+    uint8_t* data = ring.data + offset;
+    uint32_t recordSize = size;
+    std::memcpy(data, &g_epoch, sizeof(g_epoch));
+    std::memcpy(data + sizeof(g_epoch), &recordSize, sizeof(recordSize));
+    WritePacket(data + RING_HEADER_SIZE, p, serializedSize, rxTime, node, dev);
+    ring.cursor += size;
+    return true;
+}
 
+void
+GrantedTimeWindowMpiInterface::ReadRing(SharedRing& ring, uint32_t rank)
+{
+    uint64_t head = ring.header->head.load(std::memory_order_relaxed);
+    uint64_t tail = ring.header->tail.load(std::memory_order_acquire);
+    while (head < tail)
+    {
+        uint64_t offset = head % g_ringSize;
+        const uint8_t* pData = ring.data + offset;
+        uint32_t epoch;
+        uint32_t size;
+        std::memcpy(&epoch, pData, sizeof(epoch));
+        if (epoch == RING_WRAP)
+        {
+            head += g_ringSize - offset;
+            continue;
+        }
+        std::memcpy(&size, pData + sizeof(epoch), sizeof(size));
+        // Same epoch accounting as the batches, see FlushSendBuffers
+        NS_ASSERT(epoch <= g_epoch);
+        uint32_t& rxCount = epoch < g_epoch ? g_rxCount : g_rxAhead;
+        const uint8_t* pEnd = pData + size;
+        pData += RING_HEADER_SIZE;
+
+        Time rxTime;
+        uint32_t node;
+        uint32_t dev;
+        const uint8_t* pRecord = pData;
+        Ptr<Packet> p = ReadPacket(pData, pEnd, rxTime, node, dev);
+        rxCount++;
+        head += size;
+        SyncProfiler::RecordReceive(rank, pData - pRecord - PACKET_RECORD_HEADER_SIZE);
+
+        Ptr<Node> pNode = NodeList::GetNode(node);
+        Ptr<MpiReceiver> pMpiRec = GetReceiver(pNode, dev);
+        NS_ASSERT(pNode && pMpiRec);
+        g_receiveQueue.Add(pNode->GetId(), pMpiRec, dev, rxTime, p);
+    }
+    // The packets are copied out, the sender can reuse the space
+    ring.header->head.store(head, std::memory_order_release);
+}
+
+void
+GrantedTimeWindowMpiInterface::WritePacket(SentBuffer& buffer,
+                                           Ptr<Packet> p,
+                                           const Time& rxTime,
+                                           uint32_t node,
+                                           uint32_t dev)
+{
     uint32_t serializedSize = p->GetSerializedSize();
-    uint8_t* buffer = new uint8_t[serializedSize + 16];
-    i->SetBuffer(buffer);
-    // Add the time, dest node and dest device
+    WritePacket(buffer.Append(PACKET_RECORD_HEADER_SIZE + serializedSize),
+                p,
+                serializedSize,
+                rxTime,
+                node,
+                dev);
+}
+
+void
+GrantedTimeWindowMpiInterface::WritePacket(uint8_t* data,
+                                           Ptr<Packet> p,
+                                           uint32_t serializedSize,
+                                           const Time& rxTime,
+                                           uint32_t node,
+                                           uint32_t dev)
+{
+    // Add the time, dest node, dest device and size
     uint64_t t = rxTime.GetInteger();
-    uint64_t* pTime = reinterpret_cast<uint64_t*>(buffer);
-    *pTime++ = t;
-    uint32_t* pData = reinterpret_cast<uint32_t*>(pTime);
-    *pData++ = node;
-    *pData++ = dev;
+    std::memcpy(data, &t, sizeof(t));
+    data += sizeof(t);
+    std::memcpy(data, &node, sizeof(node));
+    data += sizeof(node);
+    std::memcpy(data, &dev, sizeof(dev));
+    data += sizeof(dev);
+    std::memcpy(data, &serializedSize, sizeof(serializedSize));
+    data += sizeof(serializedSize);
     // Serialize the packet
-    p->Serialize(reinterpret_cast<uint8_t*>(pData), serializedSize);
+    p->Serialize(data, serializedSize);
+}
 
-    // Find the system id for the destination node
-    Ptr<Node> destNode = NodeList::GetNode(node);
-    uint32_t nodeSysId = destNode->GetSystemId();
-
-    MPI_Isend(reinterpret_cast<void*>(i->GetBuffer()),
-              serializedSize + 16,
-              MPI_CHAR,
-              nodeSysId,
-              0,
-              g_communicator,
-              (i->GetRequest()));
-    g_txCount++;
+Ptr<Packet>
+GrantedTimeWindowMpiInterface::ReadPacket(const uint8_t*& data,
+                                          const uint8_t* end,
+                                          Time& rxTime,
+                                          uint32_t& node,
+                                          uint32_t& dev)
+{
+    // Get the meta data first
+    uint64_t time;
+    uint32_t size;
+    std::memcpy(&time, data, sizeof(time));
+    data += sizeof(time);
+    std::memcpy(&node, data, sizeof(node));
+    data += sizeof(node);
+    std::memcpy(&dev, data, sizeof(dev));
+    data += sizeof(dev);
+    std::memcpy(&size, data, sizeof(size));
+    data += sizeof(size);
+    NS_ASSERT(data + size <= end);
+
+    rxTime = Time(time);
+    Ptr<Packet> p = Create<Packet>(data, size, true);
+    data += size;
+    return p;
+}
+
+Ptr<MpiReceiver>
+GrantedTimeWindowMpiInterface::GetReceiver(Ptr<Node> node, uint32_t dev)
+{
+    // The interface index of a device is its index on the node
+    Ptr<MpiReceiver> pMpiRec = nullptr;
+    uint32_t ifIndex = dev & ~MpiReceiver::PRIORITY;
+    if (dev == MpiReceiver::NODE_RECEIVER)
+    {
+        pMpiRec = node->GetObject<MpiReceiver>();
+    }
+    else if (ifIndex < node->GetNDevices())
+    {
+        Ptr<NetDevice> pThisDev = node->GetDevice(ifIndex);
+        NS_ASSERT(pThisDev->GetIfIndex() == ifIndex);
+        pMpiRec = pThisDev->GetObject<MpiReceiver>();
+    }
+    return pMpiRec;
+}
+
+void
+GrantedTimeWindowMpiInterface::FlushSendBuffers()
+{
+    NS_LOG_FUNCTION_NOARGS();
+
+    for (uint32_t rank = 0; rank < g_txBatches.size(); ++rank)
+    {
+        SentBuffer& batch = g_txBatches[rank];
+        if (batch.GetSize() == 0)
+        {
+            continue;
+        }
+
+        // Hand the batch over to a recycled buffer, which owns it until
+        // the send completes, and keep the recycled capacity for the next
+        // window of this peer.
+        if (g_freeTx.empty())
+        {
+            g_pendingTx.emplace_back();
+        }
+        else
+        {
+            g_pendingTx.splice(g_pendingTx.end(), g_freeTx, g_freeTx.begin());
+        }
+        SentBuffer& sent = g_pendingTx.back();
+        sent.Swap(batch);
+        batch.Clear();
+
+        MPI_Isend(reinterpret_cast<void*>(sent.GetBuffer()),
+                  sent.GetSize(),
+                  MPI_CHAR,
+                  rank,
+                  0,
+                  g_communicator,
+                  sent.GetRequest());
+    }
+
+    // Publish the records written into the rings of the same host
+    for (SharedRing& ring : g_txRings)
+    {
+        if (ring.header)
+        {
+            ring.header->tail.store(ring.cursor, std::memory_order_release);
+        }
+    }
+
+    // The packets of the epoch just closed are all sent, those that
+    // arrived early from faster ranks now count as received.
+    g_epoch++;
+    g_rxCount += g_rxAhead;
+    g_rxAhead = 0;
 }
 
 void
@@ -253,67 +624,71 @@ GrantedTimeWindowMpiInterface::ReceiveMessages()
 {
     NS_LOG_FUNCTION_NOARGS();
 
-    // Poll the non-block reads to see if data arrived
+    // Read the rings of the same host in place
+    for (uint32_t rank = 0; rank < g_rxRings.size(); ++rank)
+    {
+        if (g_rxRings[rank].header)
+        {
+            ReadRing(g_rxRings[rank], rank);
+        }
+    }
+
+    // Poll for batches that arrived
     while (true)
     {
         int flag = 0;
-        int index = 0;
         MPI_Status status;
 
-        MPI_Testany(MpiInterface::GetSize(), g_requests, &index, &flag, &status);
+        MPI_Iprobe(MPI_ANY_SOURCE, 0, g_communicator, &flag, &status);
         if (!flag)
         {
             break; // No more messages
         }
         int count;
         MPI_Get_count(&status, MPI_CHAR, &count);
-        g_rxCount++; // Count this receive
-
-        // Get the meta data first
-        uint64_t* pTime = reinterpret_cast<uint64_t*>(g_pRxBuffers[index]);
-        uint64_t time = *pTime++;
-        uint32_t* pData = reinterpret_cast<uint32_t*>(pTime);
-        uint32_t node = *pData++;
-        uint32_t dev = *pData++;
-
-        Time rxTime(time);
-
-        count -= sizeof(time) + sizeof(node) + sizeof(dev);
-
-        Ptr<Packet> p = Create<Packet>(reinterpret_cast<uint8_t*>(pData), count, true);
-
-        // Find the correct node/device to schedule receive event
-        Ptr<Node> pNode = NodeList::GetNode(node);
-        Ptr<MpiReceiver> pMpiRec = nullptr;
-        uint32_t nDevices = pNode->GetNDevices();
-        for (uint32_t i = 0; i < nDevices; ++i)
+        if (g_rxBuffer.size() < static_cast<std::size_t>(count))
         {
-            Ptr<NetDevice> pThisDev = pNode->GetDevice(i);
-            if (pThisDev->GetIfIndex() == dev)
-            {
-                pMpiRec = pThisDev->GetObject<MpiReceiver>();
-                break;
-            }
+            g_rxBuffer.resize(count);
         }
+        MPI_Recv(g_rxBuffer.data(),
+                 count,
+                 MPI_CHAR,
+                 status.MPI_SOURCE,
+                 0,
+                 g_communicator,
+                 MPI_STATUS_IGNORE);
+
+        const uint8_t* pData = g_rxBuffer.data();
+        const uint8_t* pEnd = pData + count;
+        uint32_t epoch;
+        std::memcpy(&epoch, pData, sizeof(epoch));
+        pData += sizeof(epoch);
+        // A peer can be at most one epoch ahead, see FlushSendBuffers
+        NS_ASSERT(epoch <= g_epoch);
+        uint32_t& rxCount = epoch < g_epoch ? g_rxCount : g_rxAhead;
+        while (pData < pEnd)
+        {
+            Time rxTime;
+            uint32_t node;
+            uint32_t dev;
+            const uint8_t* pRecord = pData;
+            Ptr<Packet> p = ReadPacket(pData, pEnd, rxTime, node, dev);
 
-        NS_ASSERT(pNode && pMpiRec);
+            rxCount++; // Count this receive
+            SyncProfiler::RecordReceive(status.MPI_SOURCE,
+                                        pData - pRecord - PACKET_RECORD_HEADER_SIZE);
 
-        // Schedule the rx event
-        Simulator::ScheduleWithContext(pNode->GetId(),
-                                       rxTime - Simulator::Now(),
-                                       &MpiReceiver::Receive,
-                                       pMpiRec,
-                                       p);
+            // Find the correct node/device to schedule receive event
+            Ptr<Node> pNode = NodeList::GetNode(node);
+            Ptr<MpiReceiver> pMpiRec = GetReceiver(pNode, dev);
 
-        // Re-queue the next read
-        MPI_Irecv(g_pRxBuffers[index],
-                  MAX_MPI_MSG_SIZE,
-                  MPI_CHAR,
-                  MPI_ANY_SOURCE,
-                  0,
-                  g_communicator,
-                  &g_requests[index]);
+            NS_ASSERT(pNode && pMpiRec);
+
+            // Schedule the rx event
+            g_receiveQueue.Add(pNode->GetId(), pMpiRec, dev, rxTime, p);
+        }
     }
+    g_receiveQueue.Flush();
 }
 
 void
@@ -327,11 +702,12 @@ GrantedTimeWindowMpiInterface::TestSendComplete()
         MPI_Status status;
         int flag = 0;
         MPI_Test(i->GetRequest(), &flag, &status);
-        std::list<SentBuffer>::iterator current = i; // Save current for erasing
+        std::list<SentBuffer>::iterator current = i; // Save current for recycling
         i++;                                         // Advance to next
         if (flag)
         { // This message is complete
-            g_pendingTx.erase(current);
+            current->Clear();
+            g_freeTx.splice(g_freeTx.end(), g_pendingTx, current);
         }
     }
 }
@@ -341,6 +717,7 @@ GrantedTimeWindowMpiInterface::Disable()
 {
     NS_LOG_FUNCTION_NOARGS();
 
+    DisableSharedMemory();
     if (g_freeCommunicator)
     {
         MPI_Comm_free(&g_communicator);
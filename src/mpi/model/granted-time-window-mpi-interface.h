@@ -32,9 +32,11 @@
 #include "ns3/buffer.h"
 #include "ns3/nstime.h"
 
+#include <atomic>
 #include <list>
 #include <mpi.h>
 #include <stdint.h>
+#include <vector>
 
 namespace ns3
 {
@@ -51,7 +53,10 @@ const uint32_t MAX_MPI_MSG_SIZE = 2000;
  * \brief Tracks non-blocking sends
  *
  * This class is used to keep track of the asynchronous non-blocking
- * sends that have been posted.
+ * sends that have been posted.  The buffer is a growable arena holding
+ * every packet sent to one peer during a granted time window; the
+ * arenas are recycled once their send completes, so the steady state
+ * does not allocate.
  */
 class SentBuffer
 {
@@ -64,21 +69,42 @@ class SentBuffer
      */
     uint8_t* GetBuffer();
     /**
-     * \param buffer pointer to sent buffer
+     * \return number of bytes used in the buffer
      */
-    void SetBuffer(uint8_t* buffer);
+    uint32_t GetSize() const;
+    /**
+     * Grow the used part of the buffer.
+     *
+     * \param size number of bytes to add
+     * \return pointer to the first added byte, valid until the next Append
+     */
+    uint8_t* Append(uint32_t size);
+    /**
+     * Empty the buffer, keeping its capacity for the next batch.
+     */
+    void Clear();
+    /**
+     * Exchange the contents of two buffers without copying.
+     *
+     * \param other the buffer to swap with
+     */
+    void Swap(SentBuffer& other);
     /**
      * \return MPI request
      */
     MPI_Request* GetRequest();
 
   private:
-    uint8_t* m_buffer;     /**< The buffer. */
-    MPI_Request m_request; /**< The MPI request handle. */
+    std::vector<uint8_t> m_buffer; /**< The buffer. */
+    MPI_Request m_request;         /**< The MPI request handle. */
 };
 
 class Packet;
+class MpiReceiver;
+class MpiReceiveQueue;
+class Node;
 class DistributedSimulatorImpl;
+class HybridSimulatorImpl;
 
 /**
  * \ingroup mpi
@@ -88,6 +114,13 @@ class DistributedSimulatorImpl;
  * Implements the interface used by the singleton parallel controller
  * to interface between NS3 and the communications layer being
  * used for inter-task packet transfers.
+ *
+ * The ranks on the same host, found with MPI_Comm_split_type, exchange
+ * their packets through a ring per pair of ranks in an MPI shared memory
+ * window instead: the sender serializes each packet straight into the
+ * ring of the receiver, which reads it in place.  A packet that does not
+ * fit in the ring goes in the MPI batch.  The size of the rings is set
+ * by the MpiSharedMemoryRingSize global value, 0 disables them.
  */
 class GrantedTimeWindowMpiInterface : public ParallelCommunicationInterface, Object
 {
@@ -109,6 +142,75 @@ class GrantedTimeWindowMpiInterface : public ParallelCommunicationInterface, Obj
     void SendPacket(Ptr<Packet> p, const Time& rxTime, uint32_t node, uint32_t dev) override;
     MPI_Comm GetCommunicator() override;
 
+  protected:
+    /**
+     * Add a packet to the batch of a rank, sent by the next
+     * FlushSendBuffers().
+     *
+     * \param rank the rank of the destination node
+     * \param p the packet
+     * \param rxTime the time the packet is received
+     * \param node the destination node
+     * \param dev the destination device
+     */
+    static void BatchPacket(uint32_t rank,
+                            Ptr<Packet> p,
+                            const Time& rxTime,
+                            uint32_t node,
+                            uint32_t dev);
+    /**
+     * Serialize a packet and its destination.
+     *
+     * \param data where to write the record header and the packet
+     * \param p the packet
+     * \param serializedSize the serialized size of the packet
+     * \param rxTime the time the packet is received
+     * \param node the destination node
+     * \param dev the destination device
+     */
+    static void WritePacket(uint8_t* data,
+                            Ptr<Packet> p,
+                            uint32_t serializedSize,
+                            const Time& rxTime,
+                            uint32_t node,
+                            uint32_t dev);
+    /**
+     * Serialize a packet and its destination at the end of a buffer.
+     *
+     * \param buffer the buffer
+     * \param p the packet
+     * \param rxTime the time the packet is received
+     * \param node the destination node
+     * \param dev the destination device
+     */
+    static void WritePacket(SentBuffer& buffer,
+                            Ptr<Packet> p,
+                            const Time& rxTime,
+                            uint32_t node,
+                            uint32_t dev);
+    /**
+     * Deserialize a packet written by WritePacket().
+     *
+     * \param [in,out] data the start of the record, then the next one
+     * \param end the end of the buffer
+     * \param [out] rxTime the time the packet is received
+     * \param [out] node the destination node
+     * \param [out] dev the destination device
+     * \return the packet
+     */
+    static Ptr<Packet> ReadPacket(const uint8_t*& data,
+                                  const uint8_t* end,
+                                  Time& rxTime,
+                                  uint32_t& node,
+                                  uint32_t& dev);
+    /**
+     * \param node the destination node
+     * \param dev the destination device, with its flags, or
+     *        MpiReceiver::NODE_RECEIVER
+     * \return the receiver of the packets sent to the device
+     */
+    static Ptr<MpiReceiver> GetReceiver(Ptr<Node> node, uint32_t dev);
+
   private:
     /*
      * The granted time window implementation is a collaboration of several
@@ -117,7 +219,71 @@ class GrantedTimeWindowMpiInterface : public ParallelCommunicationInterface, Obj
      * It is not intended for state to be shared.
      */
     friend ns3::DistributedSimulatorImpl;
+    friend ns3::HybridSimulatorImpl;
+
+    /** The positions of a ring, in the shared memory window. */
+    struct RingHeader
+    {
+        /** Bytes read so far, written by the receiver. */
+        alignas(64) std::atomic<uint64_t> head;
+        /** Bytes published so far, written by the sender. */
+        alignas(64) std::atomic<uint64_t> tail;
+    };
+
+    /** The ring of a pair of ranks on the same host. */
+    struct SharedRing
+    {
+        /** The positions, nullptr if the peer is on another host. */
+        RingHeader* header;
+        /** The records. */
+        uint8_t* data;
+        /** Bytes written so far by the sender, published at the next flush. */
+        uint64_t cursor;
+    };
 
+    /**
+     * Map the rings of the ranks on this host, if any.  Collective.
+     */
+    static void EnableSharedMemory();
+    /**
+     * Unmap the rings.  Collective.
+     */
+    static void DisableSharedMemory();
+    /**
+     * Serialize a packet into the ring of a peer on this host.
+     *
+     * \param ring the ring
+     * \param p the packet
+     * \param rxTime the time the packet is received
+     * \param node the destination node
+     * \param dev the destination device
+     * \return false if the ring is full
+     */
+    static bool WriteRing(SharedRing& ring,
+                          Ptr<Packet> p,
+                          const Time& rxTime,
+                          uint32_t node,
+                          uint32_t dev);
+    /**
+     * Schedule the packets published in the ring of a peer on this host.
+     *
+     * \param ring the ring
+     * \param rank the rank of the peer
+     */
+    static void ReadRing(SharedRing& ring, uint32_t rank);
+
+    /**
+     * Send the packets batched for each peer since the last call,
+     * one message per peer, and close the current epoch.
+     *
+     * Every batch carries the epoch it was sent in, and the ranks close
+     * their epochs at the same synchronization points.  A packet is
+     * counted as received once the receiver has closed the epoch it was
+     * sent in as well, so the received count of a rank matches the
+     * transmitted counts of the epochs it has closed, even if a faster
+     * rank already sent the packets of the next epoch.
+     */
+    static void FlushSendBuffers();
     /**
      * Check for received messages complete
      */
@@ -127,7 +293,7 @@ class GrantedTimeWindowMpiInterface : public ParallelCommunicationInterface, Obj
      */
     static void TestSendComplete();
     /**
-     * \return received count in packets
+     * \return received count in packets, of the closed epochs
      */
     static uint32_t GetRxCount();
     /**
@@ -146,6 +312,12 @@ class GrantedTimeWindowMpiInterface : public ParallelCommunicationInterface, Obj
     /** Total packets sent. */
     static uint32_t g_txCount;
 
+    /** Packets received from the current epoch of faster ranks. */
+    static uint32_t g_rxAhead;
+
+    /** Number of epochs closed by FlushSendBuffers. */
+    static uint32_t g_epoch;
+
     /** Has this interface been enabled. */
     static bool g_enabled;
 
@@ -155,20 +327,38 @@ class GrantedTimeWindowMpiInterface : public ParallelCommunicationInterface, Obj
      */
     static bool g_mpiInitCalled;
 
-    /** Pending non-blocking receives. */
-    static MPI_Request* g_requests;
+    /** Packets batched for each peer in the current window. */
+    static std::vector<SentBuffer> g_txBatches;
 
-    /** Data buffers for non-blocking reads. */
-    static char** g_pRxBuffers;
+    /** Schedules the packets read by ReceiveMessages(). */
+    static MpiReceiveQueue g_receiveQueue;
+
+    /** Buffer the received batches are unpacked from. */
+    static std::vector<uint8_t> g_rxBuffer;
 
     /** List of pending non-blocking sends. */
     static std::list<SentBuffer> g_pendingTx;
 
+    /** Completed send buffers kept for reuse. */
+    static std::list<SentBuffer> g_freeTx;
+
     /** MPI communicator being used for ns-3 tasks. */
     static MPI_Comm g_communicator;
 
     /** Did ns-3 create the communicator?  Have to free it. */
     static bool g_freeCommunicator;
+
+    /** Capacity of each shared memory ring in bytes, 0 if disabled. */
+    static uint32_t g_ringSize;
+
+    /** The shared memory window of the rings, or MPI_WIN_NULL. */
+    static MPI_Win g_window;
+
+    /** The rings this rank writes to, for each rank. */
+    static std::vector<SharedRing> g_txRings;
+
+    /** The rings this rank reads from, for each rank. */
+    static std::vector<SharedRing> g_rxRings;
 };
 
 } // namespace ns3
@@ -0,0 +1,156 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file
+ * \ingroup mpi
+ * Implementation of class ns3::HybridMpiInterface.
+ */
+
+#include "hybrid-mpi-interface.h"
+
+#include "hybrid-simulator-impl.h"
+#include "mpi-receiver.h"
+
+#include "ns3/log.h"
+#include "ns3/node-list.h"
+#include "ns3/node.h"
+#include "ns3/simulator.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("HybridMpiInterface");
+
+NS_OBJECT_ENSURE_REGISTERED(HybridMpiInterface);
+
+uint32_t HybridMpiInterface::g_threads = 0;
+uint32_t HybridMpiInterface::g_current = 0;
+std::vector<HybridMpiInterface::Lane> HybridMpiInterface::g_lanes;
+std::vector<uint32_t> HybridMpiInterface::g_ranks;
+std::vector<Ptr<Node>> HybridMpiInterface::g_nodes;
+std::mutex HybridMpiInterface::g_batchMutex;
+
+TypeId
+HybridMpiInterface::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::HybridMpiInterface")
+                            .SetParent<GrantedTimeWindowMpiInterface>()
+                            .SetGroupName("Mpi");
+    return tid;
+}
+
+void
+HybridMpiInterface::Destroy()
+{
+    NS_LOG_FUNCTION(this);
+
+    g_threads = 0;
+    g_lanes.clear();
+    g_ranks.clear();
+    g_nodes.clear();
+    GrantedTimeWindowMpiInterface::Destroy();
+}
+
+void
+HybridMpiInterface::EnableThreads(uint32_t threads)
+{
+    NS_LOG_FUNCTION(threads);
+
+    g_threads = threads;
+    g_current = 0;
+    g_lanes.resize(2 * threads * threads);
+    for (Lane& lane : g_lanes)
+    {
+        lane.buffer.Clear();
+        lane.next = Time::Max();
+    }
+    g_ranks.resize(NodeList::GetNNodes());
+    g_nodes.resize(NodeList::GetNNodes());
+    for (uint32_t i = 0; i < NodeList::GetNNodes(); ++i)
+    {
+        g_nodes[i] = NodeList::GetNode(i);
+        g_ranks[i] = g_nodes[i]->GetSystemId();
+    }
+}
+
+void
+HybridMpiInterface::SendPacket(Ptr<Packet> p, const Time& rxTime, uint32_t node, uint32_t dev)
+{
+    NS_LOG_FUNCTION(this << p << rxTime.GetTimeStep() << node << dev);
+
+    NS_ASSERT_MSG(node < g_ranks.size(), "packet sent outside HybridSimulatorImpl::Run");
+    uint32_t rank = g_ranks[node];
+    if (rank != GetSystemId())
+    {
+        std::lock_guard<std::mutex> lock(g_batchMutex);
+        BatchPacket(rank, p, rxTime, node, dev);
+        return;
+    }
+
+    uint32_t src = HybridSimulatorImpl::GetCurrentThread();
+    uint32_t dst = HybridSimulatorImpl::GetThread(node);
+    NS_ASSERT_MSG(src != dst, "remote channel between nodes of the same thread");
+    Lane& lane = g_lanes[(g_current * g_threads + src) * g_threads + dst];
+    WritePacket(lane.buffer, p, rxTime, node, dev);
+    lane.next = Min(lane.next, rxTime);
+}
+
+void
+HybridMpiInterface::ReceiveThreadMessages(uint32_t thread)
+{
+    NS_LOG_FUNCTION(thread);
+
+    uint32_t previous = 1 - g_current;
+    MpiReceiveQueue queue;
+    for (uint32_t src = 0; src < g_threads; ++src)
+    {
+        Lane& lane = g_lanes[(previous * g_threads + src) * g_threads + thread];
+        const uint8_t* pData = lane.buffer.GetBuffer();
+        const uint8_t* pEnd = pData + lane.buffer.GetSize();
+        while (pData < pEnd)
+        {
+            Time rxTime;
+            uint32_t node;
+            uint32_t dev;
+            Ptr<Packet> p = ReadPacket(pData, pEnd, rxTime, node, dev);
+            Ptr<MpiReceiver> pMpiRec = GetReceiver(g_nodes[node], dev);
+            NS_ASSERT(pMpiRec);
+            queue.Add(node, pMpiRec, dev, rxTime, p);
+        }
+        lane.buffer.Clear();
+        lane.next = Time::Max();
+    }
+    queue.Flush();
+}
+
+Time
+HybridMpiInterface::GetNextThreadMessage()
+{
+    Time next = Time::Max();
+    for (uint32_t i = 0; i < g_threads * g_threads; ++i)
+    {
+        next = Min(next, g_lanes[g_current * g_threads * g_threads + i].next);
+    }
+    return next;
+}
+
+void
+HybridMpiInterface::SwapThreadMessages()
+{
+    g_current = 1 - g_current;
+}
+
+} // namespace ns3
@@ -0,0 +1,113 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file
+ * \ingroup mpi
+ * Declaration of class ns3::HybridMpiInterface.
+ */
+
+#ifndef NS3_HYBRID_MPI_INTERFACE_H
+#define NS3_HYBRID_MPI_INTERFACE_H
+
+#include "granted-time-window-mpi-interface.h"
+
+#include <mutex>
+#include <vector>
+
+namespace ns3
+{
+
+class HybridSimulatorImpl;
+
+/**
+ * \ingroup mpi
+ *
+ * \brief Interface between ns-3 and MPI for HybridSimulatorImpl
+ *
+ * The packets to the other ranks are batched as with
+ * GrantedTimeWindowMpiInterface, by any thread.  The packets to the
+ * nodes of another thread of this rank are written into the buffer of
+ * the pair of threads, which only the sender writes during a window and
+ * only the receiver reads during the next one.  There are two sets of
+ * buffers, swapped at every window, so no lock is needed.
+ */
+class HybridMpiInterface : public GrantedTimeWindowMpiInterface
+{
+  public:
+    /**
+     * Register this type.
+     * \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    // Inherited
+    void Destroy() override;
+    void SendPacket(Ptr<Packet> p, const Time& rxTime, uint32_t node, uint32_t dev) override;
+
+  private:
+    friend ns3::HybridSimulatorImpl;
+
+    /** The packets from one thread to another one during a window. */
+    struct alignas(64) Lane
+    {
+        /** The serialized packets. */
+        SentBuffer buffer;
+        /** The earliest receive time in the buffer. */
+        Time next;
+    };
+
+    /**
+     * Prepare the buffers between the threads, and the destination of
+     * every node, before the threads start.
+     *
+     * \param threads the number of threads
+     */
+    static void EnableThreads(uint32_t threads);
+    /**
+     * Schedule the packets sent to the nodes of a thread in the
+     * previous window.  Called by that thread.
+     *
+     * \param thread the receiving thread
+     */
+    static void ReceiveThreadMessages(uint32_t thread);
+    /**
+     * \return the earliest receive time of the packets sent to other
+     *         threads in the current window, Time::Max() if none
+     */
+    static Time GetNextThreadMessage();
+    /**
+     * Start a new window: the packets of the current one are received
+     * and new packets are written into the other set of buffers.
+     */
+    static void SwapThreadMessages();
+
+    /** Number of threads. */
+    static uint32_t g_threads;
+    /** The set of buffers written in the current window. */
+    static uint32_t g_current;
+    /** The buffers of each set and each pair of threads. */
+    static std::vector<Lane> g_lanes;
+    /** Rank of every node. */
+    static std::vector<uint32_t> g_ranks;
+    /** Every node, to find the receivers without NodeList. */
+    static std::vector<Ptr<Node>> g_nodes;
+    /** Protects the batches of the other ranks. */
+    static std::mutex g_batchMutex;
+};
+
+} // namespace ns3
+
+#endif /* NS3_HYBRID_MPI_INTERFACE_H */
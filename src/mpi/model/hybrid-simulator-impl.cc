@@ -0,0 +1,753 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file
+ * \ingroup mpi
+ * Implementation of class ns3::HybridSimulatorImpl.
+ */
+
+#include "hybrid-simulator-impl.h"
+
+#include "granted-time-window-mpi-interface.h"
+#include "hybrid-mpi-interface.h"
+#include "mpi-interface.h"
+#include "sync-profiler.h"
+
+#include "ns3/abort.h"
+#include "ns3/assert.h"
+#include "ns3/channel.h"
+#include "ns3/event-impl.h"
+#include "ns3/log.h"
+#include "ns3/node-container.h"
+#include "ns3/scheduler.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("HybridSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED(HybridSimulatorImpl);
+
+/**
+ * Number of polls of the barrier before a waiting thread yields.
+ */
+const uint32_t BARRIER_SPIN = 4096;
+
+std::vector<uint32_t> HybridSimulatorImpl::m_nodeThreads;
+thread_local HybridSimulatorImpl::Worker* HybridSimulatorImpl::m_current = nullptr;
+
+TypeId
+HybridSimulatorImpl::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::HybridSimulatorImpl")
+                            .SetParent<DistributedSimulatorImpl>()
+                            .SetGroupName("Mpi")
+                            .AddConstructor<HybridSimulatorImpl>();
+    return tid;
+}
+
+HybridSimulatorImpl::HybridSimulatorImpl()
+{
+    NS_LOG_FUNCTION(this);
+
+    m_workers.resize(1);
+    m_workers[0].events = nullptr;
+    m_workers[0].index = 0;
+    m_workers[0].uid = EventId::UID::VALID;
+    m_workers[0].currentUid = EventId::UID::INVALID;
+    m_workers[0].currentTs = 0;
+    m_workers[0].currentContext = Simulator::NO_CONTEXT;
+    m_workers[0].eventCount = 0;
+    m_workers[0].unscheduledEvents = 0;
+    m_workers[0].cancelledEvents = 0;
+    m_workers[0].processing = false;
+    m_distributed = false;
+    m_threadLookAhead = Time::Max();
+    m_windowEnd = 0;
+    m_windowCount = 0;
+    m_stopRequested = false;
+    m_stopTime = Time::Max().GetTimeStep();
+    m_barrierCount = 0;
+    m_barrierGeneration = 0;
+}
+
+HybridSimulatorImpl::~HybridSimulatorImpl()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+HybridSimulatorImpl::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+
+    for (Worker& worker : m_workers)
+    {
+        while (worker.events && !worker.events->IsEmpty())
+        {
+            Scheduler::Event next = worker.events->RemoveNext();
+            next.impl->Unref();
+        }
+        worker.events = nullptr;
+    }
+    SimulatorImpl::DoDispose();
+}
+
+void
+HybridSimulatorImpl::SetThread(uint32_t node, uint32_t thread)
+{
+    NS_LOG_FUNCTION(node << thread);
+
+    if (m_nodeThreads.size() <= node)
+    {
+        m_nodeThreads.resize(node + 1, 0);
+    }
+    m_nodeThreads[node] = thread;
+}
+
+uint32_t
+HybridSimulatorImpl::GetThread(uint32_t node)
+{
+    return node < m_nodeThreads.size() ? m_nodeThreads[node] : 0;
+}
+
+uint32_t
+HybridSimulatorImpl::GetNThreads()
+{
+    if (m_nodeThreads.empty())
+    {
+        return 1;
+    }
+    return *std::max_element(m_nodeThreads.begin(), m_nodeThreads.end()) + 1;
+}
+
+uint32_t
+HybridSimulatorImpl::GetCurrentThread()
+{
+    return m_current ? m_current->index : 0;
+}
+
+Time
+HybridSimulatorImpl::GetThreadLookAhead() const
+{
+    return m_threadLookAhead;
+}
+
+HybridSimulatorImpl::Worker&
+HybridSimulatorImpl::Current() const
+{
+    return m_current ? *m_current : const_cast<Worker&>(m_workers[0]);
+}
+
+uint32_t
+HybridSimulatorImpl::GetWorker(uint32_t context) const
+{
+    if (!m_distributed)
+    {
+        return 0;
+    }
+    if (context == Simulator::NO_CONTEXT)
+    {
+        return GetCurrentThread();
+    }
+    return GetThread(context);
+}
+
+void
+HybridSimulatorImpl::SetScheduler(ObjectFactory schedulerFactory)
+{
+    NS_LOG_FUNCTION(this << schedulerFactory);
+
+    m_schedulerFactory = schedulerFactory;
+    for (Worker& worker : m_workers)
+    {
+        Ptr<Scheduler> scheduler = schedulerFactory.Create<Scheduler>();
+        if (worker.events)
+        {
+            while (!worker.events->IsEmpty())
+            {
+                scheduler->Insert(worker.events->RemoveNext());
+            }
+        }
+        worker.events = scheduler;
+    }
+}
+
+void
+HybridSimulatorImpl::CalculateThreadLookAhead()
+{
+    NS_LOG_FUNCTION(this);
+
+    // Same as DistributedSimulatorImpl::CalculateLookAhead, for the
+    // channels between the nodes of this rank on different threads
+    m_threadLookAhead = Time::Max();
+    NodeContainer c = NodeContainer::GetGlobal();
+    for (NodeContainer::Iterator iter = c.Begin(); iter != c.End(); ++iter)
+    {
+        if ((*iter)->GetSystemId() != m_myId)
+        {
+            continue;
+        }
+        uint32_t thread = GetThread((*iter)->GetId());
+        for (uint32_t i = 0; i < (*iter)->GetNDevices(); ++i)
+        {
+            Ptr<Channel> channel = (*iter)->GetDevice(i)->GetChannel();
+            TimeValue delay;
+            if (!channel || !channel->GetAttributeFailSafe("Delay", delay))
+            {
+                continue;
+            }
+            for (std::size_t j = 0; j < channel->GetNDevices(); ++j)
+            {
+                Ptr<Node> remoteNode = channel->GetDevice(j)->GetNode();
+                if (remoteNode->GetSystemId() == m_myId &&
+                    GetThread(remoteNode->GetId()) != thread)
+                {
+                    m_threadLookAhead = Min(m_threadLookAhead, delay.Get());
+                }
+            }
+        }
+    }
+    NS_ABORT_MSG_IF(!m_threadLookAhead.IsStrictlyPositive(),
+                    "HybridSimulatorImpl needs a positive delay between the threads");
+}
+
+void
+HybridSimulatorImpl::Distribute(uint32_t threads)
+{
+    NS_LOG_FUNCTION(this << threads);
+
+    std::vector<Scheduler::Event> events;
+    for (Worker& worker : m_workers)
+    {
+        while (!worker.events->IsEmpty())
+        {
+            events.push_back(worker.events->RemoveNext());
+        }
+    }
+
+    // The threads start where the latest one was, and interleave their
+    // event ids so that they are still unique once merged back.
+    Worker first = m_workers[0];
+    for (std::size_t i = 1; i < m_workers.size(); ++i)
+    {
+        first.currentTs = std::max(first.currentTs, m_workers[i].currentTs);
+        first.eventCount += m_workers[i].eventCount;
+        first.unscheduledEvents += m_workers[i].unscheduledEvents;
+        first.uid = std::max(first.uid, m_workers[i].uid);
+    }
+    first.cancelledEvents = 0;
+    first.processing = false;
+    m_workers.assign(threads, first);
+    for (uint32_t i = 1; i < threads; ++i)
+    {
+        m_workers[i].index = i;
+        m_workers[i].uid += i;
+        m_workers[i].events = m_schedulerFactory.Create<Scheduler>();
+        m_workers[i].eventCount = 0;
+        m_workers[i].unscheduledEvents = 0;
+    }
+
+    m_distributed = threads > 1;
+    for (const Scheduler::Event& ev : events)
+    {
+        uint32_t index = GetWorker(ev.key.m_context);
+        m_workers[index].events->Insert(ev);
+        m_workers[index].unscheduledEvents++;
+        m_workers[0].unscheduledEvents--;
+    }
+}
+
+void
+HybridSimulatorImpl::Run()
+{
+    NS_LOG_FUNCTION(this);
+
+    StartRun();
+    CalculateThreadLookAhead();
+    m_stopRequested = false;
+    m_windowCount = 0;
+
+    uint32_t threads = GetNThreads();
+    Distribute(threads);
+    HybridMpiInterface::EnableThreads(threads);
+    // A profiler is not thread safe: each thread samples its own events
+    // in a fork of the profiler of the rank, merged back after the run
+    m_profilers.clear();
+    for (uint32_t i = 0; m_profiler && i < threads; ++i)
+    {
+        m_profilers.push_back(m_profiler->Fork());
+    }
+
+    std::vector<std::thread> pool;
+    for (uint32_t i = 1; i < threads; ++i)
+    {
+        pool.emplace_back(&HybridSimulatorImpl::RunWorker, this, i);
+    }
+    RunWorker(0);
+    for (std::thread& thread : pool)
+    {
+        thread.join();
+    }
+    for (const auto& profiler : m_profilers)
+    {
+        m_profiler->Merge(*profiler);
+    }
+    m_profilers.clear();
+
+    // Back to a single queue, so that the events can be cancelled or
+    // removed until the next Run()
+    Distribute(1);
+    FinishRun();
+    NS_LOG_INFO("rank " << m_myId << ": " << threads << " threads, " << m_windowCount
+                        << " windows, thread lookahead " << m_threadLookAhead.As(Time::US));
+
+    // If the simulator stopped naturally by lack of events, make a
+    // consistency test to check that we didn't lose any events along the way.
+    NS_ASSERT(!m_workers[0].events->IsEmpty() || m_workers[0].unscheduledEvents == 0);
+}
+
+void
+HybridSimulatorImpl::Barrier()
+{
+    // The last thread to arrive releases the others; the counter is
+    // reset before, so that a released thread can wait again at once.
+    uint32_t generation = m_barrierGeneration.load(std::memory_order_acquire);
+    if (m_barrierCount.fetch_add(1, std::memory_order_acq_rel) + 1 == m_workers.size())
+    {
+        m_barrierCount.store(0, std::memory_order_relaxed);
+        m_barrierGeneration.fetch_add(1, std::memory_order_acq_rel);
+        return;
+    }
+    for (uint32_t spin = 0; m_barrierGeneration.load(std::memory_order_acquire) == generation;
+         ++spin)
+    {
+        if (spin >= BARRIER_SPIN)
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void
+HybridSimulatorImpl::RunWorker(uint32_t index)
+{
+    NS_LOG_FUNCTION(this << index);
+
+    Worker& worker = m_workers[index];
+    m_current = &worker;
+    while (true)
+    {
+        if (index == 0)
+        {
+            Synchronize();
+        }
+        Barrier();
+        if (m_globalFinished)
+        {
+            break;
+        }
+
+        // The packets sent by the other threads in the previous window
+        // are due in this window at the earliest
+        worker.processing = true;
+        HybridMpiInterface::ReceiveThreadMessages(index);
+        while (!worker.events->IsEmpty() && !m_stopRequested.load(std::memory_order_relaxed) &&
+               worker.events->PeekNext().key.m_ts < m_windowEnd)
+        {
+            ProcessOneEvent(worker);
+        }
+        worker.processing = false;
+        Barrier();
+    }
+    m_current = nullptr;
+}
+
+void
+HybridSimulatorImpl::Synchronize()
+{
+    NS_LOG_FUNCTION(this);
+
+    m_windowCount++;
+    Time now = TimeStep(0);
+    for (const Worker& worker : m_workers)
+    {
+        now = Max(now, TimeStep(worker.currentTs));
+    }
+    if (m_stopRequested)
+    {
+        m_stop = true;
+    }
+
+    LbtsMessage global;
+    if (m_systemCount > 1)
+    {
+        // The other threads wait at the barrier, the packets of the other
+        // ranks go straight to the queue of their node
+        int64_t start = SyncProfiler::Now();
+        GrantedTimeWindowMpiInterface::FlushSendBuffers();
+        GrantedTimeWindowMpiInterface::ReceiveMessages();
+        GrantedTimeWindowMpiInterface::TestSendComplete();
+        start = SyncProfiler::AddTime(SyncProfiler::EXCHANGE, start);
+        ExchangeLbts(GetLocalLbts(Next(), now), &global, nullptr);
+        SyncProfiler::AddTime(SyncProfiler::WAIT, start);
+        Grant(global);
+    }
+    else
+    {
+        global = GetLocalLbts(Next(), now);
+        Grant(global);
+        m_grantedTime = GetMaximumSimulationTime();
+    }
+
+    // Stop once no rank has anything left before the stop time
+    if (m_stopTime != Time::Max().GetTimeStep() &&
+        global.GetSmallestTime() >= TimeStep(m_stopTime) &&
+        global.GetRxCount() == global.GetTxCount())
+    {
+        m_stop = true;
+        m_stopTime = Time::Max().GetTimeStep();
+    }
+
+    // The window ends before the first packet a thread can send to another
+    // one in it, and after the granted time of the rank
+    Time next = Next();
+    Time end = m_stop ? TimeStep(0) : TimeStep(m_stopTime);
+    if (m_threadLookAhead != Time::Max() && next < Time::Max() - m_threadLookAhead)
+    {
+        end = Min(end, next + m_threadLookAhead);
+    }
+    if (m_grantedTime < GetMaximumSimulationTime())
+    {
+        end = Min(end, m_grantedTime + TimeStep(1));
+    }
+    m_windowEnd = end.GetTimeStep();
+    HybridMpiInterface::SwapThreadMessages();
+    SyncProfiler::RecordRound(now, end, GetEventCount());
+}
+
+void
+HybridSimulatorImpl::ProcessOneEvent(Worker& worker)
+{
+    Scheduler::Event next = worker.events->RemoveNext();
+
+    PreEventHook(EventId(next.impl, next.key.m_ts, next.key.m_context, next.key.m_uid));
+
+    NS_ASSERT(next.key.m_ts >= worker.currentTs);
+    worker.unscheduledEvents--;
+    worker.eventCount++;
+    if (worker.cancelledEvents > 0 && next.impl->IsCancelled())
+    {
+        worker.cancelledEvents--;
+    }
+
+    NS_LOG_LOGIC("handle " << next.key.m_ts);
+    worker.currentTs = next.key.m_ts;
+    worker.currentContext = next.key.m_context;
+    worker.currentUid = next.key.m_uid;
+    if (!m_profilers.empty())
+    {
+        m_profilers[worker.index]->Invoke(next.impl, worker.currentContext);
+    }
+    else
+    {
+        next.impl->Invoke();
+    }
+    next.impl->Unref();
+}
+
+Time
+HybridSimulatorImpl::Next() const
+{
+    Time next = HybridMpiInterface::GetNextThreadMessage();
+    for (const Worker& worker : m_workers)
+    {
+        if (!worker.events->IsEmpty())
+        {
+            next = Min(next, TimeStep(worker.events->PeekNext().key.m_ts));
+        }
+    }
+    return m_stop ? GetMaximumSimulationTime() : next;
+}
+
+bool
+HybridSimulatorImpl::IsLocalFinished() const
+{
+    return m_stop || Next() == Time::Max();
+}
+
+void
+HybridSimulatorImpl::Stop()
+{
+    NS_LOG_FUNCTION(this);
+
+    m_stopRequested = true;
+}
+
+void
+HybridSimulatorImpl::Stop(const Time& delay)
+{
+    NS_LOG_FUNCTION(this << delay.GetTimeStep());
+
+    // Every thread stops before that time, whichever thread asked
+    int64_t stopTime = (Now() + delay).GetTimeStep();
+    int64_t current = m_stopTime.load();
+    while (stopTime < current && !m_stopTime.compare_exchange_weak(current, stopTime))
+    {
+    }
+}
+
+EventId
+HybridSimulatorImpl::Insert(Worker& worker, uint64_t ts, uint32_t context, EventImpl* event)
+{
+    NS_ABORT_MSG_IF(Current().processing && &worker != &Current(),
+                    "Event scheduled on the node " << context << " of another thread; the nodes "
+                                                   << "of different threads need a remote channel");
+    Scheduler::Event ev;
+    ev.impl = event;
+    ev.key.m_ts = ts;
+    ev.key.m_context = context;
+    ev.key.m_uid = worker.uid;
+    worker.uid += m_workers.size();
+    worker.unscheduledEvents++;
+    worker.events->Insert(ev);
+    return EventId(event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
+}
+
+EventId
+HybridSimulatorImpl::Schedule(const Time& delay, EventImpl* event)
+{
+    NS_LOG_FUNCTION(this << delay.GetTimeStep() << event);
+
+    Worker& current = Current();
+    Time tAbsolute = delay + TimeStep(current.currentTs);
+    NS_ASSERT(tAbsolute.IsPositive());
+    NS_ASSERT(tAbsolute >= TimeStep(current.currentTs));
+    return Insert(m_workers[GetWorker(current.currentContext)],
+                  tAbsolute.GetTimeStep(),
+                  current.currentContext,
+                  event);
+}
+
+void
+HybridSimulatorImpl::ScheduleWithContext(uint32_t context, const Time& delay, EventImpl* event)
+{
+    NS_LOG_FUNCTION(this << context << delay.GetTimeStep() << event);
+
+    Worker& current = Current();
+    Insert(m_workers[GetWorker(context)],
+           current.currentTs + delay.GetTimeStep(),
+           context,
+           event);
+}
+
+EventId
+HybridSimulatorImpl::ScheduleNow(EventImpl* event)
+{
+    NS_LOG_FUNCTION(this << event);
+    return Schedule(Time(0), event);
+}
+
+EventId
+HybridSimulatorImpl::ScheduleDestroy(EventImpl* event)
+{
+    NS_LOG_FUNCTION(this << event);
+
+    std::lock_guard<std::mutex> lock(m_destroyMutex);
+    return DistributedSimulatorImpl::ScheduleDestroy(event);
+}
+
+Time
+HybridSimulatorImpl::Now() const
+{
+    return TimeStep(Current().currentTs);
+}
+
+Time
+HybridSimulatorImpl::GetDelayLeft(const EventId& id) const
+{
+    if (IsExpired(id))
+    {
+        return TimeStep(0);
+    }
+    return TimeStep(id.GetTs() - Current().currentTs);
+}
+
+void
+HybridSimulatorImpl::Remove(const EventId& id)
+{
+    if (id.GetUid() == EventId::UID::DESTROY)
+    {
+        std::lock_guard<std::mutex> lock(m_destroyMutex);
+        DistributedSimulatorImpl::Remove(id);
+        return;
+    }
+    if (id.PeekEventImpl() == nullptr)
+    {
+        return;
+    }
+    Worker& worker = m_workers[GetWorker(id.GetContext())];
+    NS_ABORT_MSG_IF(Current().processing && &worker != &Current(),
+                    "Event of the node " << id.GetContext() << " removed by another thread");
+    if (IsExpired(id))
+    {
+        return;
+    }
+    Scheduler::Event event;
+    event.impl = id.PeekEventImpl();
+    event.key.m_ts = id.GetTs();
+    event.key.m_context = id.GetContext();
+    event.key.m_uid = id.GetUid();
+    worker.events->Remove(event);
+    event.impl->Cancel();
+    // whenever we remove an event from the event list, we have to unref it.
+    event.impl->Unref();
+
+    worker.unscheduledEvents--;
+}
+
+void
+HybridSimulatorImpl::Cancel(const EventId& id)
+{
+    if (id.GetUid() == EventId::UID::DESTROY)
+    {
+        if (!IsExpired(id))
+        {
+            id.PeekEventImpl()->Cancel();
+        }
+        return;
+    }
+    if (id.PeekEventImpl() == nullptr)
+    {
+        return;
+    }
+    Worker& worker = m_workers[GetWorker(id.GetContext())];
+    NS_ABORT_MSG_IF(Current().processing && &worker != &Current(),
+                    "Event of the node " << id.GetContext() << " cancelled by another thread");
+    if (IsExpired(id))
+    {
+        return;
+    }
+    id.PeekEventImpl()->Cancel();
+    worker.cancelledEvents++;
+    if (m_compactionThreshold > 0 && worker.cancelledEvents >= m_compactionThreshold &&
+        2 * worker.cancelledEvents > static_cast<uint32_t>(worker.unscheduledEvents))
+    {
+        worker.unscheduledEvents -= worker.events->RemoveCancelled();
+        worker.cancelledEvents = 0;
+    }
+}
+
+EventId
+HybridSimulatorImpl::Reschedule(const EventId& id, const Time& delay)
+{
+    NS_LOG_FUNCTION(this << delay.GetTimeStep());
+    NS_ASSERT(delay.IsPositive());
+
+    if (id.GetUid() == EventId::UID::DESTROY || id.PeekEventImpl() == nullptr)
+    {
+        return EventId();
+    }
+    Worker& worker = m_workers[GetWorker(id.GetContext())];
+    NS_ABORT_MSG_IF(Current().processing && &worker != &Current(),
+                    "Event of the node " << id.GetContext() << " moved by another thread");
+    EventImpl* impl = id.PeekEventImpl();
+    uint64_t ts = Current().currentTs + delay.GetTimeStep();
+    if (id.GetTs() == worker.currentTs && id.GetUid() == worker.currentUid &&
+        !impl->IsCancelled())
+    {
+        // the event being executed, inserted again
+        impl->Ref();
+        return Insert(worker, ts, id.GetContext(), impl);
+    }
+    if (IsExpired(id))
+    {
+        return EventId();
+    }
+    Scheduler::Event ev;
+    ev.impl = impl;
+    ev.key.m_ts = id.GetTs();
+    ev.key.m_context = id.GetContext();
+    ev.key.m_uid = id.GetUid();
+    Scheduler::EventKey key;
+    key.m_ts = ts;
+    key.m_context = id.GetContext();
+    key.m_uid = worker.uid;
+    worker.uid += m_workers.size();
+    worker.events->Update(ev, key);
+    return EventId(impl, key.m_ts, key.m_context, key.m_uid);
+}
+
+bool
+HybridSimulatorImpl::IsExpired(const EventId& id) const
+{
+    if (id.GetUid() == EventId::UID::DESTROY)
+    {
+        return DistributedSimulatorImpl::IsExpired(id);
+    }
+    if (id.PeekEventImpl() == nullptr)
+    {
+        return true;
+    }
+    // the current event of another thread changes while it processes
+    const Worker& worker = m_workers[GetWorker(id.GetContext())];
+    NS_ABORT_MSG_IF(Current().processing && &worker != &Current(),
+                    "Event of the node " << id.GetContext() << " tested by another thread");
+    return id.GetTs() < worker.currentTs ||
+           (id.GetTs() == worker.currentTs && id.GetUid() <= worker.currentUid) ||
+           id.PeekEventImpl()->IsCancelled();
+}
+
+uint32_t
+HybridSimulatorImpl::GetContext() const
+{
+    return Current().currentContext;
+}
+
+uint64_t
+HybridSimulatorImpl::GetEventCount() const
+{
+    // Only consistent outside Run()
+    uint64_t count = 0;
+    for (const Worker& worker : m_workers)
+    {
+        count += worker.eventCount;
+    }
+    return count;
+}
+
+uint32_t
+HybridSimulatorImpl::RemoveCancelledEvents()
+{
+    NS_LOG_FUNCTION(this);
+
+    // Between two windows, the other threads wait; a packet between two
+    // threads not delivered yet counts as an event
+    uint32_t events = HybridMpiInterface::GetNextThreadMessage() != Time::Max() ? 1 : 0;
+    for (Worker& worker : m_workers)
+    {
+        worker.unscheduledEvents -= worker.events->RemoveCancelled();
+        worker.cancelledEvents = 0;
+        events += worker.unscheduledEvents;
+    }
+    return events;
+}
+
+} // namespace ns3
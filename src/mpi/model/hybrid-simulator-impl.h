@@ -0,0 +1,254 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file
+ * \ingroup mpi
+ * Declaration of class ns3::HybridSimulatorImpl.
+ */
+
+#ifndef NS3_HYBRID_SIMULATOR_IMPL_H
+#define NS3_HYBRID_SIMULATOR_IMPL_H
+
+#include "distributed-simulator-impl.h"
+
+#include "ns3/object-factory.h"
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace ns3
+{
+
+class HybridMpiInterface;
+
+/**
+ * \ingroup simulator
+ * \ingroup mpi
+ *
+ * \brief Distributed simulator implementation running the nodes of a
+ * rank on several threads.
+ *
+ * The ranks synchronize exactly like with DistributedSimulatorImpl.
+ * Within a rank, every node is simulated by the thread given with
+ * SetThread(), which has its own event queue.  The threads process
+ * conservative windows in lock step: a window ends one lookahead after
+ * the earliest event of the rank, the lookahead being the smallest
+ * delay of the channels between nodes of different threads, and is
+ * also bounded by the time granted to the rank.  The first thread
+ * computes the next window, and exchanges the LBTS messages and the
+ * packets with the other ranks, while the other threads wait.
+ *
+ * The helpers create remote channels between the nodes of different
+ * threads, as they do between the nodes of different ranks.  Their
+ * packets are serialized by the sender into a buffer per pair of
+ * threads, and delivered by the receiver at the start of the next
+ * window; a thread never touches an object of another thread.  The
+ * models must not either: packet metadata and the NodeList lookups at
+ * run time are not supported, nor is the OverlapLbts attribute.
+ * FlowStatsMonitor and FctCollector keep the statistics of each thread
+ * apart, and merge them once the threads are done.  An event of a node
+ * of another thread can not be cancelled, removed, moved nor tested
+ * while the threads process a window.
+ */
+class HybridSimulatorImpl : public DistributedSimulatorImpl
+{
+  public:
+    /**
+     *  Register this type.
+     *  \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /** Default constructor. */
+    HybridSimulatorImpl();
+    /** Destructor. */
+    ~HybridSimulatorImpl() override;
+
+    // virtual from SimulatorImpl
+    void Stop() override;
+    void Stop(const Time& delay) override;
+    EventId Schedule(const Time& delay, EventImpl* event) override;
+    void ScheduleWithContext(uint32_t context, const Time& delay, EventImpl* event) override;
+    EventId ScheduleNow(EventImpl* event) override;
+    EventId ScheduleDestroy(EventImpl* event) override;
+    void Remove(const EventId& id) override;
+    void Cancel(const EventId& id) override;
+    EventId Reschedule(const EventId& id, const Time& delay) override;
+    bool IsExpired(const EventId& id) const override;
+    void Run() override;
+    Time Now() const override;
+    Time GetDelayLeft(const EventId& id) const override;
+    void SetScheduler(ObjectFactory schedulerFactory) override;
+    uint32_t GetContext() const override;
+    uint64_t GetEventCount() const override;
+    uint32_t RemoveCancelledEvents() override;
+
+    /**
+     * Simulate a node on a thread of its rank.  The nodes are on the
+     * thread 0 by default, and a rank runs as many threads as the
+     * largest thread index plus one.  The thread of the nodes must be
+     * set before their channels are installed.
+     *
+     * \param node the node id
+     * \param thread the thread index
+     */
+    static void SetThread(uint32_t node, uint32_t thread);
+    /**
+     * \param node the node id
+     * \return the thread index of the node
+     */
+    static uint32_t GetThread(uint32_t node);
+    /**
+     * \return the number of threads of every rank
+     */
+    static uint32_t GetNThreads();
+
+    /**
+     * \return The smallest delay of the channels between the nodes of
+     *         different threads of this rank; valid once Run() has
+     *         started.
+     */
+    Time GetThreadLookAhead() const;
+
+  protected:
+    // Inherited from Object
+    void DoDispose() override;
+
+    bool IsLocalFinished() const override;
+
+  private:
+    friend ns3::HybridMpiInterface;
+
+    /** The events and the current event of a thread. */
+    struct Worker
+    {
+        /** The event priority queue. */
+        Ptr<Scheduler> events;
+        /** Thread index. */
+        uint32_t index;
+        /** Next event unique id. */
+        uint32_t uid;
+        /** Unique id of the current event. */
+        uint32_t currentUid;
+        /** Timestamp of the current event. */
+        uint64_t currentTs;
+        /** Execution context of the current event. */
+        uint32_t currentContext;
+        /** The event count. */
+        uint64_t eventCount;
+        /** Number of events inserted but not yet scheduled. */
+        int unscheduledEvents;
+        /** Number of cancelled events in the event list, at most. */
+        uint32_t cancelledEvents;
+        /** Is the thread processing a window. */
+        bool processing;
+    };
+
+    /**
+     * \return the index of the calling thread, 0 outside Run()
+     */
+    static uint32_t GetCurrentThread();
+
+    /** \return the worker of the calling thread */
+    Worker& Current() const;
+    /**
+     * \param context an event context
+     * \return the thread that processes the events of that context
+     */
+    uint32_t GetWorker(uint32_t context) const;
+    /**
+     * Insert an event in the queue of a thread.
+     *
+     * \param worker the thread
+     * \param ts the event time stamp
+     * \param context the event context
+     * \param event the event
+     * \return the event id
+     */
+    EventId Insert(Worker& worker, uint64_t ts, uint32_t context, EventImpl* event);
+
+    /** Compute the lookahead between the threads of this rank. */
+    void CalculateThreadLookAhead();
+    /**
+     * Move the events of every thread to the thread of their context,
+     * or back to the thread 0 when \p threads is 1.
+     *
+     * \param threads the number of threads
+     */
+    void Distribute(uint32_t threads);
+    /**
+     * Exchange the LBTS messages and the packets with the other
+     * ranks, and compute the next window.  Run by the thread 0 while
+     * the others wait.
+     */
+    void Synchronize();
+    /**
+     * Process the windows of a thread until the end of the simulation.
+     *
+     * \param index the thread index
+     */
+    void RunWorker(uint32_t index);
+    /**
+     * Wait for all the threads.
+     */
+    void Barrier();
+    /**
+     * Process the next event of a thread.
+     *
+     * \param worker the thread
+     */
+    void ProcessOneEvent(Worker& worker);
+    /**
+     * \return the time of the next event of this rank, including the
+     *         packets between threads not delivered yet
+     */
+    Time Next() const;
+
+    /** Thread index of every node. */
+    static std::vector<uint32_t> m_nodeThreads;
+    /** Worker of the calling thread, nullptr outside Run(). */
+    static thread_local Worker* m_current;
+
+    /** The threads, the first one is the calling thread of Run(). */
+    std::vector<Worker> m_workers;
+    /** Are the events in the queue of the thread of their node. */
+    bool m_distributed;
+    /** The scheduler of the threads. */
+    ObjectFactory m_schedulerFactory;
+    /** Smallest delay of the channels between threads. */
+    Time m_threadLookAhead;
+    /** Exclusive end of the current window. */
+    uint64_t m_windowEnd;
+    /** Number of windows of the last Run(). */
+    uint64_t m_windowCount;
+    /** Simulator::Stop() was called by an event. */
+    std::atomic<bool> m_stopRequested;
+    /** Time step of the earliest Stop(delay), excluded. */
+    std::atomic<int64_t> m_stopTime;
+    /** Protects the events to run at Destroy(). */
+    std::mutex m_destroyMutex;
+    /** Number of threads waiting at the barrier. */
+    std::atomic<uint32_t> m_barrierCount;
+    /** Number of times every thread reached the barrier. */
+    std::atomic<uint32_t> m_barrierGeneration;
+    /** The event profiler of each thread during Run(), if profiling. */
+    std::vector<std::unique_ptr<EventProfiler>> m_profilers;
+};
+
+} // namespace ns3
+
+#endif /* NS3_HYBRID_SIMULATOR_IMPL_H */
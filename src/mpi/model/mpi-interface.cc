@@ -26,6 +26,7 @@
 #include "mpi-interface.h"
 
 #include "granted-time-window-mpi-interface.h"
+#include "hybrid-mpi-interface.h"
 #include "null-message-mpi-interface.h"
 
 #include <ns3/global-value.h>
@@ -107,6 +108,11 @@ MpiInterface::SetParallelSimulatorImpl()
             g_parallelCommunicationInterface = new GrantedTimeWindowMpiInterface();
             useDefault = false;
         }
+        else if (simulationType == "ns3::HybridSimulatorImpl")
+        {
+            g_parallelCommunicationInterface = new HybridMpiInterface();
+            useDefault = false;
+        }
     }
 
     // User did not specify a valid parallel simulator; use the default.
@@ -24,6 +24,8 @@
 
 #include "mpi-receiver.h"
 
+#include "ns3/simulator.h"
+
 namespace ns3
 {
 
@@ -60,4 +62,43 @@ MpiReceiver::DoDispose()
     m_rxCallback = MakeNullCallback<void, Ptr<Packet>>();
 }
 
+bool
+MpiReceiveQueue::IsPriority(uint32_t dev)
+{
+    return dev != MpiReceiver::NODE_RECEIVER && (dev & MpiReceiver::PRIORITY);
+}
+
+void
+MpiReceiveQueue::Add(uint32_t node,
+                     Ptr<MpiReceiver> receiver,
+                     uint32_t dev,
+                     const Time& rxTime,
+                     Ptr<Packet> p)
+{
+    if (IsPriority(dev))
+    {
+        Simulator::ScheduleWithContext(node,
+                                       rxTime - Simulator::Now(),
+                                       &MpiReceiver::Receive,
+                                       receiver,
+                                       p);
+        return;
+    }
+    m_held.push_back(Held{node, receiver, rxTime, p});
+}
+
+void
+MpiReceiveQueue::Flush()
+{
+    for (Held& held : m_held)
+    {
+        Simulator::ScheduleWithContext(held.node,
+                                       held.rxTime - Simulator::Now(),
+                                       &MpiReceiver::Receive,
+                                       held.receiver,
+                                       held.packet);
+    }
+    m_held.clear();
+}
+
 } // namespace ns3
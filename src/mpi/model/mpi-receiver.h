@@ -25,9 +25,12 @@
 #ifndef NS3_MPI_RECEIVER_H
 #define NS3_MPI_RECEIVER_H
 
+#include "ns3/nstime.h"
 #include "ns3/object.h"
 #include "ns3/packet.h"
 
+#include <vector>
+
 namespace ns3
 {
 
@@ -54,6 +57,19 @@ class MpiReceiver : public Object
     static TypeId GetTypeId();
     ~MpiReceiver() override;
 
+    /**
+     * Device index addressing the MpiReceiver aggregated to the node
+     * itself, for messages that are not meant for a NetDevice.
+     */
+    static const uint32_t NODE_RECEIVER = 0xffffffff;
+
+    /**
+     * Flag of the device index of a packet to deliver before the packets
+     * without it received for the same time, such as the control frames
+     * of a lossless network; see MpiReceiveQueue.
+     */
+    static const uint32_t PRIORITY = 0x80000000;
+
     /**
      * \brief Direct an incoming packet to the device Receive() method
      * \param p Packet to receive
@@ -72,6 +88,58 @@ class MpiReceiver : public Object
     Callback<void, Ptr<Packet>> m_rxCallback;
 };
 
+/**
+ * \ingroup mpi
+ *
+ * \brief Schedules the packets read from other ranks in one pass
+ *
+ * The packets sent with the MpiReceiver::PRIORITY flag are scheduled as
+ * they are read, the others are held until Flush(), so that among the
+ * packets of a pass received for the same time the priority ones come
+ * first.
+ */
+class MpiReceiveQueue
+{
+  public:
+    /**
+     * Schedule the reception of a packet, or hold it.
+     *
+     * \param node the destination node
+     * \param receiver the receiver of the destination device
+     * \param dev the destination device, with its flags
+     * \param rxTime the time the packet is received
+     * \param p the packet
+     */
+    void Add(uint32_t node,
+             Ptr<MpiReceiver> receiver,
+             uint32_t dev,
+             const Time& rxTime,
+             Ptr<Packet> p);
+    /**
+     * Schedule the packets held since the last call, in the order they
+     * were read.
+     */
+    void Flush();
+
+    /**
+     * \param dev the destination device of a packet
+     * \return true if the packet has the MpiReceiver::PRIORITY flag
+     */
+    static bool IsPriority(uint32_t dev);
+
+  private:
+    /** A packet held until the end of the pass. */
+    struct Held
+    {
+        uint32_t node;             //!< the destination node
+        Ptr<MpiReceiver> receiver; //!< the receiver of the destination device
+        Time rxTime;               //!< the time the packet is received
+        Ptr<Packet> packet;        //!< the packet
+    };
+
+    std::vector<Held> m_held; //!< the packets held
+};
+
 } // namespace ns3
 
 #endif /* NS3_MPI_RECEIVER_H */
@@ -29,6 +29,7 @@
 #include "null-message-simulator-impl.h"
 #include "remote-channel-bundle-manager.h"
 #include "remote-channel-bundle.h"
+#include "sync-profiler.h"
 
 #include "ns3/log.h"
 #include "ns3/mpi-receiver.h"
@@ -38,6 +39,7 @@
 #include "ns3/nstime.h"
 #include "ns3/simulator.h"
 
+#include <cstring>
 #include <iomanip>
 #include <iostream>
 #include <list>
@@ -94,6 +96,12 @@ class NullMessageSentBuffer
  */
 const uint32_t NULL_MESSAGE_MAX_MPI_MSG_SIZE = 2000;
 
+/**
+ * Flag of a Null Message asking for a guarantee time in return, in the
+ * destination node field.  The requested time follows the header.
+ */
+const uint32_t NULL_MESSAGE_REQUEST = 1;
+
 NullMessageSentBuffer::NullMessageSentBuffer()
 {
     m_buffer = nullptr;
@@ -132,6 +140,7 @@ bool NullMessageMpiInterface::g_mpiInitCalled = false;
 std::list<NullMessageSentBuffer> NullMessageMpiInterface::g_pendingTx;
 
 MPI_Comm NullMessageMpiInterface::g_communicator = MPI_COMM_WORLD;
+MpiReceiveQueue NullMessageMpiInterface::g_receiveQueue;
 bool NullMessageMpiInterface::g_freeCommunicator = false;
 MPI_Request* NullMessageMpiInterface::g_requests;
 char** NullMessageMpiInterface::g_pRxBuffers;
@@ -275,6 +284,7 @@ NullMessageMpiInterface::SendPacket(Ptr<Packet> p, const Time& rxTime, uint32_t
 
     uint32_t serializedSize = p->GetSerializedSize();
     uint32_t bufferSize = serializedSize + (2 * sizeof(uint64_t)) + (2 * sizeof(uint32_t));
+    SyncProfiler::RecordSend(nodeSysId, serializedSize);
     uint8_t* buffer = new uint8_t[bufferSize];
     iter->SetBuffer(buffer);
     // Add the time, dest node and dest device
@@ -282,9 +292,18 @@ NullMessageMpiInterface::SendPacket(Ptr<Packet> p, const Time& rxTime, uint32_t
     uint64_t* pTime = reinterpret_cast<uint64_t*>(buffer);
     *pTime++ = t;
 
+    // The packet carries the guarantee time, as a Null Message would; a
+    // guarantee already sent still holds.
+    Ptr<RemoteChannelBundle> bundle = RemoteChannelBundleManager::Find(nodeSysId);
     Time guarantee_update =
-        NullMessageSimulatorImpl::GetInstance()->CalculateGuaranteeTime(nodeSysId);
+        Max(NullMessageSimulatorImpl::GetInstance()->CalculateGuaranteeTime(nodeSysId),
+            bundle->GetSentGuaranteeTime());
     *pTime++ = guarantee_update.GetTimeStep();
+    bundle->SetSentGuaranteeTime(guarantee_update);
+    if (guarantee_update >= bundle->GetRemoteRequestTime())
+    {
+        bundle->SetRemoteRequestTime(Time(0));
+    }
 
     uint32_t* pData = reinterpret_cast<uint32_t*>(pTime);
     *pData++ = node;
@@ -309,14 +328,44 @@ NullMessageMpiInterface::SendNullMessage(const Time& guarantee_update,
 {
     NS_LOG_FUNCTION(guarantee_update.GetTimeStep() << bundle);
 
+    PostNullMessage(guarantee_update, Time(0), bundle);
+}
+
+void
+NullMessageMpiInterface::RequestNullMessage(const Time& guarantee_update,
+                                            const Time& request,
+                                            Ptr<RemoteChannelBundle> bundle)
+{
+    NS_LOG_FUNCTION(guarantee_update.GetTimeStep() << request.GetTimeStep() << bundle);
+
+    PostNullMessage(guarantee_update, request, bundle);
+    bundle->SetLocalRequestTime(request);
+}
+
+void
+NullMessageMpiInterface::PostNullMessage(const Time& guarantee_update,
+                                         const Time& request,
+                                         Ptr<RemoteChannelBundle> bundle)
+{
     NS_ASSERT(g_enabled);
 
+    bundle->SetSentGuaranteeTime(guarantee_update);
+    if (guarantee_update >= bundle->GetRemoteRequestTime())
+    {
+        bundle->SetRemoteRequestTime(Time(0));
+    }
+    SyncProfiler::RecordNullMessage(bundle->GetSystemId());
+
     NullMessageSentBuffer sendBuf;
     g_pendingTx.push_back(sendBuf);
     std::list<NullMessageSentBuffer>::reverse_iterator iter =
         g_pendingTx.rbegin(); // Points to the last element
 
     uint32_t bufferSize = 2 * sizeof(uint64_t) + 2 * sizeof(uint32_t);
+    if (!request.IsZero())
+    {
+        bufferSize += sizeof(uint64_t);
+    }
     uint8_t* buffer = new uint8_t[bufferSize];
     iter->SetBuffer(buffer);
     // Add the time, dest node and dest device
@@ -324,8 +373,13 @@ NullMessageMpiInterface::SendNullMessage(const Time& guarantee_update,
     *pTime++ = 0;
     *pTime++ = guarantee_update.GetInteger();
     uint32_t* pData = reinterpret_cast<uint32_t*>(pTime);
+    *pData++ = request.IsZero() ? 0 : NULL_MESSAGE_REQUEST;
     *pData++ = 0;
-    *pData++ = 0;
+    if (!request.IsZero())
+    {
+        uint64_t requestTime = request.GetInteger();
+        std::memcpy(pData, &requestTime, sizeof(requestTime));
+    }
 
     // Find the system id for the destination MPI rank
     uint32_t nodeSysId = bundle->GetSystemId();
@@ -411,15 +465,17 @@ NullMessageMpiInterface::ReceiveMessages(bool blocking)
                 count -= sizeof(time) + sizeof(guaranteeUpdate) + sizeof(node) + sizeof(dev);
 
                 Ptr<Packet> p = Create<Packet>(reinterpret_cast<uint8_t*>(pData), count, true);
+                SyncProfiler::RecordReceive(status.MPI_SOURCE, count);
 
                 // Find the correct node/device to schedule receive event
                 Ptr<Node> pNode = NodeList::GetNode(node);
                 Ptr<MpiReceiver> pMpiRec = nullptr;
+                uint32_t ifIndex = dev & ~MpiReceiver::PRIORITY;
                 uint32_t nDevices = pNode->GetNDevices();
                 for (uint32_t i = 0; i < nDevices; ++i)
                 {
                     Ptr<NetDevice> pThisDev = pNode->GetDevice(i);
-                    if (pThisDev->GetIfIndex() == dev)
+                    if (pThisDev->GetIfIndex() == ifIndex)
                     {
                         pMpiRec = pThisDev->GetObject<MpiReceiver>();
                         break;
@@ -428,11 +484,7 @@ NullMessageMpiInterface::ReceiveMessages(bool blocking)
                 NS_ASSERT(pNode && pMpiRec);
 
                 // Schedule the rx event
-                Simulator::ScheduleWithContext(pNode->GetId(),
-                                               rxTime - Simulator::Now(),
-                                               &MpiReceiver::Receive,
-                                               pMpiRec,
-                                               p);
+                g_receiveQueue.Add(pNode->GetId(), pMpiRec, dev, rxTime, p);
             }
 
             // Update guarantee time for both packet receives and Null Messages.
@@ -441,6 +493,18 @@ NullMessageMpiInterface::ReceiveMessages(bool blocking)
 
             bundle->SetGuaranteeTime(Time(guaranteeUpdate));
 
+            // A blocked remote task asks for a guarantee time in return,
+            // unless a message already on its way carries it
+            if (rxTime == Time(0) && (node & NULL_MESSAGE_REQUEST))
+            {
+                uint64_t requestTime;
+                std::memcpy(&requestTime, pData, sizeof(requestTime));
+                if (Time(requestTime) > bundle->GetSentGuaranteeTime())
+                {
+                    bundle->SetRemoteRequestTime(Time(requestTime));
+                }
+            }
+
             // Re-queue the next read
             MPI_Irecv(g_pRxBuffers[index],
                       NULL_MESSAGE_MAX_MPI_MSG_SIZE,
@@ -456,6 +520,7 @@ NullMessageMpiInterface::ReceiveMessages(bool blocking)
             stop = true;
         }
     } while (!stop);
+    g_receiveQueue.Flush();
 }
 
 void
@@ -37,9 +37,11 @@
 namespace ns3
 {
 
+class MpiReceiveQueue;
 class NullMessageSimulatorImpl;
 class NullMessageSentBuffer;
 class RemoteChannelBundle;
+class RemoteChannelBundleManager;
 class Packet;
 
 /**
@@ -79,6 +81,7 @@ class NullMessageMpiInterface : public ParallelCommunicationInterface, Object
      * It is not intended for state to be shared.
      */
     friend ns3::RemoteChannelBundle;
+    friend ns3::RemoteChannelBundleManager;
     friend ns3::NullMessageSimulatorImpl;
 
     /**
@@ -100,6 +103,36 @@ class NullMessageMpiInterface : public ParallelCommunicationInterface, Object
      * same packet metadata simplifies receive logic.
      */
     static void SendNullMessage(const Time& guaranteeUpdate, Ptr<RemoteChannelBundle> bundle);
+    /**
+     * \brief Send a Null Message asking the remote task for a guarantee
+     * time in return, since this task is blocked.
+     *
+     * The remote task answers once its guarantee time reaches the
+     * request, or as soon as it advances if the remote task is blocked
+     * too.
+     *
+     * \param [in] guaranteeUpdate Lower bound time on the next
+     * possible event from this MPI task to the remote MPI task.
+     *
+     * \param [in] request The guarantee time this MPI task needs
+     * from the remote MPI task to process its next event.
+     *
+     * \param [in] bundle The bundle of links between two ranks.
+     */
+    static void RequestNullMessage(const Time& guaranteeUpdate,
+                                   const Time& request,
+                                   Ptr<RemoteChannelBundle> bundle);
+    /**
+     * Post a Null Message, with a request if \p request is not zero.
+     *
+     * \param [in] guaranteeUpdate Lower bound time on the next
+     * possible event from this MPI task to the remote MPI task.
+     * \param [in] request The requested guarantee time, or zero.
+     * \param [in] bundle The bundle of links between two ranks.
+     */
+    static void PostNullMessage(const Time& guaranteeUpdate,
+                                const Time& request,
+                                Ptr<RemoteChannelBundle> bundle);
     /**
      * Non-blocking check for received messages complete.  Will
      * receive all messages that are queued up locally.
@@ -166,6 +199,9 @@ class NullMessageMpiInterface : public ParallelCommunicationInterface, Object
 
     /** Did we create the communicator?  Have to free it. */
     static bool g_freeCommunicator;
+
+    /** Schedules the packets read by ReceiveMessages(). */
+    static MpiReceiveQueue g_receiveQueue;
 };
 
 } // namespace ns3
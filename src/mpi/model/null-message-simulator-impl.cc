@@ -29,18 +29,23 @@
 #include "null-message-mpi-interface.h"
 #include "remote-channel-bundle-manager.h"
 #include "remote-channel-bundle.h"
+#include "sync-profiler.h"
 
 #include <ns3/assert.h>
+#include <ns3/boolean.h>
 #include <ns3/channel.h>
 #include <ns3/double.h>
 #include <ns3/event-impl.h>
 #include <ns3/log.h>
 #include <ns3/node-container.h>
+#include <ns3/nstime.h>
 #include <ns3/pointer.h>
 #include <ns3/ptr.h>
 #include <ns3/scheduler.h>
 #include <ns3/simulator.h>
+#include <ns3/uinteger.h>
 
+#include <chrono>
 #include <cmath>
 #include <fstream>
 #include <iomanip>
@@ -67,7 +72,33 @@ NullMessageSimulatorImpl::GetTypeId()
                           "Null Message scheduler tuning parameter",
                           DoubleValue(1.0),
                           MakeDoubleAccessor(&NullMessageSimulatorImpl::m_schedulerTune),
-                          MakeDoubleChecker<double>(0.01, 1.0));
+                          MakeDoubleChecker<double>(0.01, 1.0))
+            .AddAttribute("DemandDriven",
+                          "Ask the remote tasks for Null Messages when blocked, and send "
+                          "the periodic ones only when asked or NullMessageThreshold behind",
+                          BooleanValue(true),
+                          MakeBooleanAccessor(&NullMessageSimulatorImpl::m_demandDriven),
+                          MakeBooleanChecker())
+            .AddAttribute("NullMessageThreshold",
+                          "Advance of the guarantee time, in delays of the remote channel "
+                          "bundle, above which a periodic Null Message is sent when "
+                          "DemandDriven",
+                          DoubleValue(1.5),
+                          MakeDoubleAccessor(&NullMessageSimulatorImpl::m_nullMessageThreshold),
+                          MakeDoubleChecker<double>(0.0))
+            .AddAttribute("RequestDelay",
+                          "Wall clock time a blocked task waits for the messages on their "
+                          "way before asking for Null Messages, when DemandDriven",
+                          TimeValue(MicroSeconds(100)),
+                          MakeTimeAccessor(&NullMessageSimulatorImpl::m_requestDelay),
+                          MakeTimeChecker(Time(0)))
+            .AddAttribute("CompactionThreshold",
+                          "Number of cancelled events from which they are removed from the "
+                          "event list, once they are half of it; 0 leaves them in the list "
+                          "until they expire",
+                          UintegerValue(1024),
+                          MakeUintegerAccessor(&NullMessageSimulatorImpl::m_compactionThreshold),
+                          MakeUintegerChecker<uint32_t>());
     return tid;
 }
 
@@ -84,6 +115,7 @@ NullMessageSimulatorImpl::NullMessageSimulatorImpl()
     m_currentTs = 0;
     m_currentContext = Simulator::NO_CONTEXT;
     m_unscheduledEvents = 0;
+    m_cancelledEvents = 0;
     m_eventCount = 0;
     m_events = nullptr;
 
@@ -128,6 +160,7 @@ NullMessageSimulatorImpl::Destroy()
         }
     }
 
+    SyncProfiler::Write();
     RemoteChannelBundleManager::Destroy();
     MpiInterface::Destroy();
 }
@@ -234,6 +267,10 @@ NullMessageSimulatorImpl::ProcessOneEvent()
     NS_ASSERT(next.key.m_ts >= m_currentTs);
     m_unscheduledEvents--;
     m_eventCount++;
+    if (m_cancelledEvents > 0 && next.impl->IsCancelled())
+    {
+        m_cancelledEvents--;
+    }
 
     NS_LOG_LOGIC("handle " << next.key.m_ts);
     m_currentTs = next.key.m_ts;
@@ -278,14 +315,18 @@ NullMessageSimulatorImpl::RescheduleNullMessageEvent(Ptr<RemoteChannelBundle> bu
 {
     NS_LOG_FUNCTION(this << bundle);
 
-    Simulator::Cancel(bundle->GetEventId());
-
     Time delay(m_schedulerTune * bundle->GetDelay().GetTimeStep());
 
-    bundle->SetEventId(Simulator::Schedule(delay,
-                                           &NullMessageSimulatorImpl::NullMessageEventHandler,
-                                           this,
-                                           PeekPointer(bundle)));
+    // moved in the event list, rather than cancelled on every send
+    EventId id = Reschedule(bundle->GetEventId(), delay);
+    if (id.IsExpired())
+    {
+        id = Simulator::Schedule(delay,
+                                 &NullMessageSimulatorImpl::NullMessageEventHandler,
+                                 this,
+                                 PeekPointer(bundle));
+    }
+    bundle->SetEventId(id);
 }
 
 void
@@ -308,6 +349,9 @@ NullMessageSimulatorImpl::Run()
 
     RemoteChannelBundleManager::InitializeNullMessageEvents();
 
+    SyncProfiler::Enable(m_myId, m_systemCount);
+    SyncProfiler::StartRun();
+
     // Stop will be set if stop is called by simulation.
     m_stop = false;
     while (!IsFinished())
@@ -319,12 +363,24 @@ NullMessageSimulatorImpl::Run()
             ProcessOneEvent();
             HandleArrivingMessagesNonBlocking();
         }
-        else
+        else if (!m_demandDriven)
         {
             // Block until packet or Null Message has been received.
             HandleArrivingMessagesBlocking();
         }
+        else if (!HandleArrivingMessagesPolling())
+        {
+            // Nothing on its way unblocked this task: ask for Null Messages
+            RemoteChannelBundleManager::RequestNullMessages(Next());
+            HandleArrivingMessagesBlocking();
+        }
+    }
+    if (m_demandDriven)
+    {
+        // The remote tasks may be blocked on the last guarantee time
+        RemoteChannelBundleManager::FlushNullMessages();
     }
+    SyncProfiler::StopRun();
 }
 
 void
@@ -332,12 +388,14 @@ NullMessageSimulatorImpl::HandleArrivingMessagesNonBlocking()
 {
     NS_LOG_FUNCTION(this);
 
+    int64_t start = SyncProfiler::Now();
     NullMessageMpiInterface::ReceiveMessagesNonBlocking();
 
     CalculateSafeTime();
 
     // Check for send completes
     NullMessageMpiInterface::TestSendComplete();
+    SyncProfiler::AddTime(SyncProfiler::EXCHANGE, start);
 }
 
 void
@@ -345,12 +403,35 @@ NullMessageSimulatorImpl::HandleArrivingMessagesBlocking()
 {
     NS_LOG_FUNCTION(this);
 
+    // Every wait for the other ranks is a synchronization round
+    int64_t start = SyncProfiler::Now();
     NullMessageMpiInterface::ReceiveMessagesBlocking();
+    start = SyncProfiler::AddTime(SyncProfiler::WAIT, start);
 
     CalculateSafeTime();
 
     // Check for send completes
     NullMessageMpiInterface::TestSendComplete();
+    SyncProfiler::AddTime(SyncProfiler::EXCHANGE, start);
+    SyncProfiler::RecordRound(Now(), GetSafeTime(), m_eventCount);
+}
+
+bool
+NullMessageSimulatorImpl::HandleArrivingMessagesPolling()
+{
+    NS_LOG_FUNCTION(this);
+
+    auto deadline = std::chrono::steady_clock::now() +
+                    std::chrono::nanoseconds(m_requestDelay.GetNanoSeconds());
+    do
+    {
+        HandleArrivingMessagesNonBlocking();
+        if (Next() <= GetSafeTime())
+        {
+            return true;
+        }
+    } while (std::chrono::steady_clock::now() < deadline);
+    return false;
 }
 
 void
@@ -509,9 +590,62 @@ NullMessageSimulatorImpl::Cancel(const EventId& id)
     if (!IsExpired(id))
     {
         id.PeekEventImpl()->Cancel();
+        if (id.GetUid() != EventId::UID::DESTROY)
+        {
+            m_cancelledEvents++;
+            CompactEvents();
+        }
     }
 }
 
+EventId
+NullMessageSimulatorImpl::Reschedule(const EventId& id, const Time& delay)
+{
+    NS_LOG_FUNCTION(this << delay.GetTimeStep());
+    NS_ASSERT(delay.IsPositive());
+
+    Scheduler::Event ev;
+    ev.impl = id.PeekEventImpl();
+    ev.key.m_ts = id.GetTs();
+    ev.key.m_context = id.GetContext();
+    ev.key.m_uid = id.GetUid();
+    Scheduler::EventKey key;
+    key.m_ts = m_currentTs + delay.GetTimeStep();
+    key.m_context = id.GetContext();
+    key.m_uid = m_uid;
+    if (ev.impl != nullptr && ev.key.m_ts == m_currentTs && ev.key.m_uid == m_currentUid &&
+        !ev.impl->IsCancelled())
+    {
+        // the event being executed, inserted again
+        ev.impl->Ref();
+        m_events->Insert(Scheduler::Event{ev.impl, key});
+        m_unscheduledEvents++;
+    }
+    else if (id.GetUid() != EventId::UID::DESTROY && !IsExpired(id))
+    {
+        m_events->Update(ev, key);
+    }
+    else
+    {
+        return EventId();
+    }
+    m_uid++;
+    return EventId(ev.impl, key.m_ts, key.m_context, key.m_uid);
+}
+
+void
+NullMessageSimulatorImpl::CompactEvents()
+{
+    if (m_compactionThreshold == 0 || m_cancelledEvents < m_compactionThreshold ||
+        2 * m_cancelledEvents <= static_cast<uint32_t>(m_unscheduledEvents))
+    {
+        return;
+    }
+    NS_LOG_LOGIC("remove " << m_cancelledEvents << " cancelled events of " << m_unscheduledEvents);
+    m_unscheduledEvents -= m_events->RemoveCancelled();
+    m_cancelledEvents = 0;
+}
+
 bool
 NullMessageSimulatorImpl::IsExpired(const EventId& id) const
 {
@@ -566,13 +700,28 @@ NullMessageSimulatorImpl::CalculateGuaranteeTime(uint32_t nodeSysId)
     return Min(NullMessageSimulatorImpl::GetInstance()->Next(), GetSafeTime()) + bundle->GetDelay();
 }
 
+Time
+NullMessageSimulatorImpl::CalculateGuaranteeTime(Ptr<RemoteChannelBundle> bundle)
+{
+    Time next = m_events->IsEmpty() ? GetMaximumSimulationTime() : Next();
+    return Min(next, GetSafeTime()) + bundle->GetDelay();
+}
+
 void
 NullMessageSimulatorImpl::NullMessageEventHandler(RemoteChannelBundle* bundle)
 {
     NS_LOG_FUNCTION(this << bundle);
 
     Time time = Min(Next(), GetSafeTime()) + bundle->GetDelay();
-    NullMessageMpiInterface::SendNullMessage(time, bundle);
+    // On demand, skip the Null Message unless the remote task asked for
+    // one, or the last guarantee time sent is well behind
+    Time sent = bundle->GetSentGuaranteeTime();
+    Time threshold(m_nullMessageThreshold * bundle->GetDelay().GetTimeStep());
+    bool requested = !bundle->GetRemoteRequestTime().IsZero() && time > sent;
+    if (!m_demandDriven || requested || time - sent > threshold)
+    {
+        NullMessageMpiInterface::SendNullMessage(time, bundle);
+    }
 
     ScheduleNullMessageEvent(bundle);
 }
@@ -73,6 +73,7 @@ class NullMessageSimulatorImpl : public SimulatorImpl
     EventId ScheduleDestroy(EventImpl* event) override;
     void Remove(const EventId& id) override;
     void Cancel(const EventId& id) override;
+    EventId Reschedule(const EventId& id, const Time& delay) override;
     bool IsExpired(const EventId& id) const override;
     void Run() override;
 
@@ -106,6 +107,14 @@ class NullMessageSimulatorImpl : public SimulatorImpl
      */
     void HandleArrivingMessagesBlocking();
 
+    /**
+     * Receive the messages arriving within the RequestDelay wall clock
+     * time, until the next event is safe.
+     *
+     * \return true if the next event is safe
+     */
+    bool HandleArrivingMessagesPolling();
+
     void DoDispose() override;
 
     /**
@@ -118,6 +127,11 @@ class NullMessageSimulatorImpl : public SimulatorImpl
      * Process the next event on the queue.
      */
     void ProcessOneEvent();
+    /**
+     * Remove the cancelled events from the event list, if they are at
+     * least CompactionThreshold and half of the list.
+     */
+    void CompactEvents();
 
     /**
      * \return next local event time.
@@ -171,6 +185,16 @@ class NullMessageSimulatorImpl : public SimulatorImpl
      */
     Time CalculateGuaranteeTime(uint32_t systemId);
 
+    /**
+     * \param bundle remote channel bundle to compute guarantee time for
+     *
+     * \return Guarantee time
+     *
+     * Calculate the guarantee time for a RemoteChannelBundle, also when
+     * there is no local event left.
+     */
+    Time CalculateGuaranteeTime(Ptr<RemoteChannelBundle> bundle);
+
     /**
      * \param bundle remote channel bundle to schedule an event for.
      *
@@ -205,6 +229,10 @@ class NullMessageSimulatorImpl : public SimulatorImpl
      * not counting the "destroy" events; this is used for validation.
      */
     int m_unscheduledEvents;
+    /** Number of cancelled events in the event list, at most. */
+    uint32_t m_cancelledEvents;
+    /** Smallest number of cancelled events removed from the event list. */
+    uint32_t m_compactionThreshold;
 
     uint32_t m_myId;        /**< MPI rank. */
     uint32_t m_systemCount; /**< MPI communicator size. */
@@ -227,6 +255,26 @@ class NullMessageSimulatorImpl : public SimulatorImpl
      */
     double m_schedulerTune;
 
+    /**
+     * Send the Null Messages on demand: a blocked task asks the remote
+     * tasks holding it back for one, and the periodic Null Messages are
+     * only sent when they carry enough new information.
+     */
+    bool m_demandDriven;
+
+    /**
+     * Advance of the guarantee time since the last message to a remote
+     * task, in delays of its bundle, above which the periodic Null
+     * Message is sent when demand driven.
+     */
+    double m_nullMessageThreshold;
+
+    /**
+     * Wall clock time a blocked task waits for the messages on their way
+     * before asking for Null Messages.
+     */
+    Time m_requestDelay;
+
     /** Singleton instance. */
     static NullMessageSimulatorImpl* g_instance;
 };
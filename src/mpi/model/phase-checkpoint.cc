@@ -0,0 +1,294 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file
+ * \ingroup mpi
+ * Implementation of class ns3::PhaseCheckpoint.
+ */
+
+#include "phase-checkpoint.h"
+
+#include "mpi-interface.h"
+
+#include "ns3/address.h"
+#include "ns3/log.h"
+#include "ns3/net-device.h"
+#include "ns3/node-list.h"
+#include "ns3/node.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-seed-manager.h"
+
+#include <cstring>
+#include <fstream>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("PhaseCheckpoint");
+
+/** Magic of the checkpoint format. */
+static const char CHECKPOINT_MAGIC[8] = "NS3PHCK";
+
+/** Version of the checkpoint format. */
+static const uint32_t CHECKPOINT_VERSION = 1;
+
+/** Header of a checkpoint, followed by the times and the sections. */
+struct CheckpointHeader
+{
+    char magic[8];            //!< CHECKPOINT_MAGIC
+    uint32_t version;         //!< CHECKPOINT_VERSION
+    uint32_t rank;            //!< rank of the checkpoint
+    uint32_t nRanks;          //!< number of ranks
+    uint32_t nPhases;         //!< number of phases of the workload
+    uint32_t nStarts;         //!< number of phase start times
+    uint32_t nEnds;           //!< number of phase end times
+    uint64_t nextStreamIndex; //!< next automatically assigned RNG stream
+    uint64_t fingerprint;     //!< fingerprint of the nodes and devices
+    uint32_t nSections;       //!< number of sections
+    uint32_t reserved;        //!< padding, zero
+};
+
+static_assert(sizeof(CheckpointHeader) == 56, "the checkpoint header layout changed");
+
+/** Header of a section, followed by its name and its contents. */
+struct SectionHeader
+{
+    uint32_t nameLength; //!< length of the name
+    uint32_t length;     //!< length of the contents
+};
+
+std::vector<PhaseCheckpoint::Section> PhaseCheckpoint::g_sections;
+
+void
+PhaseCheckpoint::AddSection(const std::string& name,
+                            Callback<std::string> save,
+                            Callback<void, const std::string&> restore)
+{
+    NS_LOG_FUNCTION(name);
+    for (const Section& section : g_sections)
+    {
+        NS_ABORT_MSG_IF(section.name == name, "checkpoint section " << name << " already added");
+    }
+    g_sections.push_back(Section{name, save, restore});
+}
+
+void
+PhaseCheckpoint::AddStream(const std::string& name, Ptr<RandomVariableStream> stream)
+{
+    NS_LOG_FUNCTION(name << stream);
+    AddSection("stream:" + name,
+               MakeBoundCallback(&PhaseCheckpoint::SaveStream, stream),
+               MakeBoundCallback(&PhaseCheckpoint::RestoreStream, stream));
+}
+
+std::string
+PhaseCheckpoint::SaveStream(Ptr<RandomVariableStream> stream)
+{
+    double state[6];
+    stream->GetStreamState(state);
+    return std::string(reinterpret_cast<const char*>(state), sizeof(state));
+}
+
+void
+PhaseCheckpoint::RestoreStream(Ptr<RandomVariableStream> stream, const std::string& section)
+{
+    double state[6];
+    NS_ABORT_MSG_IF(section.size() != sizeof(state), "wrong size of a stream section");
+    std::memcpy(state, section.data(), sizeof(state));
+    stream->SetStreamState(state);
+}
+
+std::string
+PhaseCheckpoint::GetFileName(const std::string& prefix, uint32_t phase, uint32_t rank)
+{
+    return prefix + "-" + std::to_string(phase) + "-" + std::to_string(rank) + ".ckpt";
+}
+
+void
+PhaseCheckpoint::Reset()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    g_sections.clear();
+}
+
+uint64_t
+PhaseCheckpoint::GetTopologyFingerprint()
+{
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    auto add = [&hash](const uint8_t* data, uint32_t length) {
+        for (uint32_t i = 0; i < length; ++i)
+        {
+            hash = (hash ^ data[i]) * 1099511628211ULL;
+        }
+    };
+    auto addU32 = [&add](uint32_t value) {
+        add(reinterpret_cast<const uint8_t*>(&value), sizeof(value));
+    };
+
+    addU32(NodeList::GetNNodes());
+    for (auto node = NodeList::Begin(); node != NodeList::End(); ++node)
+    {
+        addU32((*node)->GetSystemId());
+        addU32((*node)->GetNDevices());
+        for (uint32_t i = 0; i < (*node)->GetNDevices(); ++i)
+        {
+            Address address = (*node)->GetDevice(i)->GetAddress();
+            uint8_t buffer[Address::MAX_SIZE];
+            uint32_t length = address.CopyTo(buffer);
+            addU32(length);
+            add(buffer, length);
+        }
+    }
+    return hash;
+}
+
+bool
+PhaseCheckpoint::Write(const std::string& name, const Progress& progress)
+{
+    NS_LOG_FUNCTION(name);
+
+    std::vector<std::string> contents;
+    contents.reserve(g_sections.size());
+    for (const Section& section : g_sections)
+    {
+        contents.push_back(section.save());
+    }
+
+    CheckpointHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+    header.version = CHECKPOINT_VERSION;
+    header.rank = MpiInterface::IsEnabled() ? MpiInterface::GetSystemId() : 0;
+    header.nRanks = MpiInterface::IsEnabled() ? MpiInterface::GetSize() : 1;
+    header.nPhases = progress.nPhases;
+    header.nStarts = progress.startTimes.size();
+    header.nEnds = progress.endTimes.size();
+    header.nextStreamIndex = RngSeedManager::PeekNextStreamIndex();
+    header.fingerprint = GetTopologyFingerprint();
+    header.nSections = g_sections.size();
+
+    std::ofstream os(name, std::ios::binary | std::ios::trunc);
+    if (!os)
+    {
+        NS_LOG_WARN("cannot write " << name);
+        return false;
+    }
+    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const std::vector<Time>* times : {&progress.startTimes, &progress.endTimes})
+    {
+        for (const Time& time : *times)
+        {
+            int64_t step = time.GetTimeStep();
+            os.write(reinterpret_cast<const char*>(&step), sizeof(step));
+        }
+    }
+    for (std::size_t i = 0; i < g_sections.size(); ++i)
+    {
+        SectionHeader section{static_cast<uint32_t>(g_sections[i].name.size()),
+                              static_cast<uint32_t>(contents[i].size())};
+        os.write(reinterpret_cast<const char*>(&section), sizeof(section));
+        os.write(g_sections[i].name.data(), section.nameLength);
+        os.write(contents[i].data(), section.length);
+    }
+    return static_cast<bool>(os);
+}
+
+bool
+PhaseCheckpoint::Read(const std::string& name, Progress& progress)
+{
+    NS_LOG_FUNCTION(name);
+
+    std::ifstream is(name, std::ios::binary);
+    CheckpointHeader header;
+    if (!is.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != CHECKPOINT_VERSION)
+    {
+        NS_LOG_WARN(name << " is not a checkpoint");
+        return false;
+    }
+    uint32_t rank = MpiInterface::IsEnabled() ? MpiInterface::GetSystemId() : 0;
+    uint32_t nRanks = MpiInterface::IsEnabled() ? MpiInterface::GetSize() : 1;
+    if (header.rank != rank || header.nRanks != nRanks)
+    {
+        NS_LOG_WARN(name << " is the checkpoint of rank " << header.rank << " of "
+                         << header.nRanks);
+        return false;
+    }
+    if (header.fingerprint != GetTopologyFingerprint())
+    {
+        NS_LOG_WARN(name << " is the checkpoint of another topology");
+        return false;
+    }
+
+    progress.nPhases = header.nPhases;
+    progress.startTimes.clear();
+    progress.endTimes.clear();
+    for (auto [count, times] : {std::make_pair(header.nStarts, &progress.startTimes),
+                                std::make_pair(header.nEnds, &progress.endTimes)})
+    {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            int64_t step;
+            is.read(reinterpret_cast<char*>(&step), sizeof(step));
+            times->push_back(TimeStep(step));
+        }
+    }
+
+    std::vector<std::string> contents(g_sections.size());
+    std::vector<bool> found(g_sections.size(), false);
+    for (uint32_t i = 0; i < header.nSections && is; ++i)
+    {
+        SectionHeader section;
+        is.read(reinterpret_cast<char*>(&section), sizeof(section));
+        std::string sectionName(section.nameLength, '\0');
+        std::string content(section.length, '\0');
+        is.read(&sectionName[0], section.nameLength);
+        is.read(&content[0], section.length);
+        for (std::size_t j = 0; j < g_sections.size(); ++j)
+        {
+            if (g_sections[j].name == sectionName)
+            {
+                contents[j] = std::move(content);
+                found[j] = true;
+                break;
+            }
+        }
+    }
+    if (!is)
+    {
+        NS_LOG_WARN(name << " is truncated");
+        return false;
+    }
+    for (std::size_t j = 0; j < g_sections.size(); ++j)
+    {
+        if (!found[j])
+        {
+            NS_LOG_WARN(name << " has no section " << g_sections[j].name);
+            return false;
+        }
+    }
+
+    RngSeedManager::SetNextStreamIndex(header.nextStreamIndex);
+    for (std::size_t j = 0; j < g_sections.size(); ++j)
+    {
+        g_sections[j].restore(contents[j]);
+    }
+    return true;
+}
+
+} // namespace ns3
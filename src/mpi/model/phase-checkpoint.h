@@ -0,0 +1,175 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file
+ * \ingroup mpi
+ * Declaration of class ns3::PhaseCheckpoint.
+ */
+
+#ifndef NS3_PHASE_CHECKPOINT_H
+#define NS3_PHASE_CHECKPOINT_H
+
+#include "ns3/callback.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+class PhaseEngine;
+class RandomVariableStream;
+
+/**
+ * \ingroup mpi
+ *
+ * \brief Per-rank checkpoint of a phased workload, taken between two
+ * phases
+ *
+ * When a phase is finished on every rank, all its packets have been
+ * received: the devices and their queues are empty, and the only
+ * pending event of the workload should be the start of the next phase.
+ * The pending events are not saved, so the PhaseEngine does not write
+ * the checkpoint, and warns, when any other event is left, including a
+ * Simulator::Stop () scheduled by the script.  The state that carries
+ * over to the next phases is then small:
+ *
+ * - the progress of the PhaseEngine: the start and end times of the
+ *   finished phases, and the start time of the next one;
+ * - the next automatically assigned RNG stream index, so the random
+ *   variables created by the next phases draw the same numbers;
+ * - the position in its stream of every random variable registered with
+ *   AddStream(), so the variables that live across phases go on drawing
+ *   the same numbers;
+ * - a fingerprint of the nodes and devices of the topology, rebuilt by
+ *   the script before restoring, with the routing;
+ * - the sections registered by the script with AddSection(), for the
+ *   progress of its applications.
+ *
+ * The RNG seed and run number are not restored, so parameter sweeps can
+ * fan out of one warmed-up checkpoint.  Any other state that outlives a
+ * phase, such as congestion control or buffer counters, must be idle at
+ * its end or saved by a section.
+ *
+ * PhaseEngine::SetCheckpoint() writes the checkpoints, and
+ * PhaseEngine::Restore() starts a run from one of them.
+ */
+class PhaseCheckpoint
+{
+  public:
+    /**
+     * Register a section of the checkpoints.
+     *
+     * \param name the name of the section, unique
+     * \param save returns the contents of the section
+     * \param restore restores the contents of the section
+     */
+    static void AddSection(const std::string& name,
+                           Callback<std::string> save,
+                           Callback<void, const std::string&> restore);
+
+    /**
+     * Save the position of a random variable that lives across phases,
+     * in a section named after it.  The restoring script registers the
+     * same variable, under the same name, before PhaseEngine::Restore ().
+     *
+     * \param name the name of the variable, unique
+     * \param stream the random variable
+     */
+    static void AddStream(const std::string& name, Ptr<RandomVariableStream> stream);
+
+    /**
+     * \param prefix the file name prefix of the checkpoints
+     * \param phase the index of the phase the checkpoint starts
+     * \param rank the rank
+     * \return the file name of the checkpoint
+     */
+    static std::string GetFileName(const std::string& prefix, uint32_t phase, uint32_t rank);
+
+    /**
+     * Forget the sections.
+     */
+    static void Reset();
+
+  private:
+    /*
+     * The phase engine writes the checkpoints between two phases, and
+     * restores one before Simulator::Run ().
+     */
+    friend ns3::PhaseEngine;
+
+    /** The progress of the PhaseEngine. */
+    struct Progress
+    {
+        uint32_t nPhases;             //!< number of phases of the workload
+        std::vector<Time> startTimes; //!< start time of the finished and next phases
+        std::vector<Time> endTimes;   //!< end time of the finished phases
+    };
+
+    /**
+     * Write the checkpoint of this rank.
+     *
+     * \param name the file name
+     * \param progress the progress of the PhaseEngine
+     * \return false if the file cannot be written
+     */
+    static bool Write(const std::string& name, const Progress& progress);
+
+    /**
+     * Read the checkpoint of this rank and restore its state.
+     *
+     * \param name the file name
+     * \param progress set to the progress of the PhaseEngine
+     * \return false if the file is missing, corrupt, or from another
+     *         topology
+     */
+    static bool Read(const std::string& name, Progress& progress);
+
+    /**
+     * \return the fingerprint of the nodes and devices
+     */
+    static uint64_t GetTopologyFingerprint();
+
+    /**
+     * \param stream the random variable
+     * \return the position of its stream
+     */
+    static std::string SaveStream(Ptr<RandomVariableStream> stream);
+
+    /**
+     * \param stream the random variable
+     * \param section the position of its stream
+     */
+    static void RestoreStream(Ptr<RandomVariableStream> stream, const std::string& section);
+
+    /** A section registered by the script. */
+    struct Section
+    {
+        std::string name;                           //!< name
+        Callback<std::string> save;                 //!< save callback
+        Callback<void, const std::string&> restore; //!< restore callback
+    };
+
+    /** The sections registered by the script. */
+    static std::vector<Section> g_sections;
+};
+
+} // namespace ns3
+
+#endif /* NS3_PHASE_CHECKPOINT_H */
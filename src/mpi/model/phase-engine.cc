@@ -0,0 +1,351 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file
+ * \ingroup mpi
+ * Implementation of class ns3::PhaseEngine.
+ */
+
+#include "phase-engine.h"
+
+#include "distributed-simulator-impl.h"
+#include "hybrid-simulator-impl.h"
+#include "mpi-interface.h"
+#include "phase-checkpoint.h"
+
+#include "ns3/abort.h"
+#include "ns3/assert.h"
+#include "ns3/default-simulator-impl.h"
+#include "ns3/log.h"
+#include "ns3/node-list.h"
+#include "ns3/node.h"
+#include "ns3/simulator-impl.h"
+#include "ns3/simulator.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("PhaseEngine");
+
+uint32_t PhaseEngine::g_nPhases = 0;
+uint32_t PhaseEngine::g_started = 0;
+uint32_t PhaseEngine::g_localDone = 0;
+Time PhaseEngine::g_localDoneTime;
+bool PhaseEngine::g_distributed = false;
+bool PhaseEngine::g_hybrid = false;
+uint32_t PhaseEngine::g_threads = 1;
+uint32_t PhaseEngine::g_threadsRunning = 0;
+std::mutex PhaseEngine::g_doneMutex;
+std::vector<Time> PhaseEngine::g_startTimes;
+std::vector<Time> PhaseEngine::g_endTimes;
+std::string PhaseEngine::g_checkpointPrefix;
+Callback<void, uint32_t> PhaseEngine::g_startCallback;
+Callback<void, uint32_t, Time> PhaseEngine::g_endCallback;
+
+void
+PhaseEngine::SetPhaseStartCallback(Callback<void, uint32_t> cb)
+{
+    g_startCallback = cb;
+}
+
+void
+PhaseEngine::SetPhaseEndCallback(Callback<void, uint32_t, Time> cb)
+{
+    g_endCallback = cb;
+}
+
+void
+PhaseEngine::Start(uint32_t nPhases, Time start)
+{
+    NS_LOG_FUNCTION(nPhases << start);
+    NS_ASSERT(start >= Simulator::Now());
+
+    CheckSimulator();
+    g_nPhases = nPhases;
+    g_started = 0;
+    g_localDone = 0;
+    g_localDoneTime = Simulator::Now();
+    g_startTimes.clear();
+    g_endTimes.clear();
+    if (nPhases > 0)
+    {
+        g_started = 1;
+        g_startTimes.push_back(start);
+        SchedulePhase(start - Simulator::Now(), 0);
+    }
+}
+
+void
+PhaseEngine::SetCheckpoint(const std::string& prefix)
+{
+    NS_LOG_FUNCTION(prefix);
+    g_checkpointPrefix = prefix;
+}
+
+bool
+PhaseEngine::Restore(const std::string& prefix, uint32_t phase)
+{
+    NS_LOG_FUNCTION(prefix << phase);
+
+    uint32_t rank = MpiInterface::IsEnabled() ? MpiInterface::GetSystemId() : 0;
+    PhaseCheckpoint::Progress progress;
+    if (!PhaseCheckpoint::Read(PhaseCheckpoint::GetFileName(prefix, phase, rank), progress))
+    {
+        return false;
+    }
+    if (phase == 0 || phase >= progress.nPhases || progress.startTimes.size() != phase + 1 ||
+        progress.endTimes.size() != phase || progress.startTimes[phase] < Simulator::Now())
+    {
+        NS_LOG_WARN("inconsistent checkpoint of phase " << phase);
+        return false;
+    }
+
+    CheckSimulator();
+    g_nPhases = progress.nPhases;
+    g_started = phase + 1;
+    g_localDone = phase;
+    g_localDoneTime = progress.endTimes.back();
+    g_startTimes = progress.startTimes;
+    g_endTimes = progress.endTimes;
+    Time start = g_startTimes[phase];
+    SchedulePhase(start - Simulator::Now(), phase);
+    return true;
+}
+
+void
+PhaseEngine::NotifyLocalDone()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    std::unique_lock<std::mutex> lock(g_doneMutex);
+    NS_ASSERT_MSG(g_localDone < g_started && g_threadsRunning > 0,
+                  "phase " << g_localDone << " is already done");
+
+    // The time the last thread is done
+    g_localDoneTime = Max(g_localDoneTime, Simulator::Now());
+    if (--g_threadsRunning > 0)
+    {
+        return;
+    }
+    g_localDone++;
+    lock.unlock();
+    if (!g_distributed)
+    {
+        EndPhase(g_localDoneTime, g_localDoneTime);
+    }
+}
+
+uint32_t
+PhaseEngine::GetPhase()
+{
+    return g_started > 0 ? g_started - 1 : 0;
+}
+
+uint32_t
+PhaseEngine::GetNPhases()
+{
+    return g_nPhases;
+}
+
+Time
+PhaseEngine::GetPhaseStart(uint32_t phase)
+{
+    NS_ASSERT(phase < g_startTimes.size());
+    return g_startTimes[phase];
+}
+
+Time
+PhaseEngine::GetPhaseEnd(uint32_t phase)
+{
+    NS_ASSERT(phase < g_endTimes.size());
+    return g_endTimes[phase];
+}
+
+void
+PhaseEngine::Reset()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    g_nPhases = 0;
+    g_started = 0;
+    g_localDone = 0;
+    g_localDoneTime = Time();
+    g_threads = 1;
+    g_threadsRunning = 0;
+    g_startTimes.clear();
+    g_endTimes.clear();
+    g_checkpointPrefix.clear();
+    g_startCallback = MakeNullCallback<void, uint32_t>();
+    g_endCallback = MakeNullCallback<void, uint32_t, Time>();
+}
+
+uint32_t
+PhaseEngine::GetLocalDone()
+{
+    return g_localDone;
+}
+
+Time
+PhaseEngine::GetLocalDoneTime()
+{
+    return g_localDoneTime;
+}
+
+bool
+PhaseEngine::Synchronize(const LbtsMessage& global, Time& start)
+{
+    if (g_endTimes.size() == g_started)
+    {
+        return false;
+    }
+    // The current phase is over when every rank has finished it; its end
+    // is the latest local end, and the next phase cannot start before
+    // the current time of any rank.
+    if (global.GetPhaseCount() < g_started)
+    {
+        return false;
+    }
+    Time end = global.GetPhaseTime();
+    start = Max(global.GetNow(), end);
+    return EndPhase(end, start);
+}
+
+bool
+PhaseEngine::EndPhase(Time end, Time start)
+{
+    NS_LOG_FUNCTION(end << start);
+
+    uint32_t phase = g_started - 1;
+    g_endTimes.push_back(end);
+    Time fct = end - g_startTimes[phase];
+    NS_LOG_INFO("phase " << phase << " done, FCT " << fct.As(Time::S));
+    if (!g_endCallback.IsNull())
+    {
+        g_endCallback(phase, fct);
+    }
+    if (g_started == g_nPhases)
+    {
+        return false;
+    }
+    g_started++;
+    g_startTimes.push_back(start);
+    SchedulePhase(start - Simulator::Now(), phase + 1);
+    if (!g_checkpointPrefix.empty())
+    {
+        WriteCheckpoint(phase + 1);
+    }
+    return true;
+}
+
+void
+PhaseEngine::WriteCheckpoint(uint32_t phase)
+{
+    NS_LOG_FUNCTION(phase);
+
+    uint32_t rank = MpiInterface::IsEnabled() ? MpiInterface::GetSystemId() : 0;
+    std::string name = PhaseCheckpoint::GetFileName(g_checkpointPrefix, phase, rank);
+
+    // The only pending events should be the starts of the next phase, one
+    // per thread.  The cancelled events are dropped first so they are not
+    // counted; during the synchronization the other threads wait.
+    Ptr<SimulatorImpl> impl = Simulator::GetImplementation();
+    uint32_t pending = g_threads;
+    if (Ptr<DistributedSimulatorImpl> distributed = DynamicCast<DistributedSimulatorImpl>(impl))
+    {
+        pending = distributed->RemoveCancelledEvents();
+    }
+    else if (Ptr<DefaultSimulatorImpl> local = DynamicCast<DefaultSimulatorImpl>(impl))
+    {
+        pending = local->RemoveCancelledEvents();
+    }
+    else
+    {
+        NS_LOG_WARN("cannot count the pending events of " << impl->GetInstanceTypeId().GetName()
+                                                          << ", writing " << name << " anyway");
+    }
+    if (pending > g_threads)
+    {
+        NS_LOG_WARN("not writing the checkpoint " << name << ": " << pending - g_threads
+                                                  << " events are pending besides phase "
+                                                  << phase);
+        return;
+    }
+
+    if (!PhaseCheckpoint::Write(name, {g_nPhases, g_startTimes, g_endTimes}))
+    {
+        NS_LOG_WARN("cannot write the checkpoint " << name);
+    }
+}
+
+void
+PhaseEngine::CheckSimulator()
+{
+    // HybridSimulatorImpl and any other subclass exchange the LBTS too;
+    // IsChildOf excludes the class itself
+    TypeId tid = Simulator::GetImplementation()->GetInstanceTypeId();
+    g_distributed = tid == DistributedSimulatorImpl::GetTypeId() ||
+                    tid.IsChildOf(DistributedSimulatorImpl::GetTypeId());
+    g_hybrid = tid == HybridSimulatorImpl::GetTypeId() ||
+               tid.IsChildOf(HybridSimulatorImpl::GetTypeId());
+    NS_ABORT_MSG_IF(!g_distributed && MpiInterface::IsEnabled() && MpiInterface::GetSize() > 1,
+                    "PhaseEngine requires ns3::DistributedSimulatorImpl");
+}
+
+void
+PhaseEngine::SchedulePhase(Time delay, uint32_t phase)
+{
+    NS_LOG_FUNCTION(delay << phase);
+
+    // Under HybridSimulatorImpl the start runs on every thread with nodes
+    // of this rank, in the context of its first node; it is scheduled
+    // before Run() or while the other threads wait for the next window.
+    std::lock_guard<std::mutex> lock(g_doneMutex);
+    g_threads = 0;
+    if (g_hybrid)
+    {
+        uint32_t rank = MpiInterface::IsEnabled() ? MpiInterface::GetSystemId() : 0;
+        std::vector<bool> started(HybridSimulatorImpl::GetNThreads(), false);
+        for (auto node = NodeList::Begin(); node != NodeList::End(); ++node)
+        {
+            uint32_t thread = HybridSimulatorImpl::GetThread((*node)->GetId());
+            if ((*node)->GetSystemId() == rank && !started[thread])
+            {
+                started[thread] = true;
+                g_threads++;
+                Simulator::ScheduleWithContext((*node)->GetId(),
+                                               delay,
+                                               &PhaseEngine::StartPhase,
+                                               phase);
+            }
+        }
+    }
+    if (g_threads == 0)
+    {
+        g_threads = 1;
+        Simulator::Schedule(delay, &PhaseEngine::StartPhase, phase);
+    }
+    g_threadsRunning = g_threads;
+}
+
+void
+PhaseEngine::StartPhase(uint32_t phase)
+{
+    NS_LOG_FUNCTION(phase);
+    if (!g_startCallback.IsNull())
+    {
+        g_startCallback(phase);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,253 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file
+ * \ingroup mpi
+ * Declaration of class ns3::PhaseEngine.
+ */
+
+#ifndef NS3_PHASE_ENGINE_H
+#define NS3_PHASE_ENGINE_H
+
+#include "ns3/callback.h"
+#include "ns3/nstime.h"
+
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+class DistributedSimulatorImpl;
+class LbtsMessage;
+
+/**
+ * \ingroup mpi
+ *
+ * \brief Run a workload made of consecutive phases inside one
+ * Simulator::Run ()
+ *
+ * A phase is finished when every rank has called NotifyLocalDone() for
+ * it.  Under DistributedSimulatorImpl the ranks report their progress
+ * in the LBTS messages they already reduce at every synchronization,
+ * so no extra collective is needed: once all ranks are done, every rank
+ * computes the same start time for the next phase, no earlier than the
+ * current time of any rank, and schedules the phase start callback at
+ * that time.  In a sequential simulation the next phase starts as soon
+ * as the current one is done.
+ *
+ * The duration of a phase (its FCT) runs from its start to the last
+ * NotifyLocalDone() of any rank.  The phase end callback receives it on
+ * every rank; it is invoked outside of any event while the ranks
+ * synchronize, so it should only record or report.
+ *
+ * Under HybridSimulatorImpl the phase start callback is invoked on
+ * every thread that simulates nodes of the rank, in the context of one
+ * of them, so that each thread creates the applications of its own
+ * nodes; each of these threads then calls NotifyLocalDone() once, and
+ * the rank is done with the phase when the last one has.
+ *
+ * Every rank can write a PhaseCheckpoint between two phases, and a
+ * later run can restart from one instead of the first phase.
+ *
+ * The NullMessageSimulatorImpl is not supported.
+ */
+class PhaseEngine
+{
+  public:
+    /**
+     * \param cb invoked on every rank at the start of each phase, with
+     *        the index of the phase
+     */
+    static void SetPhaseStartCallback(Callback<void, uint32_t> cb);
+
+    /**
+     * \param cb invoked on every rank once a phase is finished, with the
+     *        index of the phase and its duration
+     */
+    static void SetPhaseEndCallback(Callback<void, uint32_t, Time> cb);
+
+    /**
+     * Schedule the first phase.  Must be invoked on every rank before
+     * Simulator::Run ().
+     *
+     * \param nPhases the number of phases
+     * \param start the start time of the first phase
+     */
+    static void Start(uint32_t nPhases, Time start = Seconds(0));
+
+    /**
+     * Write the checkpoint of this rank at the end of every phase but
+     * the last, to PhaseCheckpoint::GetFileName (prefix, next phase,
+     * rank).  Must be invoked before Simulator::Run ().
+     *
+     * A checkpoint is not written when an event other than the start
+     * of the next phase is pending, since the events are not saved: a
+     * Simulator::Stop () with a delay counts too.
+     *
+     * \param prefix the file name prefix of the checkpoints, empty to
+     *        disable them
+     */
+    static void SetCheckpoint(const std::string& prefix);
+
+    /**
+     * Restore the checkpoint of this rank taken before a phase, and
+     * schedule that phase at its original start time.  Used instead of
+     * Start(), on every rank, once the topology and the applications are
+     * built and the checkpoint sections added.
+     *
+     * \param prefix the file name prefix of the checkpoints
+     * \param phase the index of the phase to restart from
+     * \return false if the checkpoint cannot be restored
+     */
+    static bool Restore(const std::string& prefix, uint32_t phase);
+
+    /**
+     * Report that this rank has finished the current phase.  Must be
+     * invoked once per phase, and under HybridSimulatorImpl once by
+     * every thread the phase started on.
+     */
+    static void NotifyLocalDone();
+
+    /**
+     * \return the index of the current phase
+     */
+    static uint32_t GetPhase();
+
+    /**
+     * \return the number of phases
+     */
+    static uint32_t GetNPhases();
+
+    /**
+     * \param phase the index of a started phase
+     * \return the start time of the phase
+     */
+    static Time GetPhaseStart(uint32_t phase);
+
+    /**
+     * \param phase the index of a finished phase
+     * \return the time the last rank finished the phase
+     */
+    static Time GetPhaseEnd(uint32_t phase);
+
+    /**
+     * Forget the phases and the callbacks.
+     */
+    static void Reset();
+
+  private:
+    /*
+     * The distributed simulator carries the progress of the phases in
+     * its LBTS messages.
+     */
+    friend ns3::DistributedSimulatorImpl;
+
+    /**
+     * \return the number of phases this rank has finished
+     */
+    static uint32_t GetLocalDone();
+
+    /**
+     * \return the time this rank finished its last phase
+     */
+    static Time GetLocalDoneTime();
+
+    /**
+     * Check the reduced LBTS message of all the ranks for a finished
+     * phase and schedule the next one.
+     *
+     * \param global the reduction of the LBTS messages of all the ranks:
+     *        the fewest phases finished, the latest phase end and the
+     *        latest current time
+     * \param start set to the start time of the next phase
+     * \return true if a phase was scheduled
+     */
+    static bool Synchronize(const LbtsMessage& global, Time& start);
+
+    /**
+     * Record the end of the current phase and schedule the next one.
+     *
+     * \param end the time the last rank finished the phase
+     * \param start the start time of the next phase
+     * \return true if a phase was scheduled
+     */
+    static bool EndPhase(Time end, Time start);
+
+    /**
+     * Start a phase.
+     *
+     * \param phase the index of the phase
+     */
+    static void StartPhase(uint32_t phase);
+
+    /**
+     * Write the checkpoint taken before a phase, unless events other
+     * than its start are pending.
+     *
+     * \param phase the index of the next phase
+     */
+    static void WriteCheckpoint(uint32_t phase);
+
+    /**
+     * Schedule the start of a phase, on every thread of the rank with
+     * nodes under HybridSimulatorImpl.
+     *
+     * \param delay the delay until the phase starts
+     * \param phase the index of the phase
+     */
+    static void SchedulePhase(Time delay, uint32_t phase);
+
+    /**
+     * Determine the simulator implementation.
+     */
+    static void CheckSimulator();
+
+    /** Number of phases of the workload. */
+    static uint32_t g_nPhases;
+    /** Number of phases started, the current one included. */
+    static uint32_t g_started;
+    /** Number of phases this rank has finished. */
+    static uint32_t g_localDone;
+    /** Time this rank finished its last phase. */
+    static Time g_localDoneTime;
+    /** Is the simulator the distributed granted time window one. */
+    static bool g_distributed;
+    /** Does the simulator run the nodes of a rank on several threads. */
+    static bool g_hybrid;
+    /** Number of threads the current phase started on. */
+    static uint32_t g_threads;
+    /** Number of threads not done with the current phase. */
+    static uint32_t g_threadsRunning;
+    /** Serializes NotifyLocalDone() between the threads. */
+    static std::mutex g_doneMutex;
+    /** Start time of every started phase. */
+    static std::vector<Time> g_startTimes;
+    /** End time of every finished phase. */
+    static std::vector<Time> g_endTimes;
+    /** File name prefix of the checkpoints, empty if disabled. */
+    static std::string g_checkpointPrefix;
+    /** Phase start callback. */
+    static Callback<void, uint32_t> g_startCallback;
+    /** Phase end callback. */
+    static Callback<void, uint32_t, Time> g_endCallback;
+};
+
+} // namespace ns3
+
+#endif /* NS3_PHASE_ENGINE_H */
@@ -26,6 +26,7 @@
 
 #include "remote-channel-bundle-manager.h"
 
+#include "null-message-mpi-interface.h"
 #include "null-message-simulator-impl.h"
 #include "remote-channel-bundle.h"
 
@@ -108,6 +109,54 @@ RemoteChannelBundleManager::GetSafeTime()
     return safeTime;
 }
 
+void
+RemoteChannelBundleManager::RequestNullMessages(const Time& next)
+{
+    NS_ASSERT(g_initialized);
+
+    NullMessageSimulatorImpl* simulator = NullMessageSimulatorImpl::GetInstance();
+    for (const auto& kv : g_remoteChannelBundles)
+    {
+        Ptr<RemoteChannelBundle> bundle = kv.second;
+        Time guarantee =
+            Max(simulator->CalculateGuaranteeTime(bundle), bundle->GetSentGuaranteeTime());
+        bool answer = !bundle->GetRemoteRequestTime().IsZero() &&
+                      guarantee > bundle->GetSentGuaranteeTime();
+        if (bundle->GetGuaranteeTime() < next)
+        {
+            // The request carries the guarantee time, and answers the
+            // remote task if it is blocked on this task too
+            if (bundle->GetLocalRequestTime() != next || answer)
+            {
+                NullMessageMpiInterface::RequestNullMessage(guarantee, next, bundle);
+            }
+        }
+        else if (answer)
+        {
+            // Blocked, this task cannot wait for its guarantee time to
+            // reach the request of the remote task
+            NullMessageMpiInterface::SendNullMessage(guarantee, bundle);
+        }
+    }
+}
+
+void
+RemoteChannelBundleManager::FlushNullMessages()
+{
+    NS_ASSERT(g_initialized);
+
+    NullMessageSimulatorImpl* simulator = NullMessageSimulatorImpl::GetInstance();
+    for (const auto& kv : g_remoteChannelBundles)
+    {
+        Ptr<RemoteChannelBundle> bundle = kv.second;
+        Time guarantee = simulator->CalculateGuaranteeTime(bundle);
+        if (guarantee > bundle->GetSentGuaranteeTime())
+        {
+            NullMessageMpiInterface::SendNullMessage(guarantee, bundle);
+        }
+    }
+}
+
 void
 RemoteChannelBundleManager::Destroy()
 {
@@ -83,6 +83,21 @@ class RemoteChannelBundleManager
      */
     static Time GetSafeTime();
 
+    /**
+     * Before blocking, ask the remote tasks holding the safe time back
+     * for the guarantee time of the next local event, once per event, and
+     * send the guarantee time to the remote tasks waiting for this one.
+     *
+     * \param [in] next The time of the next local event.
+     */
+    static void RequestNullMessages(const Time& next);
+
+    /**
+     * Send the guarantee time to every remote task it was not sent to
+     * yet, before leaving the simulation loop.
+     */
+    static void FlushNullMessages();
+
     /** Destroy the singleton. */
     static void Destroy();
 
@@ -47,6 +47,9 @@ RemoteChannelBundle::GetTypeId()
 RemoteChannelBundle::RemoteChannelBundle()
     : m_remoteSystemId(UINT32_MAX),
       m_guaranteeTime(0),
+      m_sentGuaranteeTime(0),
+      m_remoteRequestTime(0),
+      m_localRequestTime(0),
       m_delay(Time::Max())
 {
 }
@@ -54,6 +57,9 @@ RemoteChannelBundle::RemoteChannelBundle()
 RemoteChannelBundle::RemoteChannelBundle(const uint32_t remoteSystemId)
     : m_remoteSystemId(remoteSystemId),
       m_guaranteeTime(0),
+      m_sentGuaranteeTime(0),
+      m_remoteRequestTime(0),
+      m_localRequestTime(0),
       m_delay(Time::Max())
 {
 }
@@ -85,6 +91,42 @@ RemoteChannelBundle::SetGuaranteeTime(Time time)
     m_guaranteeTime = time;
 }
 
+Time
+RemoteChannelBundle::GetSentGuaranteeTime() const
+{
+    return m_sentGuaranteeTime;
+}
+
+void
+RemoteChannelBundle::SetSentGuaranteeTime(Time time)
+{
+    m_sentGuaranteeTime = time;
+}
+
+Time
+RemoteChannelBundle::GetRemoteRequestTime() const
+{
+    return m_remoteRequestTime;
+}
+
+void
+RemoteChannelBundle::SetRemoteRequestTime(Time time)
+{
+    m_remoteRequestTime = time;
+}
+
+Time
+RemoteChannelBundle::GetLocalRequestTime() const
+{
+    return m_localRequestTime;
+}
+
+void
+RemoteChannelBundle::SetLocalRequestTime(Time time)
+{
+    m_localRequestTime = time;
+}
+
 Time
 RemoteChannelBundle::GetDelay() const
 {
@@ -98,6 +98,47 @@ class RemoteChannelBundle : public Object
      */
     void SetGuaranteeTime(Time time);
 
+    /**
+     * Get the last guarantee time sent to the remote task, with a packet
+     * or a Null Message.
+     * \return sent guarantee time
+     */
+    Time GetSentGuaranteeTime() const;
+
+    /**
+     * Set the last guarantee time sent to the remote task.
+     *
+     * \param time The guarantee time.
+     */
+    void SetSentGuaranteeTime(Time time);
+
+    /**
+     * Get the guarantee time the blocked remote task asked for and was
+     * not sent yet.
+     * \return requested guarantee time, zero if none
+     */
+    Time GetRemoteRequestTime() const;
+
+    /**
+     * Set the guarantee time the remote task asked for.
+     *
+     * \param time The requested guarantee time, zero once sent.
+     */
+    void SetRemoteRequestTime(Time time);
+
+    /**
+     * Get the guarantee time this task last asked the remote task for.
+     * \return requested guarantee time, zero if none
+     */
+    Time GetLocalRequestTime() const;
+
+    /**
+     * Set the guarantee time this task asked the remote task for.
+     *
+     * \param time The requested guarantee time.
+     */
+    void SetLocalRequestTime(Time time);
+
     /**
      * Get the minimum delay along any channel in this bundle
      * \return The minimum delay.
@@ -161,6 +202,15 @@ class RemoteChannelBundle : public Object
      */
     Time m_guaranteeTime;
 
+    /** Last guarantee time sent to the remote task. */
+    Time m_sentGuaranteeTime;
+
+    /** Guarantee time the blocked remote task asked for. */
+    Time m_remoteRequestTime;
+
+    /** Guarantee time this task asked the remote task for. */
+    Time m_localRequestTime;
+
     /**
      * Delay for this Channel bundle, which is
      * the min link delay over all incoming channels;
@@ -0,0 +1,277 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file
+ * \ingroup mpi
+ * Implementation of class ns3::SyncProfiler.
+ */
+
+#include "sync-profiler.h"
+
+#include "ns3/global-value.h"
+#include "ns3/log.h"
+#include "ns3/string.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("SyncProfiler");
+
+/**
+ * \ingroup mpi
+ * \anchor GlobalValueMpiSyncProfile
+ * The file name prefix of the synchronization profiles of the ranks,
+ * empty to disable the profiler.
+ *
+ * This is accessible as "--MpiSyncProfile" from CommandLine.
+ */
+static GlobalValue g_profileValue("MpiSyncProfile",
+                                  "The file name prefix of the synchronization profile of "
+                                  "every rank, empty to disable the profiler",
+                                  StringValue(""),
+                                  MakeStringChecker());
+
+bool SyncProfiler::g_enabled = false;
+std::string SyncProfiler::g_prefix;
+uint32_t SyncProfiler::g_rank = 0;
+int64_t SyncProfiler::g_runStart = 0;
+int64_t SyncProfiler::g_runTime = 0;
+int64_t SyncProfiler::g_time[SyncProfiler::CATEGORY_COUNT];
+uint64_t SyncProfiler::g_rounds = 0;
+uint64_t SyncProfiler::g_events = 0;
+bool SyncProfiler::g_open = false;
+SyncProfiler::Histogram SyncProfiler::g_windows;
+SyncProfiler::Histogram SyncProfiler::g_windowEvents;
+std::vector<SyncProfiler::Peer> SyncProfiler::g_peers;
+
+void
+SyncProfiler::Histogram::Add(uint64_t value)
+{
+    min = count ? std::min(min, value) : value;
+    max = count ? std::max(max, value) : value;
+    count++;
+    sum += value;
+    std::size_t bucket = 0;
+    while (value)
+    {
+        value >>= 1;
+        bucket++;
+    }
+    if (buckets.size() <= bucket)
+    {
+        buckets.resize(bucket + 1, 0);
+    }
+    buckets[bucket]++;
+}
+
+void
+SyncProfiler::Enable(uint32_t rank, uint32_t size)
+{
+    NS_LOG_FUNCTION(rank << size);
+
+    StringValue prefix;
+    g_profileValue.GetValue(prefix);
+    if (g_enabled || prefix.Get().empty())
+    {
+        return;
+    }
+    g_enabled = true;
+    g_prefix = prefix.Get();
+    g_rank = rank;
+    g_runStart = 0;
+    g_runTime = 0;
+    for (int64_t& time : g_time)
+    {
+        time = 0;
+    }
+    g_rounds = 0;
+    g_events = 0;
+    g_open = false;
+    g_windows = Histogram{0, 0, 0, 0, {}};
+    g_windowEvents = Histogram{0, 0, 0, 0, {}};
+    g_peers.assign(size, Peer{0, 0, 0, 0, 0});
+}
+
+int64_t
+SyncProfiler::Now()
+{
+    if (!g_enabled)
+    {
+        return 0;
+    }
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+int64_t
+SyncProfiler::AddTime(Category category, int64_t start)
+{
+    if (!g_enabled)
+    {
+        return 0;
+    }
+    int64_t now = Now();
+    g_time[category] += now - start;
+    return now;
+}
+
+void
+SyncProfiler::StartRun()
+{
+    g_runStart = Now();
+}
+
+void
+SyncProfiler::StopRun()
+{
+    if (g_enabled)
+    {
+        g_runTime += Now() - g_runStart;
+    }
+}
+
+void
+SyncProfiler::RecordRound(const Time& now, const Time& end, uint64_t events)
+{
+    if (!g_enabled)
+    {
+        return;
+    }
+    g_rounds++;
+    if (g_open)
+    {
+        g_windowEvents.Add(events - g_events);
+    }
+    // The last rounds grant everything, or nothing once stopped
+    g_open = end > now && end != Time::Max();
+    if (g_open)
+    {
+        g_windows.Add((end - now).GetNanoSeconds());
+    }
+    g_events = events;
+}
+
+void
+SyncProfiler::RecordSend(uint32_t peer, uint32_t bytes)
+{
+    if (g_enabled)
+    {
+        g_peers[peer].txPackets++;
+        g_peers[peer].txBytes += bytes;
+    }
+}
+
+void
+SyncProfiler::RecordReceive(uint32_t peer, uint32_t bytes)
+{
+    if (g_enabled)
+    {
+        g_peers[peer].rxPackets++;
+        g_peers[peer].rxBytes += bytes;
+    }
+}
+
+void
+SyncProfiler::RecordNullMessage(uint32_t peer)
+{
+    if (g_enabled)
+    {
+        g_peers[peer].txNullMessages++;
+    }
+}
+
+void
+SyncProfiler::WriteHistogram(std::ostream& os, const Histogram& histogram)
+{
+    os << "{\"count\": " << histogram.count << ", \"min\": " << histogram.min
+       << ", \"max\": " << histogram.max << ", \"mean\": "
+       << (histogram.count ? double(histogram.sum) / histogram.count : 0.0)
+       << ", \"log2Buckets\": [";
+    for (std::size_t i = 0; i < histogram.buckets.size(); ++i)
+    {
+        os << (i ? ", " : "") << histogram.buckets[i];
+    }
+    os << "]}";
+}
+
+void
+SyncProfiler::Write()
+{
+    NS_LOG_FUNCTION_NOARGS();
+
+    if (!g_enabled)
+    {
+        return;
+    }
+    g_enabled = false;
+
+    Peer total{0, 0, 0, 0, 0};
+    for (const Peer& peer : g_peers)
+    {
+        total.txPackets += peer.txPackets;
+        total.txBytes += peer.txBytes;
+        total.rxPackets += peer.rxPackets;
+        total.rxBytes += peer.rxBytes;
+        total.txNullMessages += peer.txNullMessages;
+    }
+    int64_t compute = g_runTime - g_time[EXCHANGE] - g_time[WAIT];
+    StringValue simulator;
+    GlobalValue::GetValueByNameFailSafe("SimulatorImplementationType", simulator);
+
+    std::string name = g_prefix + "-" + std::to_string(g_rank);
+    std::ofstream json(name + ".json");
+    if (!json)
+    {
+        NS_LOG_WARN("cannot write " << name << ".json");
+        return;
+    }
+    json << "{\n"
+         << "  \"rank\": " << g_rank << ",\n"
+         << "  \"ranks\": " << g_peers.size() << ",\n"
+         << "  \"simulator\": \"" << simulator.Get() << "\",\n"
+         << "  \"rounds\": " << g_rounds << ",\n"
+         << "  \"events\": " << g_events << ",\n"
+         << "  \"runSeconds\": " << g_runTime * 1e-9 << ",\n"
+         << "  \"computeSeconds\": " << compute * 1e-9 << ",\n"
+         << "  \"exchangeSeconds\": " << g_time[EXCHANGE] * 1e-9 << ",\n"
+         << "  \"waitSeconds\": " << g_time[WAIT] * 1e-9 << ",\n"
+         << "  \"txPackets\": " << total.txPackets << ",\n"
+         << "  \"txBytes\": " << total.txBytes << ",\n"
+         << "  \"rxPackets\": " << total.rxPackets << ",\n"
+         << "  \"rxBytes\": " << total.rxBytes << ",\n"
+         << "  \"txNullMessages\": " << total.txNullMessages << ",\n"
+         << "  \"windowNs\": ";
+    WriteHistogram(json, g_windows);
+    json << ",\n  \"eventsPerWindow\": ";
+    WriteHistogram(json, g_windowEvents);
+    json << "\n}\n";
+
+    std::ofstream csv(name + ".csv");
+    csv << "rank,peer,txPackets,txBytes,rxPackets,rxBytes,txNullMessages\n";
+    for (std::size_t i = 0; i < g_peers.size(); ++i)
+    {
+        const Peer& peer = g_peers[i];
+        csv << g_rank << "," << i << "," << peer.txPackets << "," << peer.txBytes << ","
+            << peer.rxPackets << "," << peer.rxBytes << "," << peer.txNullMessages << "\n";
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,188 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file
+ * \ingroup mpi
+ * Declaration of class ns3::SyncProfiler.
+ */
+
+#ifndef NS3_SYNC_PROFILER_H
+#define NS3_SYNC_PROFILER_H
+
+#include "ns3/nstime.h"
+
+#include <ostream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup mpi
+ *
+ * \brief Per-rank profile of the synchronization of a distributed run
+ *
+ * The profiler is enabled by the MpiSyncProfile global value, the file
+ * name prefix of the profiles.  The parallel simulators record every
+ * synchronization round: the length of the window it opens, the events
+ * processed since the previous round, and the wall clock time spent
+ * exchanging the packets and blocked waiting for the other ranks; the
+ * rest of the run is the event processing.  The MPI interfaces record
+ * the packets and the serialized bytes sent to and received from every
+ * peer, and the Null Messages sent to it.
+ *
+ * Destroy() writes the profile of the rank to <prefix>-<rank>.json, and
+ * the counters of every peer to <prefix>-<rank>.csv.  The script
+ * src/mpi/examples/sync-profile-report.py merges the profiles of all the
+ * ranks and names the rank on the critical path.
+ */
+class SyncProfiler
+{
+  public:
+    /** The wall clock time spent synchronizing. */
+    enum Category
+    {
+        EXCHANGE, //!< Sending and receiving the packets of the other ranks
+        WAIT,     //!< Blocked in the LBTS reduction, or waiting for a message
+        CATEGORY_COUNT
+    };
+
+    /**
+     * Start profiling if the MpiSyncProfile global value is set, and not
+     * already started.
+     *
+     * \param rank the rank of this process
+     * \param size the number of ranks
+     */
+    static void Enable(uint32_t rank, uint32_t size);
+    /**
+     * \return true if profiling
+     */
+    static bool IsEnabled();
+    /**
+     * \return the wall clock time in nanoseconds, 0 if not profiling
+     */
+    static int64_t Now();
+    /**
+     * Add the wall clock time elapsed since \p start to a category.
+     *
+     * \param category the category
+     * \param start the start time, from Now()
+     * \return the current time, to chain the categories
+     */
+    static int64_t AddTime(Category category, int64_t start);
+    /**
+     * Start timing a Run().
+     */
+    static void StartRun();
+    /**
+     * Stop timing a Run().
+     */
+    static void StopRun();
+    /**
+     * Record a synchronization round.
+     *
+     * \param now the current simulation time
+     * \param end the end of the window granted by the round
+     * \param events the number of events processed so far
+     */
+    static void RecordRound(const Time& now, const Time& end, uint64_t events);
+    /**
+     * Record a packet sent to another rank.
+     *
+     * \param peer the destination rank
+     * \param bytes the serialized size of the packet
+     */
+    static void RecordSend(uint32_t peer, uint32_t bytes);
+    /**
+     * Record a packet received from another rank.
+     *
+     * \param peer the source rank
+     * \param bytes the serialized size of the packet
+     */
+    static void RecordReceive(uint32_t peer, uint32_t bytes);
+    /**
+     * Record a Null Message sent to another rank.
+     *
+     * \param peer the destination rank
+     */
+    static void RecordNullMessage(uint32_t peer);
+    /**
+     * Write the profile of this rank, and stop profiling.
+     */
+    static void Write();
+
+  private:
+    /** A distribution with power of two buckets. */
+    struct Histogram
+    {
+        /**
+         * Add a value.
+         *
+         * \param value the value
+         */
+        void Add(uint64_t value);
+
+        uint64_t count;                //!< number of values
+        uint64_t sum;                  //!< sum of the values
+        uint64_t min;                  //!< smallest value
+        uint64_t max;                  //!< largest value
+        std::vector<uint64_t> buckets; //!< values in [2^(i-1), 2^i), 0 in the first
+    };
+
+    /** The counters of a peer. */
+    struct Peer
+    {
+        uint64_t txPackets;      //!< packets sent
+        uint64_t txBytes;        //!< bytes sent
+        uint64_t rxPackets;      //!< packets received
+        uint64_t rxBytes;        //!< bytes received
+        uint64_t txNullMessages; //!< Null Messages sent
+    };
+
+    /**
+     * Write a histogram as a JSON object.
+     *
+     * \param os the stream
+     * \param histogram the histogram
+     */
+    static void WriteHistogram(std::ostream& os, const Histogram& histogram);
+
+    static bool g_enabled;                 //!< profiling
+    static std::string g_prefix;           //!< file name prefix
+    static uint32_t g_rank;                //!< rank of this process
+    static int64_t g_runStart;             //!< start of the current Run()
+    static int64_t g_runTime;              //!< time spent in Run()
+    static int64_t g_time[CATEGORY_COUNT]; //!< time spent synchronizing
+    static uint64_t g_rounds;              //!< synchronization rounds
+    static uint64_t g_events;              //!< events at the last round
+    static bool g_open;                    //!< the last round opened a window
+    static Histogram g_windows;            //!< window lengths in ns
+    static Histogram g_windowEvents;       //!< events per window
+    static std::vector<Peer> g_peers;      //!< counters of every rank
+};
+
+inline bool
+SyncProfiler::IsEnabled()
+{
+    return g_enabled;
+}
+
+} // namespace ns3
+
+#endif /* NS3_SYNC_PROFILER_H */
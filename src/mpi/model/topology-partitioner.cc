@@ -0,0 +1,850 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file
+ * \ingroup mpi
+ * Implementation of class ns3::TopologyPartitioner.
+ */
+
+#include "topology-partitioner.h"
+
+#include "ns3/assert.h"
+#include "ns3/channel.h"
+#include "ns3/log.h"
+#include "ns3/net-device.h"
+#include "ns3/node.h"
+
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <set>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("TopologyPartitioner");
+
+/** Rank of a group that is not assigned yet. */
+static const uint32_t UNASSIGNED = std::numeric_limits<uint32_t>::max();
+
+TopologyPartitioner::TopologyPartitioner()
+    : m_tolerance(0.05),
+      m_passes(20)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+uint32_t
+TopologyPartitioner::AddNode(double load)
+{
+    NS_LOG_FUNCTION(this << load);
+    m_load.push_back(load);
+    return m_load.size() - 1;
+}
+
+void
+TopologyPartitioner::SetNodeLoad(uint32_t node, double load)
+{
+    NS_LOG_FUNCTION(this << node << load);
+    NS_ASSERT(node < m_load.size());
+    m_load[node] = load;
+}
+
+void
+TopologyPartitioner::AddLink(uint32_t a, uint32_t b, Time delay, double traffic)
+{
+    NS_LOG_FUNCTION(this << a << b << delay << traffic);
+    NS_ASSERT(a < m_load.size() && b < m_load.size());
+    m_links.push_back({a, b, delay, traffic});
+}
+
+void
+TopologyPartitioner::AddTopology(const NodeContainer& c)
+{
+    NS_LOG_FUNCTION(this);
+
+    for (auto iter = c.Begin(); iter != c.End(); ++iter)
+    {
+        uint32_t id = (*iter)->GetId();
+        if (id >= m_load.size())
+        {
+            m_load.resize(id + 1, 0);
+        }
+    }
+
+    std::set<Ptr<Channel>> seen;
+    for (auto iter = c.Begin(); iter != c.End(); ++iter)
+    {
+        for (uint32_t i = 0; i < (*iter)->GetNDevices(); ++i)
+        {
+            Ptr<NetDevice> localNetDevice = (*iter)->GetDevice(i);
+            if (!localNetDevice->IsPointToPoint())
+            {
+                continue;
+            }
+            Ptr<Channel> channel = localNetDevice->GetChannel();
+            if (!channel || channel->GetNDevices() != 2 || !seen.insert(channel).second)
+            {
+                continue;
+            }
+
+            uint32_t a = channel->GetDevice(0)->GetNode()->GetId();
+            uint32_t b = channel->GetDevice(1)->GetNode()->GetId();
+            if (std::max(a, b) >= m_load.size())
+            {
+                m_load.resize(std::max(a, b) + 1, 0);
+            }
+            TimeValue delay;
+            channel->GetAttributeFailSafe("Delay", delay);
+            AddLink(a, b, delay.Get());
+        }
+    }
+}
+
+bool
+TopologyPartitioner::ReadLeafSpine(const std::string& filename)
+{
+    NS_LOG_FUNCTION(this << filename);
+
+    std::ifstream topof(filename);
+    if (!topof.is_open())
+    {
+        NS_LOG_WARN("Cannot open topology file " << filename);
+        return false;
+    }
+
+    uint32_t nodeNum;
+    uint32_t switchNum;
+    uint32_t torNum;
+    uint32_t linkNum;
+    double serverRate;
+    double switchRate;
+    topof >> nodeNum >> switchNum >> torNum >> linkNum >> serverRate >> switchRate;
+    if (!topof || serverRate <= 0)
+    {
+        NS_LOG_WARN("Bad header in topology file " << filename);
+        return false;
+    }
+
+    std::vector<bool> isSwitch(nodeNum, false);
+    for (uint32_t i = 0; i < switchNum; i++)
+    {
+        uint32_t sid;
+        topof >> sid;
+        if (sid < nodeNum)
+        {
+            isSwitch[sid] = true;
+        }
+    }
+
+    uint32_t first = m_load.size();
+    m_load.resize(first + nodeNum, 0);
+
+    // Servers send at most their line rate; an uplink of a ToR carries
+    // the traffic of its servers spread over its uplinks.
+    std::vector<uint32_t> servers(nodeNum, 0);
+    std::vector<uint32_t> uplinks(nodeNum, 0);
+    std::vector<Link> links;
+    std::vector<double> rates;
+    for (uint32_t i = 0; i < linkNum; i++)
+    {
+        uint32_t src;
+        uint32_t dst;
+        double rate;
+        std::string delay;
+        double errorRate;
+        topof >> src >> dst >> rate >> delay >> errorRate;
+        if (!topof || src >= nodeNum || dst >= nodeNum)
+        {
+            NS_LOG_WARN("Bad link " << i << " in topology file " << filename);
+            m_load.resize(first);
+            return false;
+        }
+        if (isSwitch[src] != isSwitch[dst])
+        {
+            servers[isSwitch[src] ? src : dst]++;
+        }
+        else if (isSwitch[src])
+        {
+            uplinks[src]++;
+            uplinks[dst]++;
+        }
+        links.push_back({src, dst, Time(delay), 1});
+        rates.push_back(rate / serverRate);
+    }
+
+    for (uint32_t i = 0; i < links.size(); i++)
+    {
+        Link& l = links[i];
+        if (isSwitch[l.a] && isSwitch[l.b])
+        {
+            // the end with servers is the ToR
+            uint32_t tor = servers[l.a] >= servers[l.b] ? l.a : l.b;
+            l.traffic = std::min(rates[i], double(servers[tor]) / std::max(uplinks[tor], 1U));
+        }
+        else
+        {
+            l.traffic = rates[i];
+        }
+        AddLink(first + l.a, first + l.b, l.delay, l.traffic);
+    }
+    return true;
+}
+
+void
+TopologyPartitioner::SetImbalanceTolerance(double tolerance)
+{
+    NS_LOG_FUNCTION(this << tolerance);
+    m_tolerance = tolerance;
+}
+
+void
+TopologyPartitioner::SetRefinementPasses(uint32_t passes)
+{
+    NS_LOG_FUNCTION(this << passes);
+    m_passes = passes;
+}
+
+uint32_t
+TopologyPartitioner::GetNNodes() const
+{
+    return m_load.size();
+}
+
+std::vector<double>
+TopologyPartitioner::GetLoads() const
+{
+    std::vector<double> derived(m_load.size(), 0);
+    for (const Link& l : m_links)
+    {
+        derived[l.a] += l.traffic;
+        derived[l.b] += l.traffic;
+    }
+    std::vector<double> load(m_load.size());
+    double total = 0;
+    for (uint32_t i = 0; i < m_load.size(); i++)
+    {
+        load[i] = m_load[i] > 0 ? m_load[i] : derived[i];
+        total += load[i];
+    }
+    if (total <= 0)
+    {
+        std::fill(load.begin(), load.end(), 1);
+    }
+    return load;
+}
+
+uint32_t
+TopologyPartitioner::Contract(Time minCutDelay, std::vector<uint32_t>& group) const
+{
+    // union-find over the links that may not be cut
+    std::vector<uint32_t> parent(m_load.size());
+    std::iota(parent.begin(), parent.end(), 0);
+    std::function<uint32_t(uint32_t)> find = [&parent, &find](uint32_t x) {
+        return parent[x] == x ? x : parent[x] = find(parent[x]);
+    };
+    for (const Link& l : m_links)
+    {
+        if (l.delay < minCutDelay)
+        {
+            parent[find(l.a)] = find(l.b);
+        }
+    }
+
+    group.assign(m_load.size(), UNASSIGNED);
+    std::vector<uint32_t> index(m_load.size(), UNASSIGNED);
+    uint32_t nGroups = 0;
+    for (uint32_t i = 0; i < m_load.size(); i++)
+    {
+        uint32_t root = find(i);
+        if (index[root] == UNASSIGNED)
+        {
+            index[root] = nGroups++;
+        }
+        group[i] = index[root];
+    }
+    return nGroups;
+}
+
+bool
+TopologyPartitioner::Fits(const std::vector<double>& groupLoad,
+                          uint32_t nRanks,
+                          double maxLoad) const
+{
+    std::vector<double> sorted(groupLoad);
+    std::sort(sorted.begin(), sorted.end(), std::greater<double>());
+    std::vector<double> rankLoad(nRanks, 0);
+    for (double load : sorted)
+    {
+        auto lightest = std::min_element(rankLoad.begin(), rankLoad.end());
+        if (*lightest + load > maxLoad)
+        {
+            return false;
+        }
+        *lightest += load;
+    }
+    return true;
+}
+
+std::vector<uint32_t>
+TopologyPartitioner::PartitionGroups(const std::vector<std::vector<Edge>>& adj,
+                                     const std::vector<double>& groupLoad,
+                                     uint32_t nRanks,
+                                     double maxLoad) const
+{
+    uint32_t nGroups = groupLoad.size();
+
+    // Merge the groups hanging off a single neighbour, e.g. the servers
+    // of a ToR, into it.  Otherwise a growing region sees the many cheap
+    // server links of a ToR and takes another spine instead.
+    std::vector<uint32_t> parent(nGroups);
+    std::iota(parent.begin(), parent.end(), 0);
+    std::vector<double> merged(groupLoad);
+    for (uint32_t g = 0; g < nGroups; g++)
+    {
+        if (adj[g].size() == 1)
+        {
+            uint32_t peer = adj[g][0].peer;
+            if (adj[peer].size() > 1 && merged[peer] + groupLoad[g] <= maxLoad / 2)
+            {
+                parent[g] = peer;
+                merged[peer] += groupLoad[g];
+            }
+        }
+    }
+    std::vector<uint32_t> coarse(nGroups, UNASSIGNED);
+    std::vector<double> coarseLoad;
+    for (uint32_t g = 0; g < nGroups; g++)
+    {
+        if (parent[g] == g)
+        {
+            coarse[g] = coarseLoad.size();
+            coarseLoad.push_back(merged[g]);
+        }
+    }
+    std::vector<std::vector<Edge>> coarseAdj(coarseLoad.size());
+    for (uint32_t g = 0; g < nGroups; g++)
+    {
+        if (parent[g] != g)
+        {
+            coarse[g] = coarse[parent[g]];
+            continue;
+        }
+        for (const Edge& e : adj[g])
+        {
+            if (parent[e.peer] == e.peer)
+            {
+                coarseAdj[coarse[g]].push_back({coarse[e.peer], e.traffic});
+            }
+        }
+    }
+    double largest = *std::max_element(coarseLoad.begin(), coarseLoad.end());
+    std::vector<uint32_t> coarseRank(coarseLoad.size(), 0);
+
+    // Bisect recursively: split the groups of a range of ranks in two
+    // halves, each with the share of the load of its ranks, then split
+    // every half again.  A direct k-way split tends to put all the
+    // groups every other group talks to, e.g. the spines, in the first
+    // region.
+    std::function<void(const std::vector<uint32_t>&, uint32_t, uint32_t)> split =
+        [&](const std::vector<uint32_t>& groups, uint32_t first, uint32_t n) {
+            if (n == 1 || groups.size() < 2)
+            {
+                for (uint32_t g : groups)
+                {
+                    coarseRank[g] = first;
+                }
+                return;
+            }
+            std::vector<uint32_t> index(coarseLoad.size(), UNASSIGNED);
+            for (uint32_t i = 0; i < groups.size(); i++)
+            {
+                index[groups[i]] = i;
+            }
+            std::vector<std::vector<Edge>> subAdj(groups.size());
+            std::vector<double> subLoad(groups.size());
+            double subTotal = 0;
+            for (uint32_t i = 0; i < groups.size(); i++)
+            {
+                subLoad[i] = coarseLoad[groups[i]];
+                subTotal += subLoad[i];
+                for (const Edge& e : coarseAdj[groups[i]])
+                {
+                    if (index[e.peer] != UNASSIGNED)
+                    {
+                        subAdj[i].push_back({index[e.peer], e.traffic});
+                    }
+                }
+            }
+            uint32_t n0 = n / 2;
+            std::vector<double> capacity(2);
+            for (uint32_t side = 0; side < 2; side++)
+            {
+                uint32_t ranks = side == 0 ? n0 : n - n0;
+                capacity[side] =
+                    std::max(std::min(subTotal * ranks / n * (1 + m_tolerance), ranks * maxLoad),
+                             largest);
+            }
+            std::vector<uint32_t> side = Grow(subAdj, subLoad, capacity);
+            Refine(subAdj, subLoad, capacity, side);
+            std::vector<uint32_t> halves[2];
+            for (uint32_t i = 0; i < groups.size(); i++)
+            {
+                halves[side[i]].push_back(groups[i]);
+            }
+            split(halves[0], first, n0);
+            split(halves[1], first + n0, n - n0);
+        };
+    std::vector<uint32_t> all(coarseLoad.size());
+    std::iota(all.begin(), all.end(), 0);
+    split(all, 0, nRanks);
+
+    // Back to the groups; the halves may have used up their tolerance
+    // twice over, and merged groups may need to move apart
+    std::vector<uint32_t> rank(nGroups);
+    for (uint32_t g = 0; g < nGroups; g++)
+    {
+        rank[g] = coarseRank[coarse[g]];
+    }
+    Refine(adj, groupLoad, std::vector<double>(nRanks, maxLoad), rank);
+    return rank;
+}
+
+std::vector<uint32_t>
+TopologyPartitioner::Grow(const std::vector<std::vector<Edge>>& adj,
+                          const std::vector<double>& groupLoad,
+                          const std::vector<double>& capacity) const
+{
+    uint32_t nGroups = groupLoad.size();
+    uint32_t nRanks = capacity.size();
+    double total = std::accumulate(groupLoad.begin(), groupLoad.end(), 0.0);
+    double totalCapacity = std::accumulate(capacity.begin(), capacity.end(), 0.0);
+    std::vector<double> degree(nGroups, 0);
+    for (uint32_t g = 0; g < nGroups; g++)
+    {
+        for (const Edge& e : adj[g])
+        {
+            degree[g] += e.traffic;
+        }
+    }
+
+    // Grow one region per rank.  The next group is the one whose move
+    // into the region saves the most cut traffic; a region is closed once
+    // it reaches its share of the load.
+    std::vector<uint32_t> rank(nGroups, UNASSIGNED);
+    std::vector<double> rankLoad(nRanks, 0);
+    std::vector<double> conn(nGroups, 0);
+    double assigned = 0;
+    for (uint32_t r = 0; r + 1 < nRanks; r++)
+    {
+        double target = (total - assigned) * capacity[r] / totalCapacity;
+        totalCapacity -= capacity[r];
+        std::fill(conn.begin(), conn.end(), 0);
+        while (true)
+        {
+            uint32_t best = UNASSIGNED;
+            double bestGain = -std::numeric_limits<double>::max();
+            for (uint32_t g = 0; g < nGroups; g++)
+            {
+                if (rank[g] != UNASSIGNED)
+                {
+                    continue;
+                }
+                double after = rankLoad[r] + groupLoad[g];
+                bool fits = after <= target ||
+                            (after <= capacity[r] && after - target < target - rankLoad[r]);
+                if (!fits && rankLoad[r] > 0)
+                {
+                    continue;
+                }
+                // seeds are peripheral groups, later groups must touch the region
+                double gain = rankLoad[r] > 0 ? 2 * conn[g] - degree[g] : -degree[g];
+                if (rankLoad[r] > 0 && conn[g] <= 0)
+                {
+                    continue;
+                }
+                if (gain > bestGain ||
+                    (gain == bestGain && best != UNASSIGNED && groupLoad[g] < groupLoad[best]))
+                {
+                    best = g;
+                    bestGain = gain;
+                }
+            }
+            if (best == UNASSIGNED)
+            {
+                if (rankLoad[r] >= target * (1 - m_tolerance))
+                {
+                    break;
+                }
+                // the region is cut off from the rest, start a new seed
+                // if one still fits
+                double room = target - rankLoad[r];
+                for (uint32_t g = 0; g < nGroups; g++)
+                {
+                    if (rank[g] == UNASSIGNED && groupLoad[g] <= room &&
+                        (best == UNASSIGNED || degree[g] < degree[best]))
+                    {
+                        best = g;
+                    }
+                }
+                if (best == UNASSIGNED)
+                {
+                    break;
+                }
+            }
+            rank[best] = r;
+            rankLoad[r] += groupLoad[best];
+            assigned += groupLoad[best];
+            for (const Edge& e : adj[best])
+            {
+                conn[e.peer] += e.traffic;
+            }
+        }
+    }
+    for (uint32_t g = 0; g < nGroups; g++)
+    {
+        if (rank[g] == UNASSIGNED)
+        {
+            rank[g] = nRanks - 1;
+            rankLoad[nRanks - 1] += groupLoad[g];
+        }
+    }
+    return rank;
+}
+
+void
+TopologyPartitioner::Refine(const std::vector<std::vector<Edge>>& adj,
+                            const std::vector<double>& groupLoad,
+                            const std::vector<double>& capacity,
+                            std::vector<uint32_t>& rank) const
+{
+    uint32_t nGroups = groupLoad.size();
+    uint32_t nRanks = capacity.size();
+    std::vector<double> rankLoad(nRanks, 0);
+    std::vector<uint32_t> rankSize(nRanks, 0);
+    for (uint32_t g = 0; g < nGroups; g++)
+    {
+        rankLoad[rank[g]] += groupLoad[g];
+        rankSize[rank[g]]++;
+    }
+
+    const double eps = 1e-9;
+    std::vector<double> rankConn(nRanks, 0);
+
+    // Best move of one group: the rank with room it talks to most, where
+    // slack is the load a rank may take beyond its capacity.  Moves never
+    // empty a rank.  Returns the reduction of the cut traffic.
+    auto bestMove = [&](uint32_t g, double slack, uint32_t& to) {
+        uint32_t own = rank[g];
+        to = own;
+        if (rankSize[own] == 1)
+        {
+            return 0.0;
+        }
+        for (const Edge& e : adj[g])
+        {
+            rankConn[rank[e.peer]] += e.traffic;
+        }
+        double bestGain = -std::numeric_limits<double>::max();
+        for (uint32_t r = 0; r < nRanks; r++)
+        {
+            if (r == own || rankLoad[r] + groupLoad[g] > capacity[r] + slack + eps)
+            {
+                continue;
+            }
+            double gain = rankConn[r] - rankConn[own];
+            if (gain > bestGain + eps ||
+                (gain > bestGain - eps && to != own && rankLoad[r] < rankLoad[to]))
+            {
+                to = r;
+                bestGain = gain;
+            }
+        }
+        for (const Edge& e : adj[g])
+        {
+            rankConn[rank[e.peer]] = 0;
+        }
+        return bestGain;
+    };
+    auto move = [&](uint32_t g, uint32_t to) {
+        rankLoad[rank[g]] -= groupLoad[g];
+        rankSize[rank[g]]--;
+        rank[g] = to;
+        rankLoad[to] += groupLoad[g];
+        rankSize[to]++;
+    };
+
+    // Move groups out of overloaded ranks, cheapest first
+    for (uint32_t r = 0; r < nRanks; r++)
+    {
+        while (rankLoad[r] > capacity[r] + eps)
+        {
+            uint32_t best = UNASSIGNED;
+            uint32_t bestTo = r;
+            double bestGain = -std::numeric_limits<double>::max();
+            for (uint32_t g = 0; g < nGroups; g++)
+            {
+                if (rank[g] != r)
+                {
+                    continue;
+                }
+                uint32_t to;
+                double gain = bestMove(g, 0, to);
+                if (to != r && gain > bestGain)
+                {
+                    best = g;
+                    bestTo = to;
+                    bestGain = gain;
+                }
+            }
+            if (best == UNASSIGNED)
+            {
+                break;
+            }
+            move(best, bestTo);
+        }
+    }
+
+    // Refine with Fiduccia-Mattheyses passes: move every group once, best
+    // move first even when it adds cut traffic, then keep the balanced
+    // prefix of the moves that saved the most.  Within a pass a rank may
+    // exceed its capacity by the largest group, otherwise a tight
+    // tolerance blocks every move that needs another one to make room.
+    double slack = *std::max_element(groupLoad.begin(), groupLoad.end());
+    auto balanced = [&]() {
+        for (uint32_t r = 0; r < nRanks; r++)
+        {
+            if (rankLoad[r] > capacity[r] + eps)
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+    std::vector<bool> locked(nGroups);
+    std::vector<std::pair<uint32_t, uint32_t>> moves; // group, previous rank
+    for (uint32_t pass = 0; pass < m_passes; pass++)
+    {
+        std::fill(locked.begin(), locked.end(), false);
+        moves.clear();
+        double saved = 0;
+        double bestSaved = 0;
+        std::size_t bestPrefix = 0;
+        for (uint32_t step = 0; step < nGroups; step++)
+        {
+            uint32_t best = UNASSIGNED;
+            uint32_t bestTo = 0;
+            double bestGain = -std::numeric_limits<double>::max();
+            for (uint32_t g = 0; g < nGroups; g++)
+            {
+                if (locked[g])
+                {
+                    continue;
+                }
+                uint32_t to;
+                double gain = bestMove(g, slack, to);
+                if (to != rank[g] && gain > bestGain + eps)
+                {
+                    best = g;
+                    bestTo = to;
+                    bestGain = gain;
+                }
+            }
+            if (best == UNASSIGNED)
+            {
+                break;
+            }
+            moves.emplace_back(best, rank[best]);
+            move(best, bestTo);
+            locked[best] = true;
+            saved += bestGain;
+            if (saved > bestSaved + eps && balanced())
+            {
+                bestSaved = saved;
+                bestPrefix = moves.size();
+            }
+        }
+        while (moves.size() > bestPrefix)
+        {
+            move(moves.back().first, moves.back().second);
+            moves.pop_back();
+        }
+        if (bestPrefix == 0)
+        {
+            break;
+        }
+    }
+}
+
+std::vector<uint32_t>
+TopologyPartitioner::Partition(uint32_t nRanks)
+{
+    NS_LOG_FUNCTION(this << nRanks);
+    NS_ASSERT(nRanks > 0);
+
+    uint32_t nNodes = m_load.size();
+    if (nRanks == 1 || nNodes == 0)
+    {
+        return std::vector<uint32_t>(nNodes, 0);
+    }
+
+    std::vector<double> load = GetLoads();
+    double total = std::accumulate(load.begin(), load.end(), 0.0);
+    double maxLoad = std::max(total / nRanks * (1 + m_tolerance),
+                              *std::max_element(load.begin(), load.end()));
+
+    // Keep the links shorter than the largest possible lookahead inside
+    // the ranks: try the delays from the largest down and take the first
+    // one whose contracted groups still fit the load limit.
+    std::vector<Time> delays;
+    for (const Link& l : m_links)
+    {
+        delays.push_back(l.delay);
+    }
+    std::sort(delays.begin(), delays.end(), std::greater<Time>());
+    delays.erase(std::unique(delays.begin(), delays.end()), delays.end());
+
+    std::vector<uint32_t> group;
+    uint32_t nGroups = 0;
+    std::vector<double> groupLoad;
+    for (const Time& minCutDelay : delays)
+    {
+        nGroups = Contract(minCutDelay, group);
+        groupLoad.assign(nGroups, 0);
+        for (uint32_t i = 0; i < nNodes; i++)
+        {
+            groupLoad[group[i]] += load[i];
+        }
+        if (nGroups >= nRanks && Fits(groupLoad, nRanks, maxLoad))
+        {
+            NS_LOG_LOGIC("smallest cut delay " << minCutDelay << ", " << nGroups << " groups");
+            break;
+        }
+        nGroups = 0;
+    }
+    if (nGroups == 0)
+    {
+        // no delay level fits, let every node move on its own
+        nGroups = Contract(Time(0), group);
+        groupLoad = load;
+    }
+
+    // adjacency of the groups, parallel links merged
+    std::vector<std::vector<Edge>> adj(nGroups);
+    for (const Link& l : m_links)
+    {
+        uint32_t a = group[l.a];
+        uint32_t b = group[l.b];
+        if (a == b)
+        {
+            continue;
+        }
+        auto merge = [](std::vector<Edge>& edges, uint32_t peer, double traffic) {
+            for (Edge& e : edges)
+            {
+                if (e.peer == peer)
+                {
+                    e.traffic += traffic;
+                    return;
+                }
+            }
+            edges.push_back({peer, traffic});
+        };
+        merge(adj[a], b, l.traffic);
+        merge(adj[b], a, l.traffic);
+    }
+
+    std::vector<uint32_t> groupRank = PartitionGroups(adj, groupLoad, nRanks, maxLoad);
+    std::vector<uint32_t> assignment(nNodes);
+    for (uint32_t i = 0; i < nNodes; i++)
+    {
+        assignment[i] = groupRank[group[i]];
+    }
+
+    NS_LOG_INFO("partitioned " << nNodes << " nodes on " << nRanks << " ranks: "
+                               << GetCutLinks(assignment) << " cut links, lookahead "
+                               << GetLookAhead(assignment).As(Time::US) << ", imbalance "
+                               << GetImbalance(assignment));
+    return assignment;
+}
+
+uint32_t
+TopologyPartitioner::GetCutLinks(const std::vector<uint32_t>& assignment) const
+{
+    uint32_t cut = 0;
+    for (const Link& l : m_links)
+    {
+        if (assignment[l.a] != assignment[l.b])
+        {
+            cut++;
+        }
+    }
+    return cut;
+}
+
+double
+TopologyPartitioner::GetCutTraffic(const std::vector<uint32_t>& assignment) const
+{
+    double cut = 0;
+    for (const Link& l : m_links)
+    {
+        if (assignment[l.a] != assignment[l.b])
+        {
+            cut += l.traffic;
+        }
+    }
+    return cut;
+}
+
+Time
+TopologyPartitioner::GetLookAhead(const std::vector<uint32_t>& assignment) const
+{
+    Time lookAhead = Time::Max();
+    for (const Link& l : m_links)
+    {
+        if (assignment[l.a] != assignment[l.b])
+        {
+            lookAhead = Min(lookAhead, l.delay);
+        }
+    }
+    return lookAhead;
+}
+
+double
+TopologyPartitioner::GetImbalance(const std::vector<uint32_t>& assignment) const
+{
+    std::vector<double> load = GetLoads();
+    uint32_t nRanks = 0;
+    for (uint32_t r : assignment)
+    {
+        nRanks = std::max(nRanks, r + 1);
+    }
+    if (nRanks == 0)
+    {
+        return 1;
+    }
+    std::vector<double> rankLoad(nRanks, 0);
+    for (uint32_t i = 0; i < assignment.size(); i++)
+    {
+        rankLoad[assignment[i]] += load[i];
+    }
+    double total = std::accumulate(rankLoad.begin(), rankLoad.end(), 0.0);
+    return *std::max_element(rankLoad.begin(), rankLoad.end()) / (total / nRanks);
+}
+
+} // namespace ns3
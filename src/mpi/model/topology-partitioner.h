@@ -0,0 +1,255 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file
+ * \ingroup mpi
+ * Declaration of class ns3::TopologyPartitioner.
+ */
+
+#ifndef NS3_TOPOLOGY_PARTITIONER_H
+#define NS3_TOPOLOGY_PARTITIONER_H
+
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup mpi
+ *
+ * \brief Assign the nodes of a topology to MPI ranks
+ *
+ * The partitioner works on a weighted graph of the topology: every node
+ * has an expected event load, every link a propagation delay and an
+ * expected traffic.  Partition() returns one system id per node such that
+ *
+ * - no rank carries more than (1 + tolerance) times the average load,
+ * - the smallest delay of a link between two ranks, which bounds the
+ *   lookahead of the distributed simulator, is as large as the balance
+ *   constraint allows, and
+ * - the traffic crossing ranks is small.
+ *
+ * A node's system id is fixed when the node is constructed, so the graph
+ * is normally filled before the nodes exist, either by hand or with
+ * ReadLeafSpine(), and the nodes are then created in graph order with
+ * the returned system ids.  Graph nodes are numbered like the NodeList,
+ * so AddTopology() can also describe a topology that is already built,
+ * e.g. to compute the assignment for the next run.
+ */
+class TopologyPartitioner
+{
+  public:
+    TopologyPartitioner();
+
+    /**
+     * Add a node to the graph.
+     *
+     * \param load the expected event load of the node; when 0 it is
+     *        derived from the traffic of the links of the node
+     * \return the index of the node
+     */
+    uint32_t AddNode(double load = 0);
+
+    /**
+     * \param node the index of the node
+     * \param load the expected event load of the node
+     */
+    void SetNodeLoad(uint32_t node, double load);
+
+    /**
+     * Add a link between two nodes of the graph.
+     *
+     * \param a the index of the first node
+     * \param b the index of the second node
+     * \param delay the propagation delay of the link
+     * \param traffic the expected traffic carried by the link
+     */
+    void AddLink(uint32_t a, uint32_t b, Time delay, double traffic = 1);
+
+    /**
+     * Add the nodes of a container and their point-to-point links.
+     *
+     * Graph indices are the node ids, so nodes missing from the graph
+     * are added first.  Links are taken from the channels of the devices
+     * reporting IsPointToPoint() and use their Delay attribute; each link
+     * is added once.
+     *
+     * \param c the nodes
+     */
+    void AddTopology(const NodeContainer& c);
+
+    /**
+     * Fill the graph from a leaf-spine topology file.
+     *
+     * The first line holds the number of nodes, switches and ToR switches,
+     * the number of links and the server and switch data rates; the
+     * second line lists the switch ids, and every following line a link
+     * as "src dst rate delay error-rate".  The traffic of a link is its
+     * rate relative to the server rate.
+     *
+     * \param filename the topology file
+     * \return false if the file cannot be read
+     */
+    bool ReadLeafSpine(const std::string& filename);
+
+    /**
+     * \param tolerance the allowed load imbalance, 0.05 means that no rank
+     *        gets more than 5% above the average load
+     */
+    void SetImbalanceTolerance(double tolerance);
+
+    /**
+     * \param passes the maximum number of refinement passes
+     */
+    void SetRefinementPasses(uint32_t passes);
+
+    /**
+     * Compute the assignment.
+     *
+     * \param nRanks the number of ranks
+     * \return the system id of every node, indexed like the graph
+     */
+    std::vector<uint32_t> Partition(uint32_t nRanks);
+
+    /**
+     * \return the number of nodes in the graph
+     */
+    uint32_t GetNNodes() const;
+
+    /**
+     * \param assignment a system id per node
+     * \return the number of links between different ranks
+     */
+    uint32_t GetCutLinks(const std::vector<uint32_t>& assignment) const;
+
+    /**
+     * \param assignment a system id per node
+     * \return the traffic of the links between different ranks
+     */
+    double GetCutTraffic(const std::vector<uint32_t>& assignment) const;
+
+    /**
+     * \param assignment a system id per node
+     * \return the smallest delay of the links between different ranks,
+     *         Time::Max () when no link is cut
+     */
+    Time GetLookAhead(const std::vector<uint32_t>& assignment) const;
+
+    /**
+     * \param assignment a system id per node
+     * \return the load of the busiest rank over the average load
+     */
+    double GetImbalance(const std::vector<uint32_t>& assignment) const;
+
+  private:
+    /** A link of the graph. */
+    struct Link
+    {
+        uint32_t a;      //!< first node
+        uint32_t b;      //!< second node
+        Time delay;      //!< propagation delay
+        double traffic;  //!< expected traffic
+    };
+
+    /** An edge of the adjacency lists. */
+    struct Edge
+    {
+        uint32_t peer;   //!< the node at the other end
+        double traffic;  //!< expected traffic
+    };
+
+    /**
+     * Merge every node with the nodes it reaches over links shorter than
+     * the given delay.
+     *
+     * \param minCutDelay the smallest delay a cut link may have
+     * \param group filled with the group of every node
+     * \return the number of groups
+     */
+    uint32_t Contract(Time minCutDelay, std::vector<uint32_t>& group) const;
+
+    /**
+     * Check that groups can be packed into the ranks without exceeding
+     * the load limit, largest group first.
+     *
+     * \param groupLoad the load of every group
+     * \param nRanks the number of ranks
+     * \param maxLoad the load limit of a rank
+     * \return true if the groups fit
+     */
+    bool Fits(const std::vector<double>& groupLoad, uint32_t nRanks, double maxLoad) const;
+
+    /**
+     * Split the groups between the ranks by recursive bisection, then
+     * refine the result over all the ranks.
+     *
+     * \param adj the adjacency of the groups
+     * \param groupLoad the load of every group
+     * \param nRanks the number of ranks
+     * \param maxLoad the load limit of a rank
+     * \return the rank of every group
+     */
+    std::vector<uint32_t> PartitionGroups(const std::vector<std::vector<Edge>>& adj,
+                                          const std::vector<double>& groupLoad,
+                                          uint32_t nRanks,
+                                          double maxLoad) const;
+
+    /**
+     * Grow one region per rank over the group graph, each with the share
+     * of the load given by its capacity.
+     *
+     * \param adj the adjacency of the groups
+     * \param groupLoad the load of every group
+     * \param capacity the load limit of every rank
+     * \return the rank of every group
+     */
+    std::vector<uint32_t> Grow(const std::vector<std::vector<Edge>>& adj,
+                               const std::vector<double>& groupLoad,
+                               const std::vector<double>& capacity) const;
+
+    /**
+     * Move groups out of overloaded ranks, then reduce the cut traffic
+     * with Fiduccia-Mattheyses passes.
+     *
+     * \param adj the adjacency of the groups
+     * \param groupLoad the load of every group
+     * \param capacity the load limit of every rank
+     * \param rank the rank of every group, updated
+     */
+    void Refine(const std::vector<std::vector<Edge>>& adj,
+                const std::vector<double>& groupLoad,
+                const std::vector<double>& capacity,
+                std::vector<uint32_t>& rank) const;
+
+    /**
+     * \return the load of every node, derived from its links if not set
+     */
+    std::vector<double> GetLoads() const;
+
+    std::vector<double> m_load;  //!< the load of every node, 0 if derived
+    std::vector<Link> m_links;   //!< the links
+    double m_tolerance;          //!< the allowed load imbalance
+    uint32_t m_passes;           //!< the maximum number of refinement passes
+};
+
+} // namespace ns3
+
+#endif /* NS3_TOPOLOGY_PARTITIONER_H */
@@ -0,0 +1,390 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file
+ * \ingroup mpi
+ * Implementation of class ns3::WorkloadTrace.
+ */
+
+#include "workload-trace.h"
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("WorkloadTrace");
+
+/** Magic bytes at the start of a trace. */
+static const char TRACE_MAGIC[8] = "NS3WLTR";
+
+/** Version of the trace format. */
+static const uint32_t TRACE_VERSION = 1;
+
+static_assert(sizeof(WorkloadFlow) == 24, "the trace record layout changed");
+
+/**
+ * \param offset a file offset
+ * \return the offset rounded up to a multiple of 8
+ */
+static uint64_t
+Align8(uint64_t offset)
+{
+    return (offset + 7) & ~uint64_t(7);
+}
+
+WorkloadTrace::Range::Range(const WorkloadFlow* first, const WorkloadFlow* last)
+    : m_first(first),
+      m_last(last)
+{
+}
+
+const WorkloadFlow*
+WorkloadTrace::Range::begin() const
+{
+    return m_first;
+}
+
+const WorkloadFlow*
+WorkloadTrace::Range::end() const
+{
+    return m_last;
+}
+
+uint32_t
+WorkloadTrace::Range::size() const
+{
+    return m_last - m_first;
+}
+
+WorkloadTrace::WorkloadTrace()
+    : m_map(nullptr),
+      m_length(0),
+      m_header(nullptr),
+      m_assignment(nullptr),
+      m_index(nullptr),
+      m_flows(nullptr),
+      m_systemId(0),
+      m_partitioned(false)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+WorkloadTrace::~WorkloadTrace()
+{
+    NS_LOG_FUNCTION(this);
+    Close();
+}
+
+bool
+WorkloadTrace::ParseFlow(const std::string& line, WorkloadFlow& flow)
+{
+    std::istringstream ss(line);
+    std::string key;
+    std::string type;
+    uint32_t srcPort;
+    uint32_t dstPort;
+    uint32_t priority;
+    ss >> key >> type >> key >> flow.src >> key >> srcPort >> key >> flow.dst >> key >> dstPort >>
+        key >> priority >> key >> flow.size;
+    if (!ss)
+    {
+        return false;
+    }
+    flow.srcPort = srcPort;
+    flow.dstPort = dstPort;
+    flow.priority = priority;
+    return true;
+}
+
+bool
+WorkloadTrace::Convert(const std::string& text,
+                       const std::string& binary,
+                       const std::vector<uint32_t>& assignment)
+{
+    NS_LOG_FUNCTION(text << binary << assignment.size());
+
+    std::ifstream input(text);
+    if (!input.is_open())
+    {
+        NS_LOG_ERROR("cannot open " << text);
+        return false;
+    }
+    std::ofstream output(binary, std::ios::binary | std::ios::trunc);
+    if (!output.is_open())
+    {
+        NS_LOG_ERROR("cannot open " << binary);
+        return false;
+    }
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+    header.version = TRACE_VERSION;
+    header.nRanks =
+        assignment.empty() ? 1 : *std::max_element(assignment.begin(), assignment.end()) + 1;
+    header.nNodes = assignment.size();
+    header.flowsOffset = Align8(sizeof(Header) + assignment.size() * sizeof(uint32_t));
+
+    // The header is written again once the phases are known
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    output.write(reinterpret_cast<const char*>(assignment.data()),
+                 assignment.size() * sizeof(uint32_t));
+    output.seekp(header.flowsOffset);
+
+    std::vector<Section> index;
+    std::vector<std::vector<WorkloadFlow>> sections(header.nRanks);
+    uint64_t written = 0;
+    bool valid = true;
+    bool inPhase = false;
+    // Store the flows of a phase once per rank owning one of their ends
+    auto flushPhase = [&]() {
+        for (auto& section : sections)
+        {
+            index.push_back({written, section.size()});
+            output.write(reinterpret_cast<const char*>(section.data()),
+                         section.size() * sizeof(WorkloadFlow));
+            written += section.size();
+            section.clear();
+        }
+    };
+
+    std::string line;
+    while (std::getline(input, line))
+    {
+        if (line.empty() || line[0] == '#' || line.find("stat") != std::string::npos)
+        {
+            continue;
+        }
+        if (line.find("phase") != std::string::npos)
+        {
+            if (inPhase)
+            {
+                flushPhase();
+            }
+            inPhase = true;
+            continue;
+        }
+        WorkloadFlow flow;
+        std::memset(&flow, 0, sizeof(flow));
+        if (!ParseFlow(line, flow))
+        {
+            NS_LOG_WARN("skipping malformed flow in " << text << ": " << line);
+            continue;
+        }
+        if (flow.src >= assignment.size() || flow.dst >= assignment.size())
+        {
+            NS_LOG_ERROR("flow between unknown nodes " << flow.src << " and " << flow.dst);
+            valid = false;
+            break;
+        }
+        inPhase = true;
+        uint32_t srcRank = assignment[flow.src];
+        uint32_t dstRank = assignment[flow.dst];
+        sections[srcRank].push_back(flow);
+        if (dstRank != srcRank)
+        {
+            sections[dstRank].push_back(flow);
+        }
+    }
+    if (inPhase)
+    {
+        flushPhase();
+    }
+
+    header.nPhases = index.size() / header.nRanks;
+    header.indexOffset = header.flowsOffset + written * sizeof(WorkloadFlow);
+    output.write(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(Section));
+    output.seekp(0);
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    output.close();
+    return valid && !output.fail();
+}
+
+bool
+WorkloadTrace::Open(const std::string& binary,
+                    uint32_t systemId,
+                    const std::vector<uint32_t>& assignment)
+{
+    NS_LOG_FUNCTION(this << binary << systemId);
+
+    Close();
+    int fd = open(binary.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        NS_LOG_ERROR("cannot open " << binary);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(Header))
+    {
+        close(fd);
+        return false;
+    }
+    void* map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        NS_LOG_ERROR("cannot map " << binary);
+        return false;
+    }
+    m_map = static_cast<uint8_t*>(map);
+    m_length = st.st_size;
+    m_header = reinterpret_cast<const Header*>(m_map);
+
+    const Header& h = *m_header;
+    if (std::memcmp(h.magic, TRACE_MAGIC, sizeof(h.magic)) != 0 || h.version != TRACE_VERSION ||
+        h.indexOffset + uint64_t(h.nPhases) * h.nRanks * sizeof(Section) > m_length ||
+        h.flowsOffset > h.indexOffset)
+    {
+        NS_LOG_ERROR(binary << " is not a workload trace");
+        Close();
+        return false;
+    }
+    m_assignment = reinterpret_cast<const uint32_t*>(m_map + sizeof(Header));
+    m_index = reinterpret_cast<const Section*>(m_map + h.indexOffset);
+    m_flows = reinterpret_cast<const WorkloadFlow*>(m_map + h.flowsOffset);
+    m_systemId = systemId;
+    m_runAssignment = assignment;
+    m_partitioned = assignment.size() == h.nNodes &&
+                    std::equal(assignment.begin(), assignment.end(), m_assignment);
+    NS_LOG_INFO(binary << ": " << h.nPhases << " phases, "
+                       << (m_partitioned ? "partitioned" : "filtered") << " reads");
+    return true;
+}
+
+void
+WorkloadTrace::Close()
+{
+    NS_LOG_FUNCTION(this);
+    if (m_map)
+    {
+        munmap(m_map, m_length);
+    }
+    m_map = nullptr;
+    m_length = 0;
+    m_header = nullptr;
+    m_assignment = nullptr;
+    m_index = nullptr;
+    m_flows = nullptr;
+    m_filtered.clear();
+}
+
+bool
+WorkloadTrace::IsPartitioned() const
+{
+    return m_partitioned;
+}
+
+uint32_t
+WorkloadTrace::GetNPhases() const
+{
+    return m_header ? m_header->nPhases : 0;
+}
+
+WorkloadTrace::Range
+WorkloadTrace::GetFlows(uint32_t phase)
+{
+    NS_LOG_FUNCTION(this << phase);
+    NS_ASSERT(m_header && phase < m_header->nPhases);
+
+    if (phase + 1 < m_header->nPhases)
+    {
+        Advise(phase + 1, MADV_WILLNEED);
+    }
+    const Section* sections = m_index + uint64_t(phase) * m_header->nRanks;
+    if (m_partitioned)
+    {
+        if (m_systemId >= m_header->nRanks)
+        {
+            return Range(nullptr, nullptr);
+        }
+        const Section& s = sections[m_systemId];
+        return Range(m_flows + s.first, m_flows + s.first + s.count);
+    }
+
+    // Keep the copy stored with the sender, as seen by the trace
+    m_filtered.clear();
+    for (uint32_t r = 0; r < m_header->nRanks; ++r)
+    {
+        for (uint64_t i = 0; i < sections[r].count; ++i)
+        {
+            const WorkloadFlow& flow = m_flows[sections[r].first + i];
+            if (m_assignment[flow.src] != r)
+            {
+                continue;
+            }
+            NS_ASSERT(flow.src < m_runAssignment.size() && flow.dst < m_runAssignment.size());
+            if (m_runAssignment[flow.src] == m_systemId || m_runAssignment[flow.dst] == m_systemId)
+            {
+                m_filtered.push_back(flow);
+            }
+        }
+    }
+    return Range(m_filtered.data(), m_filtered.data() + m_filtered.size());
+}
+
+void
+WorkloadTrace::Release(uint32_t phase)
+{
+    NS_LOG_FUNCTION(this << phase);
+    NS_ASSERT(m_header && phase < m_header->nPhases);
+    Advise(phase, MADV_DONTNEED);
+}
+
+void
+WorkloadTrace::Advise(uint32_t phase, int advice) const
+{
+    const Section* sections = m_index + uint64_t(phase) * m_header->nRanks;
+    const Section* first = sections;
+    const Section* last = sections + m_header->nRanks - 1;
+    if (m_partitioned && m_systemId < m_header->nRanks)
+    {
+        first = last = sections + m_systemId;
+    }
+    uint64_t begin = m_header->flowsOffset + first->first * sizeof(WorkloadFlow);
+    uint64_t end = m_header->flowsOffset + (last->first + last->count) * sizeof(WorkloadFlow);
+    if (end <= begin)
+    {
+        return;
+    }
+    // Only whole pages of this rank are dropped; pages shared with the
+    // neighbour sections are simply read again if needed.
+    uint64_t page = sysconf(_SC_PAGESIZE);
+    uint64_t pageBegin = begin & ~(page - 1);
+    if (advice == MADV_DONTNEED)
+    {
+        pageBegin = (begin + page - 1) & ~(page - 1);
+        end &= ~(page - 1);
+        if (end <= pageBegin)
+        {
+            return;
+        }
+    }
+    madvise(m_map + pageBegin, end - pageBegin, advice);
+}
+
+} // namespace ns3
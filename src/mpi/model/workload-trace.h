@@ -0,0 +1,208 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file
+ * \ingroup mpi
+ * Declaration of struct ns3::WorkloadFlow and class ns3::WorkloadTrace.
+ */
+
+#ifndef NS3_WORKLOAD_TRACE_H
+#define NS3_WORKLOAD_TRACE_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup mpi
+ *
+ * \brief A flow of a workload phase
+ *
+ * This is also the record of the binary trace format, so the layout
+ * must not change without changing the trace version.
+ */
+struct WorkloadFlow
+{
+    uint32_t src;     //!< the node id of the sender
+    uint16_t srcPort; //!< the port of the sender
+    uint32_t dst;     //!< the node id of the receiver
+    uint16_t dstPort; //!< the port of the receiver
+    uint8_t priority; //!< the priority of the flow
+    uint64_t size;    //!< the size of the flow in bytes
+};
+
+/**
+ * \ingroup mpi
+ *
+ * \brief Memory-mapped, pre-partitioned binary workload trace
+ *
+ * Convert() turns a flow file in the rdma_operate.txt format into a
+ * binary trace for a given node-to-rank assignment, one phase at a
+ * time.  Within a phase the flows are stored once per rank owning one
+ * of their ends, and an index gives the flows of every (phase, rank)
+ * pair, so a rank only touches the pages holding its own flows.  The
+ * trace is mapped read only; pages are read as the simulation reaches
+ * the phases, the next phase is prefetched and Release() drops the
+ * pages of a finished phase.
+ *
+ * If the trace is opened with an assignment other than the one it was
+ * converted with, the flows of each phase are filtered into a private
+ * buffer instead, which is correct but reads the whole phase.
+ */
+class WorkloadTrace
+{
+  public:
+    /** The flows of one phase for this rank. */
+    class Range
+    {
+      public:
+        /**
+         * \param first the first flow
+         * \param last past the last flow
+         */
+        Range(const WorkloadFlow* first, const WorkloadFlow* last);
+
+        /** \return the first flow */
+        const WorkloadFlow* begin() const;
+        /** \return past the last flow */
+        const WorkloadFlow* end() const;
+        /** \return the number of flows */
+        uint32_t size() const;
+
+      private:
+        const WorkloadFlow* m_first; //!< the first flow
+        const WorkloadFlow* m_last;  //!< past the last flow
+    };
+
+    WorkloadTrace();
+    ~WorkloadTrace();
+
+    // Delete copy constructor and assignment operator to avoid misuse
+    WorkloadTrace(const WorkloadTrace&) = delete;
+    WorkloadTrace& operator=(const WorkloadTrace&) = delete;
+
+    /**
+     * Parse a flow line of the rdma_operate.txt format:
+     * "Type rdma_send src_node 0 src_port 1160 dst_node 16 dst_port 1160
+     * priority 0 msg_len 8388608".
+     *
+     * \param line the line
+     * \param flow set to the flow
+     * \return false if the line is not a flow
+     */
+    static bool ParseFlow(const std::string& line, WorkloadFlow& flow);
+
+    /**
+     * Convert a text flow file into a binary trace.
+     *
+     * \param text the flow file in the rdma_operate.txt format
+     * \param binary the trace to write
+     * \param assignment the system id of every node
+     * \return false if a file cannot be opened or a flow names an
+     *         unknown node
+     */
+    static bool Convert(const std::string& text,
+                        const std::string& binary,
+                        const std::vector<uint32_t>& assignment);
+
+    /**
+     * Map a binary trace.
+     *
+     * \param binary the trace
+     * \param systemId the rank reading the trace
+     * \param assignment the system id of every node in this run
+     * \return false if the file is not a valid trace
+     */
+    bool Open(const std::string& binary, uint32_t systemId, const std::vector<uint32_t>& assignment);
+
+    /**
+     * Unmap the trace.
+     */
+    void Close();
+
+    /**
+     * \return true if the trace was converted for the assignment it was
+     *         opened with
+     */
+    bool IsPartitioned() const;
+
+    /**
+     * \return the number of phases
+     */
+    uint32_t GetNPhases() const;
+
+    /**
+     * The flows of a phase with an end on this rank.  The range stays
+     * valid until Release() of the phase or Close().
+     *
+     * \param phase the index of the phase
+     * \return the flows
+     */
+    Range GetFlows(uint32_t phase);
+
+    /**
+     * Drop the pages of a phase that is no longer needed.
+     *
+     * \param phase the index of the phase
+     */
+    void Release(uint32_t phase);
+
+  private:
+    /** Trace file header. */
+    struct Header
+    {
+        char magic[8];        //!< "NS3WLTR"
+        uint32_t version;     //!< format version
+        uint32_t nRanks;      //!< number of ranks of the assignment
+        uint32_t nNodes;      //!< number of nodes of the assignment
+        uint32_t nPhases;     //!< number of phases
+        uint64_t indexOffset; //!< offset of the (phase, rank) index
+        uint64_t flowsOffset; //!< offset of the flow records
+    };
+
+    /** Index entry of the flows of a rank in a phase. */
+    struct Section
+    {
+        uint64_t first; //!< the first flow record
+        uint64_t count; //!< the number of flow records
+    };
+
+    /**
+     * Advise the kernel about the pages of the flows of a phase.
+     *
+     * \param phase the index of the phase
+     * \param advice the madvise advice
+     */
+    void Advise(uint32_t phase, int advice) const;
+
+    uint8_t* m_map;                        //!< the mapping
+    std::size_t m_length;                  //!< the length of the mapping
+    const Header* m_header;                //!< the header
+    const uint32_t* m_assignment;          //!< the assignment of the trace
+    const Section* m_index;                //!< the (phase, rank) index
+    const WorkloadFlow* m_flows;           //!< the flow records
+    uint32_t m_systemId;                   //!< this rank
+    std::vector<uint32_t> m_runAssignment; //!< the assignment of this run
+    bool m_partitioned;                    //!< same assignment as the trace
+    std::vector<WorkloadFlow> m_filtered;  //!< the flows of the phase, if not partitioned
+};
+
+} // namespace ns3
+
+#endif /* NS3_WORKLOAD_TRACE_H */
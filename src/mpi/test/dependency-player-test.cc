@@ -0,0 +1,160 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/dependency-player.h"
+#include "ns3/node-container.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+#include <fstream>
+#include <map>
+
+/**
+ * \file
+ * \ingroup mpi-tests
+ * DependencyPlayer test suite
+ */
+
+using namespace ns3;
+
+/**
+ * \ingroup mpi-tests
+ * \brief Play a diamond of groups read from trafficGen.py style files
+ */
+class DiamondDependencyTest : public TestCase
+{
+  public:
+    DiamondDependencyTest();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Finish a step after as many microseconds as its flows have bytes.
+     *
+     * \param step the index of the step
+     */
+    void StepStart(uint32_t step);
+
+    /**
+     * Record the duration of a group.
+     *
+     * \param group the index of the group
+     * \param fct the duration of the group
+     */
+    void GroupEnd(uint32_t group, Time fct);
+
+    Ptr<DependencyPlayer> m_player; //!< The player
+    std::map<uint32_t, Time> m_fcts; //!< Duration of every group
+};
+
+DiamondDependencyTest::DiamondDependencyTest()
+    : TestCase("Overlap independent groups and start a group after all its predecessors")
+{
+}
+
+void
+DiamondDependencyTest::StepStart(uint32_t step)
+{
+    uint64_t bytes = 0;
+    for (const WorkloadFlow& flow : m_player->GetFlows(step))
+    {
+        bytes += flow.size;
+    }
+    Simulator::Schedule(MicroSeconds(bytes), &DependencyPlayer::NotifyLocalDone, m_player, step);
+}
+
+void
+DiamondDependencyTest::GroupEnd(uint32_t group, Time fct)
+{
+    m_fcts[group] = fct;
+}
+
+void
+DiamondDependencyTest::DoRun()
+{
+    NodeContainer nodes;
+    nodes.Create(4);
+
+    // Group 0 has two steps of 10 and 5 us, group 1 one of 20 us, group 2
+    // an empty step and one of 7 us, group 3 one step of 1 us.
+    std::string prefix = CreateTempDirFilename("rdma_operate");
+    const char* groups[] = {
+        "stat rdma operate:\nphase:3000\n"
+        "Type rdma_send src_node 0 src_port 1000 dst_node 1 dst_port 1000 priority 0 msg_len 10\n"
+        "phase:3000\n"
+        "Type rdma_send src_node 1 src_port 1000 dst_node 0 dst_port 1000 priority 0 msg_len 5\n",
+        "stat rdma operate:\nphase:3000\n"
+        "Type rdma_send src_node 2 src_port 1001 dst_node 3 dst_port 1001 priority 3 msg_len 20\n",
+        "stat rdma operate:\nphase:3000\nphase:3000\n"
+        "Type rdma_send src_node 3 src_port 1002 dst_node 2 dst_port 1002 priority 0 msg_len 7\n",
+        "stat rdma operate:\nphase:3000\n"
+        "Type rdma_send src_node 0 src_port 1003 dst_node 3 dst_port 1003 priority 0 msg_len 1\n",
+    };
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        std::ofstream(prefix + std::to_string(i) + ".txt") << groups[i];
+    }
+    std::string dependencies = CreateTempDirFilename("dependence.txt");
+    std::ofstream(dependencies) << "1-2:0-0\n3-3:1-2\n";
+
+    m_player = CreateObject<DependencyPlayer>();
+    m_player->SetAttribute("NotificationDelay", TimeValue(MicroSeconds(2)));
+    NS_TEST_ASSERT_MSG_EQ(m_player->ReadGroups(prefix), 4, "wrong number of groups");
+    NS_TEST_ASSERT_MSG_EQ(m_player->ReadDependencies(dependencies), true, "cannot read DAG");
+    NS_TEST_ASSERT_MSG_EQ(m_player->GetNSteps(), 6, "wrong number of steps");
+    NS_TEST_EXPECT_MSG_EQ(m_player->GetFlows(2)[0].priority, 3, "wrong priority");
+
+    m_player->SetStepStartCallback(MakeCallback(&DiamondDependencyTest::StepStart, this));
+    m_player->SetGroupEndCallback(MakeCallback(&DiamondDependencyTest::GroupEnd, this));
+    m_player->Start(MicroSeconds(1));
+    Simulator::Run();
+
+    // group 0: 1 + 10 + 2 + 5 = 18 us, then groups 1 and 2 overlap
+    NS_TEST_EXPECT_MSG_EQ(m_fcts[0], MicroSeconds(17), "wrong duration of group 0");
+    NS_TEST_EXPECT_MSG_EQ(m_player->GetStepStart(2), MicroSeconds(20), "group 1 started late");
+    NS_TEST_EXPECT_MSG_EQ(m_player->GetStepStart(3), MicroSeconds(20), "group 2 started late");
+    NS_TEST_EXPECT_MSG_EQ(m_fcts[1], MicroSeconds(20), "wrong duration of group 1");
+    NS_TEST_EXPECT_MSG_EQ(m_fcts[2], MicroSeconds(7), "wrong duration of group 2");
+    // group 3 waits for group 1, the longer one
+    NS_TEST_EXPECT_MSG_EQ(m_player->GetStepStart(5), MicroSeconds(42), "group 3 started early");
+    NS_TEST_EXPECT_MSG_EQ(m_fcts[3], MicroSeconds(1), "wrong duration of group 3");
+    for (uint32_t s = 0; s < m_player->GetNSteps(); s++)
+    {
+        NS_TEST_EXPECT_MSG_EQ(m_player->IsStepFinished(s), true, "step " << s << " not done");
+    }
+
+    m_player->Dispose();
+    m_player = nullptr;
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup mpi-tests
+ * \brief DependencyPlayer TestSuite
+ */
+class DependencyPlayerTestSuite : public TestSuite
+{
+  public:
+    DependencyPlayerTestSuite();
+};
+
+DependencyPlayerTestSuite::DependencyPlayerTestSuite()
+    : TestSuite("mpi-dependency-player", UNIT)
+{
+    AddTestCase(new DiamondDependencyTest, TestCase::QUICK);
+}
+
+static DependencyPlayerTestSuite g_dependencyPlayerTestSuite; //!< Static variable for test initialization
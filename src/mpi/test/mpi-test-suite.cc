@@ -154,6 +154,23 @@ static MpiTestSuite g_mpiSimple2("mpi-example-simple-2",
                                  NS_TEST_SOURCEDIR,
                                  2);
 static MpiTestSuite g_mpiThird2("mpi-example-third-2", "third-distributed", NS_TEST_SOURCEDIR, 2);
+static MpiTestSuite g_mpiSimple2Overlap("mpi-example-simple-2-overlap",
+                                        "simple-distributed",
+                                        NS_TEST_SOURCEDIR,
+                                        2,
+                                        "--ns3::DistributedSimulatorImpl::OverlapLbts=true");
+static MpiTestSuite g_mpiSimple2NoRing("mpi-example-simple-2-noring",
+                                       "simple-distributed",
+                                       NS_TEST_SOURCEDIR,
+                                       2,
+                                       "--MpiSharedMemoryRingSize=0");
+
+/* Tests using HybridSimulatorImpl */
+static MpiTestSuite g_mpiSimple2Hybrid("mpi-example-simple-2-hybrid",
+                                       "simple-distributed",
+                                       NS_TEST_SOURCEDIR,
+                                       2,
+                                       "--hybrid");
 
 /* Tests using NullMessageSimulatorImpl */
 static MpiTestSuite g_mpiSimple2NullMsg("mpi-example-simple-2-nullmsg",
@@ -161,6 +178,12 @@ static MpiTestSuite g_mpiSimple2NullMsg("mpi-example-simple-2-nullmsg",
                                         NS_TEST_SOURCEDIR,
                                         2,
                                         "--nullmsg");
+static MpiTestSuite g_mpiSimple2NullMsgPeriodic(
+    "mpi-example-simple-2-nullmsg-periodic",
+    "simple-distributed",
+    NS_TEST_SOURCEDIR,
+    2,
+    "--nullmsg --ns3::NullMessageSimulatorImpl::DemandDriven=false");
 static MpiTestSuite g_mpiEmpty2NullMsg("mpi-example-empty-2-nullmsg",
                                        "simple-distributed-empty-node",
                                        NS_TEST_SOURCEDIR,
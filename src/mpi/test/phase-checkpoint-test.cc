@@ -0,0 +1,269 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/phase-checkpoint.h"
+#include "ns3/phase-engine.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+#include <fstream>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup mpi-tests
+ * PhaseCheckpoint test suite
+ */
+
+using namespace ns3;
+
+/**
+ * \ingroup mpi-tests
+ * \brief Restart a sequential workload from a checkpoint and compare it
+ * with the uninterrupted run
+ */
+class PhaseCheckpointRestoreTest : public TestCase
+{
+  public:
+    PhaseCheckpointRestoreTest();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Start a phase that lasts a random number of microseconds, drawn
+     * from a new random variable and from one that lives across phases.
+     *
+     * \param phase the index of the phase
+     */
+    void PhaseStart(uint32_t phase);
+
+    /**
+     * Record the duration of a phase.
+     *
+     * \param phase the index of the phase
+     * \param fct the duration of the phase
+     */
+    void PhaseEnd(uint32_t phase, Time fct);
+
+    /**
+     * \return the checkpoint section of the test
+     */
+    std::string Save();
+
+    /**
+     * \param section the checkpoint section of the test
+     */
+    void Restore(const std::string& section);
+
+    /**
+     * Run the workload.
+     *
+     * \param prefix the file name prefix of the checkpoints
+     * \param phase the phase to restart from, 0 for the first one
+     */
+    void RunPhases(const std::string& prefix, uint32_t phase);
+
+    uint32_t m_progress;                //!< Number of phases started, saved in the checkpoints
+    std::vector<Time> m_fct;            //!< Duration of every phase, 0 if not run
+    Ptr<UniformRandomVariable> m_extra; //!< Variable drawn by every phase
+};
+
+PhaseCheckpointRestoreTest::PhaseCheckpointRestoreTest()
+    : TestCase("Restart from a checkpoint as if the run was not interrupted")
+{
+}
+
+void
+PhaseCheckpointRestoreTest::PhaseStart(uint32_t phase)
+{
+    NS_TEST_EXPECT_MSG_EQ(m_progress, phase, "wrong progress at phase " << phase);
+    m_progress++;
+    Ptr<UniformRandomVariable> duration = CreateObject<UniformRandomVariable>();
+    Simulator::Schedule(MicroSeconds(duration->GetInteger(1, 1000) + m_extra->GetInteger(1, 1000)),
+                        &PhaseEngine::NotifyLocalDone);
+}
+
+void
+PhaseCheckpointRestoreTest::PhaseEnd(uint32_t phase, Time fct)
+{
+    m_fct[phase] = fct;
+}
+
+std::string
+PhaseCheckpointRestoreTest::Save()
+{
+    return std::to_string(m_progress);
+}
+
+void
+PhaseCheckpointRestoreTest::Restore(const std::string& section)
+{
+    m_progress = std::stoul(section);
+}
+
+void
+PhaseCheckpointRestoreTest::RunPhases(const std::string& prefix, uint32_t phase)
+{
+    m_progress = 0;
+    m_fct.assign(5, Time());
+    m_extra = CreateObject<UniformRandomVariable>();
+    PhaseEngine::SetPhaseStartCallback(MakeCallback(&PhaseCheckpointRestoreTest::PhaseStart, this));
+    PhaseEngine::SetPhaseEndCallback(MakeCallback(&PhaseCheckpointRestoreTest::PhaseEnd, this));
+    PhaseCheckpoint::AddSection("progress",
+                                MakeCallback(&PhaseCheckpointRestoreTest::Save, this),
+                                MakeCallback(&PhaseCheckpointRestoreTest::Restore, this));
+    PhaseCheckpoint::AddStream("extra", m_extra);
+    if (phase == 0)
+    {
+        PhaseEngine::SetCheckpoint(prefix);
+        PhaseEngine::Start(5, MicroSeconds(10));
+    }
+    else
+    {
+        NS_TEST_ASSERT_MSG_EQ(PhaseEngine::Restore(prefix, phase), true, "cannot restore");
+    }
+    Simulator::Run();
+    NS_TEST_EXPECT_MSG_EQ(m_progress, 5, "not every phase started");
+    m_extra = nullptr;
+}
+
+void
+PhaseCheckpointRestoreTest::DoRun()
+{
+    std::string prefix = CreateTempDirFilename("checkpoint");
+    RunPhases(prefix, 0);
+    std::vector<Time> fct = m_fct;
+    Time end = Simulator::Now();
+    PhaseEngine::Reset();
+    PhaseCheckpoint::Reset();
+    Simulator::Destroy();
+
+    // Every restart draws the durations of the same streams, at the same
+    // positions
+    for (uint32_t phase = 1; phase < 5; phase++)
+    {
+        RunPhases(prefix, phase);
+        for (uint32_t i = 0; i < 5; i++)
+        {
+            Time expected = i < phase ? Time() : fct[i];
+            NS_TEST_EXPECT_MSG_EQ(m_fct[i], expected, "wrong FCT " << i);
+        }
+        NS_TEST_EXPECT_MSG_EQ(Simulator::Now(), end, "wrong end of phase 4");
+        NS_TEST_EXPECT_MSG_EQ(PhaseEngine::GetPhaseEnd(0),
+                              MicroSeconds(10) + fct[0],
+                              "wrong end of phase 0");
+        PhaseEngine::Reset();
+        PhaseCheckpoint::Reset();
+        Simulator::Destroy();
+    }
+
+    // There is no checkpoint after the last phase, and a damaged one is
+    // rejected
+    NS_TEST_EXPECT_MSG_EQ(PhaseEngine::Restore(prefix, 5), false, "restored the last phase");
+    std::ofstream(PhaseCheckpoint::GetFileName(prefix, 2, 0), std::ios::binary | std::ios::trunc)
+        << "NS3PHCK";
+    NS_TEST_EXPECT_MSG_EQ(PhaseEngine::Restore(prefix, 2), false, "restored a truncated file");
+    PhaseEngine::Reset();
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup mpi-tests
+ * \brief Skip the checkpoints of the phases that leave events pending
+ */
+class PhaseCheckpointPendingTest : public TestCase
+{
+  public:
+    PhaseCheckpointPendingTest();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Start a phase; phase 1 leaves an event after its end, phase 0 a
+     * cancelled one.
+     *
+     * \param phase the index of the phase
+     */
+    void PhaseStart(uint32_t phase);
+
+    /** Do nothing. */
+    static void Nothing();
+};
+
+PhaseCheckpointPendingTest::PhaseCheckpointPendingTest()
+    : TestCase("Write no checkpoint when events besides the next phase are pending")
+{
+}
+
+void
+PhaseCheckpointPendingTest::Nothing()
+{
+}
+
+void
+PhaseCheckpointPendingTest::PhaseStart(uint32_t phase)
+{
+    if (phase == 0)
+    {
+        Simulator::Cancel(Simulator::Schedule(Seconds(1), &PhaseCheckpointPendingTest::Nothing));
+    }
+    else if (phase == 1)
+    {
+        Simulator::Schedule(Seconds(1), &PhaseCheckpointPendingTest::Nothing);
+    }
+    Simulator::Schedule(MicroSeconds(10), &PhaseEngine::NotifyLocalDone);
+}
+
+void
+PhaseCheckpointPendingTest::DoRun()
+{
+    std::string prefix = CreateTempDirFilename("pending");
+    PhaseEngine::SetPhaseStartCallback(
+        MakeCallback(&PhaseCheckpointPendingTest::PhaseStart, this));
+    PhaseEngine::SetCheckpoint(prefix);
+    PhaseEngine::Start(4);
+    Simulator::Run();
+
+    for (uint32_t phase = 1; phase < 4; phase++)
+    {
+        bool written = std::ifstream(PhaseCheckpoint::GetFileName(prefix, phase, 0)).good();
+        NS_TEST_EXPECT_MSG_EQ(written, (phase == 1), "wrong checkpoint of phase " << phase);
+    }
+    PhaseEngine::Reset();
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup mpi-tests
+ * \brief PhaseCheckpoint TestSuite
+ */
+class PhaseCheckpointTestSuite : public TestSuite
+{
+  public:
+    PhaseCheckpointTestSuite();
+};
+
+PhaseCheckpointTestSuite::PhaseCheckpointTestSuite()
+    : TestSuite("mpi-phase-checkpoint", UNIT)
+{
+    AddTestCase(new PhaseCheckpointRestoreTest, TestCase::QUICK);
+    AddTestCase(new PhaseCheckpointPendingTest, TestCase::QUICK);
+}
+
+static PhaseCheckpointTestSuite
+    g_phaseCheckpointTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,363 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/distributed-simulator-impl.h"
+#include "ns3/global-value.h"
+#include "ns3/hybrid-simulator-impl.h"
+#include "ns3/mpi-interface.h"
+#include "ns3/node.h"
+#include "ns3/phase-engine.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/test.h"
+
+#include <mutex>
+#include <set>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup mpi-tests
+ * PhaseEngine test suite
+ */
+
+using namespace ns3;
+
+/**
+ * \ingroup mpi-tests
+ * Initialize MPI for the cases using it.  MPI can only be initialized
+ * once per process, so the cases share it and enable the interface on
+ * its communicator, which Disable keeps.
+ */
+static void
+InitializeMpi()
+{
+    int initialized = 0;
+    MPI_Initialized(&initialized);
+    if (!initialized)
+    {
+        int argc = 1;
+        char name[] = "mpi-phase-engine";
+        char* args[] = {name, nullptr};
+        char** argv = args;
+        MPI_Init(&argc, &argv);
+    }
+}
+
+/**
+ * \ingroup mpi-tests
+ * \brief Run consecutive phases in a sequential simulation
+ */
+class SequentialPhaseTest : public TestCase
+{
+  public:
+    SequentialPhaseTest();
+
+  protected:
+    /**
+     * Constructor
+     *
+     * \param name the name of the test case
+     * \param localEnd whether the phases end as soon as they are done
+     *        locally, rather than at the synchronization of the ranks
+     */
+    SequentialPhaseTest(const std::string& name, bool localEnd);
+
+    void DoRun() override;
+
+  private:
+    /**
+     * Notify the PhaseEngine that the current phase is done.
+     */
+    void LocalDone();
+
+    /**
+     * Start a phase that lasts (phase + 1) microseconds.
+     *
+     * \param phase the index of the phase
+     */
+    void PhaseStart(uint32_t phase);
+
+    /**
+     * Record the duration of a phase.
+     *
+     * \param phase the index of the phase
+     * \param fct the duration of the phase
+     */
+    void PhaseEnd(uint32_t phase, Time fct);
+
+    std::vector<Time> m_starts; //!< Time every phase started
+    std::vector<Time> m_fcts;   //!< Duration of every phase
+    bool m_localEnd;            //!< Whether the phases should end in NotifyLocalDone
+    bool m_notifying;           //!< Whether NotifyLocalDone is running
+};
+
+SequentialPhaseTest::SequentialPhaseTest()
+    : SequentialPhaseTest("Start every phase when the previous one is done, within one Run", true)
+{
+}
+
+SequentialPhaseTest::SequentialPhaseTest(const std::string& name, bool localEnd)
+    : TestCase(name),
+      m_localEnd(localEnd),
+      m_notifying(false)
+{
+}
+
+void
+SequentialPhaseTest::LocalDone()
+{
+    m_notifying = true;
+    PhaseEngine::NotifyLocalDone();
+    m_notifying = false;
+}
+
+void
+SequentialPhaseTest::PhaseStart(uint32_t phase)
+{
+    NS_TEST_EXPECT_MSG_EQ(phase, m_starts.size(), "phases out of order");
+    NS_TEST_EXPECT_MSG_EQ(PhaseEngine::GetPhase(), phase, "wrong current phase");
+    m_starts.push_back(Simulator::Now());
+    Simulator::Schedule(MicroSeconds(phase + 1), &SequentialPhaseTest::LocalDone, this);
+}
+
+void
+SequentialPhaseTest::PhaseEnd(uint32_t phase, Time fct)
+{
+    NS_TEST_EXPECT_MSG_EQ(phase, m_fcts.size(), "phases out of order");
+    NS_TEST_EXPECT_MSG_EQ(m_notifying,
+                          m_localEnd,
+                          "phase " << phase << " ended in the wrong place");
+    m_fcts.push_back(fct);
+}
+
+void
+SequentialPhaseTest::DoRun()
+{
+    PhaseEngine::SetPhaseStartCallback(MakeCallback(&SequentialPhaseTest::PhaseStart, this));
+    PhaseEngine::SetPhaseEndCallback(MakeCallback(&SequentialPhaseTest::PhaseEnd, this));
+    PhaseEngine::Start(4, MicroSeconds(10));
+    Simulator::Run();
+
+    NS_TEST_ASSERT_MSG_EQ(m_starts.size(), 4, "not every phase started");
+    NS_TEST_ASSERT_MSG_EQ(m_fcts.size(), 4, "not every phase ended");
+    Time start = MicroSeconds(10);
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        NS_TEST_EXPECT_MSG_EQ(m_starts[i], start, "phase " << i << " started late");
+        NS_TEST_EXPECT_MSG_EQ(PhaseEngine::GetPhaseStart(i), start, "wrong start " << i);
+        NS_TEST_EXPECT_MSG_EQ(m_fcts[i], MicroSeconds(i + 1), "wrong FCT " << i);
+        start += MicroSeconds(i + 1);
+        NS_TEST_EXPECT_MSG_EQ(PhaseEngine::GetPhaseEnd(i), start, "wrong end " << i);
+    }
+    NS_TEST_EXPECT_MSG_EQ(Simulator::Now(), start, "simulation ran past the last phase");
+
+    PhaseEngine::Reset();
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup mpi-tests
+ * \brief Run consecutive phases with a parallel simulator, on one rank
+ *
+ * The phases end at the synchronization of the ranks, with the
+ * DistributedSimulatorImpl and the HybridSimulatorImpl derived from it.
+ */
+class ParallelPhaseTest : public SequentialPhaseTest
+{
+  public:
+    /**
+     * Constructor
+     *
+     * \param tid the simulator implementation to run
+     * \param finalize whether to finalize MPI after the run
+     */
+    ParallelPhaseTest(TypeId tid, bool finalize);
+
+  private:
+    void DoRun() override;
+
+    TypeId m_tid;    //!< The simulator implementation
+    bool m_finalize; //!< Whether this is the last case using MPI
+};
+
+ParallelPhaseTest::ParallelPhaseTest(TypeId tid, bool finalize)
+    : SequentialPhaseTest("Synchronize the phases with the " + tid.GetName(), false),
+      m_tid(tid),
+      m_finalize(finalize)
+{
+}
+
+void
+ParallelPhaseTest::DoRun()
+{
+    InitializeMpi();
+    GlobalValue::Bind("SimulatorImplementationType", StringValue(m_tid.GetName()));
+    MpiInterface::Enable(MPI_COMM_WORLD);
+    NS_TEST_EXPECT_MSG_EQ(Simulator::GetImplementation()->GetInstanceTypeId(),
+                          m_tid,
+                          "wrong simulator implementation");
+
+    SequentialPhaseTest::DoRun();
+
+    MpiInterface::Disable();
+    if (m_finalize)
+    {
+        MPI_Finalize();
+    }
+    GlobalValue::Bind("SimulatorImplementationType", StringValue("ns3::DefaultSimulatorImpl"));
+}
+
+/**
+ * \ingroup mpi-tests
+ * \brief Run the phases on the two threads of a HybridSimulatorImpl
+ *
+ * Every phase starts on both threads, and the thread of node n is done
+ * (n + 1) * (phase + 1) microseconds later; the phase ends when the
+ * slower one is.
+ */
+class HybridThreadPhaseTest : public TestCase
+{
+  public:
+    /**
+     * Constructor
+     *
+     * \param finalize whether to finalize MPI after the run
+     */
+    HybridThreadPhaseTest(bool finalize);
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Start a phase on the thread of the current node.
+     *
+     * \param phase the index of the phase
+     */
+    void PhaseStart(uint32_t phase);
+
+    /**
+     * Record the duration of a phase.
+     *
+     * \param phase the index of the phase
+     * \param fct the duration of the phase
+     */
+    void PhaseEnd(uint32_t phase, Time fct);
+
+    std::mutex m_mutex;                        //!< Serializes PhaseStart between the threads
+    std::vector<std::set<uint32_t>> m_threads; //!< Threads every phase started on
+    std::vector<Time> m_fcts;                  //!< Duration of every phase
+    bool m_finalize;                           //!< Whether this is the last case using MPI
+};
+
+HybridThreadPhaseTest::HybridThreadPhaseTest(bool finalize)
+    : TestCase("Start the phases on every thread of the HybridSimulatorImpl"),
+      m_finalize(finalize)
+{
+}
+
+void
+HybridThreadPhaseTest::PhaseStart(uint32_t phase)
+{
+    uint32_t node = Simulator::GetContext();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_threads.size() <= phase)
+        {
+            m_threads.resize(phase + 1);
+        }
+        m_threads[phase].insert(HybridSimulatorImpl::GetThread(node));
+    }
+    Simulator::Schedule(MicroSeconds((node + 1) * (phase + 1)), &PhaseEngine::NotifyLocalDone);
+}
+
+void
+HybridThreadPhaseTest::PhaseEnd(uint32_t phase, Time fct)
+{
+    NS_TEST_EXPECT_MSG_EQ(phase, m_fcts.size(), "phases out of order");
+    m_fcts.push_back(fct);
+}
+
+void
+HybridThreadPhaseTest::DoRun()
+{
+    InitializeMpi();
+    GlobalValue::Bind("SimulatorImplementationType", StringValue("ns3::HybridSimulatorImpl"));
+    MpiInterface::Enable(MPI_COMM_WORLD);
+
+    // Two nodes on two threads, linked by a channel for the lookahead
+    Ptr<SimpleChannel> channel = CreateObject<SimpleChannel>();
+    channel->SetAttribute("Delay", TimeValue(MicroSeconds(1)));
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        Ptr<Node> node = CreateObject<Node>();
+        HybridSimulatorImpl::SetThread(node->GetId(), i);
+        Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice>();
+        device->SetChannel(channel);
+        node->AddDevice(device);
+    }
+
+    PhaseEngine::SetPhaseStartCallback(MakeCallback(&HybridThreadPhaseTest::PhaseStart, this));
+    PhaseEngine::SetPhaseEndCallback(MakeCallback(&HybridThreadPhaseTest::PhaseEnd, this));
+    PhaseEngine::Start(3, MicroSeconds(10));
+    Simulator::Run();
+
+    NS_TEST_EXPECT_MSG_EQ(m_threads.size(), 3, "not every phase started");
+    for (uint32_t i = 0; i < m_threads.size(); i++)
+    {
+        NS_TEST_EXPECT_MSG_EQ(m_threads[i].size(), 2, "phase " << i << " not on both threads");
+    }
+    NS_TEST_ASSERT_MSG_EQ(m_fcts.size(), 3, "not every phase ended");
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        NS_TEST_EXPECT_MSG_EQ(m_fcts[i], MicroSeconds(2 * (i + 1)), "wrong FCT " << i);
+    }
+
+    PhaseEngine::Reset();
+    Simulator::Destroy();
+    // The threads of the nodes outlive the simulator
+    HybridSimulatorImpl::SetThread(1, 0);
+
+    MpiInterface::Disable();
+    if (m_finalize)
+    {
+        MPI_Finalize();
+    }
+    GlobalValue::Bind("SimulatorImplementationType", StringValue("ns3::DefaultSimulatorImpl"));
+}
+
+/**
+ * \ingroup mpi-tests
+ * \brief PhaseEngine TestSuite
+ */
+class PhaseEngineTestSuite : public TestSuite
+{
+  public:
+    PhaseEngineTestSuite();
+};
+
+PhaseEngineTestSuite::PhaseEngineTestSuite()
+    : TestSuite("mpi-phase-engine", UNIT)
+{
+    AddTestCase(new SequentialPhaseTest, TestCase::QUICK);
+    AddTestCase(new ParallelPhaseTest(DistributedSimulatorImpl::GetTypeId(), false),
+                TestCase::QUICK);
+    AddTestCase(new ParallelPhaseTest(HybridSimulatorImpl::GetTypeId(), false), TestCase::QUICK);
+    AddTestCase(new HybridThreadPhaseTest(true), TestCase::QUICK);
+}
+
+static PhaseEngineTestSuite g_phaseEngineTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,135 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/global-value.h"
+#include "ns3/string.h"
+#include "ns3/sync-profiler.h"
+#include "ns3/test.h"
+
+#include <fstream>
+#include <sstream>
+
+/**
+ * \file
+ * \ingroup mpi-tests
+ * SyncProfiler test suite
+ */
+
+using namespace ns3;
+
+/**
+ * \ingroup mpi-tests
+ * \brief Record a few rounds and packets and check the written profile
+ */
+class SyncProfilerWriteTest : public TestCase
+{
+  public:
+    SyncProfilerWriteTest();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \param name the file name
+     * \return the contents of the file
+     */
+    static std::string Read(const std::string& name);
+};
+
+SyncProfilerWriteTest::SyncProfilerWriteTest()
+    : TestCase("Write the profile of a rank")
+{
+}
+
+std::string
+SyncProfilerWriteTest::Read(const std::string& name)
+{
+    std::ifstream is(name);
+    std::ostringstream os;
+    os << is.rdbuf();
+    return os.str();
+}
+
+void
+SyncProfilerWriteTest::DoRun()
+{
+    SyncProfiler::Enable(1, 3);
+    NS_TEST_ASSERT_MSG_EQ(SyncProfiler::IsEnabled(), false, "enabled without a prefix");
+
+    std::string prefix = CreateTempDirFilename("profile");
+    GlobalValue::Bind("MpiSyncProfile", StringValue(prefix));
+    SyncProfiler::Enable(1, 3);
+    GlobalValue::Bind("MpiSyncProfile", StringValue(""));
+    NS_TEST_ASSERT_MSG_EQ(SyncProfiler::IsEnabled(), true, "not enabled");
+
+    // Two windows of 10 and 20 us with 5 then 7 events, then the last
+    // round grants everything
+    SyncProfiler::StartRun();
+    SyncProfiler::RecordRound(MicroSeconds(0), MicroSeconds(10), 0);
+    SyncProfiler::RecordSend(0, 100);
+    SyncProfiler::RecordSend(2, 50);
+    SyncProfiler::RecordReceive(2, 70);
+    SyncProfiler::RecordNullMessage(2);
+    SyncProfiler::RecordRound(MicroSeconds(10), MicroSeconds(30), 5);
+    SyncProfiler::RecordRound(MicroSeconds(30), Time::Max(), 12);
+    SyncProfiler::StopRun();
+    SyncProfiler::Write();
+    NS_TEST_EXPECT_MSG_EQ(SyncProfiler::IsEnabled(), false, "still enabled after Write");
+
+    std::string json = Read(prefix + "-1.json");
+    for (const std::string& field : {
+             std::string("\"rank\": 1,"),
+             std::string("\"ranks\": 3,"),
+             std::string("\"rounds\": 3,"),
+             std::string("\"events\": 12,"),
+             std::string("\"txPackets\": 2,"),
+             std::string("\"txBytes\": 150,"),
+             std::string("\"rxPackets\": 1,"),
+             std::string("\"rxBytes\": 70,"),
+             std::string("\"txNullMessages\": 1,"),
+             std::string("\"windowNs\": {\"count\": 2, \"min\": 10000, \"max\": 20000"),
+             std::string("\"eventsPerWindow\": {\"count\": 2, \"min\": 5, \"max\": 7, "
+                         "\"mean\": 6, \"log2Buckets\": [0, 0, 0, 2]}"),
+         })
+    {
+        NS_TEST_EXPECT_MSG_NE(json.find(field), std::string::npos, "missing " << field);
+    }
+
+    std::string csv = Read(prefix + "-1.csv");
+    NS_TEST_EXPECT_MSG_EQ(csv,
+                          "rank,peer,txPackets,txBytes,rxPackets,rxBytes,txNullMessages\n"
+                          "1,0,1,100,0,0,0\n"
+                          "1,1,0,0,0,0,0\n"
+                          "1,2,1,50,1,70,1\n",
+                          "wrong peer counters");
+}
+
+/**
+ * \ingroup mpi-tests
+ * \brief SyncProfiler TestSuite
+ */
+class SyncProfilerTestSuite : public TestSuite
+{
+  public:
+    SyncProfilerTestSuite();
+};
+
+SyncProfilerTestSuite::SyncProfilerTestSuite()
+    : TestSuite("mpi-sync-profiler", UNIT)
+{
+    AddTestCase(new SyncProfilerWriteTest, TestCase::QUICK);
+}
+
+static SyncProfilerTestSuite g_syncProfilerTestSuite; //!< Static variable for test initialization
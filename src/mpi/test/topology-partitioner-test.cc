@@ -0,0 +1,184 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/topology-partitioner.h"
+
+#include <fstream>
+#include <set>
+
+/**
+ * \file
+ * \ingroup mpi-tests
+ * TopologyPartitioner test suite
+ */
+
+using namespace ns3;
+
+/**
+ * \ingroup mpi-tests
+ * \brief Partition a leaf-spine topology read from a file
+ */
+class LeafSpinePartitionTest : public TestCase
+{
+  public:
+    LeafSpinePartitionTest();
+
+  private:
+    void DoRun() override;
+};
+
+LeafSpinePartitionTest::LeafSpinePartitionTest()
+    : TestCase("Balance a leaf-spine topology and spread its spines over the ranks")
+{
+}
+
+void
+LeafSpinePartitionTest::DoRun()
+{
+    // same layout as generate_topology_leafspine.py
+    const uint32_t serversPerTor = 8;
+    const uint32_t tors = 16;
+    const uint32_t spines = 4;
+    const uint32_t servers = serversPerTor * tors;
+    std::string filename = CreateTempDirFilename("leaf-spine.txt");
+    {
+        std::ofstream topof(filename);
+        topof << servers + tors + spines << " " << tors + spines << " " << tors << " "
+              << servers + tors * spines << " 25000000000 25000000000\n";
+        for (uint32_t i = 0; i < tors + spines; i++)
+        {
+            topof << servers + i << " ";
+        }
+        topof << "\n";
+        for (uint32_t i = 0; i < tors; i++)
+        {
+            for (uint32_t j = 0; j < serversPerTor; j++)
+            {
+                topof << serversPerTor * i + j << " " << servers + i << " 25000000000 2us 0\n";
+            }
+        }
+        for (uint32_t i = 0; i < tors; i++)
+        {
+            for (uint32_t j = 0; j < spines; j++)
+            {
+                topof << servers + i << " " << servers + tors + j << " 25000000000 2us 0\n";
+            }
+        }
+    }
+
+    TopologyPartitioner partitioner;
+    NS_TEST_ASSERT_MSG_EQ(partitioner.ReadLeafSpine(filename), true, "cannot read topology");
+    NS_TEST_ASSERT_MSG_EQ(partitioner.GetNNodes(), servers + tors + spines, "wrong node count");
+
+    std::vector<uint32_t> sid = partitioner.Partition(4);
+    NS_TEST_ASSERT_MSG_EQ(sid.size(), servers + tors + spines, "wrong assignment size");
+    NS_TEST_ASSERT_MSG_LT_OR_EQ(partitioner.GetImbalance(sid), 1.05 + 1e-9, "ranks not balanced");
+    NS_TEST_ASSERT_MSG_EQ(partitioner.GetLookAhead(sid), MicroSeconds(2), "wrong lookahead");
+
+    // a ToR and its servers stay together, only the fabric links are cut
+    uint32_t splitRacks = 0;
+    for (uint32_t i = 0; i < servers; i++)
+    {
+        if (sid[i] != sid[servers + i / serversPerTor])
+        {
+            splitRacks++;
+        }
+    }
+    NS_TEST_ASSERT_MSG_LT_OR_EQ(splitRacks, serversPerTor, "too many servers away from their ToR");
+
+    std::set<uint32_t> spineRanks;
+    for (uint32_t j = 0; j < spines; j++)
+    {
+        spineRanks.insert(sid[servers + tors + j]);
+    }
+    NS_TEST_ASSERT_MSG_EQ(spineRanks.size(), spines, "spines not spread over the ranks");
+    // each ToR reaches the three spines of the other ranks
+    NS_TEST_ASSERT_MSG_EQ(partitioner.GetCutLinks(sid), tors * (spines - 1), "cut not minimal");
+}
+
+/**
+ * \ingroup mpi-tests
+ * \brief Prefer cutting long links, which sets the lookahead
+ */
+class LookAheadPartitionTest : public TestCase
+{
+  public:
+    LookAheadPartitionTest();
+
+  private:
+    void DoRun() override;
+};
+
+LookAheadPartitionTest::LookAheadPartitionTest()
+    : TestCase("Cut only the long links when the balance allows it")
+{
+}
+
+void
+LookAheadPartitionTest::DoRun()
+{
+    // two pods of 8 nodes in a ring of short links, joined by long links
+    // between every pair of nodes, so the cheapest cut in traffic would
+    // split the pods
+    TopologyPartitioner partitioner;
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        partitioner.AddNode(1);
+    }
+    for (uint32_t pod = 0; pod < 2; pod++)
+    {
+        for (uint32_t i = 0; i < 8; i++)
+        {
+            partitioner.AddLink(pod * 8 + i, pod * 8 + (i + 1) % 8, MicroSeconds(1), 1);
+        }
+    }
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        partitioner.AddLink(i, 8 + i, MicroSeconds(10), 1);
+    }
+
+    std::vector<uint32_t> sid = partitioner.Partition(2);
+    NS_TEST_ASSERT_MSG_EQ(partitioner.GetLookAhead(sid), MicroSeconds(10), "short link cut");
+    NS_TEST_ASSERT_MSG_EQ(partitioner.GetCutLinks(sid), 8, "wrong cut");
+    NS_TEST_ASSERT_MSG_EQ(partitioner.GetImbalance(sid), 1, "pods not on separate ranks");
+
+    // a pod too heavy for one rank has to be split
+    partitioner.SetNodeLoad(0, 20);
+    sid = partitioner.Partition(2);
+    NS_TEST_ASSERT_MSG_EQ(partitioner.GetLookAhead(sid), MicroSeconds(1), "heavy pod not split");
+    NS_TEST_ASSERT_MSG_LT_OR_EQ(partitioner.GetImbalance(sid),
+                                20.0 / 17.5 + 1e-9,
+                                "heavy node not alone");
+}
+
+/**
+ * \ingroup mpi-tests
+ * \brief TopologyPartitioner TestSuite
+ */
+class TopologyPartitionerTestSuite : public TestSuite
+{
+  public:
+    TopologyPartitionerTestSuite();
+};
+
+TopologyPartitionerTestSuite::TopologyPartitionerTestSuite()
+    : TestSuite("mpi-topology-partitioner", UNIT)
+{
+    AddTestCase(new LeafSpinePartitionTest, TestCase::QUICK);
+    AddTestCase(new LookAheadPartitionTest, TestCase::QUICK);
+}
+
+static TopologyPartitionerTestSuite g_topologyPartitionerTestSuite; //!< Static variable for test initialization
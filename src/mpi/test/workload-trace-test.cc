@@ -0,0 +1,141 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/workload-trace.h"
+
+#include <fstream>
+
+/**
+ * \file
+ * \ingroup mpi-tests
+ * WorkloadTrace test suite
+ */
+
+using namespace ns3;
+
+/**
+ * \ingroup mpi-tests
+ * \brief Convert a flow file and read it back on every rank
+ */
+class WorkloadTraceConvertTest : public TestCase
+{
+  public:
+    WorkloadTraceConvertTest();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \param range the flows of a phase
+     * \return the sizes of the flows, in order
+     */
+    static std::vector<uint64_t> Sizes(const WorkloadTrace::Range& range);
+};
+
+WorkloadTraceConvertTest::WorkloadTraceConvertTest()
+    : TestCase("Read the flows of every rank from a converted trace")
+{
+}
+
+std::vector<uint64_t>
+WorkloadTraceConvertTest::Sizes(const WorkloadTrace::Range& range)
+{
+    std::vector<uint64_t> sizes;
+    for (const WorkloadFlow& flow : range)
+    {
+        sizes.push_back(flow.size);
+    }
+    return sizes;
+}
+
+void
+WorkloadTraceConvertTest::DoRun()
+{
+    // Nodes 0 and 1 on rank 0, nodes 2 and 3 on rank 1; the second phase
+    // is empty and the third one stays on rank 1.
+    std::string text = CreateTempDirFilename("rdma_operate.txt");
+    std::ofstream(text)
+        << "stat rdma operate:\nphase:3000\n"
+           "Type rdma_send src_node 0 src_port 1000 dst_node 1 dst_port 1000 priority 0 msg_len 1\n"
+           "Type rdma_send src_node 1 src_port 1001 dst_node 2 dst_port 1001 priority 3 msg_len 2\n"
+           "Type rdma_send src_node 3 src_port 1002 dst_node 0 dst_port 1002 priority 0 msg_len 3\n"
+           "phase:3000\n"
+           "phase:3000\n"
+           "Type rdma_send src_node 2 src_port 1003 dst_node 3 dst_port 1003 priority 0 msg_len 4\n";
+    std::string binary = CreateTempDirFilename("rdma_operate.bin");
+    std::vector<uint32_t> assignment = {0, 0, 1, 1};
+    NS_TEST_ASSERT_MSG_EQ(WorkloadTrace::Convert(text, binary, assignment),
+                          true,
+                          "cannot convert");
+
+    WorkloadTrace rank0;
+    NS_TEST_ASSERT_MSG_EQ(rank0.Open(binary, 0, assignment), true, "cannot open");
+    NS_TEST_EXPECT_MSG_EQ(rank0.IsPartitioned(), true, "same assignment not partitioned");
+    NS_TEST_ASSERT_MSG_EQ(rank0.GetNPhases(), 3, "wrong number of phases");
+    NS_TEST_EXPECT_MSG_EQ((Sizes(rank0.GetFlows(0)) == std::vector<uint64_t>{1, 2, 3}),
+                          true,
+                          "wrong flows of rank 0");
+    NS_TEST_EXPECT_MSG_EQ(rank0.GetFlows(1).size(), 0, "flows in an empty phase");
+    rank0.Release(0);
+    NS_TEST_EXPECT_MSG_EQ(rank0.GetFlows(2).size(), 0, "flows of rank 1 on rank 0");
+
+    WorkloadTrace rank1;
+    NS_TEST_ASSERT_MSG_EQ(rank1.Open(binary, 1, assignment), true, "cannot open");
+    WorkloadTrace::Range flows = rank1.GetFlows(0);
+    NS_TEST_EXPECT_MSG_EQ((Sizes(flows) == std::vector<uint64_t>{2, 3}),
+                          true,
+                          "wrong flows of rank 1");
+    const WorkloadFlow& flow = *flows.begin();
+    NS_TEST_EXPECT_MSG_EQ(flow.src, 1, "wrong sender");
+    NS_TEST_EXPECT_MSG_EQ(flow.srcPort, 1001, "wrong sender port");
+    NS_TEST_EXPECT_MSG_EQ(flow.dst, 2, "wrong receiver");
+    NS_TEST_EXPECT_MSG_EQ(flow.dstPort, 1001, "wrong receiver port");
+    NS_TEST_EXPECT_MSG_EQ(+flow.priority, 3, "wrong priority");
+    NS_TEST_EXPECT_MSG_EQ((Sizes(rank1.GetFlows(2)) == std::vector<uint64_t>{4}),
+                          true,
+                          "wrong flows of rank 1 in the last phase");
+
+    // Another partition of the nodes reads every flow exactly once
+    WorkloadTrace other;
+    NS_TEST_ASSERT_MSG_EQ(other.Open(binary, 0, {0, 1, 1, 0}), true, "cannot open");
+    NS_TEST_EXPECT_MSG_EQ(other.IsPartitioned(), false, "other assignment partitioned");
+    NS_TEST_EXPECT_MSG_EQ((Sizes(other.GetFlows(0)) == std::vector<uint64_t>{1, 3}),
+                          true,
+                          "wrong filtered flows");
+    NS_TEST_EXPECT_MSG_EQ((Sizes(other.GetFlows(2)) == std::vector<uint64_t>{4}),
+                          true,
+                          "wrong filtered flows in the last phase");
+
+    NS_TEST_EXPECT_MSG_EQ(other.Open(text, 0, assignment), false, "opened a text file");
+}
+
+/**
+ * \ingroup mpi-tests
+ * \brief WorkloadTrace TestSuite
+ */
+class WorkloadTraceTestSuite : public TestSuite
+{
+  public:
+    WorkloadTraceTestSuite();
+};
+
+WorkloadTraceTestSuite::WorkloadTraceTestSuite()
+    : TestSuite("mpi-workload-trace", UNIT)
+{
+    AddTestCase(new WorkloadTraceConvertTest, TestCase::QUICK);
+}
+
+static WorkloadTraceTestSuite g_workloadTraceTestSuite; //!< Static variable for test initialization
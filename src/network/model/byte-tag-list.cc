@@ -54,15 +54,22 @@ struct ByteTagListData
  *
  * \brief Container class for struct ByteTagListData
  *
- * Internal use only.
+ * Internal use only.  One per thread.
  */
-static class ByteTagListDataFreeList : public std::vector<ByteTagListData*>
+static thread_local class ByteTagListDataFreeList : public std::vector<ByteTagListData*>
 {
   public:
     ~ByteTagListDataFreeList();
 } g_freeList; //!< Container for struct ByteTagListData
 
-static uint32_t g_maxSize = 0; //!< maximum data size (used for allocation)
+static thread_local uint32_t g_maxSize = 0; //!< maximum data size (used for allocation)
+
+/**
+ * Whether the free list of this thread was destroyed.  The thread_local
+ * destructors of the main thread run before the static ones, which may
+ * still release packets, so the free list must not be used again.
+ */
+static thread_local bool g_freeListDestroyed = false;
 
 ByteTagListDataFreeList::~ByteTagListDataFreeList()
 {
@@ -72,6 +79,8 @@ ByteTagListDataFreeList::~ByteTagListDataFreeList()
         uint8_t* buffer = (uint8_t*)(*i);
         delete[] buffer;
     }
+    clear();
+    g_freeListDestroyed = true;
 }
 #endif /* USE_FREE_LIST */
 
@@ -355,7 +364,7 @@ ByteTagListData*
 ByteTagList::Allocate(uint32_t size)
 {
     NS_LOG_FUNCTION(this << size);
-    while (!g_freeList.empty())
+    while (!g_freeListDestroyed && !g_freeList.empty())
     {
         ByteTagListData* data = g_freeList.back();
         g_freeList.pop_back();
@@ -389,7 +398,8 @@ ByteTagList::Deallocate(ByteTagListData* data)
     data->count--;
     if (data->count == 0)
     {
-        if (g_freeList.size() > FREE_LIST_SIZE || data->size < g_maxSize)
+        if (g_freeListDestroyed || g_freeList.size() > FREE_LIST_SIZE ||
+            data->size < g_maxSize)
         {
             uint8_t* buffer = (uint8_t*)data;
             delete[] buffer;
@@ -86,7 +86,8 @@ Node::GetTypeId()
 }
 
 Node::Node()
-    : m_id(0),
+    : m_nodeType(0),
+      m_id(0),
       m_sid(0)
 {
     NS_LOG_FUNCTION(this);
@@ -94,7 +95,8 @@ Node::Node()
 }
 
 Node::Node(uint32_t sid)
-    : m_id(0),
+    : m_nodeType(0),
+      m_id(0),
       m_sid(sid)
 {
     NS_LOG_FUNCTION(this << sid);
@@ -134,6 +136,26 @@ Node::GetSystemId() const
     return m_sid;
 }
 
+uint32_t
+Node::GetNodeType() const
+{
+    NS_LOG_FUNCTION(this);
+    return m_nodeType;
+}
+
+bool
+Node::SwitchReceiveFromDevice(Ptr<NetDevice> device, Ptr<Packet> packet, CustomHeader& ch)
+{
+    NS_LOG_FUNCTION(this << device << packet);
+    return false;
+}
+
+void
+Node::SwitchNotifyDequeue(uint32_t ifIndex, uint32_t qIndex, Ptr<Packet> p)
+{
+    NS_LOG_FUNCTION(this << ifIndex << qIndex << p);
+}
+
 uint32_t
 Node::AddDevice(Ptr<NetDevice> device)
 {
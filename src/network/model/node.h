@@ -34,6 +34,7 @@ class Application;
 class Packet;
 class Address;
 class Time;
+class CustomHeader;
 
 /**
  * \ingroup network
@@ -93,6 +94,38 @@ class Node : public Object
      */
     uint32_t GetSystemId() const;
 
+    /**
+     * \returns the type of this node: 0 for a host, 1 for a switch.
+     *
+     * The qbb net devices forward the frames they receive to
+     * SwitchReceiveFromDevice on switches and to the RDMA stack on hosts.
+     */
+    uint32_t GetNodeType() const;
+
+    /**
+     * \brief Forward a frame received by a switch port.
+     *
+     * Only switch nodes override this; the default implementation
+     * drops the frame.
+     *
+     * \param device the ingress NetDevice
+     * \param packet the frame, including its PPP header
+     * \param ch the parsed headers of the frame
+     * \returns true if the frame was accepted
+     */
+    virtual bool SwitchReceiveFromDevice(Ptr<NetDevice> device,
+                                         Ptr<Packet> packet,
+                                         CustomHeader& ch);
+
+    /**
+     * \brief Notify a switch that a frame left one of its egress queues.
+     *
+     * \param ifIndex the egress interface
+     * \param qIndex the egress queue (priority class)
+     * \param p the frame about to be transmitted
+     */
+    virtual void SwitchNotifyDequeue(uint32_t ifIndex, uint32_t qIndex, Ptr<Packet> p);
+
     /**
      * \brief Associate a NetDevice to this node.
      *
@@ -221,6 +254,8 @@ class Node : public Object
     void DoDispose() override;
     void DoInitialize() override;
 
+    uint32_t m_nodeType; //!< 0 for a host, 1 for a switch
+
   private:
     /**
      * \brief Notifies all the DeviceAdditionListener about the new device added.
@@ -19,7 +19,8 @@
 
 /**
 \file   packet-tag-list.cc
-\brief  Implements a linked list of Packet tags, including copy-on-write semantics.
+\brief  Implements the list of Packet tags: a few inline, the others in a linked
+        list with copy-on-write semantics.
 */
 
 #include "packet-tag-list.h"
@@ -172,9 +173,29 @@ PacketTagList::COWTraverse(Tag& tag, PacketTagList::COWWriter Writer)
     return found;
 }
 
+void
+PacketTagList::RemoveInline(uint32_t i)
+{
+    NS_ASSERT(i < m_inlineCount);
+    --m_inlineCount;
+    for (; i < m_inlineCount; ++i)
+    {
+        m_inline[i] = m_inline[i + 1];
+    }
+}
+
 bool
 PacketTagList::Remove(Tag& tag)
 {
+    uint32_t i = FindInline(tag.GetInstanceTypeId());
+    if (i < m_inlineCount)
+    {
+        NS_LOG_INFO("found tid inline");
+        InlineTagData& cur = m_inline[i];
+        tag.Deserialize(TagBuffer(cur.data, cur.data + cur.size));
+        RemoveInline(i);
+        return true;
+    }
     return COWTraverse(tag, &PacketTagList::RemoveWriter);
 }
 
@@ -215,6 +236,25 @@ PacketTagList::RemoveWriter(Tag& tag,
 bool
 PacketTagList::Replace(Tag& tag)
 {
+    uint32_t i = FindInline(tag.GetInstanceTypeId());
+    if (i < m_inlineCount)
+    {
+        NS_LOG_INFO("found tid inline");
+        uint32_t size = tag.GetSerializedSize();
+        if (size <= INLINE_TAG_SIZE)
+        {
+            InlineTagData& cur = m_inline[i];
+            cur.size = size;
+            tag.Serialize(TagBuffer(cur.data, cur.data + cur.size));
+        }
+        else
+        {
+            // the new value no longer fits inline
+            RemoveInline(i);
+            Add(tag);
+        }
+        return true;
+    }
     bool found = COWTraverse(tag, &PacketTagList::ReplaceWriter);
     if (!found)
     {
@@ -263,11 +303,23 @@ PacketTagList::Add(const Tag& tag) const
 {
     NS_LOG_FUNCTION(this << tag.GetInstanceTypeId());
     // ensure this id was not yet added
+    NS_ASSERT_MSG(FindInline(tag.GetInstanceTypeId()) == m_inlineCount,
+                  "Error: cannot add the same kind of tag twice.");
     for (TagData* cur = m_next; cur != nullptr; cur = cur->next)
     {
         NS_ASSERT_MSG(cur->tid != tag.GetInstanceTypeId(),
                       "Error: cannot add the same kind of tag twice.");
     }
+    uint32_t size = tag.GetSerializedSize();
+    if (m_inlineCount < INLINE_TAGS && size <= INLINE_TAG_SIZE)
+    {
+        PacketTagList* self = const_cast<PacketTagList*>(this);
+        InlineTagData& slot = self->m_inline[self->m_inlineCount++];
+        slot.tid = tag.GetInstanceTypeId();
+        slot.size = size;
+        tag.Serialize(TagBuffer(slot.data, slot.data + slot.size));
+        return;
+    }
     TagData* head = CreateTagData(tag.GetSerializedSize());
     head->count = 1;
     head->next = nullptr;
@@ -283,6 +335,15 @@ PacketTagList::Peek(Tag& tag) const
 {
     NS_LOG_FUNCTION(this << tag.GetInstanceTypeId());
     TypeId tid = tag.GetInstanceTypeId();
+    uint32_t i = FindInline(tid);
+    if (i < m_inlineCount)
+    {
+        /* found tag inline */
+        const InlineTagData& cur = m_inline[i];
+        tag.Deserialize(TagBuffer(const_cast<uint8_t*>(cur.data),
+                                  const_cast<uint8_t*>(cur.data) + cur.size));
+        return true;
+    }
     for (TagData* cur = m_next; cur != nullptr; cur = cur->next)
     {
         if (cur->tid == tid)
@@ -311,8 +372,7 @@ PacketTagList::GetSerializedSize() const
 
     size = 4; // numberOfTags
 
-    for (TagData* cur = m_next; cur != nullptr; cur = cur->next)
-    {
+    auto addTag = [&size](uint32_t tagSize) {
         size += 4; // TagData -> size
 
         // TypeId hash; ensure size is multiple of 4 bytes
@@ -320,8 +380,17 @@ PacketTagList::GetSerializedSize() const
         size += hashSize;
 
         // TagData -> data; ensure size is multiple of 4 bytes
-        uint32_t tagWordSize = (cur->size + 3) & (~3);
+        uint32_t tagWordSize = (tagSize + 3) & (~3);
         size += tagWordSize;
+    };
+
+    for (uint32_t i = 0; i < m_inlineCount; ++i)
+    {
+        addTag(m_inline[i].size);
+    }
+    for (TagData* cur = m_next; cur != nullptr; cur = cur->next)
+    {
+        addTag(cur->size);
     }
 
     return size;
@@ -348,48 +417,64 @@ PacketTagList::Serialize(uint32_t* buffer, uint32_t maxSize) const
         return 0;
     }
 
-    for (TagData* cur = m_next; cur != nullptr; cur = cur->next)
-    {
+    // the inline tags first, then the others
+    auto serializeTag = [&](TypeId tagTid, uint32_t tagSize, const uint8_t* tagData) {
         if (size + 4 <= maxSize)
         {
-            *p++ = cur->size;
+            *p++ = tagSize;
             size += 4;
         }
         else
         {
-            return 0;
+            return false;
         }
 
-        NS_LOG_INFO("Serializing tag id " << cur->tid);
+        NS_LOG_INFO("Serializing tag id " << tagTid);
 
         // ensure size is multiple of 4 bytes for 4 byte boundaries
         uint32_t hashSize = (sizeof(TypeId::hash_t) + 3) & (~3);
         if (size + hashSize <= maxSize)
         {
-            TypeId::hash_t tid = cur->tid.GetHash();
+            TypeId::hash_t tid = tagTid.GetHash();
             memcpy(p, &tid, sizeof(TypeId::hash_t));
             p += hashSize / 4;
             size += hashSize;
         }
         else
         {
-            return 0;
+            return false;
         }
 
         // ensure size is multiple of 4 bytes for 4 byte boundaries
-        uint32_t tagWordSize = (cur->size + 3) & (~3);
+        uint32_t tagWordSize = (tagSize + 3) & (~3);
         if (size + tagWordSize <= maxSize)
         {
-            memcpy(p, cur->data, cur->size);
+            memcpy(p, tagData, tagSize);
             size += tagWordSize;
             p += tagWordSize / 4;
         }
         else
         {
-            return 0;
+            return false;
         }
 
         (*numberOfTags)++;
+        return true;
+    };
+
+    for (uint32_t i = 0; i < m_inlineCount; ++i)
+    {
+        if (!serializeTag(m_inline[i].tid, m_inline[i].size, m_inline[i].data))
+        {
+            return 0;
+        }
+    }
+    for (TagData* cur = m_next; cur != nullptr; cur = cur->next)
+    {
+        if (!serializeTag(cur->tid, cur->size, cur->data))
+        {
+            return 0;
+        }
     }
 
     // Serialized successfully
@@ -427,30 +512,39 @@ PacketTagList::Deserialize(const uint32_t* buffer, uint32_t size)
 
         NS_LOG_INFO("Deserializing tag of type " << tid);
 
-        TagData* newTag = CreateTagData(tagSize);
-        newTag->count = 1;
-        newTag->next = nullptr;
-        newTag->tid = tid;
-
         NS_ASSERT(sizeCheck >= tagSize);
-        memcpy(newTag->data, p, tagSize);
-
-        // ensure 4 byte boundary
-        uint32_t tagWordSize = (tagSize + 3) & (~3);
-        p += tagWordSize / 4;
-        sizeCheck -= tagWordSize;
-
-        // Set link list pointers.
-        if (i == 0)
+        if (m_inlineCount < INLINE_TAGS && tagSize <= INLINE_TAG_SIZE)
         {
-            m_next = newTag;
+            InlineTagData& slot = m_inline[m_inlineCount++];
+            slot.tid = tid;
+            slot.size = tagSize;
+            memcpy(slot.data, p, tagSize);
         }
         else
         {
-            prevTag->next = newTag;
+            TagData* newTag = CreateTagData(tagSize);
+            newTag->count = 1;
+            newTag->next = nullptr;
+            newTag->tid = tid;
+            memcpy(newTag->data, p, tagSize);
+
+            // Set link list pointers.
+            if (prevTag == nullptr)
+            {
+                m_next = newTag;
+            }
+            else
+            {
+                prevTag->next = newTag;
+            }
+
+            prevTag = newTag;
         }
 
-        prevTag = newTag;
+        // ensure 4 byte boundary
+        uint32_t tagWordSize = (tagSize + 3) & (~3);
+        p += tagWordSize / 4;
+        sizeCheck -= tagWordSize;
     }
 
     NS_ASSERT(sizeCheck == 0);
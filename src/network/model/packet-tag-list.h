@@ -21,9 +21,11 @@
 
 /**
 \file   packet-tag-list.h
-\brief  Defines a linked list of Packet tags, including copy-on-write semantics.
+\brief  Defines the list of Packet tags: a few inline, the others in a linked
+        list with copy-on-write semantics.
 */
 
+#include "ns3/assert.h"
 #include "ns3/type-id.h"
 
 #include <ostream>
@@ -120,6 +122,15 @@ class Tag;
  *       The portion of the list between the first branch and the target is
  *       shared. This portion is copied before the #Remove or #Replace is
  *       performed.
+ *
+ * \par <b> Inline tags </b>
+ *   The first #INLINE_TAGS tags added, of at most #INLINE_TAG_SIZE bytes
+ *   each, are not stored in the tree but in the PacketTagList itself,
+ *   and so in the Packet, without any allocation.  They are copied with
+ *   the PacketTagList, which costs no more than sharing a branch for so
+ *   few small tags, and are then modified in place.  Only the tags added
+ *   once the inline slots are full, or too large for them, go to the
+ *   tree.  Slots freed by #Remove are reused by the next #Add.
  */
 class PacketTagList
 {
@@ -148,6 +159,23 @@ class PacketTagList
         uint8_t data[1]; //!< Serialization buffer
     };
 
+    /// Maximum number of tags stored inline.
+    static constexpr uint32_t INLINE_TAGS = 4;
+    /// Maximum serialized size of a tag stored inline.
+    static constexpr uint32_t INLINE_TAG_SIZE = 21;
+
+    /**
+     * A tag stored inline, in the PacketTagList itself.
+     *
+     * See PacketTagList for a discussion of the data structure.
+     */
+    struct InlineTagData
+    {
+        TypeId tid;                    //!< Type of the tag serialized into #data
+        uint8_t size;                  //!< Size of the serialized tag
+        uint8_t data[INLINE_TAG_SIZE]; //!< Serialization buffer
+    };
+
     /**
      * Create a new PacketTagList.
      */
@@ -157,7 +185,7 @@ class PacketTagList
      *
      * \param [in] o The PacketTagList to copy.
      *
-     * This makes a light-weight copy by #RemoveAll, then
+     * This makes a light-weight copy by copying the inline tags, then
      * pointing to the same \ref TagData as \pname{o}.
      */
     inline PacketTagList(const PacketTagList& o);
@@ -167,8 +195,9 @@ class PacketTagList
      * \param [in] o The PacketTagList to copy.
      * \returns the copied object
      *
-     * This makes a light-weight copy by #RemoveAll, then
-     * pointing to the same \ref TagData as \pname{o}.
+     * This makes a light-weight copy by copying the inline tags, then
+     * #RemoveAll and pointing to the same \ref TagData as \pname{o}
+     * if they are not already shared.
      */
     inline PacketTagList& operator=(const PacketTagList& o);
     /**
@@ -211,13 +240,23 @@ class PacketTagList
      */
     bool Peek(Tag& tag) const;
     /**
-     * Remove all tags from this list (up to the first merge).
+     * Remove all tags from this list (the inline tags, and the others
+     * up to the first merge).
      */
     inline void RemoveAll();
     /**
-     * \returns pointer to head of tag list
+     * \returns pointer to head of the list of the tags not stored inline
      */
     const PacketTagList::TagData* Head() const;
+    /**
+     * \returns the number of tags stored inline
+     */
+    inline uint32_t InlineCount() const;
+    /**
+     * \param [in] i The index of the inline tag, less than #InlineCount.
+     * \returns the inline tag, the oldest at index 0
+     */
+    inline const PacketTagList::InlineTagData& Inline(uint32_t i) const;
     /**
      * Returns number of bytes required for packet serialization.
      *
@@ -253,6 +292,20 @@ class PacketTagList
      */
     static TagData* CreateTagData(size_t dataSize);
 
+    /**
+     * Find an inline tag.
+     *
+     * \param [in] tid The type of the tag.
+     * \returns The index of the tag, or #InlineCount if not found.
+     */
+    inline uint32_t FindInline(TypeId tid) const;
+    /**
+     * Remove an inline tag, keeping the order of the others.
+     *
+     * \param [in] i The index of the tag.
+     */
+    void RemoveInline(uint32_t i);
+
     /**
      * Typedef of method function pointer for copy-on-write operations
      *
@@ -305,6 +358,14 @@ class PacketTagList
      * Pointer to first \ref TagData on the list
      */
     TagData* m_next;
+    /**
+     * Number of tags used in #m_inline
+     */
+    uint32_t m_inlineCount;
+    /**
+     * The tags stored inline, the oldest first
+     */
+    InlineTagData m_inline[INLINE_TAGS];
 };
 
 } // namespace ns3
@@ -317,13 +378,19 @@ namespace ns3
 {
 
 PacketTagList::PacketTagList()
-    : m_next()
+    : m_next(),
+      m_inlineCount(0)
 {
 }
 
 PacketTagList::PacketTagList(const PacketTagList& o)
-    : m_next(o.m_next)
+    : m_next(o.m_next),
+      m_inlineCount(o.m_inlineCount)
 {
+    for (uint32_t i = 0; i < m_inlineCount; ++i)
+    {
+        m_inline[i] = o.m_inline[i];
+    }
     if (m_next != nullptr)
     {
         m_next->count++;
@@ -334,15 +401,23 @@ PacketTagList&
 PacketTagList::operator=(const PacketTagList& o)
 {
     // self assignment
-    if (m_next == o.m_next)
+    if (this == &o)
     {
         return *this;
     }
-    RemoveAll();
-    m_next = o.m_next;
-    if (m_next != nullptr)
+    if (m_next != o.m_next)
     {
-        m_next->count++;
+        RemoveAll();
+        m_next = o.m_next;
+        if (m_next != nullptr)
+        {
+            m_next->count++;
+        }
+    }
+    m_inlineCount = o.m_inlineCount;
+    for (uint32_t i = 0; i < m_inlineCount; ++i)
+    {
+        m_inline[i] = o.m_inline[i];
     }
     return *this;
 }
@@ -355,6 +430,7 @@ PacketTagList::~PacketTagList()
 void
 PacketTagList::RemoveAll()
 {
+    m_inlineCount = 0;
     TagData* prev = nullptr;
     for (TagData* cur = m_next; cur != nullptr; cur = cur->next)
     {
@@ -378,6 +454,30 @@ PacketTagList::RemoveAll()
     m_next = nullptr;
 }
 
+uint32_t
+PacketTagList::InlineCount() const
+{
+    return m_inlineCount;
+}
+
+const PacketTagList::InlineTagData&
+PacketTagList::Inline(uint32_t i) const
+{
+    NS_ASSERT(i < m_inlineCount);
+    return m_inline[i];
+}
+
+uint32_t
+PacketTagList::FindInline(TypeId tid) const
+{
+    uint32_t i = 0;
+    while (i < m_inlineCount && m_inline[i].tid != tid)
+    {
+        ++i;
+    }
+    return i;
+}
+
 } // namespace ns3
 
 #endif /* PACKET_TAG_LIST_H */
@@ -33,6 +33,7 @@
 #include "ns3/mac48-address.h"
 #include "ns3/ptr.h"
 
+#include <atomic>
 #include <stdint.h>
 
 namespace ns3
@@ -160,10 +161,14 @@ class PacketTagIterator
         friend class PacketTagIterator;
         /**
          * Constructor
-         * \param data the data to copy.
+         * \param tid the type of the tag.
+         * \param size the size of the serialized tag.
+         * \param data the serialized tag.
          */
-        Item(const PacketTagList::TagData* data);
-        const PacketTagList::TagData* m_data; //!< the tag data
+        Item(TypeId tid, uint32_t size, const uint8_t* data);
+        TypeId m_tid;          //!< the type of the tag
+        uint32_t m_size;       //!< the size of the serialized tag
+        const uint8_t* m_data; //!< the serialized tag
     };
 
     /**
@@ -180,10 +185,12 @@ class PacketTagIterator
     friend class Packet;
     /**
      * Constructor
-     * \param head head of the items
+     * \param list the list of the items
      */
-    PacketTagIterator(const PacketTagList::TagData* head);
-    const PacketTagList::TagData* m_current; //!< actual position over the set of tags in a packet
+    PacketTagIterator(const PacketTagList& list);
+    const PacketTagList* m_list;             //!< the list of the tags in a packet
+    const PacketTagList::TagData* m_current; //!< actual position over the tags not stored inline
+    uint32_t m_inline;                       //!< number of inline tags left to visit
 };
 
 /**
@@ -795,7 +802,11 @@ class Packet : public SimpleRefCount<Packet>
     /* Please see comments above about nix-vector */
     mutable Ptr<NixVector> m_nixVector; //!< the packet's Nix vector
 
-    static uint32_t m_globalUid; //!< Global counter of packets Uid
+    /**
+     * Global counter of packets Uid, shared by the threads of a
+     * HybridSimulatorImpl.
+     */
+    static std::atomic<uint32_t> m_globalUid;
 };
 
 /**
@@ -1202,6 +1202,65 @@ PacketTagListTest::DoRun()
     ReplaceCheck(7);
 }
 
+{ // Inline tags
+    std::cout << GetName() << "check inline tags" << std::endl;
+    NS_TEST_EXPECT_MSG_EQ(ref.InlineCount(), PacketTagList::INLINE_TAGS, "inline tags of ref");
+
+    PacketTagList ptl = ref;
+    ATestTag<8> t8(1);
+    ptl.Remove(t2);
+    ptl.Add(t8); // reuses the inline slot of t2
+    NS_TEST_EXPECT_MSG_EQ(ptl.InlineCount(), PacketTagList::INLINE_TAGS, "inline slot reused");
+    CheckRefList(ref, "inline slot reused, orig");
+    CheckRefList(ptl, "inline slot reused, copy", 2);
+    CheckRef(ptl, t8, "inline slot reused, copy");
+
+    ATestTag<PacketTagList::INLINE_TAG_SIZE> large(3); // too large by the size of m_data
+    PacketTagList big;
+    big.Add(large);
+    NS_TEST_EXPECT_MSG_EQ(big.InlineCount(), 0U, "tag too large to be stored inline");
+    CheckRef(big, large, "large tag");
+
+    // every tag is visited by the iterator and kept by serialization
+    Ptr<Packet> p = Create<Packet>(10);
+    ATestTag<1> p1(1);
+    ATestTag<2> p2(2);
+    ATestTag<3> p3(3);
+    ATestTag<4> p4(4);
+    ATestTag<5> p5(5);
+    p->AddPacketTag(p1);
+    p->AddPacketTag(p2);
+    p->AddPacketTag(large);
+    p->AddPacketTag(p3);
+    p->AddPacketTag(p4);
+    p->AddPacketTag(p5);
+    p->RemovePacketTag(p2);
+    uint32_t nTags = 0;
+    PacketTagIterator i = p->GetPacketTagIterator();
+    while (i.HasNext())
+    {
+        i.Next();
+        nTags++;
+    }
+    NS_TEST_EXPECT_MSG_EQ(nTags, 5U, "tags visited by the iterator");
+
+    uint32_t serializedSize = p->GetSerializedSize();
+    std::vector<uint8_t> buffer(serializedSize);
+    NS_TEST_EXPECT_MSG_EQ(p->Serialize(buffer.data(), serializedSize), 1U, "serialization");
+    Ptr<Packet> q = Create<Packet>(buffer.data(), serializedSize, true);
+    NS_TEST_EXPECT_MSG_EQ(q->PeekPacketTag(p2), false, "removed tag deserialized");
+    ATestTagBase* expected[] = {&p1, &large, &p3, &p4, &p5};
+    for (ATestTagBase* t : expected)
+    {
+        int value = t->GetData();
+        t->m_data = 0;
+        NS_TEST_EXPECT_MSG_EQ(q->PeekPacketTag(*t),
+                              true,
+                              "deserialized " << t->GetInstanceTypeId());
+        NS_TEST_EXPECT_MSG_EQ(t->GetData(), value, "deserialized " << t->GetInstanceTypeId());
+    }
+}
+
 { // Timing
     std::cout << GetName() << "add+remove timing" << std::endl;
     int flm = std::numeric_limits<int>::max();
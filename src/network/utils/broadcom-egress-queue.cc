@@ -0,0 +1,189 @@
+#include <iostream>
+#include <stdio.h>
+#include "broadcom-egress-queue.h"
+#include "ns3/log.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include "ns3/simulator.h"
+
+NS_LOG_COMPONENT_DEFINE ("BEgressQueue");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (BEgressQueue);
+
+TypeId BEgressQueue::GetTypeId (void)
+{
+	static TypeId tid = TypeId ("ns3::BEgressQueue")
+		.SetParent<Queue<Packet> > ()
+		.SetGroupName ("Network")
+		.AddConstructor<BEgressQueue> ()
+		.AddAttribute ("MaxBytes",
+		               "The maximum number of bytes accepted by this BEgressQueue.",
+		               DoubleValue (1000.0 * 1024 * 1024),
+		               MakeDoubleAccessor (&BEgressQueue::m_maxBytes),
+		               MakeDoubleChecker<double> ())
+		.AddTraceSource ("BeqEnqueue", "Enqueue a packet in the BEgressQueue. Multiple queue",
+		                 MakeTraceSourceAccessor (&BEgressQueue::m_traceBeqEnqueue),
+		                 "ns3::BEgressQueue::BeqEnqueue")
+		.AddTraceSource ("BeqDequeue", "Dequeue a packet in the BEgressQueue. Multiple queue",
+		                 MakeTraceSourceAccessor (&BEgressQueue::m_traceBeqDequeue),
+		                 "ns3::BEgressQueue::BeqDequeue")
+		;
+	return tid;
+}
+
+BEgressQueue::BEgressQueue () :
+	Queue<Packet> (),
+	NS_LOG_TEMPLATE_DEFINE ("BEgressQueue")
+{
+	NS_LOG_FUNCTION_NOARGS ();
+	m_bytesInQueueTotal = 0;
+	m_rrlast = 0;
+	m_qlast = 0;
+	for (uint32_t i = 0; i < fCnt; i++)
+	{
+		m_bytesInQueue[i] = 0;
+	}
+	for (uint32_t i = 0; i < qCnt; i++)
+	{
+		Ptr<DropTailQueue<Packet> > q = CreateObject<DropTailQueue<Packet> > ();
+		q->SetMaxSize (QueueSize (BYTES, 0xffffffff)); // admission is done by the MMU
+		m_queues.push_back (q);
+	}
+}
+
+BEgressQueue::~BEgressQueue ()
+{
+	NS_LOG_FUNCTION_NOARGS ();
+}
+
+bool BEgressQueue::DoEnqueue (Ptr<Packet> p, uint32_t qIndex)
+{
+	NS_LOG_FUNCTION (this << p);
+
+	if (m_bytesInQueueTotal + p->GetSize () < m_maxBytes) // infinite queue
+	{
+		m_queues[qIndex]->Enqueue (p);
+		m_bytesInQueueTotal += p->GetSize ();
+		m_bytesInQueue[qIndex] += p->GetSize ();
+	}
+	else
+	{
+		return false;
+	}
+	return true;
+}
+
+Ptr<Packet> BEgressQueue::DoDequeueRR (bool paused[]) // this is for switch only
+{
+	NS_LOG_FUNCTION (this);
+
+	if (m_bytesInQueueTotal == 0)
+	{
+		NS_LOG_LOGIC ("Queue empty");
+		return 0;
+	}
+	bool found = false;
+	uint32_t qIndex;
+
+	if (m_queues[0]->GetNPackets () > 0) // 0 is the highest priority
+	{
+		found = true;
+		qIndex = 0;
+	}
+	else
+	{
+		for (qIndex = 1; qIndex <= qCnt; qIndex++)
+		{
+			uint32_t idx = (qIndex + m_rrlast) % qCnt;
+			if (!paused[idx] && m_queues[idx]->GetNPackets () > 0)
+			{
+				found = true;
+				qIndex = idx;
+				break;
+			}
+		}
+		if (found)
+		{
+			m_rrlast = qIndex;
+		}
+	}
+	if (found)
+	{
+		Ptr<Packet> p = m_queues[qIndex]->Dequeue ();
+		m_traceBeqDequeue (p, qIndex);
+		m_bytesInQueueTotal -= p->GetSize ();
+		m_bytesInQueue[qIndex] -= p->GetSize ();
+		m_qlast = qIndex;
+		NS_LOG_LOGIC ("Popped " << p);
+		NS_LOG_LOGIC ("Number bytes " << m_bytesInQueueTotal);
+		return p;
+	}
+	NS_LOG_LOGIC ("Nothing can be sent");
+	return 0;
+}
+
+bool BEgressQueue::Enqueue (Ptr<Packet> p, uint32_t qIndex)
+{
+	NS_LOG_FUNCTION (this << p);
+	//
+	// If DoEnqueue fails, Queue::Drop is called by the subclass
+	//
+	bool retval = DoEnqueue (p, qIndex);
+	if (retval)
+	{
+		NS_LOG_LOGIC ("m_traceEnqueue (p)");
+		m_traceBeqEnqueue (p, qIndex);
+	}
+	return retval;
+}
+
+Ptr<Packet> BEgressQueue::DequeueRR (bool paused[])
+{
+	NS_LOG_FUNCTION (this);
+	return DoDequeueRR (paused);
+}
+
+bool BEgressQueue::Enqueue (Ptr<Packet> p)
+{
+	return Enqueue (p, 0);
+}
+
+Ptr<Packet> BEgressQueue::Dequeue (void)
+{
+	bool paused[qCnt] = {false};
+	return DequeueRR (paused);
+}
+
+Ptr<Packet> BEgressQueue::Remove (void)
+{
+	return Dequeue ();
+}
+
+Ptr<const Packet> BEgressQueue::Peek (void) const
+{
+	for (uint32_t i = 0; i < qCnt; i++)
+	{
+		if (m_queues[i]->GetNPackets () > 0)
+			return m_queues[i]->Peek ();
+	}
+	return 0;
+}
+
+uint32_t BEgressQueue::GetNBytes (uint32_t qIndex) const
+{
+	return m_bytesInQueue[qIndex];
+}
+
+uint32_t BEgressQueue::GetNBytesTotal () const
+{
+	return m_bytesInQueueTotal;
+}
+
+uint32_t BEgressQueue::GetLastQueue ()
+{
+	return m_qlast;
+}
+
+} // namespace ns3
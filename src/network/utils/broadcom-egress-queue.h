@@ -0,0 +1,63 @@
+#ifndef BROADCOM_EGRESS_H
+#define BROADCOM_EGRESS_H
+
+#include <queue>
+#include <vector>
+#include "ns3/packet.h"
+#include "ns3/queue.h"
+#include "ns3/drop-tail-queue.h"
+#include "ns3/traced-callback.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup queue
+ * \brief Egress port of a shared buffer switch, one FIFO per priority class
+ *
+ * Queue 0 carries PFC, CNP and (optionally) ACK frames and is served with
+ * strict priority; the other classes are served round robin while they are
+ * not paused by PFC. Buffer admission is done by the switch MMU, so the
+ * sub-queues themselves never drop.
+ */
+class BEgressQueue : public Queue<Packet> {
+public:
+	static TypeId GetTypeId (void);
+	static const unsigned fCnt = 128; // max number of queues, 128 for NICs
+	static const unsigned qCnt = 8; // max number of queues, 8 for switches
+
+	BEgressQueue ();
+	virtual ~BEgressQueue ();
+
+	bool Enqueue (Ptr<Packet> p, uint32_t qIndex);
+	Ptr<Packet> DequeueRR (bool paused[]);
+	uint32_t GetNBytes (uint32_t qIndex) const;
+	uint32_t GetNBytesTotal () const;
+	uint32_t GetLastQueue ();
+
+	// for compatibility with Queue<Packet>, all use queue 0 and ignore PFC
+	virtual bool Enqueue (Ptr<Packet> p) override;
+	virtual Ptr<Packet> Dequeue (void) override;
+	virtual Ptr<Packet> Remove (void) override;
+	virtual Ptr<const Packet> Peek (void) const override;
+	using Queue<Packet>::GetNBytes;
+
+	TracedCallback<Ptr<const Packet>, uint32_t> m_traceBeqEnqueue;
+	TracedCallback<Ptr<const Packet>, uint32_t> m_traceBeqDequeue;
+
+private:
+	bool DoEnqueue (Ptr<Packet> p, uint32_t qIndex);
+	Ptr<Packet> DoDequeueRR (bool paused[]);
+
+	double m_maxBytes; // total bytes limit
+	uint32_t m_bytesInQueue[fCnt];
+	uint32_t m_bytesInQueueTotal;
+	uint32_t m_rrlast;
+	uint32_t m_qlast;
+	std::vector<Ptr<DropTailQueue<Packet> > > m_queues; // uc queues
+
+	NS_LOG_TEMPLATE_DECLARE; //!< redefinition of the log component
+};
+
+} // namespace ns3
+
+#endif /* BROADCOM_EGRESS_H */
@@ -0,0 +1,270 @@
+#include <stdint.h>
+#include <iostream>
+#include <cstring>
+#include "custom-header.h"
+#include "ns3/log.h"
+
+NS_LOG_COMPONENT_DEFINE ("CustomHeader");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (CustomHeader);
+
+CustomHeader::CustomHeader ()
+  : CustomHeader (L2_Header | L3_Header | L4_Header)
+{
+}
+
+CustomHeader::CustomHeader (uint32_t _headerType)
+  : headerType (_headerType),
+    l2Size (0), l3Size (0), l4Size (0),
+    pppProto (0),
+    m_payloadSize (0), ipid (0), m_tos (0), m_ttl (0), l3Prot (0), ipv4Flags (0),
+    m_fragmentOffset (0), sip (0), dip (0), m_checksum (0), m_headerSize (20),
+    getInt (0)
+{
+  memset (&tcp, 0, sizeof (tcp));
+}
+
+TypeId
+CustomHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CustomHeader")
+    .SetParent<Header> ()
+    .AddConstructor<CustomHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+CustomHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+void
+CustomHeader::Print (std::ostream &os) const
+{
+  os << "ppp=" << pppProto
+     << " prot=" << (uint32_t)l3Prot
+     << " sip=" << std::hex << sip << " dip=" << dip << std::dec
+     << " tos=" << (uint32_t)m_tos << " ttl=" << (uint32_t)m_ttl;
+}
+
+uint32_t
+CustomHeader::GetSerializedSize (void) const
+{
+  return l2Size + l3Size + l4Size;
+}
+
+void
+CustomHeader::Serialize (Buffer::Iterator start) const
+{
+  Buffer::Iterator i = start;
+
+  // ppp header
+  if (headerType & L2_Header)
+    {
+      i.WriteHtonU16 (pppProto);
+    }
+
+  // IPv4 header, always written without options
+  if (headerType & L3_Header)
+    {
+      i.WriteU8 ((4 << 4) | 5);
+      i.WriteU8 (m_tos);
+      i.WriteHtonU16 (m_payloadSize + 20);
+      i.WriteHtonU16 (ipid);
+      uint32_t fragmentOffset = m_fragmentOffset / 8;
+      uint8_t flagsFrag = (fragmentOffset >> 8) & 0x1f;
+      if (ipv4Flags & 1)
+        flagsFrag |= (1 << 6); // don't fragment
+      if (ipv4Flags & 2)
+        flagsFrag |= (1 << 5); // more fragments
+      i.WriteU8 (flagsFrag);
+      i.WriteU8 (fragmentOffset & 0xff);
+      i.WriteU8 (m_ttl);
+      i.WriteU8 (l3Prot);
+      i.WriteU16 (m_checksum);
+      i.WriteHtonU32 (sip);
+      i.WriteHtonU32 (dip);
+    }
+
+  if (headerType & L4_Header)
+    {
+      if (l3Prot == 0x6) // TCP
+        {
+          i.WriteHtonU16 (tcp.sport);
+          i.WriteHtonU16 (tcp.dport);
+          i.WriteHtonU32 (tcp.seq);
+          i.WriteHtonU32 (tcp.ack);
+          i.WriteHtonU16 ((tcp.length << 12) | tcp.tcpFlags);
+          i.WriteHtonU16 (tcp.windowSize);
+          i.WriteHtonU16 (0);
+          i.WriteHtonU16 (tcp.urgentPointer);
+          uint32_t optionLen = tcp.length > 5 ? (tcp.length - 5) * 4 : 0;
+          i.Write (tcp.optionBuf, optionLen);
+        }
+      else if (l3Prot == 0x11) // UDP + seq and pg + INT
+        {
+          i.WriteHtonU16 (udp.sport);
+          i.WriteHtonU16 (udp.dport);
+          i.WriteHtonU16 (udp.payload_size);
+          i.WriteHtonU16 (0);
+          i.WriteHtonU32 (udp.seq);
+          i.WriteHtonU16 (udp.pg);
+          udp.ih.Serialize (i);
+        }
+      else if (l3Prot == 0xFF) // CNP, see CnHeader
+        {
+          i.WriteU8 (cnp.qIndex);
+          i.WriteU16 (cnp.fid);
+          i.WriteU8 (cnp.ecnBits);
+          i.WriteU16 (cnp.qfb);
+          i.WriteU16 (cnp.total);
+        }
+      else if (l3Prot == 0xFC || l3Prot == 0xFD) // ACK or NACK, see qbbHeader
+        {
+          i.WriteU16 (ack.sport);
+          i.WriteU16 (ack.dport);
+          i.WriteU16 (ack.flags);
+          i.WriteU16 (ack.pg);
+          i.WriteU32 (ack.seq);
+          ack.ih.Serialize (i);
+        }
+      else if (l3Prot == 0xFE) // PFC, see PauseHeader
+        {
+          i.WriteU32 (pfc.time);
+          i.WriteU32 (pfc.qlen);
+          i.WriteU8 (pfc.qIndex);
+        }
+    }
+}
+
+uint32_t
+CustomHeader::Deserialize (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+  l2Size = l3Size = l4Size = 0;
+
+  // ppp header
+  if (headerType & L2_Header)
+    {
+      pppProto = i.ReadNtohU16 ();
+      l2Size = 2;
+    }
+
+  // IPv4 header
+  if (headerType & L3_Header)
+    {
+      uint8_t verIhl = i.ReadU8 ();
+      m_headerSize = (verIhl & 0x0f) * 4;
+      m_tos = i.ReadU8 ();
+      uint16_t size = i.ReadNtohU16 ();
+      m_payloadSize = size - m_headerSize;
+      ipid = i.ReadNtohU16 ();
+      uint8_t flags = i.ReadU8 ();
+      ipv4Flags = 0;
+      if (flags & (1 << 6))
+        ipv4Flags |= 1; // don't fragment
+      if (flags & (1 << 5))
+        ipv4Flags |= 2; // more fragments
+      m_fragmentOffset = ((flags & 0x1f) << 8) | i.ReadU8 ();
+      m_fragmentOffset *= 8;
+      m_ttl = i.ReadU8 ();
+      l3Prot = i.ReadU8 ();
+      m_checksum = i.ReadU16 ();
+      sip = i.ReadNtohU32 ();
+      dip = i.ReadNtohU32 ();
+      // skip the options
+      if (m_headerSize > 20)
+        i.Next (m_headerSize - 20);
+      l3Size = m_headerSize;
+    }
+
+  if (headerType & L4_Header)
+    {
+      if (l3Prot == 0x6) // TCP
+        {
+          tcp.sport = i.ReadNtohU16 ();
+          tcp.dport = i.ReadNtohU16 ();
+          tcp.seq = i.ReadNtohU32 ();
+          tcp.ack = i.ReadNtohU32 ();
+          uint16_t field = i.ReadNtohU16 ();
+          tcp.tcpFlags = field & 0xFF;
+          tcp.length = field >> 12;
+          tcp.windowSize = i.ReadNtohU16 ();
+          i.Next (2);
+          tcp.urgentPointer = i.ReadNtohU16 ();
+          uint32_t optionLen = tcp.length > 5 ? (tcp.length - 5) * 4 : 0;
+          if (optionLen > sizeof (tcp.optionBuf))
+            {
+              NS_LOG_WARN ("TCP options longer than " << sizeof (tcp.optionBuf) << " bytes");
+              return 0;
+            }
+          i.Read (tcp.optionBuf, optionLen);
+          l4Size = tcp.length * 4;
+        }
+      else if (l3Prot == 0x11) // UDP + seq and pg + INT
+        {
+          udp.sport = i.ReadNtohU16 ();
+          udp.dport = i.ReadNtohU16 ();
+          udp.payload_size = i.ReadNtohU16 ();
+          i.Next (2);
+          udp.seq = i.ReadNtohU32 ();
+          udp.pg = i.ReadNtohU16 ();
+          if (getInt)
+            udp.ih.Deserialize (i);
+          l4Size = GetUdpHeaderSize ();
+        }
+      else if (l3Prot == 0xFF) // CNP
+        {
+          cnp.qIndex = i.ReadU8 ();
+          cnp.fid = i.ReadU16 ();
+          cnp.ecnBits = i.ReadU8 ();
+          cnp.qfb = i.ReadU16 ();
+          cnp.total = i.ReadU16 ();
+          l4Size = 8;
+        }
+      else if (l3Prot == 0xFC || l3Prot == 0xFD) // ACK or NACK
+        {
+          ack.sport = i.ReadU16 ();
+          ack.dport = i.ReadU16 ();
+          ack.flags = i.ReadU16 ();
+          ack.pg = i.ReadU16 ();
+          ack.seq = i.ReadU32 ();
+          if (getInt)
+            ack.ih.Deserialize (i);
+          l4Size = GetAckSerializedSize ();
+        }
+      else if (l3Prot == 0xFE) // PFC
+        {
+          pfc.time = i.ReadU32 ();
+          pfc.qlen = i.ReadU32 ();
+          pfc.qIndex = i.ReadU8 ();
+          l4Size = 9;
+        }
+    }
+
+  return GetSerializedSize ();
+}
+
+uint8_t
+CustomHeader::GetIpv4EcnBits (void) const
+{
+  return m_tos & 0x3;
+}
+
+uint32_t
+CustomHeader::GetUdpHeaderSize (void)
+{
+  return 8 + 6 + IntHeader::GetStaticSize (); // UDP, seq and pg, INT
+}
+
+uint32_t
+CustomHeader::GetAckSerializedSize (void)
+{
+  return 12 + IntHeader::GetStaticSize (); // ports, flags, pg and seq, INT
+}
+
+} // namespace ns3
@@ -0,0 +1,110 @@
+#ifndef CUSTOM_HEADER_H
+#define CUSTOM_HEADER_H
+
+#include <stdint.h>
+#include "ns3/header.h"
+#include "ns3/buffer.h"
+#include "ns3/int-header.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup network
+ * \brief Flat view of the PPP, IPv4 and transport headers of a qbb frame
+ *
+ * The qbb devices, the switch and RdmaHw look at every frame through this
+ * header instead of peeling PppHeader, Ipv4Header and the transport header
+ * one by one. Which layers are parsed is chosen by headerType. The
+ * transport part depends on the IPv4 protocol number: TCP (0x06), RDMA data
+ * over UDP (0x11), ACK (0xFC), NACK (0xFD), PFC (0xFE) and CNP (0xFF).
+ */
+class CustomHeader : public Header
+{
+public:
+  enum HeaderType {
+	  L2_Header = 1,
+	  L3_Header = 2,
+	  L4_Header = 4
+  };
+
+  CustomHeader ();
+  CustomHeader (uint32_t _headerType);
+
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual void Print (std::ostream &os) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+  uint32_t headerType;
+  uint32_t l2Size, l3Size, l4Size;
+
+  // ppp header
+  uint16_t pppProto;
+
+  // IPv4 header
+  uint16_t m_payloadSize;
+  uint16_t ipid;
+  uint8_t m_tos;
+  uint8_t m_ttl;
+  uint8_t l3Prot;
+  uint8_t ipv4Flags;
+  uint16_t m_fragmentOffset;
+  uint32_t sip;
+  uint32_t dip;
+  uint16_t m_checksum;
+  uint16_t m_headerSize;
+
+  union {
+	  struct {
+		  uint16_t sport;
+		  uint16_t dport;
+		  uint32_t seq;
+		  uint32_t ack;
+		  uint8_t length;   // in words
+		  uint8_t tcpFlags;
+		  uint16_t windowSize;
+		  uint16_t urgentPointer;
+		  uint8_t optionBuf[32]; // raw options
+	  } tcp;
+	  struct {
+		  uint16_t sport;
+		  uint16_t dport;
+		  uint16_t payload_size;
+		  // sequence header of the RDMA data segments
+		  uint16_t pg;
+		  uint32_t seq;
+		  IntHeader ih;
+	  } udp;
+	  struct {
+		  uint16_t sport, dport;
+		  uint16_t flags;
+		  uint16_t pg;
+		  uint32_t seq; // the qbb sequence number
+		  IntHeader ih;
+	  } ack;
+	  struct {
+		  uint16_t fid;
+		  uint8_t qIndex;
+		  uint16_t qfb;
+		  uint8_t ecnBits;
+		  uint16_t total;
+	  } cnp;
+	  struct {
+		  uint32_t time;
+		  uint32_t qlen;
+		  uint8_t qIndex;
+	  } pfc;
+  };
+
+  uint8_t getInt; // whether to parse the INT header
+
+  uint8_t GetIpv4EcnBits (void) const;
+  static uint32_t GetUdpHeaderSize (void);
+  static uint32_t GetAckSerializedSize (void);
+};
+
+} // namespace ns3
+
+#endif /* CUSTOM_HEADER_H */
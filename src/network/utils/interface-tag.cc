@@ -0,0 +1,60 @@
+#include "interface-tag.h"
+
+namespace ns3{
+
+NS_OBJECT_ENSURE_REGISTERED (InterfaceTag);
+
+TypeId
+InterfaceTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::InterfaceTag")
+    .SetParent<Tag> ()
+    .AddConstructor<InterfaceTag> ()
+  ;
+  return tid;
+}
+TypeId
+InterfaceTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+InterfaceTag::InterfaceTag ()
+  : m_portId (0)
+{
+}
+InterfaceTag::InterfaceTag (uint32_t portId)
+  : m_portId (portId)
+{
+}
+uint32_t
+InterfaceTag::GetSerializedSize (void) const
+{
+  return 4;
+}
+void
+InterfaceTag::Serialize (TagBuffer i) const
+{
+  i.WriteU32 (m_portId);
+}
+void
+InterfaceTag::Deserialize (TagBuffer i)
+{
+  m_portId = i.ReadU32 ();
+}
+void
+InterfaceTag::Print (std::ostream &os) const
+{
+  os << "port=" << m_portId;
+}
+void
+InterfaceTag::SetPortId (uint32_t portId)
+{
+  m_portId = portId;
+}
+uint32_t
+InterfaceTag::GetPortId (void) const
+{
+  return m_portId;
+}
+
+}
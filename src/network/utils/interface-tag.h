@@ -0,0 +1,46 @@
+#ifndef INTERFACE_TAG_H
+#define INTERFACE_TAG_H
+
+#include "ns3/tag.h"
+#include "ns3/packet.h"
+#include <iostream>
+
+namespace ns3{
+
+/**
+ * \ingroup network
+ * \brief Ingress port of a packet inside a switch
+ *
+ * Set by the qbb device when a switch receives the packet and removed when
+ * the packet leaves the switch, so that the MMU can release the ingress
+ * buffer and send PFC resume on the right port.
+ */
+class InterfaceTag : public Tag
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer i) const;
+  virtual void Deserialize (TagBuffer i);
+  virtual void Print (std::ostream &os) const;
+
+  InterfaceTag ();
+  InterfaceTag (uint32_t portId);
+  void SetPortId (uint32_t portId);
+  /**
+   * Get the ingress interface index
+   * \return the interface index.
+   */
+  uint32_t GetPortId (void) const;
+private:
+  uint32_t m_portId;  //!< ingress interface index
+};
+
+}
+
+#endif /* INTERFACE_TAG_H */
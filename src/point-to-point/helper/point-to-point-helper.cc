@@ -28,6 +28,7 @@
 #include "ns3/simulator.h"
 
 #ifdef NS3_MPI
+#include "ns3/hybrid-simulator-impl.h"
 #include "ns3/mpi-interface.h"
 #include "ns3/mpi-receiver.h"
 #include "ns3/point-to-point-remote-channel.h"
@@ -265,8 +266,9 @@ PointToPointHelper::Install(Ptr<Node> a, Ptr<Node> b)
     Ptr<PointToPointChannel> channel = nullptr;
 
     // If MPI is enabled, we need to see if both nodes have the same system id
-    // (rank), and the rank is the same as this instance.  If both are true,
-    // use a normal p2p channel, otherwise use a remote channel
+    // (rank), and the rank is the same as this instance, and the same thread
+    // of a HybridSimulatorImpl.  If all are true, use a normal p2p channel,
+    // otherwise use a remote channel
 #ifdef NS3_MPI
     bool useNormalChannel = true;
     if (MpiInterface::IsEnabled())
@@ -274,7 +276,9 @@ PointToPointHelper::Install(Ptr<Node> a, Ptr<Node> b)
         uint32_t n1SystemId = a->GetSystemId();
         uint32_t n2SystemId = b->GetSystemId();
         uint32_t currSystemId = MpiInterface::GetSystemId();
-        if (n1SystemId != currSystemId || n2SystemId != currSystemId)
+        if (n1SystemId != currSystemId || n2SystemId != currSystemId ||
+            HybridSimulatorImpl::GetThread(a->GetId()) !=
+                HybridSimulatorImpl::GetThread(b->GetId()))
         {
             useNormalChannel = false;
         }
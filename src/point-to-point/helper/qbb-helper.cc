@@ -0,0 +1,131 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "qbb-helper.h"
+
+#include "ns3/broadcom-egress-queue.h"
+#include "ns3/log.h"
+#include "ns3/mac48-address.h"
+#include "ns3/node.h"
+#include "ns3/qbb-channel.h"
+#include "ns3/qbb-net-device.h"
+
+#ifdef NS3_MPI
+#include "ns3/hybrid-simulator-impl.h"
+#include "ns3/mpi-interface.h"
+#include "ns3/mpi-receiver.h"
+#include "ns3/qbb-remote-channel.h"
+#endif
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("QbbHelper");
+
+QbbHelper::QbbHelper()
+{
+    m_queueFactory.SetTypeId("ns3::BEgressQueue");
+    m_deviceFactory.SetTypeId("ns3::QbbNetDevice");
+    m_channelFactory.SetTypeId("ns3::QbbChannel");
+}
+
+void
+QbbHelper::SetQueueAttribute(std::string n1, const AttributeValue& v1)
+{
+    m_queueFactory.Set(n1, v1);
+}
+
+void
+QbbHelper::SetDeviceAttribute(std::string n1, const AttributeValue& v1)
+{
+    m_deviceFactory.Set(n1, v1);
+}
+
+void
+QbbHelper::SetChannelAttribute(std::string n1, const AttributeValue& v1)
+{
+    m_channelFactory.Set(n1, v1);
+}
+
+NetDeviceContainer
+QbbHelper::Install(NodeContainer c)
+{
+    NS_ASSERT(c.GetN() == 2);
+    return Install(c.Get(0), c.Get(1));
+}
+
+NetDeviceContainer
+QbbHelper::Install(Ptr<Node> a, Ptr<Node> b)
+{
+    NetDeviceContainer container;
+
+    Ptr<QbbNetDevice> devA = m_deviceFactory.Create<QbbNetDevice>();
+    devA->SetAddress(Mac48Address::Allocate());
+    a->AddDevice(devA);
+    devA->SetQueue(m_queueFactory.Create<BEgressQueue>());
+    Ptr<QbbNetDevice> devB = m_deviceFactory.Create<QbbNetDevice>();
+    devB->SetAddress(Mac48Address::Allocate());
+    b->AddDevice(devB);
+    devB->SetQueue(m_queueFactory.Create<BEgressQueue>());
+
+    Ptr<QbbChannel> channel = nullptr;
+
+    // If MPI is enabled, we need to see if both nodes have the same system id
+    // (rank), and the rank is the same as this instance, and the same thread
+    // of a HybridSimulatorImpl.  If all are true, use a normal qbb channel,
+    // otherwise use a remote channel
+#ifdef NS3_MPI
+    bool useNormalChannel = true;
+    if (MpiInterface::IsEnabled())
+    {
+        uint32_t n1SystemId = a->GetSystemId();
+        uint32_t n2SystemId = b->GetSystemId();
+        uint32_t currSystemId = MpiInterface::GetSystemId();
+        if (n1SystemId != currSystemId || n2SystemId != currSystemId ||
+            HybridSimulatorImpl::GetThread(a->GetId()) !=
+                HybridSimulatorImpl::GetThread(b->GetId()))
+        {
+            useNormalChannel = false;
+        }
+    }
+    if (useNormalChannel)
+    {
+        m_channelFactory.SetTypeId("ns3::QbbChannel");
+        channel = m_channelFactory.Create<QbbChannel>();
+    }
+    else
+    {
+        m_channelFactory.SetTypeId("ns3::QbbRemoteChannel");
+        channel = m_channelFactory.Create<QbbRemoteChannel>();
+        Ptr<MpiReceiver> mpiRecA = CreateObject<MpiReceiver>();
+        Ptr<MpiReceiver> mpiRecB = CreateObject<MpiReceiver>();
+        mpiRecA->SetReceiveCallback(MakeBoundCallback(&QbbRemoteChannel::Deliver, devA));
+        mpiRecB->SetReceiveCallback(MakeBoundCallback(&QbbRemoteChannel::Deliver, devB));
+        devA->AggregateObject(mpiRecA);
+        devB->AggregateObject(mpiRecB);
+    }
+#else
+    channel = m_channelFactory.Create<QbbChannel>();
+#endif
+
+    devA->Attach(channel);
+    devB->Attach(channel);
+    container.Add(devA);
+    container.Add(devB);
+
+    return container;
+}
+
+} // namespace ns3
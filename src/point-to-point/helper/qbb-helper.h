@@ -0,0 +1,103 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef QBB_HELPER_H
+#define QBB_HELPER_H
+
+#include "ns3/net-device-container.h"
+#include "ns3/node-container.h"
+#include "ns3/object-factory.h"
+
+#include <string>
+
+namespace ns3
+{
+
+class Node;
+
+/**
+ * \ingroup point-to-point
+ * \brief Build a set of QbbNetDevice objects
+ *
+ * Every device gets a BEgressQueue with one queue per priority class. When
+ * MPI is enabled and the two nodes do not both live on this rank, the link
+ * uses a QbbRemoteChannel and each device aggregates an MpiReceiver, the
+ * same way PointToPointHelper does for PointToPointRemoteChannel.
+ */
+class QbbHelper
+{
+  public:
+    /**
+     * Create a QbbHelper to make life easier when creating lossless links.
+     */
+    QbbHelper();
+
+    /**
+     * Set an attribute value to be propagated to each BEgressQueue created
+     * by the helper.
+     *
+     * \param name the name of the attribute to set
+     * \param value the value of the attribute to set
+     */
+    void SetQueueAttribute(std::string name, const AttributeValue& value);
+
+    /**
+     * Set an attribute value to be propagated to each QbbNetDevice created
+     * by the helper.
+     *
+     * \param name the name of the attribute to set
+     * \param value the value of the attribute to set
+     */
+    void SetDeviceAttribute(std::string name, const AttributeValue& value);
+
+    /**
+     * Set an attribute value to be propagated to each QbbChannel created by
+     * the helper.
+     *
+     * \param name the name of the attribute to set
+     * \param value the value of the attribute to set
+     */
+    void SetChannelAttribute(std::string name, const AttributeValue& value);
+
+    /**
+     * \param c a set of nodes
+     * \return a NetDeviceContainer for nodes
+     *
+     * This method creates a QbbChannel with the attributes configured by
+     * QbbHelper::SetChannelAttribute, then, for each node in the input
+     * container, we create a QbbNetDevice with the requested attributes and
+     * a BEgressQueue. Only two nodes can be connected, so the container must
+     * hold exactly two nodes.
+     */
+    NetDeviceContainer Install(NodeContainer c);
+
+    /**
+     * \param a first node
+     * \param b second node
+     * \return a NetDeviceContainer for nodes
+     *
+     * Saves you from having to construct a temporary NodeContainer.
+     */
+    NetDeviceContainer Install(Ptr<Node> a, Ptr<Node> b);
+
+  private:
+    ObjectFactory m_queueFactory;   //!< Queue Factory
+    ObjectFactory m_channelFactory; //!< Channel Factory
+    ObjectFactory m_deviceFactory;  //!< Device Factory
+};
+
+} // namespace ns3
+
+#endif /* QBB_HELPER_H */
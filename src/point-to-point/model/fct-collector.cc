@@ -0,0 +1,345 @@
+#include "fct-collector.h"
+#include "ns3/double.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+#ifdef NS3_MPI
+#include "ns3/mpi-interface.h"
+#endif
+
+NS_LOG_COMPONENT_DEFINE("FctCollector");
+
+namespace ns3 {
+
+/******************
+ * QuantileSketch
+ *****************/
+QuantileSketch::QuantileSketch(double alpha, double minValue, double maxValue)
+	: m_alpha(alpha), m_min(minValue), m_count(0), m_sum(0)
+{
+	NS_ASSERT_MSG(alpha > 0 && alpha < 1 && minValue > 0 && maxValue > minValue, "QuantileSketch: bad parameters");
+	m_gamma = (1 + alpha) / (1 - alpha);
+	m_logGamma = std::log(m_gamma);
+	m_bins.assign((uint32_t)std::ceil(std::log(maxValue / minValue) / m_logGamma) + 1, 0);
+}
+
+uint32_t QuantileSketch::GetIndex(double value) const {
+	if (value <= m_min)
+		return 0;
+	double i = std::ceil(std::log(value / m_min) / m_logGamma);
+	return (uint32_t)std::min(i, (double)(m_bins.size() - 1));
+}
+
+double QuantileSketch::GetValue(uint32_t index) const {
+	if (index == 0)
+		return m_min;
+	// the value of the bin closest to all its values in relative terms
+	return 2 * m_min * std::pow(m_gamma, index) / (m_gamma + 1);
+}
+
+void QuantileSketch::Add(double value) {
+	m_bins[GetIndex(value)]++;
+	m_count++;
+	m_sum += value;
+}
+
+void QuantileSketch::Merge(const QuantileSketch &other) {
+	NS_ASSERT_MSG(m_bins.size() == other.m_bins.size() && m_alpha == other.m_alpha && m_min == other.m_min,
+	              "QuantileSketch::Merge: sketches of different parameters");
+	for (uint32_t i = 0; i < m_bins.size(); i++)
+		m_bins[i] += other.m_bins[i];
+	m_count += other.m_count;
+	m_sum += other.m_sum;
+}
+
+double QuantileSketch::GetQuantile(double q) const {
+	if (m_count == 0)
+		return 0;
+	q = std::min(std::max(q, 0.0), 1.0);
+	uint64_t rank = (uint64_t)(q * (m_count - 1));
+	uint64_t seen = 0;
+	for (uint32_t i = 0; i < m_bins.size(); i++) {
+		seen += m_bins[i];
+		if (seen > rank)
+			return GetValue(i);
+	}
+	return GetValue(m_bins.size() - 1);
+}
+
+uint64_t QuantileSketch::GetCount(void) const {
+	return m_count;
+}
+
+double QuantileSketch::GetSum(void) const {
+	return m_sum;
+}
+
+const std::vector<uint64_t> &QuantileSketch::GetBins(void) const {
+	return m_bins;
+}
+
+void QuantileSketch::SetBins(const std::vector<uint64_t> &bins, double sum) {
+	NS_ASSERT_MSG(bins.size() == m_bins.size(), "QuantileSketch::SetBins: wrong number of bins");
+	m_bins = bins;
+	m_count = 0;
+	for (uint64_t n : bins)
+		m_count += n;
+	m_sum = sum;
+}
+
+/******************
+ * FctCollector
+ *****************/
+NS_OBJECT_ENSURE_REGISTERED(FctCollector);
+
+TypeId FctCollector::GetTypeId (void)
+{
+	static TypeId tid = TypeId ("ns3::FctCollector")
+	                    .SetParent<Object> ()
+	                    .SetGroupName("PointToPoint")
+	                    .AddAttribute("Capacity",
+	                                  "Number of flows buffered before they are folded into the sketches",
+	                                  UintegerValue(4096),
+	                                  MakeUintegerAccessor(&FctCollector::m_capacity),
+	                                  MakeUintegerChecker<uint32_t>(1))
+	                    .AddAttribute("SizeBuckets",
+	                                  "Comma separated upper bounds of the flow size buckets (bytes), "
+	                                  "larger flows go to a last bucket. Must not change once flows are recorded.",
+	                                  StringValue("10000,100000,1000000,10000000"),
+	                                  MakeStringAccessor(&FctCollector::m_sizeBuckets),
+	                                  MakeStringChecker())
+	                    .AddAttribute("RelativeAccuracy",
+	                                  "Relative accuracy of the slowdown quantiles. Must not change once flows are recorded.",
+	                                  DoubleValue(0.01),
+	                                  MakeDoubleAccessor(&FctCollector::m_alpha),
+	                                  MakeDoubleChecker<double>(1e-4, 0.5))
+	                    .AddAttribute("FileName",
+	                                  "Report file, written by rank 0",
+	                                  StringValue("fct_summary.txt"),
+	                                  MakeStringAccessor(&FctCollector::m_fileName),
+	                                  MakeStringChecker())
+	                    ;
+	return tid;
+}
+
+Ptr<FctCollector> FctCollector::Get (void)
+{
+	return *DoGet(true);
+}
+
+bool FctCollector::IsEnabled (void)
+{
+	return *DoGet(false) != nullptr;
+}
+
+Ptr<FctCollector> *FctCollector::DoGet (bool create)
+{
+	static Ptr<FctCollector> ptr = nullptr;
+	if (!ptr && create) {
+		ptr = CreateObject<FctCollector>();
+		Simulator::ScheduleDestroy(&FctCollector::Delete);
+	}
+	return &ptr;
+}
+
+void FctCollector::Delete (void)
+{
+	(*DoGet(false))->Dispose();
+	(*DoGet(false)) = nullptr;
+}
+
+namespace {
+// identifies the collectors, a shard cached by a thread is only valid for its own
+std::atomic<uint64_t> g_collectorId(0);
+}
+
+FctCollector::FctCollector()
+	: m_id(++g_collectorId)
+{
+	NS_LOG_FUNCTION(this);
+}
+
+FctCollector::~FctCollector()
+{
+	NS_LOG_FUNCTION(this);
+}
+
+void FctCollector::DoDispose(void) {
+	NS_LOG_FUNCTION(this);
+	m_shards.clear();
+	m_expected.clear();
+	Object::DoDispose();
+}
+
+FctCollector::Shard &FctCollector::GetShard(void) {
+	static thread_local uint64_t id = 0;
+	static thread_local Shard *shard = nullptr;
+	if (id != m_id) {
+		std::lock_guard<std::mutex> lock(m_shardsMutex);
+		m_shards.emplace_back(new Shard());
+		shard = m_shards.back().get();
+		id = m_id;
+	}
+	return *shard;
+}
+
+void FctCollector::Record(int64_t start, int64_t finish, uint64_t size, int64_t ideal) {
+	Shard &shard = GetShard();
+	if (shard.start.empty()) {
+		shard.start.reserve(m_capacity);
+		shard.finish.reserve(m_capacity);
+		shard.size.reserve(m_capacity);
+		shard.ideal.reserve(m_capacity);
+	}
+	shard.start.push_back(start);
+	shard.finish.push_back(finish);
+	shard.size.push_back(size);
+	shard.ideal.push_back(ideal);
+	if (shard.start.size() >= m_capacity)
+		Fold(shard);
+}
+
+Time FctCollector::GetIdealFct(uint64_t bytes, DataRate rate, Time latency) {
+	return latency + rate.CalculateBytesTxTime(bytes);
+}
+
+void FctCollector::ExpectFlow(Ipv4Address src, Ipv4Address dst, uint16_t dport, uint64_t size, Time start, Time ideal) {
+	std::unique_lock<std::shared_mutex> lock(m_expectedMutex);
+	Expected &e = m_expected[std::make_tuple(src.Get(), dst.Get(), dport)];
+	e.size = size;
+	e.received = 0;
+	e.start = start.GetNanoSeconds();
+	e.ideal = ideal.GetNanoSeconds();
+}
+
+void FctCollector::SinkRx(Ptr<const Packet> p, const Address &from, const Address &to) {
+	if (!IsEnabled() || !InetSocketAddress::IsMatchingType(from) || !InetSocketAddress::IsMatchingType(to))
+		return;
+	Ptr<FctCollector> c = Get();
+	InetSocketAddress src = InetSocketAddress::ConvertFrom(from);
+	InetSocketAddress dst = InetSocketAddress::ConvertFrom(to);
+	std::shared_lock<std::shared_mutex> lock(c->m_expectedMutex);
+	auto it = c->m_expected.find(std::make_tuple(src.GetIpv4().Get(), dst.GetIpv4().Get(), dst.GetPort()));
+	if (it == c->m_expected.end())
+		return;
+	Expected &e = it->second;
+	lock.unlock();
+	if (e.received >= e.size)
+		return; // already recorded
+	e.received += p->GetSize();
+	if (e.received >= e.size)
+		c->Record(e.start, Simulator::Now().GetNanoSeconds(), e.size, e.ideal);
+}
+
+std::vector<FctCollector::Bucket> FctCollector::Setup(void) const {
+	std::vector<uint64_t> bounds;
+	std::istringstream iss(m_sizeBuckets);
+	std::string token;
+	while (std::getline(iss, token, ',')) {
+		if (token.empty())
+			continue;
+		uint64_t b = std::stoull(token);
+		NS_ABORT_MSG_IF(!bounds.empty() && b <= bounds.back(), "FctCollector: SizeBuckets must increase");
+		bounds.push_back(b);
+	}
+	bounds.push_back(0);
+	std::vector<Bucket> buckets;
+	for (uint64_t b : bounds)
+		buckets.push_back(Bucket{b, QuantileSketch(m_alpha), 0});
+	return buckets;
+}
+
+void FctCollector::Fold(Shard &shard) {
+	if (shard.buckets.empty())
+		shard.buckets = Setup();
+	std::vector<Bucket> &buckets = shard.buckets;
+	for (uint32_t i = 0; i < shard.start.size(); i++) {
+		uint32_t b = 0;
+		while (buckets[b].maxSize != 0 && shard.size[i] > buckets[b].maxSize)
+			b++;
+		double fct = (double)(shard.finish[i] - shard.start[i]);
+		buckets[b].slowdown.Add(fct / std::max<int64_t>(shard.ideal[i], 1));
+		buckets[b].fctSum += fct;
+	}
+	shard.start.clear();
+	shard.finish.clear();
+	shard.size.clear();
+	shard.ideal.clear();
+}
+
+std::vector<FctCollector::Bucket> FctCollector::Merge(void) {
+	// the sketches of the threads merge exactly by adding their bins
+	std::vector<Bucket> merged = Setup();
+	for (const std::unique_ptr<Shard> &shard : m_shards) {
+		Fold(*shard);
+		NS_ASSERT_MSG(shard->buckets.size() == merged.size(), "FctCollector: SizeBuckets changed");
+		for (uint32_t i = 0; i < merged.size(); i++) {
+			merged[i].slowdown.Merge(shard->buckets[i].slowdown);
+			merged[i].fctSum += shard->buckets[i].fctSum;
+		}
+	}
+#ifdef NS3_MPI
+	if (MpiInterface::IsEnabled() && MpiInterface::GetSize() > 1) {
+		// one reduction for all the bins, one for the sums
+		std::vector<uint64_t> bins;
+		std::vector<double> sums;
+		for (const Bucket &b : merged) {
+			bins.insert(bins.end(), b.slowdown.GetBins().begin(), b.slowdown.GetBins().end());
+			sums.push_back(b.slowdown.GetSum());
+			sums.push_back(b.fctSum);
+		}
+		MPI_Allreduce(MPI_IN_PLACE, bins.data(), bins.size(), MPI_UINT64_T, MPI_SUM, MpiInterface::GetCommunicator());
+		MPI_Allreduce(MPI_IN_PLACE, sums.data(), sums.size(), MPI_DOUBLE, MPI_SUM, MpiInterface::GetCommunicator());
+		uint32_t offset = 0;
+		for (uint32_t i = 0; i < merged.size(); i++) {
+			uint32_t n = merged[i].slowdown.GetBins().size();
+			std::vector<uint64_t> sum(bins.begin() + offset, bins.begin() + offset + n);
+			merged[i].slowdown.SetBins(sum, sums[2 * i]);
+			merged[i].fctSum = sums[2 * i + 1];
+			offset += n;
+		}
+	}
+#endif
+	return merged;
+}
+
+void FctCollector::Report(void) {
+	std::vector<Bucket> merged = Merge();
+#ifdef NS3_MPI
+	if (MpiInterface::IsEnabled() && MpiInterface::GetSystemId() != 0)
+		return;
+#endif
+	std::ofstream file(m_fileName.c_str(), std::ios::out | std::ios::trunc);
+	if (!file.is_open())
+		throw std::runtime_error("Unable to open file for writing flow completion times.");
+	file << "# size_min size_max flows mean_fct_ns mean_slowdown p50 p99 p99.9\n";
+	uint64_t lower = 0;
+	for (const Bucket &b : merged) {
+		uint64_t n = b.slowdown.GetCount();
+		if (n > 0) {
+			file << lower << " ";
+			if (b.maxSize == 0)
+				file << "inf";
+			else
+				file << b.maxSize;
+			file << " " << n << " " << std::fixed << std::setprecision(0) << b.fctSum / n
+			     << std::setprecision(3) << " " << b.slowdown.GetSum() / n
+			     << " " << b.slowdown.GetQuantile(0.5) << " " << b.slowdown.GetQuantile(0.99)
+			     << " " << b.slowdown.GetQuantile(0.999) << "\n";
+			file.unsetf(std::ios_base::floatfield);
+		}
+		lower = b.maxSize + 1;
+	}
+}
+
+} // namespace ns3
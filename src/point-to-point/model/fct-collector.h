@@ -0,0 +1,168 @@
+#ifndef FCT_COLLECTOR_H
+#define FCT_COLLECTOR_H
+
+#include "ns3/object.h"
+#include "ns3/address.h"
+#include "ns3/data-rate.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+#include <stdint.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup point-to-point
+ * \brief Mergeable quantile sketch with a relative accuracy guarantee.
+ *
+ * Values are counted in logarithmic bins: bin i holds the values in
+ * (min * gamma^(i-1), min * gamma^i] with gamma = (1 + alpha) / (1 - alpha),
+ * so a quantile is returned within a relative error alpha of a value of
+ * the stream. The bins are fixed by alpha and the value range, values
+ * outside of the range fall in the first or the last bin. Two sketches of
+ * the same parameters merge by adding their bins, which keeps the merge
+ * exact and independent of the order of the streams.
+ */
+class QuantileSketch {
+public:
+	QuantileSketch(double alpha = 0.01, double minValue = 1e-3, double maxValue = 1e6);
+
+	void Add(double value);
+	// add the values of a sketch of the same parameters
+	void Merge(const QuantileSketch &other);
+	// the value of rank q * (count - 1) in the stream, 0 if empty
+	double GetQuantile(double q) const;
+	uint64_t GetCount(void) const;
+	double GetSum(void) const;
+
+	// the bin counts, to reduce sketches of the same parameters across processes
+	const std::vector<uint64_t> &GetBins(void) const;
+	// replace the bins and the sum, e.g. by the result of such a reduction
+	void SetBins(const std::vector<uint64_t> &bins, double sum);
+
+private:
+	uint32_t GetIndex(double value) const;
+	double GetValue(uint32_t index) const;
+
+	double m_alpha;
+	double m_min;
+	double m_gamma;
+	double m_logGamma;
+	std::vector<uint64_t> m_bins;
+	uint64_t m_count;
+	double m_sum;
+};
+
+/**
+ * \ingroup point-to-point
+ * \brief Per-process collector of the flow completion times.
+ *
+ * A completed flow is recorded with its start, finish, size and ideal
+ * completion time, the time it would take alone on an idle path, into a
+ * columnar buffer of Capacity records. When the buffer is full it is folded
+ * into one QuantileSketch of the slowdown (FCT / ideal FCT) per flow size
+ * bucket, so the memory does not grow with the number of flows.
+ *
+ * Every thread records into its own buffer and sketches, so the threads of
+ * a HybridSimulatorImpl never share them; Merge adds the sketches of all
+ * the threads, and must only be called once they are done.
+ *
+ * RdmaHw records its queue pairs as they complete once the collector
+ * exists. The UDP flows are declared with ExpectFlow, before
+ * Simulator::Run, and recorded by the SinkRx trace sink, connected to the
+ * RxWithAddresses trace of their PacketSink, when all their bytes are
+ * received. A flow is received by a single node, so SinkRx only updates
+ * the entry of the flow and never the table of the expected flows; the
+ * flows of a phase may also be declared by the threads while they run,
+ * the table being locked for writing by ExpectFlow and for reading by
+ * SinkRx.
+ *
+ * Report merges the sketches of all the ranks and writes, from rank 0,
+ * the number of flows, the mean FCT and the mean, p50, p99 and p99.9
+ * slowdown of every size bucket. Under MPI it is collective: every rank
+ * calls it, after Simulator::Run.
+ */
+class FctCollector : public Object {
+public:
+	/** Merged statistics of a flow size bucket. */
+	struct Bucket {
+		uint64_t maxSize;        // largest flow size of the bucket, 0 for the last one
+		QuantileSketch slowdown;
+		double fctSum;           // sum of the FCT (ns)
+	};
+
+	static TypeId GetTypeId (void);
+	static Ptr<FctCollector> Get (void);
+	// whether the collector was created by Get
+	static bool IsEnabled (void);
+
+	FctCollector();
+	virtual ~FctCollector();
+
+	// record a completed flow, times in ns
+	void Record(int64_t start, int64_t finish, uint64_t size, int64_t ideal);
+	// the completion time of bytes sent at rate over a path of the given latency
+	static Time GetIdealFct(uint64_t bytes, DataRate rate, Time latency);
+
+	// record the UDP flow from src to dst:dport once size bytes are received
+	void ExpectFlow(Ipv4Address src, Ipv4Address dst, uint16_t dport, uint64_t size, Time start, Time ideal);
+	// PacketSink RxWithAddresses trace sink
+	static void SinkRx(Ptr<const Packet> p, const Address &from, const Address &to);
+
+	// fold the buffer and return the buckets merged across the ranks, collective under MPI
+	std::vector<Bucket> Merge(void);
+	// merge the buckets and write the report from rank 0, collective under MPI
+	void Report(void);
+
+protected:
+	virtual void DoDispose(void);
+
+private:
+	static Ptr<FctCollector> *DoGet (bool create);
+	static void Delete (void);
+
+	struct Expected {
+		uint64_t size;
+		uint64_t received;
+		int64_t start;
+		int64_t ideal;
+	};
+
+	/** The flows recorded by one thread. */
+	struct Shard {
+		// the buffer, one column per field
+		std::vector<int64_t> start;
+		std::vector<int64_t> finish;
+		std::vector<uint64_t> size;
+		std::vector<int64_t> ideal;
+
+		std::vector<Bucket> buckets;
+	};
+
+	// the shard of the calling thread, created on first use
+	Shard &GetShard(void);
+	std::vector<Bucket> Setup(void) const;
+	void Fold(Shard &shard);
+
+	uint32_t m_capacity;
+	std::string m_sizeBuckets;  // comma separated upper bounds of the size buckets (bytes)
+	double m_alpha;
+	std::string m_fileName;
+
+	uint64_t m_id;              // tells the shards of this collector from the ones of a previous one
+	std::mutex m_shardsMutex;
+	std::vector<std::unique_ptr<Shard> > m_shards;
+	std::shared_mutex m_expectedMutex;  // guards the table, not the entries
+	std::map<std::tuple<uint32_t, uint32_t, uint16_t>, Expected> m_expected;
+};
+
+} // namespace ns3
+
+#endif /* FCT_COLLECTOR_H */
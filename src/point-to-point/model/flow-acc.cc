@@ -0,0 +1,390 @@
+#include "flow-acc.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+
+#ifdef NS3_MPI
+#include "ns3/mpi-interface.h"
+#endif
+
+NS_LOG_COMPONENT_DEFINE("FlowStatsMonitor");
+
+namespace ns3 {
+
+/******************
+ * FlowStat
+ *****************/
+FlowStat::FlowStat(uint64_t k, uint64_t bytes, uint64_t now)
+	: key(k), byteCount(bytes), timestamp(now), ifnewpacket(false), steadyStateReached(false),
+	  rateHead(0), rateCount(0)
+{
+}
+
+bool FlowStat::PushRate(double r) {
+	const uint32_t cap = size - 1;
+	if (rateCount < cap) {
+		rate[(rateHead + rateCount) % cap] = r;
+		rateCount++;
+		return false;
+	}
+	// window complete: drop the oldest sample
+	rate[rateHead] = r;
+	rateHead = (rateHead + 1) % cap;
+	return true;
+}
+
+bool FlowStat::IsRateFlat() const {
+	if (rateCount == 0)
+		return false;
+	double mn = rate[0], mx = rate[0];
+	for (uint32_t i = 1; i < rateCount; i++) {
+		mn = std::min(mn, rate[i]);
+		mx = std::max(mx, rate[i]);
+	}
+	return std::fabs(mx - mn) <= 2.22045e-16;
+}
+
+double FlowStat::GetAvgRate() const {
+	double sum = 0;
+	for (uint32_t i = 0; i < rateCount; i++)
+		sum += rate[i];
+	return sum / rateCount;
+}
+
+/******************
+ * FlowStatsTable
+ *****************/
+FlowStatsTable::FlowStatsTable()
+	: m_slots(64, 0), m_mask(63)
+{
+}
+
+uint64_t FlowStatsTable::MakeKey(uint32_t srcId, uint32_t dstId, uint16_t sport, uint16_t dport) {
+	return ((uint64_t)(srcId & 0xffff) << 48) | ((uint64_t)(dstId & 0xffff) << 32) | ((uint64_t)sport << 16) | dport;
+}
+
+std::string FlowStatsTable::KeyToString(uint64_t key) {
+	std::ostringstream oss;
+	oss << (key >> 48) << "-" << ((key >> 32) & 0xffff) << "-" << ((key >> 16) & 0xffff) << "-" << (key & 0xffff);
+	return oss.str();
+}
+
+uint32_t FlowStatsTable::Hash(uint64_t key) {
+	// 64-bit finalizer of MurmurHash3
+	key ^= key >> 33;
+	key *= 0xff51afd7ed558ccdULL;
+	key ^= key >> 33;
+	key *= 0xc4ceb9fe1a85ec53ULL;
+	key ^= key >> 33;
+	return (uint32_t)key;
+}
+
+uint32_t FlowStatsTable::Find(uint64_t key) const {
+	for (uint32_t i = Hash(key) & m_mask;; i = (i + 1) & m_mask) {
+		uint32_t s = m_slots[i];
+		if (s == 0)
+			return NOT_FOUND;
+		if (m_stats[s - 1].key == key)
+			return s - 1;
+	}
+}
+
+uint32_t FlowStatsTable::Insert(const FlowStat &stat) {
+	NS_ASSERT_MSG(Find(stat.key) == NOT_FOUND, "FlowStatsTable::Insert: duplicated flow");
+	if ((m_stats.size() + 1) * 2 > m_slots.size())
+		Grow();
+	m_stats.push_back(stat);
+	uint32_t idx = m_stats.size() - 1;
+	uint32_t i = Hash(stat.key) & m_mask;
+	while (m_slots[i] != 0)
+		i = (i + 1) & m_mask;
+	m_slots[i] = idx + 1;
+	return idx;
+}
+
+FlowStat &FlowStatsTable::Get(uint32_t idx) {
+	return m_stats[idx];
+}
+
+uint32_t FlowStatsTable::GetN(void) const {
+	return m_stats.size();
+}
+
+void FlowStatsTable::Grow(void) {
+	m_slots.assign(m_slots.size() * 2, 0);
+	m_mask = m_slots.size() - 1;
+	for (uint32_t idx = 0; idx < m_stats.size(); idx++) {
+		uint32_t i = Hash(m_stats[idx].key) & m_mask;
+		while (m_slots[i] != 0)
+			i = (i + 1) & m_mask;
+		m_slots[i] = idx + 1;
+	}
+}
+
+/******************
+ * FlowStatsMonitor
+ *****************/
+NS_OBJECT_ENSURE_REGISTERED(FlowStatsMonitor);
+
+TypeId FlowStatsMonitor::GetTypeId (void)
+{
+	static TypeId tid = TypeId ("ns3::FlowStatsMonitor")
+	                    .SetParent<Object> ()
+	                    .SetGroupName("PointToPoint")
+	                    .AddAttribute("MonitorPeriod",
+	                                  "Period over which a flow rate is measured (ns)",
+	                                  UintegerValue(10000),
+	                                  MakeUintegerAccessor(&FlowStatsMonitor::m_period),
+	                                  MakeUintegerChecker<uint64_t>(1))
+	                    .AddAttribute("FileName",
+	                                  "Statistics file. Under MPI the rank is appended to the name.",
+	                                  StringValue("flow_stats.txt"),
+	                                  MakeStringAccessor(&FlowStatsMonitor::m_fileName),
+	                                  MakeStringChecker())
+	                    .AddAttribute("BufferSize",
+	                                  "Flush the report once this many bytes are buffered",
+	                                  UintegerValue(1 << 20),
+	                                  MakeUintegerAccessor(&FlowStatsMonitor::m_bufferSize),
+	                                  MakeUintegerChecker<uint32_t>())
+	                    .AddAttribute("FlushInterval",
+	                                  "Maximum wall-clock time a report line stays buffered, checked when "
+	                                  "a line is added; no simulation event is scheduled. Zero disables it.",
+	                                  TimeValue(Seconds(1)),
+	                                  MakeTimeAccessor(&FlowStatsMonitor::m_flushInterval),
+	                                  MakeTimeChecker())
+	                    ;
+	return tid;
+}
+
+namespace {
+// the monitors of all the threads, the first one owns the file
+std::mutex g_monitorsMutex;
+std::vector<Ptr<FlowStatsMonitor> > g_monitors;
+// bumped at Destroy, so that every thread creates a new monitor
+std::atomic<uint32_t> g_generation(0);
+}
+
+Ptr<FlowStatsMonitor> FlowStatsMonitor::Get (void)
+{
+	static thread_local Ptr<FlowStatsMonitor> monitor = nullptr;
+	static thread_local uint32_t generation = 0;
+	if (!monitor || generation != g_generation.load()) {
+		monitor = CreateObject<FlowStatsMonitor>();
+		generation = g_generation.load();
+		std::lock_guard<std::mutex> lock(g_monitorsMutex);
+		if (g_monitors.empty())
+			Simulator::ScheduleDestroy(&FlowStatsMonitor::Delete);
+		g_monitors.push_back(monitor);
+	}
+	return monitor;
+}
+
+void FlowStatsMonitor::Delete (void)
+{
+	// the threads are done: flush the other monitors into the file of the first one, then close it
+	std::vector<Ptr<FlowStatsMonitor> > monitors;
+	{
+		std::lock_guard<std::mutex> lock(g_monitorsMutex);
+		monitors = g_monitors;
+	}
+	for (uint32_t i = monitors.size(); i-- > 0;)
+		monitors[i]->Dispose();
+	std::lock_guard<std::mutex> lock(g_monitorsMutex);
+	g_monitors.clear();
+	g_generation++;
+}
+
+FlowStatsMonitor::FlowStatsMonitor()
+	: m_nonSteady(0), m_inSteadyState(false), m_steadyStateStartTime(0), m_pending(false)
+{
+	NS_LOG_FUNCTION(this);
+}
+
+FlowStatsMonitor::~FlowStatsMonitor()
+{
+	NS_LOG_FUNCTION(this);
+}
+
+void FlowStatsMonitor::DoDispose(void) {
+	NS_LOG_FUNCTION(this);
+	Flush();
+	if (m_file.is_open())
+		m_file.close();
+	m_tables.clear();
+	m_deadlines = decltype(m_deadlines)();
+	Object::DoDispose();
+}
+
+void FlowStatsMonitor::Register(FlowStatsTable *table) {
+	if (std::find(m_tables.begin(), m_tables.end(), table) == m_tables.end())
+		m_tables.push_back(table);
+}
+
+void FlowStatsMonitor::Unregister(FlowStatsTable *table) {
+	auto it = std::find(m_tables.begin(), m_tables.end(), table);
+	if (it == m_tables.end())
+		return;
+	m_tables.erase(it);
+	// drop the pending periods of the table, its records go away with it
+	std::vector<Deadline> keep;
+	while (!m_deadlines.empty()) {
+		if (m_deadlines.top().table != table)
+			keep.push_back(m_deadlines.top());
+		m_deadlines.pop();
+	}
+	for (auto &d : keep)
+		m_deadlines.push(d);
+	for (uint32_t i = 0; i < table->GetN(); i++)
+		if (!table->Get(i).steadyStateReached)
+			m_nonSteady--;
+}
+
+FlowStatsMonitor::SteadyEvent FlowStatsMonitor::Record(FlowStatsTable &table, uint64_t key, uint16_t packetSize) {
+	uint64_t currentTime = Simulator::Now().GetNanoSeconds();
+	SteadyEvent ev = STEADY_NONE;
+
+	uint32_t idx = table.Find(key);
+	if (idx == FlowStatsTable::NOT_FOUND) {
+		// a new flow starts with its first packet already counted, as the string keyed map did
+		Register(&table);
+		idx = table.Insert(FlowStat(key, packetSize, currentTime));
+		m_nonSteady++;
+	}
+
+	// report every flow whose monitor period ended, in flow order
+	while (!m_deadlines.empty() && m_deadlines.top().time <= currentTime) {
+		m_due.push_back(m_deadlines.top());
+		m_deadlines.pop();
+	}
+	if (!m_due.empty()) {
+		std::sort(m_due.begin(), m_due.end(), [](const Deadline &a, const Deadline &b) { return a.key < b.key; });
+		for (auto &d : m_due)
+			EmitRate(d.table->Get(d.idx), currentTime);
+		m_due.clear();
+	}
+
+	FlowStat &stat = table.Get(idx);
+	if (!stat.ifnewpacket) {
+		stat.ifnewpacket = true;
+		m_deadlines.push(Deadline{stat.timestamp + m_period, &table, idx, key});
+	}
+	stat.byteCount += packetSize;
+
+	bool allSteadyStateReached = m_nonSteady == 0;
+	if (allSteadyStateReached && !m_inSteadyState) {
+		m_steadyStateStartTime = currentTime;
+		m_inSteadyState = true;
+		NS_LOG_INFO("System entered steady state at time: " << m_steadyStateStartTime << " ns");
+		m_buf << "System entered steady state at time: " << m_steadyStateStartTime << " ns\n";
+		ev = STEADY_ENTER;
+	}
+	if (!allSteadyStateReached && m_inSteadyState) {
+		uint64_t duration = currentTime - m_steadyStateStartTime;
+		NS_LOG_INFO("System exited steady state at time: " << currentTime << " ns, duration: " << duration << " ns");
+		m_buf << "System exited steady state at time: " << currentTime << " ns, duration: " << duration << " ns\n";
+		m_inSteadyState = false;
+		ev = STEADY_EXIT;
+	}
+	Append();
+	return ev;
+}
+
+void FlowStatsMonitor::EmitRate(FlowStat &stat, uint64_t now) {
+	double rate = static_cast<double>(stat.byteCount) * 8 / m_period;
+	m_buf << "Flow ID: " << FlowStatsTable::KeyToString(stat.key) << " - Rate: " << rate << " Gbps" << " currentTime: " << now << "\n";
+	stat.ifnewpacket = false;
+	if (stat.PushRate(rate)) {
+		bool steady = stat.IsRateFlat();
+		if (steady && !stat.steadyStateReached)
+			m_nonSteady--;
+		else if (!steady && stat.steadyStateReached)
+			m_nonSteady++;
+		stat.steadyStateReached = steady;
+	}
+	stat.byteCount = 0;
+	stat.timestamp = now;
+}
+
+const FlowStat *FlowStatsMonitor::Find(uint64_t key) const {
+	for (FlowStatsTable *t : m_tables) {
+		uint32_t idx = t->Find(key);
+		if (idx != FlowStatsTable::NOT_FOUND)
+			return &t->Get(idx);
+	}
+	return NULL;
+}
+
+void FlowStatsMonitor::ReportMinTime(double minTime) {
+	NS_LOG_INFO("最小流完成时间: " << minTime);
+	std::ios_base::fmtflags f(m_buf.flags());
+	std::streamsize p = m_buf.precision();
+	m_buf << "最小流完成时间: " << std::fixed << std::setprecision(6) << minTime << "\n";
+	m_buf.flags(f);
+	m_buf.precision(p);
+	Append();
+}
+
+void FlowStatsMonitor::Append(void) {
+	// a flush timer would add simulation events, and so change the end of
+	// the run, the event counts and the checkpoints; check the wall clock
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	if (!m_pending) {
+		m_pending = true;
+		m_firstPending = now;
+	}
+	if ((uint64_t)m_buf.tellp() >= m_bufferSize ||
+	    (m_flushInterval.IsStrictlyPositive() &&
+	     now - m_firstPending >= std::chrono::nanoseconds(m_flushInterval.GetNanoSeconds()))) {
+		Flush();
+	}
+}
+
+std::string FlowStatsMonitor::GetFileName(void) const {
+#ifdef NS3_MPI
+	if (MpiInterface::IsEnabled() && MpiInterface::GetSize() > 1) {
+		std::ostringstream oss;
+		std::string::size_type dot = m_fileName.rfind('.');
+		if (dot == std::string::npos)
+			oss << m_fileName << "-" << MpiInterface::GetSystemId();
+		else
+			oss << m_fileName.substr(0, dot) << "-" << MpiInterface::GetSystemId() << m_fileName.substr(dot);
+		return oss.str();
+	}
+#endif
+	return m_fileName;
+}
+
+void FlowStatsMonitor::Open(void) {
+	std::string name = GetFileName();
+	m_file.open(name.c_str(), std::ios::out | std::ios::trunc);
+	if (!m_file.is_open())
+		throw std::runtime_error("Unable to open file for writing flow statistics.");
+}
+
+void FlowStatsMonitor::Flush(void) {
+	m_pending = false;
+	if (m_buf.tellp() <= 0)
+		return;
+	// the monitors of the other threads write to the file of the first one
+	std::lock_guard<std::mutex> lock(g_monitorsMutex);
+	FlowStatsMonitor *owner = this;
+	if (std::find(g_monitors.begin(), g_monitors.end(), this) != g_monitors.end())
+		owner = PeekPointer(g_monitors.front());
+	if (!owner->m_file.is_open())
+		owner->Open();
+	const std::string s = m_buf.str();
+	owner->m_file.write(s.data(), s.size());
+	owner->m_file.flush();
+	m_buf.str("");
+	m_buf.clear();
+}
+
+} // namespace ns3
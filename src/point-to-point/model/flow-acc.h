@@ -0,0 +1,160 @@
+#ifndef FLOW_ACC_H
+#define FLOW_ACC_H
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include <stdint.h>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <queue>
+
+namespace ns3 {
+
+/**
+ * \ingroup point-to-point
+ * \brief Receiver-side rate statistics of one flow.
+ *
+ * Rate samples are kept in a small ring; a flow is in steady state when
+ * every sample of a full ring is equal.
+ */
+struct FlowStat {
+	static const uint32_t size = 10; // window length, the ring keeps size - 1 samples
+
+	uint64_t key;           // packed 5-tuple, see FlowStatsTable::MakeKey
+	uint64_t byteCount;     // bytes received in the current monitor period
+	uint64_t timestamp;     // start of the current monitor period (ns)
+	bool ifnewpacket;       // a packet arrived in the current monitor period
+	bool steadyStateReached;
+	double rate[size - 1];  // the last rate samples (Gbps)
+	uint32_t rateHead;      // oldest sample
+	uint32_t rateCount;
+
+	FlowStat(uint64_t k, uint64_t bytes, uint64_t now);
+	// push one sample, return true if the ring was already full (window complete)
+	bool PushRate(double r);
+	bool IsRateFlat() const;
+	double GetAvgRate() const;
+};
+
+/**
+ * \ingroup point-to-point
+ * \brief Open-addressed table of FlowStat indexed by the packed flow key.
+ *
+ * Records are stored densely and never move, so their index stays valid
+ * while the probe array grows. Flows are never removed.
+ */
+class FlowStatsTable {
+public:
+	static const uint32_t NOT_FOUND = 0xffffffff;
+
+	FlowStatsTable();
+
+	// srcId/dstId are the node ids encoded in the IP address (ip >> 8 & 0xffff)
+	static uint64_t MakeKey(uint32_t srcId, uint32_t dstId, uint16_t sport, uint16_t dport);
+	// "src-dst-sport-dport", the id printed in the statistics file
+	static std::string KeyToString(uint64_t key);
+
+	uint32_t Find(uint64_t key) const;
+	uint32_t Insert(const FlowStat &stat); // key must not exist yet
+	FlowStat &Get(uint32_t idx);
+	uint32_t GetN(void) const;
+
+private:
+	static uint32_t Hash(uint64_t key);
+	void Grow(void);
+
+	std::vector<uint32_t> m_slots; // index + 1 into m_stats, 0 means empty
+	std::vector<FlowStat> m_stats;
+	uint32_t m_mask;
+};
+
+/**
+ * \ingroup point-to-point
+ * \brief Per-thread collector of the receiver flow statistics.
+ *
+ * Every QbbNetDevice owns a FlowStatsTable and reports the data packets it
+ * receives to the monitor of the thread that first used it. The monitor
+ * emits one rate line per flow and monitor period, tracks whether all its
+ * flows reached steady state, and writes the report through a buffer that
+ * is flushed when it grows large, when a line is added some wall-clock time
+ * after the first pending one, and at Simulator::Destroy. It never schedules
+ * simulation events. Under MPI every rank writes its own file.
+ *
+ * Each thread of a HybridSimulatorImpl gets its own monitor from Get, so
+ * the threads never share the flows, the deadlines nor the clock; the
+ * steady state is then the one of the flows received by the nodes of the
+ * thread. The monitors of a process append to the file of the first one,
+ * under a lock, and are all flushed and disposed together at Destroy.
+ */
+class FlowStatsMonitor : public Object {
+public:
+	enum SteadyEvent {
+		STEADY_NONE = 0,
+		STEADY_ENTER,
+		STEADY_EXIT
+	};
+
+	static TypeId GetTypeId (void);
+	// the monitor of the calling thread, created on first use
+	static Ptr<FlowStatsMonitor> Get (void);
+
+	FlowStatsMonitor();
+	virtual ~FlowStatsMonitor();
+
+	void Register(FlowStatsTable *table);
+	void Unregister(FlowStatsTable *table);
+
+	// account a received data packet, return the steady state transition it caused
+	SteadyEvent Record(FlowStatsTable &table, uint64_t key, uint16_t packetSize);
+	// look the flow up in every registered table, return NULL if unknown
+	const FlowStat *Find(uint64_t key) const;
+	// write the minimum remaining flow completion time (ns) estimated at steady state entry
+	void ReportMinTime(double minTime);
+
+	void Flush(void);
+	std::string GetFileName(void) const;
+
+protected:
+	virtual void DoDispose(void);
+
+private:
+	static void Delete (void);
+
+	struct Deadline {
+		uint64_t time;
+		FlowStatsTable *table;
+		uint32_t idx;
+		uint64_t key;
+		bool operator>(const Deadline &o) const {
+			return time != o.time ? time > o.time : key > o.key;
+		}
+	};
+
+	void EmitRate(FlowStat &stat, uint64_t now);
+	void Append(void);
+	void Open(void);
+
+	uint64_t m_period;          // monitor period (ns)
+	uint32_t m_bufferSize;      // flush once the buffer holds this many bytes
+	Time m_flushInterval;       // max wall-clock time a line waits in the buffer
+	std::string m_fileName;
+
+	std::vector<FlowStatsTable*> m_tables;
+	std::priority_queue<Deadline, std::vector<Deadline>, std::greater<Deadline> > m_deadlines;
+	std::vector<Deadline> m_due;
+	uint32_t m_nonSteady;       // flows not in steady state
+	bool m_inSteadyState;
+	uint64_t m_steadyStateStartTime;
+
+	std::ostringstream m_buf;
+	std::ofstream m_file;       // only opened by the first monitor of the process
+	bool m_pending;             // the buffer holds lines
+	std::chrono::steady_clock::time_point m_firstPending;
+};
+
+} // namespace ns3
+
+#endif /* FLOW_ACC_H */
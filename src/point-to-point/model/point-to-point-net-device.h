@@ -152,7 +152,7 @@ class PointToPointNetDevice : public NetDevice
      *
      * \param p Ptr to the received packet.
      */
-    void Receive(Ptr<Packet> p);
+    virtual void Receive(Ptr<Packet> p);
 
     // The remaining methods are documented in ns3::NetDevice*
 
@@ -206,7 +206,9 @@ class PointToPointNetDevice : public NetDevice
      */
     void DoMpiReceive(Ptr<Packet> p);
 
-  private:
+    // The members below are protected so that QbbNetDevice can reuse the
+    // transmit state machine, the traces and the receive callbacks.
+
     /**
      * \brief Dispose of the object
      */
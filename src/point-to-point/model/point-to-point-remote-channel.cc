@@ -46,7 +46,10 @@ PointToPointRemoteChannel::GetTypeId()
 }
 
 PointToPointRemoteChannel::PointToPointRemoteChannel()
-    : PointToPointChannel()
+    : PointToPointChannel(),
+      m_devices{nullptr, nullptr},
+      m_nodes{0, 0},
+      m_ifIndices{0, 0}
 {
 }
 
@@ -54,6 +57,18 @@ PointToPointRemoteChannel::~PointToPointRemoteChannel()
 {
 }
 
+void
+PointToPointRemoteChannel::Attach(Ptr<PointToPointNetDevice> device)
+{
+    NS_LOG_FUNCTION(this << device);
+
+    PointToPointChannel::Attach(device);
+    std::size_t i = GetNDevices() - 1;
+    m_devices[i] = PeekPointer(device);
+    m_nodes[i] = device->GetNode()->GetId();
+    m_ifIndices[i] = device->GetIfIndex();
+}
+
 bool
 PointToPointRemoteChannel::TransmitStart(Ptr<const Packet> p,
                                          Ptr<PointToPointNetDevice> src,
@@ -64,12 +79,11 @@ PointToPointRemoteChannel::TransmitStart(Ptr<const Packet> p,
 
     IsInitialized();
 
-    uint32_t wire = src == GetSource(0) ? 0 : 1;
-    Ptr<PointToPointNetDevice> dst = GetDestination(wire);
+    uint32_t dst = PeekPointer(src) == m_devices[0] ? 1 : 0;
 
     // Calculate the rxTime (absolute)
     Time rxTime = Simulator::Now() + txTime + GetDelay();
-    MpiInterface::SendPacket(p->Copy(), rxTime, dst->GetNode()->GetId(), dst->GetIfIndex());
+    MpiInterface::SendPacket(p->Copy(), rxTime, m_nodes[dst], m_ifIndices[dst]);
     return true;
 }
 
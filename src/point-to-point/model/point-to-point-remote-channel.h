@@ -67,6 +67,21 @@ class PointToPointRemoteChannel : public PointToPointChannel
      * \returns true if successful (currently always true)
      */
     bool TransmitStart(Ptr<const Packet> p, Ptr<PointToPointNetDevice> src, Time txTime) override;
+
+    /**
+     * \brief Attach a given netdevice to this channel, and keep its address
+     *
+     * \param device pointer to the netdevice to attach to the channel
+     */
+    void Attach(Ptr<PointToPointNetDevice> device) override;
+
+  private:
+    // Only the sender of a packet is used when transmitting: with a
+    // HybridSimulatorImpl the other end may be a node of another thread,
+    // whose reference counts must not be touched.
+    PointToPointNetDevice* m_devices[2]; //!< The attached devices
+    uint32_t m_nodes[2];                 //!< Node id of the attached devices
+    uint32_t m_ifIndices[2];             //!< Interface index of the attached devices
 };
 
 } // namespace ns3
@@ -1,5 +1,6 @@
 #include "qbb-channel.h"
 #include "qbb-net-device.h"
+#include "rdma-segment-pool.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
@@ -51,7 +52,7 @@ QbbChannel::Attach (Ptr<QbbNetDevice> device)
   //fflush(stdout);
   NS_LOG_FUNCTION (this << device);
   NS_ASSERT_MSG (m_nDevices < N_DEVICES, "Only two devices permitted");
-  NS_ASSERT (device != 0);
+  NS_ASSERT (device);
 
   m_link[m_nDevices++].m_src = device;
 //
@@ -82,6 +83,10 @@ QbbChannel::TransmitStart (
   NS_ASSERT (m_link[1].m_state != INITIALIZING);
 
   uint32_t wire = src == m_link[0].m_src ? 0 : 1;
+  if (!m_txrxQbb.IsEmpty ())
+    {
+      RdmaSegmentPool::Get ().Materialize (p);
+    }
 
   Simulator::ScheduleWithContext (m_link[wire].m_dst->GetNode ()->GetId (),
                                   txTime + m_delay, &QbbNetDevice::Receive,
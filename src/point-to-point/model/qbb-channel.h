@@ -44,7 +44,7 @@ public:
    * \brief Attach a given netdevice to this channel
    * \param device pointer to the netdevice to attach to the channel
    */
-  void Attach (Ptr<QbbNetDevice> device);
+  virtual void Attach (Ptr<QbbNetDevice> device);
 
   /**
    * \brief Transmit a packet over this channel
@@ -1,4 +1,3 @@
-#define __STDC_LIMIT_MACROS 1
 #include <stdint.h>
 #include <stdio.h>
 #include "ns3/qbb-net-device.h"
@@ -16,21 +15,23 @@
 #include "ns3/simulator.h"
 #include "ns3/point-to-point-channel.h"
 #include "ns3/qbb-channel.h"
-#include "ns3/random-variable.h"
+#include "ns3/random-variable-stream.h"
 #include "ns3/qbb-header.h"
 #include "ns3/error-model.h"
 #include "ns3/cn-header.h"
 #include "ns3/ppp-header.h"
 #include "ns3/udp-header.h"
 #include "ns3/tcp-header.h"
-#include "ns3/seq-ts-header.h"
 #include "ns3/pointer.h"
 #include "ns3/custom-header.h"
-#include "ns3/rdma-tag.h"
 #include "ns3/interface-tag.h"
 #include "ns3/unsched-tag.h"
-#include "flow-acc.h"
 #include "ns3/node-list.h"
+#include "ns3/rdma-segment-pool.h"
+
+#ifdef NS3_MPI
+#include "ns3/hybrid-simulator-impl.h"
+#endif
 
 #include <iostream>
 
@@ -41,14 +42,7 @@ namespace ns3 {
 uint32_t RdmaEgressQueue::ack_q_idx = 3;
 uint32_t RdmaEgressQueue::tcpip_q_idx = 1;
 
-//计算接收端口流量速率的变量
-uint64_t MONITOR_PERIOD =10000; // 监测周期(ns)
-bool isFirstOpen = true;
-std::map<std::string, FlowStat> flowStats; //flowid,size字节数,存储流的统计信息
-uint64_t steadyStateStartTime = 0;  // 记录稳态进入时间
-bool inSteadyState = false;         // 标识系统是否处于稳态
-double flowMinTime = 1.79769e+308;	//整个系统最小流完成时间
-//int number_test = 0;//做一个计数实验，看判断多少次最小流完成时间
+//接收端流量统计见 flow-acc.h，每个设备一张流表，每个进程一个输出文件
 
 // RdmaEgressQueue
 //使用 TypeId 机制来查询 RdmaEgressQueue 的类型信息
@@ -68,6 +62,10 @@ TypeId RdmaEgressQueue::GetTypeId (void)
 RdmaEgressQueue::RdmaEgressQueue() {
 	m_rrlast = 0;
 	m_qlast = 0;
+	hostDequeueIndex = 0;
+	m_nextSeq = 0;
+	m_rrSeq = 0;
+	m_nFinished = 0;
 	m_ackQ = CreateObject<DropTailQueue<Packet>>();
 	m_ackQ->SetAttribute("MaxSize", QueueSizeValue (QueueSize (BYTES, 0xffffffff))); // queue limit is on a higher level, not here
 }
@@ -80,19 +78,14 @@ Ptr<Packet> RdmaEgressQueue::DequeueQindex(int qIndex) {
 		Ptr<Packet> p = m_ackQ->Dequeue();
 		m_qlast = -1;
 		m_traceRdmaDequeue(p, 0);//出队
-		UnSchedTag tag;
-		bool found = p->PeekPacketTag(tag);
-		uint32_t unsched = tag.GetValue();
 		return p;
 	}
 	if (qIndex >= 0) { // qp
 		Ptr<Packet> p = m_rdmaGetNxtPkt(m_qpGrp->Get(qIndex));
 		m_rrlast = qIndex;
+		m_rrSeq = m_qpGrp->Get(qIndex)->sched.seq;
 		m_qlast = qIndex;
 		m_traceRdmaDequeue(p, m_qpGrp->Get(qIndex)->m_pg);
-		UnSchedTag tag;
-		bool found = p->PeekPacketTag(tag);
-		uint32_t unsched = tag.GetValue();
 		return p;
 	}
 	return 0;
@@ -100,8 +93,6 @@ Ptr<Packet> RdmaEgressQueue::DequeueQindex(int qIndex) {
 
 //在 RDMA 出队过程中选择下一个队列索引 (qIndex)
 int RdmaEgressQueue::GetNextQindex(bool paused[]) {
-	bool found = false;
-	uint32_t qIndex;
 	if (!paused[ack_q_idx] && m_ackQ->GetNPackets() > 0)
 		return -1;
 
@@ -111,34 +102,10 @@ int RdmaEgressQueue::GetNextQindex(bool paused[]) {
 	for (uint32_t dorr = 0; dorr < 2; dorr++) {
 		hostDequeueIndex++;
 		if (hostDequeueIndex % 2) {
-			uint32_t fcount = m_qpGrp->GetN();
-			uint32_t min_finish_id = 0xffffffff;
-			for (qIndex = 1; qIndex <= fcount; qIndex++) {
-				uint32_t idx = (qIndex + m_rrlast) % fcount;
-				Ptr<RdmaQueuePair> qp = m_qpGrp->Get(idx);
-				if (!paused[qp->m_pg] && qp->GetBytesLeft() > 0 && !qp->IsWinBound()) {
-					if (m_qpGrp->Get(idx)->m_nextAvail.GetTimeStep() > Simulator::Now().GetTimeStep()) //not available now
-						continue;
-					res = idx;
-					break;
-				} else if (qp->IsFinished()) {
-					min_finish_id = idx < min_finish_id ? idx : min_finish_id;
-				}
-			}
-
-			// clear the finished qp
-			if (min_finish_id < 0xffffffff) {
-				int nxt = min_finish_id;
-				auto &qps = m_qpGrp->m_qps;
-				for (int i = min_finish_id + 1; i < fcount; i++) if (!qps[i]->IsFinished()) {
-						if (i == res) // update res to the idx after removing finished qp
-							res = nxt;
-						qps[nxt] = qps[i];
-						nxt++;
-					}
-				qps.resize(nxt);
-			}
-
+			// clear the finished qp once they are half of the group
+			if (m_nFinished > 0 && 2 * m_nFinished >= m_qpGrp->GetN())
+				CompactQps();
+			res = PickQp(paused);
 			if (res != -1024) {
 				return res;
 			}
@@ -154,6 +121,124 @@ int RdmaEgressQueue::GetNextQindex(bool paused[]) {
 	return res;
 }
 
+//按轮询顺序选择第一个可发送的 QP
+int RdmaEgressQueue::PickQp(bool paused[]) {
+	// qps whose next available time has come
+	while (!m_rateLimited.empty() && m_rateLimited.begin()->first <= Simulator::Now()) {
+		Ptr<RdmaQueuePair> qp = m_rateLimited.begin()->second;
+		m_rateLimited.erase(m_rateLimited.begin());
+		qp->sched.state = QP_IDLE;
+		ScheduleQp(qp);
+	}
+
+	while (true) {
+		// the first qp after the last one served, wrapping around
+		Ptr<RdmaQueuePair> next = 0;
+		Ptr<RdmaQueuePair> first = 0;
+		for (uint32_t pg = 0; pg < qCnt; pg++) {
+			if (paused[pg] || m_ready[pg].empty())
+				continue;
+			auto it = m_ready[pg].upper_bound(m_rrSeq);
+			if (it != m_ready[pg].end() && (!next || it->first < next->sched.seq))
+				next = it->second;
+			if (!first || m_ready[pg].begin()->first < first->sched.seq)
+				first = m_ready[pg].begin()->second;
+		}
+		if (!next)
+			next = first;
+		if (!next)
+			return -1024;
+		// a ready qp may have lost its window or rate since it was scheduled
+		if (next->GetBytesLeft() > 0 && !next->IsWinBound() && next->m_nextAvail <= Simulator::Now())
+			return next->sched.index;
+		UnscheduleQp(next);
+		ScheduleQp(next);
+	}
+}
+
+//把 QP 放入与其状态对应的集合
+void RdmaEgressQueue::ScheduleQp(Ptr<RdmaQueuePair> qp) {
+	NS_ASSERT(qp->sched.state == QP_IDLE);
+	NS_ASSERT_MSG(qp->m_pg < qCnt, "RdmaEgressQueue: priority group out of range");
+	if (qp->GetBytesLeft() > 0 && !qp->IsWinBound()) {
+		if (qp->m_nextAvail > Simulator::Now()) {
+			qp->sched.state = QP_RATE_LIMITED;
+			qp->sched.key = qp->m_nextAvail;
+			m_rateLimited.emplace(qp->sched.key, qp);
+		} else {
+			qp->sched.state = QP_READY;
+			m_ready[qp->m_pg][qp->sched.seq] = qp;
+		}
+	} else if (qp->IsFinished()) {
+		qp->sched.state = QP_FINISHED;
+		m_nFinished++;
+	} else {
+		qp->sched.state = QP_BLOCKED;
+	}
+}
+
+void RdmaEgressQueue::UnscheduleQp(Ptr<RdmaQueuePair> qp) {
+	if (qp->sched.state == QP_READY) {
+		m_ready[qp->m_pg].erase(qp->sched.seq);
+	} else if (qp->sched.state == QP_RATE_LIMITED) {
+		auto range = m_rateLimited.equal_range(qp->sched.key);
+		for (auto it = range.first; it != range.second; ++it) {
+			if (it->second == qp) {
+				m_rateLimited.erase(it);
+				break;
+			}
+		}
+	}
+	qp->sched.state = QP_IDLE;
+}
+
+//清除已完成的 QP, 并更新其余 QP 的索引
+void RdmaEgressQueue::CompactQps() {
+	auto &qps = m_qpGrp->m_qps;
+	uint32_t nxt = 0;
+	for (uint32_t i = 0; i < qps.size(); i++) {
+		if (qps[i]->sched.state == QP_FINISHED)
+			continue;
+		if (qps[i]->sched.state == QP_BLOCKED && qps[i]->IsFinished())
+			continue;
+		qps[i]->sched.index = nxt;
+		qps[nxt++] = qps[i];
+	}
+	qps.resize(nxt);
+	m_nFinished = 0;
+}
+
+void RdmaEgressQueue::AddQp(Ptr<RdmaQueuePair> qp) {
+	NS_ASSERT_MSG(m_qpGrp->GetN() > 0 && m_qpGrp->m_qps.back() == qp,
+	              "RdmaEgressQueue::AddQp: qp is not the last one of m_qpGrp");
+	qp->sched.index = m_qpGrp->GetN() - 1;
+	qp->sched.seq = ++m_nextSeq;
+	qp->sched.state = QP_IDLE;
+	ScheduleQp(qp);
+}
+
+void RdmaEgressQueue::UpdateQp(Ptr<RdmaQueuePair> qp) {
+	if (qp->sched.state == QP_IDLE || qp->sched.state == QP_FINISHED)
+		return;
+	UnscheduleQp(qp);
+	ScheduleQp(qp);
+}
+
+void RdmaEgressQueue::ClearQps() {
+	for (uint32_t i = 0; i < m_qpGrp->GetN(); i++)
+		m_qpGrp->Get(i)->sched.state = QP_IDLE;
+	for (uint32_t pg = 0; pg < qCnt; pg++)
+		m_ready[pg].clear();
+	m_rateLimited.clear();
+	m_nFinished = 0;
+}
+
+Time RdmaEgressQueue::GetNextAvail() {
+	if (m_rateLimited.empty())
+		return Simulator::GetMaximumSimulationTime();
+	return m_rateLimited.begin()->first;
+}
+
 //获取最近使用的队列
 int RdmaEgressQueue::GetLastQueue() {
 	return m_qlast;
@@ -179,6 +264,7 @@ Ptr<RdmaQueuePair> RdmaEgressQueue::GetQp(uint32_t i) {
 void RdmaEgressQueue::RecoverQueue(uint32_t i) {
 	NS_ASSERT_MSG(i < m_qpGrp->GetN(), "RdmaEgressQueue::RecoverQueue: qIndex >= m_qpGrp->GetN()");
 	m_qpGrp->Get(i)->snd_nxt = m_qpGrp->Get(i)->snd_una;
+	UpdateQp(m_qpGrp->Get(i));
 }
 
 void RdmaEgressQueue::EnqueueHighPrioQ(Ptr<Packet> p) {
@@ -223,7 +309,7 @@ QbbNetDevice::GetTypeId(void)
 	                                   "A queue to use as the transmit queue in the device.",
 	                                   PointerValue (),
 	                                   MakePointerAccessor (&QbbNetDevice::m_queue),
-	                                   MakePointerChecker<Queue<Packet>>())
+	                                   MakePointerChecker<BEgressQueue>())
 	                    .AddAttribute ("RdmaEgressQueue",
 	                                   "A queue to use as the transmit queue in the device.",
 	                                   PointerValue (),
@@ -248,6 +334,7 @@ QbbNetDevice::QbbNetDevice()
 {
 	NS_LOG_FUNCTION(this);
 	m_ecn_source = new std::vector<ECNAccount>;
+	m_uniform = CreateObject<UniformRandomVariable>();
 	m_rdmaEQ = CreateObject<RdmaEgressQueue>();
 	m_rdmaEQ->qb_dev = this;
 
@@ -268,6 +355,10 @@ void
 QbbNetDevice::DoDispose()
 {
 	NS_LOG_FUNCTION(this);
+	if (m_flowMonitor) {
+		m_flowMonitor->Unregister(&m_flowStats);
+		m_flowMonitor = nullptr;
+	}
 
 	PointToPointNetDevice::DoDispose();
 }
@@ -277,6 +368,15 @@ DataRate QbbNetDevice::GetDataRate() {
 	return m_bps;
 }
 
+bool QbbNetDevice::IsPacketTraced(void) const {
+	return !(m_traceEnqueue.IsEmpty() && m_traceDequeue.IsEmpty() && m_traceDrop.IsEmpty() && m_traceQpDequeue.IsEmpty() &&
+	         m_macTxTrace.IsEmpty() && m_macTxDropTrace.IsEmpty() && m_macPromiscRxTrace.IsEmpty() && m_macRxTrace.IsEmpty() &&
+	         m_phyTxBeginTrace.IsEmpty() && m_phyTxEndTrace.IsEmpty() && m_phyTxDropTrace.IsEmpty() &&
+	         m_phyRxEndTrace.IsEmpty() && m_phyRxDropTrace.IsEmpty() &&
+	         m_snifferTrace.IsEmpty() && m_promiscSnifferTrace.IsEmpty() &&
+	         (!m_rdmaEQ || (m_rdmaEQ->m_traceRdmaEnqueue.IsEmpty() && m_rdmaEQ->m_traceRdmaDequeue.IsEmpty())));
+}
+
 bool
 QbbNetDevice::TransmitStart(Ptr<Packet> p)
 {
@@ -312,7 +412,7 @@ QbbNetDevice::TransmitComplete(void)
 	NS_LOG_FUNCTION(this);
 	NS_ASSERT_MSG(m_txMachineState == BUSY, "Must be BUSY if transmitting");
 	m_txMachineState = READY;
-	NS_ASSERT_MSG(m_currentPkt != 0, "QbbNetDevice::TransmitComplete(): m_currentPkt zero");
+	NS_ASSERT_MSG(m_currentPkt, "QbbNetDevice::TransmitComplete(): m_currentPkt zero");
 	m_phyTxEndTrace(m_currentPkt);
 	m_currentPkt = 0;
 	DequeueAndTransmit();//传输下一个数据包
@@ -341,7 +441,7 @@ QbbNetDevice::DequeueAndTransmit(void)
 			}
 			else if (qIndex == -2) {
 				Ptr<Packet> p = m_queue->DequeueRR (m_paused);
-				if (p == 0)
+				if (!p)
 				{
 					NS_LOG_LOGIC ("No pending packets in device queue after tx complete");
 					return;
@@ -368,41 +468,29 @@ QbbNetDevice::DequeueAndTransmit(void)
 
 			// update for the next avail time
 			m_rdmaPktSent(lastQp, p, m_tInterframeGap);//通知 QP 该数据包已发送，并设置下次可用时间 (m_tInterframeGap)
+			m_rdmaEQ->UpdateQp(lastQp);
 			totalBytesSent += p->GetSize();
 		} else { // no packet to send
 			NS_LOG_INFO("PAUSE prohibits send at node " << m_node->GetId());
-			Time t = Simulator::GetMaximumSimulationTime();
-			for (uint32_t i = 0; i < m_rdmaEQ->GetFlowCount(); i++) {
-				Ptr<RdmaQueuePair> qp = m_rdmaEQ->GetQp(i);
-				if (qp->GetBytesLeft() == 0)
-					continue;
-				t = Min(qp->m_nextAvail, t);
-			}
+			Time t = m_rdmaEQ->GetNextAvail();
 			if (m_nextSend.IsExpired() && t < Simulator::GetMaximumSimulationTime() && t > Simulator::Now()) {
-				m_nextSend = Simulator::Schedule(t - Simulator::Now(), &QbbNetDevice::DequeueAndTransmit, this);
+				// re-arms the event being executed, if this is it
+				m_nextSend = Simulator::Reschedule(m_nextSend, t - Simulator::Now());
+				if (m_nextSend.IsExpired())
+					m_nextSend = Simulator::Schedule(t - Simulator::Now(), &QbbNetDevice::DequeueAndTransmit, this);
 			}
 		}
 		return;
 	}
 	else {  //switch, doesn't care about qcn, just send
 		p = m_queue->DequeueRR(m_paused);		//this is round-robin
-		if (p != 0) {
+		if (p) {
 			m_snifferTrace(p);
 			m_promiscSnifferTrace(p);
-			Ipv4Header h;
-			Ptr<Packet> packet = p->Copy();
-			uint16_t protocol = 0;
-			ProcessHeader(packet, protocol);
-			packet->RemoveHeader(h);
 			InterfaceTag t;
 			uint32_t qIndex = m_queue->GetLastQueue();
-			if (qIndex == 0) { //this is a pause or cnp, send it immediately!
-				m_node->SwitchNotifyDequeue(m_ifIndex, qIndex, p);
-				p->RemovePacketTag(t);
-			} else {
-				m_node->SwitchNotifyDequeue(m_ifIndex, qIndex, p);
-				p->RemovePacketTag(t);
-			}
+			m_node->SwitchNotifyDequeue(m_ifIndex, qIndex, p);
+			p->RemovePacketTag(t);
 			m_traceDequeue(p, qIndex);
 			TransmitStart(p);
 			numTxBytes += p->GetSize();
@@ -411,15 +499,11 @@ QbbNetDevice::DequeueAndTransmit(void)
 		} else { //No queue can deliver any packet
 			NS_LOG_INFO("PAUSE prohibits send at node " << m_node->GetId());
 			if (m_node->GetNodeType() == 0 && m_qcnEnabled) { //nothing to send, possibly due to qcn flow control, if so reschedule sending
-				Time t = Simulator::GetMaximumSimulationTime();
-				for (uint32_t i = 0; i < m_rdmaEQ->GetFlowCount(); i++) {
-					Ptr<RdmaQueuePair> qp = m_rdmaEQ->GetQp(i);
-					if (qp->GetBytesLeft() == 0)
-						continue;
-					t = Min(qp->m_nextAvail, t);
-				}
+				Time t = m_rdmaEQ->GetNextAvail();
 				if (m_nextSend.IsExpired() && t < Simulator::GetMaximumSimulationTime() && t > Simulator::Now()) {
-					m_nextSend = Simulator::Schedule(t - Simulator::Now(), &QbbNetDevice::DequeueAndTransmit, this);
+					m_nextSend = Simulator::Reschedule(m_nextSend, t - Simulator::Now());
+					if (m_nextSend.IsExpired())
+						m_nextSend = Simulator::Schedule(t - Simulator::Now(), &QbbNetDevice::DequeueAndTransmit, this);
 				}
 			}
 		}
@@ -491,8 +575,12 @@ QbbNetDevice::Receive(Ptr<Packet> packet)
 {
 // std::cout << "receive" << std::endl;
 	NS_LOG_FUNCTION(this << packet);
+	RdmaSegmentPool &segments = RdmaSegmentPool::Get();
+	if (segments.GetN() > 0 && IsPacketTraced())
+		segments.Materialize(packet); // traces see the header bytes
 	if (!m_linkUp) {
 		m_traceDrop(packet, 0);
+		segments.Release(packet);
 		return;
 	}
 
@@ -503,6 +591,7 @@ QbbNetDevice::Receive(Ptr<Packet> packet)
 		// corrupted packet, don't forward this packet up, let it go.
 		//
 		m_phyRxDropTrace(packet);
+		segments.Release(packet);
 		return;
 	}
 
@@ -510,7 +599,10 @@ QbbNetDevice::Receive(Ptr<Packet> packet)
 
 	CustomHeader ch(CustomHeader::L2_Header | CustomHeader::L3_Header | CustomHeader::L4_Header);
 	ch.getInt = 1; // parse INT header
-	packet->PeekHeader(ch);//查看但不移除数据包中的头部信息
+	if (CustomHeader *segment = segments.Find(packet))
+		ch = *segment; // data segment without header bytes
+	else
+		packet->PeekHeader(ch);//查看但不移除数据包中的头部信息
 	if (ch.l3Prot == 0xFE) { // PFC
 		if (!m_qbbEnabled) return;
 		unsigned qIndex = ch.pfc.qIndex;
@@ -526,13 +618,7 @@ QbbNetDevice::Receive(Ptr<Packet> packet)
 			packet->AddPacketTag(InterfaceTag(m_ifIndex));
 			m_node->SwitchReceiveFromDevice(this, packet, ch);
 		} else { // NIC
-			int ret;
-			Ptr<Packet> cp = packet->Copy();
-			
-			PppHeader ph; cp->RemoveHeader(ph);//（可以得到源、目的端口）
- 			Ipv4Header ih;//(这里可以得到源、目的地址ipv4地址)
-			cp->RemoveHeader(ih);
-			if (ih.GetProtocol() == 0x06) {
+			if (ch.l3Prot == 0x06) {
 				m_snifferTrace (packet);
 				m_promiscSnifferTrace (packet);
 				m_phyRxEndTrace (packet);
@@ -551,227 +637,98 @@ QbbNetDevice::Receive(Ptr<Packet> packet)
 			else {
 				// send to RdmaHw
 				if(((ch.dip >> 8) & 0xffff)==m_node->GetId()){//接收端才进行计算
-				std::ofstream flowstatsFile;
-				// 根据是否是第一次打开文件来选择文件打开模式
-        		std::ios_base::openmode mode = isFirstOpen ? std::ios::out : std::ios::app;
-
-				flowstatsFile.open("flow_stats.txt", mode);
-				
-				if (!flowstatsFile.is_open()) {
-        			throw std::runtime_error("Unable to open file for writing flow statistics.");
-    			}
-				GenerateFlowId(cp,ch,flowstatsFile);
-				
-				// 如果是第一次打开，设置标志为false，后续追加
-            	isFirstOpen = false;
-				flowstatsFile.close();
+					GenerateFlowId(packet, ch);
 				}
-				ret = m_rdmaReceiveCb(packet, ch);
+				m_rdmaReceiveCb(packet, ch);
+				if (ch.l3Prot == 0x11)
+					segments.Release(packet); // consumed by RdmaHw
 			}
-			// TODO we may based on the ret do something
 		}
 	}
 	return;
 }
 
 //生成flowid和获取数据包大小
-void QbbNetDevice::GenerateFlowId(Ptr<Packet> cp,CustomHeader& header,std::ofstream& flowstatsFile)
+void QbbNetDevice::GenerateFlowId(Ptr<Packet> p, CustomHeader& header)
 {
 	uint8_t protocol = header.l3Prot; // 获取协议号
-    uint32_t srcIp = header.sip; // 获取源IP地址
-    uint32_t dstIp = header.dip; // 获取目标IP地址
-	//将IP转换成ID
-	uint32_t srcId = ((srcIp >> 8) & 0xffff);
-	uint32_t dstId = ((dstIp >> 8) & 0xffff);
-    uint16_t srcPort = 0; // 源端口号
-    uint16_t dstPort = 0; // 目标端口号
-	//获取数据包大小
-	uint16_t packetSize = 0;
-	// 根据协议类型处理传输层头部
-    if (protocol == 0x11) // UDP协议号为17
-    {
-        srcPort = header.udp.sport; // 获取源端口号
-        dstPort = header.udp.dport; // 获取目标端口号
-		packetSize = cp->GetSize();
-		//packetSize = header.udp.payload_size;
-		//packetSize = header.m_payloadSize;
-    }
-    else
-    {
-        NS_LOG_INFO("不支持的协议: " << static_cast<uint32_t>(protocol)); // 记录不支持的协议
-        return ; // 返回默认值表示不支持的协议
-    }
-
-    // 将所有信息组合成一个字符串
-    std::ostringstream oss;
-    oss << srcId << "-" << dstId << "-" << srcPort << "-" << dstPort;
-
-    // 使用哈希函数将组合后的字符串转换为唯一整数ID
-    /*std::hash<std::string> hasher;
-    uint32_t flowid = static_cast<uint32_t>(hasher(oss.str()));*/
-	std::string flowid = oss.str();
-    
-	/*if(flowid == "0-1-0-0"){
-		cout << header.udp.seq<<endl;
-		flowstatsFile <<header.udp.seq<<endl;
-	}*/
-
-	//计算速率
-	onPacketReceived(flowid, packetSize,flowstatsFile);
-}
-
-void QbbNetDevice::onPacketReceived(std::string flowid, uint16_t packetSize,std::ofstream& flowstatsFile) {
-    uint64_t currentTime = Simulator::Now().GetNanoSeconds();
-    
-    // 检查该流是否存在
-    auto it = flowStats.find(flowid);
-    
-    if (it == flowStats.end()){
-        // 流不存在，创建新流
-        FlowStat newStat = { packetSize, currentTime };
-        flowStats[flowid] = newStat;
-    }
-	calculateRate(flowid,packetSize,flowstatsFile);
-}
-
-// 计算每条流速率并输出
-void QbbNetDevice::calculateRate(std::string flowid, uint16_t packetSize,std::ofstream& flowstatsFile) {
-    uint64_t currentTime =  Simulator::Now().GetNanoSeconds();
-
-    // 遍历所有流，找出与flowid对应的流，计算速率
-    //判断系统稳态的变量
-	bool allSteadyStateReached = true;
-
-    // 遍历所有流，找出与flowid对应的流，计算速率
-    for (auto& entry : flowStats) {
-        string flow_id = entry.first;
-        FlowStat& stat = entry.second;
-
-        // 判断是否超过监测周期
-		if (currentTime - stat.timestamp >= MONITOR_PERIOD) {
-			if(stat.ifnewpacket){	//在这个周期内是否有这个流的新数据包进入
-				// 计算速率（单位：字节/纳秒）
-				double rate = static_cast<double>(stat.byteCount)*8 / MONITOR_PERIOD;  // 
-				cout << "Flow ID: " << flow_id << " - Rate: " << rate << " Gbps" << " currentTime: " << currentTime << endl;
-				flowstatsFile << "Flow ID: " << flow_id << " - Rate: " << rate << " Gbps" << " currentTime: " << currentTime << std::endl;
-				stat.ifnewpacket =false;
-				stat.rate.push_back(rate);
-				if(stat.rate.size() >= stat.size){
-					stat.rate.erase(stat.rate.begin());
-					// 获取最小值和最大值
-					auto result = std::minmax_element(stat.rate.begin(), stat.rate.end());
-					auto minIt = result.first;
-					auto maxIt = result.second;
-					if(std::fabs(*maxIt - *minIt)  <= 2.22045e-16 ){
-						stat.steadyStateReached = true;//流进入稳态
-						//cout<<"进入稳态"<<endl;
-						
-					}else {
-						stat.steadyStateReached = false;  // 如果速率波动超过阈值，重置稳态状态
-						allSteadyStateReached = false;   // 任何一个流未进入稳态，系统不再稳态
-					}
-					
-				}
-				
-				// 清空流的统计信息
-				stat.byteCount = 0;
-				stat.timestamp = currentTime;
-				//stat.byteCount +=packetSize;
-			}
-		}
-		if(flow_id == flowid){		
-			stat.ifnewpacket	= true;
-			stat.byteCount +=packetSize;
-		}
-	}
-
-	for (auto& entry_SteadyState : flowStats) {				
-		if (!entry_SteadyState.second.steadyStateReached) {
-			allSteadyStateReached = false;
-			break;  // 一旦发现一个流未进入稳态，直接跳出循环
-		}
+	if (protocol != 0x11) // UDP协议号为17
+	{
+		NS_LOG_INFO("不支持的协议: " << static_cast<uint32_t>(protocol)); // 记录不支持的协议
+		return;
 	}
-	// 判断系统是否刚刚进入稳态
-    if (allSteadyStateReached && !inSteadyState) {
-        steadyStateStartTime = currentTime;
-        inSteadyState = true;
-        cout << "System entered steady state at time: " << steadyStateStartTime << " ns" << endl;
-		flowstatsFile << "System entered steady state at time: " << steadyStateStartTime << " ns" << endl;
+	//将IP转换成ID
+	uint32_t srcId = ((header.sip >> 8) & 0xffff);
+	uint32_t dstId = ((header.dip >> 8) & 0xffff);
+	//数据包大小不含PPP和IPv4头部
+	uint16_t packetSize = p->GetSize() - PppHeader().GetSerializedSize() - Ipv4Header().GetSerializedSize();
+	onPacketReceived(FlowStatsTable::MakeKey(srcId, dstId, header.udp.sport, header.udp.dport), packetSize);
+}
+
+void QbbNetDevice::onPacketReceived(uint64_t flowKey, uint16_t packetSize) {
+	// the monitor of the thread of the node, kept across the runs
+	if (!m_flowMonitor)
+		m_flowMonitor = FlowStatsMonitor::Get();
+	if (m_flowMonitor->Record(m_flowStats, flowKey, packetSize) == FlowStatsMonitor::STEADY_ENTER) {
 		//计算剩余流量大小除以已测量的速度均值，获取最小流完成时间
-		//如果在这里进行，就只计算了接收端这一个节点的，所以我们要在外部计算所有节点的流完成时间
-		calculateMintime();
-		cout << "最小流完成时间: " <<std::fixed << std::setprecision(6)<< flowMinTime <<endl;
-		flowstatsFile <<"最小流完成时间: " <<std::fixed << std::setprecision(6)<< flowMinTime <<endl;
-		//flowstatsFile <<"判断最小流完成时间的次数"<<number_test<<endl;
-		flowMinTime = 1.79769e+308;
-    }
-
-    // 判断系统是否退出稳态
-    if (!allSteadyStateReached && inSteadyState) {
-        uint64_t steadyStateExitTime = currentTime; //退出稳态时间
-        uint64_t duration = steadyStateExitTime - steadyStateStartTime;
-        cout << "System exited steady state at time: " << steadyStateExitTime << " ns" << endl;
-        cout << "Steady state duration: " << std::fixed << std::setprecision(6)<<duration  << " ns" << endl;
-        flowstatsFile << "System exited steady state at time: " << steadyStateExitTime << " ns, duration: " <<std::fixed << std::setprecision(6)<< duration  << " ns" << std::endl;
-        inSteadyState = false;
-    }
+		//只用接收端这一个节点的统计不够，所以要计算所有节点的流完成时间
+		m_flowMonitor->ReportMinTime(calculateMintime());
+	}
 }
 
 //计算剩余流量大小除以已测量的速度均值，获取最小时间
 //每一个设备qbbnetdevice都对应一个m_rdmaEQ，也就是要计算所有设备找出最小流完成时间
-void QbbNetDevice::calculateMintime(){
+double QbbNetDevice::calculateMintime(){
+	double flowMinTime = 1.79769e+308;	//整个系统最小流完成时间
+#ifdef NS3_MPI
+	// the queues of the nodes of the other threads are theirs, and their flows are in other monitors
+	uint32_t thread = HybridSimulatorImpl::GetThread(Simulator::GetContext());
+#endif
 	// 遍历所有 Node（网络节点）
-    for (NodeList::Iterator it = NodeList::Begin(); it != NodeList::End(); ++it)
-    {
-        Ptr<Node> node = *it;
-
-        // 遍历该 Node 的所有 NetDevice（设备）
-        for (uint32_t i = 0; i < node->GetNDevices(); ++i)
-        {
-            Ptr<QbbNetDevice> qbbDev = DynamicCast<QbbNetDevice>(node->GetDevice(i));
-            if (!qbbDev|| node->GetNodeType()!=0) continue; // 如果不是 QbbNetDevice或者主机端，则跳过
+	for (NodeList::Iterator it = NodeList::Begin(); it != NodeList::End(); ++it)
+	{
+		Ptr<Node> node = *it;
+#ifdef NS3_MPI
+		if (HybridSimulatorImpl::GetThread(node->GetId()) != thread)
+			continue;
+#endif
+
+		// 遍历该 Node 的所有 NetDevice（设备）
+		for (uint32_t i = 0; i < node->GetNDevices(); ++i)
+		{
+			Ptr<QbbNetDevice> qbbDev = DynamicCast<QbbNetDevice>(node->GetDevice(i));
+			if (!qbbDev|| node->GetNodeType()!=0) continue; // 如果不是 QbbNetDevice或者主机端，则跳过
 
-            // 获取该设备的 RDMA 事件队列
-            Ptr<RdmaEgressQueue> rdmaEQ = qbbDev->m_rdmaEQ;
-            if (!rdmaEQ) continue;
+			// 获取该设备的 RDMA 事件队列
+			Ptr<RdmaEgressQueue> rdmaEQ = qbbDev->m_rdmaEQ;
+			if (!rdmaEQ) continue;
 
-            // 遍历 RDMA 事件队列中的所有流，计算最小流完成时间
-            flowCompletiontime(rdmaEQ);
-        }
-    }
+			// 遍历 RDMA 事件队列中的所有流，计算最小流完成时间
+			flowCompletiontime(rdmaEQ, flowMinTime);
+		}
+	}
+	return flowMinTime;
 }
 
 
-void QbbNetDevice::flowCompletiontime(Ptr<RdmaEgressQueue> rdmaEQ){
-	uint32_t qIndex;
+void QbbNetDevice::flowCompletiontime(Ptr<RdmaEgressQueue> rdmaEQ, double& flowMinTime){
+	Ptr<FlowStatsMonitor> monitor = FlowStatsMonitor::Get();
 	uint32_t fcount = rdmaEQ->m_qpGrp->GetN();
-		for (qIndex = 0; qIndex < fcount; qIndex++) {
-			uint32_t idx = qIndex ;
-			Ptr<RdmaQueuePair> qp = rdmaEQ->m_qpGrp->Get(idx);//qp里面也有很多条流
-
-			//获取flowid
-			uint32_t srcIp = qp->sip.Get(); // 获取源IP地址
-			uint32_t dstIp = qp->dip.Get(); // 获取目标IP地址
-			//将IP转换成ID
-			uint32_t srcId = ((srcIp >> 8) & 0xffff);
-			uint32_t dstId = ((dstIp >> 8) & 0xffff);
-			uint16_t srcPort = qp->sport; // 源端口号
-			uint16_t dstPort = qp->dport; // 目标端口号
-			std::ostringstream oss;
-    		oss << srcId << "-" << dstId << "-" << srcPort << "-" << dstPort;
-			std::string flowid = oss.str();
-
-			map<std::string, FlowStat>::iterator iter=flowStats.find(flowid);
-			if(iter!=flowStats.end()){
-				double sum = std::accumulate(iter->second.rate.begin(), iter->second.rate.end(), 0.0); // 计算总和
-    			double avg = sum / iter->second.rate.size();
-				double time = static_cast<double>(qp->GetBytesLeft())*8 / avg;
-				//number_test++;
-				if(time < flowMinTime)
-					flowMinTime =time;
-			}
+	for (uint32_t qIndex = 0; qIndex < fcount; qIndex++) {
+		Ptr<RdmaQueuePair> qp = rdmaEQ->m_qpGrp->Get(qIndex);//qp里面也有很多条流
+		if (qp->IsFinished())
+			continue;
+
+		//获取flowid
+		uint32_t srcId = ((qp->sip.Get() >> 8) & 0xffff);
+		uint32_t dstId = ((qp->dip.Get() >> 8) & 0xffff);
+		const FlowStat *stat = monitor->Find(FlowStatsTable::MakeKey(srcId, dstId, qp->sport, qp->dport));
+		if (stat != NULL && stat->rateCount > 0) {
+			double time = static_cast<double>(qp->GetBytesLeft())*8 / stat->GetAvgRate();
+			if(time < flowMinTime)
+				flowMinTime = time;
 		}
-
+	}
 }
 
 //获取当前 NetDevice 所连接的远端设备的地址
@@ -813,6 +770,9 @@ bool QbbNetDevice::Send(Ptr<Packet> packet, const Address &dest, uint16_t protoc
 }
 
 bool QbbNetDevice::SwitchSend (uint32_t qIndex, Ptr<Packet> packet, CustomHeader &ch) {
+	RdmaSegmentPool &segments = RdmaSegmentPool::Get();
+	if (segments.GetN() > 0 && IsPacketTraced())
+		segments.Materialize(packet);
 	m_macTxTrace(packet);
 	m_traceEnqueue(packet, qIndex);
 	m_queue->Enqueue(packet, qIndex);
@@ -830,7 +790,7 @@ void QbbNetDevice::SendPfc(uint32_t qIndex, uint32_t type) {
 	ipv4h.SetDestination(Ipv4Address("255.255.255.255"));
 	ipv4h.SetPayloadSize(p->GetSize());
 	ipv4h.SetTtl(1);
-	ipv4h.SetIdentification(UniformVariable(0, 65536).GetValue());
+	ipv4h.SetIdentification(m_uniform->GetInteger(0, 65535));
 	p->AddHeader(ipv4h);
 	AddHeader(p, 0x800);
 	CustomHeader ch(CustomHeader::L2_Header | CustomHeader::L3_Header | CustomHeader::L4_Header);
@@ -855,15 +815,13 @@ QbbNetDevice::GetChannel(void) const
 	return m_channel;
 }
 
-bool QbbNetDevice::IsQbb(void) const {
-	return true;
-}
-
 void QbbNetDevice::NewQp(Ptr<RdmaQueuePair> qp) {
 	qp->m_nextAvail = Simulator::Now();
+	m_rdmaEQ->AddQp(qp);
 	DequeueAndTransmit();
 }
 void QbbNetDevice::ReassignedQp(Ptr<RdmaQueuePair> qp) {
+	m_rdmaEQ->AddQp(qp);
 	DequeueAndTransmit();
 }
 void QbbNetDevice::TriggerTransmit(void) {
@@ -905,9 +863,10 @@ void QbbNetDevice::TakeDown() {
 			m_paused[i] = false;
 		while (1) {
 			Ptr<Packet> p = m_queue->DequeueRR(m_paused);
-			if (p == 0)
+			if (!p)
 				break;
 			m_traceDrop(p, m_queue->GetLastQueue());
+			RdmaSegmentPool::Get().Release(p);
 		}
 		// TODO: Notify switch that this link is down
 	}
@@ -917,9 +876,9 @@ void QbbNetDevice::TakeDown() {
 //更新设备的下一次可用发送时间
 void QbbNetDevice::UpdateNextAvail(Time t) {
 	if (!m_nextSend.IsExpired() && t < Time(m_nextSend.GetTs())) {
-		Simulator::Cancel(m_nextSend);
+		// moved earlier in the event list, rather than cancelled and scheduled again
 		Time delta = t < Simulator::Now() ? Time(0) : t - Simulator::Now();
-		m_nextSend = Simulator::Schedule(delta, &QbbNetDevice::DequeueAndTransmit, this);
+		m_nextSend = Simulator::Reschedule(m_nextSend, delta);
 	}
 }
 } 
@@ -10,19 +10,20 @@
 #include "ns3/ipv4-header.h"
 #include "ns3/udp-header.h"
 #include "ns3/rdma-queue-pair.h"
+#include "ns3/flow-acc.h"
 #include <vector>
 #include<map>
 #include<string>
 #include <sstream>
 #include <fstream>
-#include <filesystem>//判断文件时是否存在
-#include<numeric> //accmulate
-#include<numeric> //accmulate
+#include "ns3/random-variable-stream.h"
 // #include <ns3/rdma.h>
 // #define ENABLE_QP 1
 
 namespace ns3 {
 
+class QbbNetDevice;
+
 class RdmaEgressQueue : public Object{
 public:
 	static const uint32_t qCnt = 8;
@@ -55,6 +56,33 @@ public:
 	Ptr<QbbNetDevice> qb_dev;
 	bool dummy_paused[8];
 	uint64_t hostDequeueIndex;
+
+	/*
+	 * Queue pair scheduler. A qp that can send is kept in the ready ring
+	 * of its priority, ordered by arrival, so the round robin over all
+	 * qps is a lookup per priority instead of a scan. A qp waiting for
+	 * its next available time is kept in a map ordered by that time, and
+	 * a qp without data or window waits for UpdateQp(). RdmaHw must call
+	 * UpdateQp() whenever it changes snd_una, snd_nxt, m_rate or
+	 * m_nextAvail outside of a dequeue.
+	 */
+	enum QpState { QP_IDLE, QP_READY, QP_RATE_LIMITED, QP_BLOCKED, QP_FINISHED };
+	void AddQp(Ptr<RdmaQueuePair> qp); // register the qp just added to m_qpGrp
+	void UpdateQp(Ptr<RdmaQueuePair> qp); // re-evaluate a qp after its state changed
+	void ClearQps(); // forget all qps, before m_qpGrp is cleared
+	Time GetNextAvail(); // the earliest next available time of a rate limited qp
+
+private:
+	void ScheduleQp(Ptr<RdmaQueuePair> qp);
+	void UnscheduleQp(Ptr<RdmaQueuePair> qp);
+	int PickQp(bool paused[]);
+	void CompactQps();
+
+	std::map<uint64_t, Ptr<RdmaQueuePair> > m_ready[qCnt]; // qps able to send, by round-robin position
+	std::multimap<Time, Ptr<RdmaQueuePair> > m_rateLimited; // qps waiting for m_nextAvail
+	uint64_t m_nextSeq; // round-robin position of the next qp
+	uint64_t m_rrSeq; // round-robin position of the last qp served
+	uint32_t m_nFinished; // finished qps still in m_qpGrp
 };
 
 /**
@@ -73,15 +101,14 @@ public:
 
   //计算接收端流量速率
   //生成flowid和获取数据包大小
-  void GenerateFlowId(Ptr<Packet> cp,CustomHeader& header,std::ofstream& flowstatsFile);
-  //接收到数据包时的初始化
-  void onPacketReceived(std::string flowid, uint16_t packetSize,std::ofstream& flowstatsFile);
-  // 计算速率并输出
-  void calculateRate(std::string flowid, uint16_t packetSize,std::ofstream& flowstatsFile);
+  void GenerateFlowId(Ptr<Packet> p, CustomHeader& header);
+  //接收到数据包时交给 FlowStatsMonitor 统计速率和稳态
+  void onPacketReceived(uint64_t flowKey, uint16_t packetSize);
   //计算剩余流量大小除以已测量的速度均值，获取最小时间
-  void calculateMintime();
+  //HybridSimulatorImpl 下只遍历调用线程的节点
+  static double calculateMintime();
   //计算流完成时间的子函数
-  void flowCompletiontime(Ptr<RdmaEgressQueue> rdmaEQ);
+  static void flowCompletiontime(Ptr<RdmaEgressQueue> rdmaEQ, double& flowMinTime);
 
   /**
    * Receive a packet from a connected PointToPointChannel.
@@ -111,6 +138,13 @@ public:
 
   DataRate GetDataRate();
 
+  /**
+   * \return true if a trace source that hands out packets is connected,
+   *         so the packets passing through need their header bytes
+   * @see RdmaSegmentPool
+   */
+  bool IsPacketTraced (void) const;
+
   /**
    * Get the size of Tx buffer available in the device
    *
@@ -134,7 +168,6 @@ public:
    void SetQueueFifo (Ptr<DropTailQueue<Packet>> q);
    Ptr<DropTailQueue<Packet>> GetQueueFifo ();
 
-   virtual bool IsQbb(void) const;
    void NewQp(Ptr<RdmaQueuePair> qp);
    void ReassignedQp(Ptr<RdmaQueuePair> qp);
    void TriggerTransmit(void);
@@ -234,6 +267,11 @@ protected:
 
   std::vector<ECNAccount> *m_ecn_source;
 
+  Ptr<UniformRandomVariable> m_uniform; //< identification of the PFC frames
+
+  FlowStatsTable m_flowStats; //< receiver side statistics of the flows ending here
+  Ptr<FlowStatsMonitor> m_flowMonitor; //< monitor of the thread of the node, set by the first data packet
+
 public:
 	Ptr<RdmaEgressQueue> m_rdmaEQ;
 	void RdmaEnqueueHighPrioQ(Ptr<Packet> p);
@@ -0,0 +1,256 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "qbb-remote-channel.h"
+
+#include "qbb-net-device.h"
+#include "rdma-segment-pool.h"
+
+#include "ns3/int-header.h"
+#include "ns3/log.h"
+#include "ns3/mpi-interface.h"
+#include "ns3/mpi-receiver.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("QbbRemoteChannel");
+
+NS_OBJECT_ENSURE_REGISTERED(QbbRemoteChannel);
+
+/** Size of the PPP and IPv4 headers of a control frame. */
+static const uint32_t CONTROL_L4_OFFSET = 2 + 20;
+
+/** Size of the IPv4 fields kept by the encoding. */
+static const uint32_t CONTROL_L3_SIZE = 1 + 1 + 1 + 2 + 8;
+
+/** Largest control frame encoded, so that its padding fits a byte. */
+static const uint32_t CONTROL_MAX_SIZE = 255;
+
+/** Size of the ACK/NACK header before its INT header, see qbbHeader. */
+static const uint32_t CONTROL_ACK_SIZE = 12;
+
+/**
+ * \param protocol the IPv4 protocol of a frame
+ * \return the size of its control header, 0 if it is not a control frame
+ */
+static uint32_t
+GetControlSize(uint8_t protocol)
+{
+    switch (protocol)
+    {
+    case 0xFE: // PFC, see PauseHeader
+        return 9;
+    case 0xFF: // CNP, see CnHeader
+        return 8;
+    case 0xFC: // ACK
+    case 0xFD: // NACK
+        return CONTROL_ACK_SIZE + IntHeader::GetStaticSize();
+    default:
+        return 0;
+    }
+}
+
+/**
+ * \param protocol the IPv4 protocol of a control frame
+ * \return true if its INT header has hops to trim
+ */
+static bool
+HasIntHops(uint8_t protocol)
+{
+    return (protocol == 0xFC || protocol == 0xFD) && IntHeader::mode == IntHeader::NORMAL;
+}
+
+TypeId
+QbbRemoteChannel::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::QbbRemoteChannel")
+                            .SetParent<QbbChannel>()
+                            .SetGroupName("PointToPoint")
+                            .AddConstructor<QbbRemoteChannel>();
+    return tid;
+}
+
+QbbRemoteChannel::QbbRemoteChannel()
+    : QbbChannel(),
+      m_devices{nullptr, nullptr},
+      m_nodes{0, 0},
+      m_ifIndices{0, 0}
+{
+}
+
+QbbRemoteChannel::~QbbRemoteChannel()
+{
+}
+
+void
+QbbRemoteChannel::Attach(Ptr<QbbNetDevice> device)
+{
+    NS_LOG_FUNCTION(this << device);
+
+    QbbChannel::Attach(device);
+    std::size_t i = GetNDevices() - 1;
+    m_devices[i] = PeekPointer(device);
+    m_nodes[i] = device->GetNode()->GetId();
+    m_ifIndices[i] = device->GetIfIndex();
+}
+
+bool
+QbbRemoteChannel::TransmitStart(Ptr<Packet> p, Ptr<QbbNetDevice> src, Time txTime)
+{
+    NS_LOG_FUNCTION(this << p << src);
+    NS_LOG_LOGIC("UID is " << p->GetUid() << ")");
+
+    IsInitialized();
+
+    uint32_t dst = PeekPointer(src) == m_devices[0] ? 1 : 0;
+
+    // Calculate the rxTime (absolute)
+    Time rxTime = Simulator::Now() + txTime + GetDelay();
+    // the remote rank gets the bytes, not the descriptor of a data segment
+    RdmaSegmentPool::Get().Materialize(p);
+    if (Ptr<Packet> control = EncodeControl(p))
+    {
+        MpiInterface::SendPacket(control,
+                                 rxTime,
+                                 m_nodes[dst],
+                                 m_ifIndices[dst] | MpiReceiver::PRIORITY);
+        return true;
+    }
+    MpiInterface::SendPacket(p->Copy(), rxTime, m_nodes[dst], m_ifIndices[dst]);
+    return true;
+}
+
+Ptr<Packet>
+QbbRemoteChannel::EncodeControl(Ptr<const Packet> p)
+{
+    uint32_t size = p->GetSize();
+    if (size < CONTROL_L4_OFFSET || size > CONTROL_MAX_SIZE)
+    {
+        return nullptr;
+    }
+    uint8_t frame[CONTROL_MAX_SIZE];
+    p->CopyData(frame, size);
+    const uint8_t* ip = frame + 2;
+    uint8_t protocol = ip[9];
+    uint32_t l4Size = GetControlSize(protocol);
+    // PPP protocol IPv4, IPv4 without options nor fragments nor checksum
+    uint32_t totalLength = (ip[2] << 8) | ip[3];
+    if (l4Size == 0 || frame[0] != 0x00 || frame[1] != 0x21 || ip[0] != 0x45 ||
+        totalLength != size - 2 || ip[6] != 0 || ip[7] != 0 || ip[10] != 0 || ip[11] != 0 ||
+        CONTROL_L4_OFFSET + l4Size > size)
+    {
+        return nullptr;
+    }
+    uint32_t end = CONTROL_L4_OFFSET + l4Size;
+    if (std::any_of(frame + end, frame + size, [](uint8_t byte) { return byte != 0; }))
+    {
+        return nullptr;
+    }
+
+    uint8_t buffer[CONTROL_MAX_SIZE];
+    uint8_t* out = buffer;
+    *out++ = protocol;
+    *out++ = ip[1]; // TOS
+    *out++ = ip[8]; // TTL
+    out = std::copy(ip + 4, ip + 6, out);   // identification
+    out = std::copy(ip + 12, ip + 20, out); // addresses
+    const uint8_t* l4 = frame + CONTROL_L4_OFFSET;
+    if (HasIntHops(protocol))
+    {
+        // the hops after the last one set are zero
+        const uint8_t* hops = l4 + CONTROL_ACK_SIZE;
+        uint32_t hopSize = sizeof(IntHop::buf);
+        uint8_t nHops = IntHeader::maxHop;
+        while (nHops > 0 && std::all_of(hops + (nHops - 1) * hopSize,
+                                        hops + nHops * hopSize,
+                                        [](uint8_t byte) { return byte == 0; }))
+        {
+            nHops--;
+        }
+        out = std::copy(l4, hops, out);
+        *out++ = nHops;
+        out = std::copy(hops, hops + nHops * hopSize, out);
+        out = std::copy(hops + IntHeader::maxHop * hopSize, l4 + l4Size, out); // nhop
+    }
+    else
+    {
+        out = std::copy(l4, l4 + l4Size, out);
+    }
+    *out++ = size - end; // padding
+    return Create<Packet>(buffer, out - buffer);
+}
+
+Ptr<Packet>
+QbbRemoteChannel::DecodeControl(Ptr<const Packet> p)
+{
+    uint8_t buffer[CONTROL_MAX_SIZE];
+    uint32_t length = p->GetSize();
+    NS_ASSERT(length <= CONTROL_MAX_SIZE);
+    p->CopyData(buffer, length);
+    const uint8_t* in = buffer;
+    uint8_t protocol = in[0];
+    uint32_t l4Size = GetControlSize(protocol);
+    NS_ASSERT_MSG(l4Size > 0, "not an encoded control frame");
+
+    uint8_t frame[CONTROL_MAX_SIZE] = {};
+    uint8_t* ip = frame + 2;
+    frame[1] = 0x21; // PPP protocol IPv4
+    ip[0] = 0x45;
+    ip[1] = in[1];
+    ip[8] = in[2];
+    ip[9] = protocol;
+    std::copy(in + 3, in + 5, ip + 4);
+    std::copy(in + 5, in + 13, ip + 12);
+    in += CONTROL_L3_SIZE;
+    uint8_t* l4 = frame + CONTROL_L4_OFFSET;
+    if (HasIntHops(protocol))
+    {
+        uint8_t* hops = std::copy(in, in + CONTROL_ACK_SIZE, l4);
+        in += CONTROL_ACK_SIZE;
+        uint32_t hopSize = sizeof(IntHop::buf);
+        uint8_t nHops = *in++;
+        std::copy(in, in + nHops * hopSize, hops);
+        in += nHops * hopSize;
+        uint32_t rest = l4Size - CONTROL_ACK_SIZE - IntHeader::maxHop * hopSize;
+        std::copy(in, in + rest, hops + IntHeader::maxHop * hopSize);
+        in += rest;
+    }
+    else
+    {
+        std::copy(in, in + l4Size, l4);
+        in += l4Size;
+    }
+    uint32_t size = CONTROL_L4_OFFSET + l4Size + *in++;
+    NS_ASSERT(in == buffer + length && size <= CONTROL_MAX_SIZE);
+    ip[2] = (size - 2) >> 8;
+    ip[3] = (size - 2) & 0xff;
+    return Create<Packet>(frame, size);
+}
+
+void
+QbbRemoteChannel::Deliver(Ptr<QbbNetDevice> device, Ptr<Packet> p)
+{
+    // a qbb frame starts with a PPP protocol below 0xFC00
+    uint8_t first = 0;
+    p->CopyData(&first, 1);
+    device->Receive(first >= 0xFC ? DecodeControl(p) : p);
+}
+
+} // namespace ns3
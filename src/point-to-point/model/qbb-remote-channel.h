@@ -0,0 +1,117 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This object connects two qbb net devices where at least one is not
+// local to this simulator object.  Like PointToPointRemoteChannel, it
+// over-rides the transmit method and uses an MPI Send operation instead.
+// The control frames of the RDMA stack (PFC, CNP, ACK and NACK) cross
+// the ranks in a compact encoding, ahead of the data frames received
+// for the same time.
+
+#ifndef QBB_REMOTE_CHANNEL_H
+#define QBB_REMOTE_CHANNEL_H
+
+#include "qbb-channel.h"
+
+namespace ns3
+{
+
+/**
+ * \ingroup point-to-point
+ * \brief A QbbChannel whose other end lives on another MPI rank.
+ */
+class QbbRemoteChannel : public QbbChannel
+{
+  public:
+    /**
+     * \brief Get the TypeId
+     *
+     * \return The TypeId for this class
+     */
+    static TypeId GetTypeId();
+
+    /**
+     * \brief Constructor
+     */
+    QbbRemoteChannel();
+
+    /**
+     * \brief Deconstructor
+     */
+    ~QbbRemoteChannel() override;
+
+    /**
+     * \brief Transmit the packet
+     *
+     * \param p Packet to transmit
+     * \param src Source QbbNetDevice
+     * \param txTime Transmit time to apply
+     * \returns true if successful (currently always true)
+     */
+    bool TransmitStart(Ptr<Packet> p, Ptr<QbbNetDevice> src, Time txTime) override;
+
+    /**
+     * \brief Attach a given netdevice to this channel, and keep its address
+     *
+     * \param device pointer to the netdevice to attach to the channel
+     */
+    void Attach(Ptr<QbbNetDevice> device) override;
+
+    /**
+     * \brief Encode a control frame for another rank
+     *
+     * The frame keeps the fields that vary, that is the TOS, TTL,
+     * identification and addresses of its IPv4 header, its PFC, CNP or
+     * ACK/NACK header and the used hops of its INT header, and the size of
+     * its padding.  The encoding starts with the IPv4 protocol of the
+     * frame, 0xFC to 0xFF, where a qbb frame starts with its PPP protocol.
+     *
+     * \param p the frame
+     * \return the encoded frame, or nullptr if p is not a control frame
+     *         that DecodeControl() restores byte for byte
+     */
+    static Ptr<Packet> EncodeControl(Ptr<const Packet> p);
+
+    /**
+     * \brief Restore a control frame encoded by EncodeControl()
+     *
+     * \param p the encoded frame
+     * \return the frame
+     */
+    static Ptr<Packet> DecodeControl(Ptr<const Packet> p);
+
+    /**
+     * \brief Hand a frame received from another rank to a device
+     *
+     * This is the receive callback of the MpiReceiver of the devices of
+     * the channel.
+     *
+     * \param device the receiving device
+     * \param p the frame, encoded if it is a control frame
+     */
+    static void Deliver(Ptr<QbbNetDevice> device, Ptr<Packet> p);
+
+  private:
+    // Only the sender of a packet is used when transmitting: with a
+    // HybridSimulatorImpl the other end may be a node of another thread,
+    // whose reference counts must not be touched.
+    QbbNetDevice* m_devices[2]; //!< The attached devices
+    uint32_t m_nodes[2];        //!< Node id of the attached devices
+    uint32_t m_ifIndices[2];    //!< Interface index of the attached devices
+};
+
+} // namespace ns3
+
+#endif /* QBB_REMOTE_CHANNEL_H */
@@ -1,5 +1,5 @@
 #include <ns3/simulator.h>
-#include <ns3/seq-ts-header.h>
+#include "rdma-seq-header.h"
 #include <ns3/udp-header.h>
 #include <ns3/ipv4-header.h>
 #include "ns3/ppp-header.h"
@@ -8,11 +8,14 @@
 #include "ns3/double.h"
 #include "ns3/data-rate.h"
 #include "ns3/pointer.h"
+#include "ns3/trace-source-accessor.h"
 #include "rdma-hw.h"
 #include "ppp-header.h"
 #include "qbb-header.h"
 #include "cn-header.h"
 #include "ns3/unsched-tag.h"
+#include "rdma-segment-pool.h"
+#include "fct-collector.h"
 
 namespace ns3 {
 
@@ -175,8 +178,27 @@ TypeId RdmaHw::GetTypeId (void)
 	                                  UintegerValue(65536),
 	                                  MakeUintegerAccessor(&RdmaHw::pint_smpl_thresh),
 	                                  MakeUintegerChecker<uint32_t>())
+	                    .AddAttribute("SegmentDescriptors",
+	                                  "Keep the headers of data segments parsed in RdmaSegmentPool, serialize them only for traces and remote ranks",
+	                                  BooleanValue(false),
+	                                  MakeBooleanAccessor(&RdmaHw::m_segmentDescriptors),
+	                                  MakeBooleanChecker())
+	                    .AddAttribute("ApproxSegmentSize",
+	                                  "Largest payload of a coalesced data segment in the message-level approximation, disabled if not above Mtu",
+	                                  UintegerValue(0),
+	                                  MakeUintegerAccessor(&RdmaHw::m_approxSegment),
+	                                  MakeUintegerChecker<uint32_t>())
+	                    .AddAttribute("ApproxGuard",
+	                                  "Head, tail and post rate decrease part of a flow sent packet by packet in the message-level approximation, in base RTTs",
+	                                  DoubleValue(1.0),
+	                                  MakeDoubleAccessor(&RdmaHw::m_approxGuard),
+	                                  MakeDoubleChecker<double>(0))
 	                    .AddAttribute("PowerTCPEnabled", "to enable PowerTCP", BooleanValue(false), MakeBooleanAccessor(&RdmaHw::PowerTCPEnabled), MakeBooleanChecker())
 	                    .AddAttribute("PowerTCPdelay", "to enable PowerTCP in delaymode", BooleanValue(false), MakeBooleanAccessor(&RdmaHw::PowerTCPdelay), MakeBooleanChecker())
+	                    .AddTraceSource("RxData",
+	                                    "Data received in order by a rx qp",
+	                                    MakeTraceSourceAccessor(&RdmaHw::m_traceRxData),
+	                                    "ns3::RdmaHw::RxDataTracedCallback")
 	                    ;
 	return tid;
 }
@@ -210,7 +232,7 @@ uint32_t RdmaHw::GetNicIdxOfQp(Ptr<RdmaQueuePair> qp) {
 	if (v.size() > 0) {
 		return v[qp->GetHash() % v.size()];
 	} else {
-		NS_ASSERT_MSG(false, "We assume at least one NIC is alive");
+		NS_FATAL_ERROR("We assume at least one NIC is alive");
 	}
 }
 uint64_t RdmaHw::GetQpKey(uint32_t dip, uint16_t sport, uint16_t pg) {
@@ -307,7 +329,7 @@ uint32_t RdmaHw::GetNicIdxOfRxQp(Ptr<RdmaRxQueuePair> q) {
 	if (v.size() > 0) {
 		return v[q->GetHash() % v.size()];
 	} else {
-		NS_ASSERT_MSG(false, "We assume at least one NIC is alive");
+		NS_FATAL_ERROR("We assume at least one NIC is alive");
 	}
 }
 void RdmaHw::DeleteRxQp(uint32_t dip, uint16_t pg, uint16_t dport) {
@@ -330,6 +352,8 @@ int RdmaHw::ReceiveUdp(Ptr<Packet> p, CustomHeader &ch) {
 	rxQp->m_milestone_rx = m_ack_interval;
 
 	int x = ReceiverCheckSeq(ch.udp.seq, rxQp, payload_size);
+	if (x == 1 || x == 5) // in order
+		m_traceRxData(ch.sip, ch.udp.sport, ch.udp.dport, payload_size);
 	if (x == 1 || x == 2) { //generate ACK or NACK
 		qbbHeader seqh;
 		seqh.SetSeq(rxQp->ReceiverNextExpectedSeq);
@@ -372,11 +396,7 @@ int RdmaHw::ReceiveCnp(Ptr<Packet> p, CustomHeader &ch) {
 		return 0;
 	}
 	uint16_t udpport = ch.cnp.fid; // corresponds to the sport
-	uint8_t ecnbits = ch.cnp.ecnBits;
-	uint16_t qfb = ch.cnp.qfb;
-	uint16_t total = ch.cnp.total;
 
-	uint32_t i;
 	// get qp
 	Ptr<RdmaQueuePair> qp = GetQp(ch.sip, udpport, qIndex);
 	if (qp == NULL)
@@ -410,7 +430,6 @@ int RdmaHw::ReceiveAck(Ptr<Packet> p, CustomHeader &ch) {
 	uint16_t port = ch.ack.dport;
 	uint32_t seq = ch.ack.seq;
 	uint8_t cnp = (ch.ack.flags >> qbbHeader::FLAG_CNP) & 1;
-	int i;
 	Ptr<RdmaQueuePair> qp = GetQp(ch.sip, port, qIndex);
 	if (qp == NULL) {
 		std::cout << "ERROR: " << "node:" << m_node->GetId() << ' ' << (ch.l3Prot == 0xFC ? "ACK" : "NACK") << " NIC cannot find the flow\n";
@@ -452,6 +471,7 @@ int RdmaHw::ReceiveAck(Ptr<Packet> p, CustomHeader &ch) {
 		HandleAckHpPint(qp, p, ch);
 	}
 	// ACK may advance the on-the-fly window, allowing more packets to send
+	dev->m_rdmaEQ->UpdateQp(qp);
 	dev->TriggerTransmit();
 	return 0;
 }
@@ -473,7 +493,7 @@ int RdmaHw::ReceiverCheckSeq(uint32_t seq, Ptr<RdmaRxQueuePair> q, uint32_t size
 	uint32_t expected = q->ReceiverNextExpectedSeq;
 	if (seq == expected) {
 		q->ReceiverNextExpectedSeq = expected + size;
-		if (q->ReceiverNextExpectedSeq >= q->m_milestone_rx) {
+		if (q->ReceiverNextExpectedSeq >= (uint32_t)q->m_milestone_rx) {
 			q->m_milestone_rx += m_ack_interval;
 			return 1; //Generate ACK
 		} else if (q->ReceiverNextExpectedSeq % m_chunk == 0) {
@@ -527,6 +547,14 @@ void RdmaHw::QpComplete(Ptr<RdmaQueuePair> qp) {
 	// It may also delete the rxQp on the receiver
 	m_qpCompleteCallback(qp);
 
+	if (FctCollector::IsEnabled()) {
+		// the standalone FCT: the base RTT plus the frames of the flow at the line rate of the qp
+		uint64_t headers = 2 + 20 + CustomHeader::GetUdpHeaderSize();
+		uint64_t bytes = qp->m_size + (qp->m_size + m_mtu - 1) / m_mtu * headers;
+		Time ideal = FctCollector::GetIdealFct(bytes, qp->m_max_rate, NanoSeconds(qp->m_baseRtt));
+		FctCollector::Get()->Record(qp->startTime.GetNanoSeconds(), Simulator::Now().GetNanoSeconds(), qp->m_size, ideal.GetNanoSeconds());
+	}
+
 	qp->m_notifyAppFinish();
 
 	// delete the qp
@@ -551,6 +579,7 @@ void RdmaHw::RedistributeQp() {
 	for (uint32_t i = 0; i < m_nic.size(); i++) {
 		if (m_nic[i].dev == NULL)
 			continue;
+		m_nic[i].dev->m_rdmaEQ->ClearQps();
 		m_nic[i].qpGrp->Clear();
 	}
 
@@ -564,13 +593,47 @@ void RdmaHw::RedistributeQp() {
 	}
 }
 
+/*
+ * Message-level approximation: in the body of a long flow, several MTUs
+ * are sent as one coalesced segment that crosses the devices and switches
+ * as a single frame, so the bulk advances at the congestion control rate
+ * with one event per segment and hop instead of one per MTU. The head and
+ * the tail of the flow, and ApproxGuard RTTs after every rate decrease
+ * (the flow hit a bottleneck), keep the packet-level behaviour.
+ */
+uint32_t RdmaHw::GetPayloadSize(Ptr<RdmaQueuePair> qp, uint32_t nic_idx) {
+	uint64_t left = qp->GetBytesLeft();	//获取剩余流量大小
+	if (left <= m_mtu)
+		return left;
+	if (m_approxSegment <= m_mtu)
+		return m_mtu;
+	// the congestion control modes change m_rate in place, compare with the last send
+	if (qp->m_rate < qp->m_approxRate)
+		qp->m_approxResume = Simulator::Now() + NanoSeconds(qp->m_baseRtt * m_approxGuard);
+	qp->m_approxRate = qp->m_rate;
+	if (Simulator::Now() < qp->m_approxResume)
+		return m_mtu;
+	uint64_t lineRate = m_nic[nic_idx].dev->GetDataRate().GetBitRate();
+	uint64_t guard = lineRate * qp->m_baseRtt * 1e-9 / 8 * m_approxGuard;
+	if (qp->snd_nxt < guard || left < guard + 2 * m_mtu)
+		return m_mtu;
+	// a segment lasts as long at any rate, so the congestion feedback is as frequent
+	uint64_t size = m_approxSegment * ((double)qp->m_rate.GetBitRate() / lineRate);
+	// whole MTUs that fit the IPv4 length and, if any, half the window
+	size = std::min<uint64_t>(size, left - guard);
+	size = std::min<uint64_t>(size, 0xffff - 20 - CustomHeader::GetUdpHeaderSize());
+	if (qp->m_win)
+		size = std::min<uint64_t>(size, qp->m_win / 2);
+	return std::max<uint64_t>(size / m_mtu, 1) * m_mtu;
+}
+
 Ptr<Packet> RdmaHw::GetNxtPacket(Ptr<RdmaQueuePair> qp) {
-	uint32_t payload_size = qp->GetBytesLeft();	//获取剩余流量大小
-	if (m_mtu < payload_size)
-		payload_size = m_mtu;
+	uint32_t nic_idx = GetNicIdxOfQp(qp);
+	uint32_t payload_size = GetPayloadSize(qp, nic_idx);
+	if (m_segmentDescriptors && !m_nic[nic_idx].dev->IsPacketTraced())
+		return GetNxtSegment(qp, nic_idx, payload_size);
 	Ptr<Packet> p = Create<Packet> (payload_size);
 	uint32_t sentBytes = qp->m_size - qp->GetBytesLeft();
-	uint32_t nic_idx = GetNicIdxOfQp(qp);
 	DataRate m_bps = m_nic[nic_idx].dev->GetDataRate();
 	double bdp = m_bps.GetBitRate() * 1 * qp->m_baseRtt * 1e-9 / 8;
 	UnSchedTag unschedtag;
@@ -581,8 +644,8 @@ Ptr<Packet> RdmaHw::GetNxtPacket(Ptr<RdmaQueuePair> qp) {
 		unschedtag.SetValue(0);
 	}
 	p->AddPacketTag(unschedtag);
-	// add SeqTsHeader
-	SeqTsHeader seqTs;
+	// add RdmaSeqHeader
+	RdmaSeqHeader seqTs;
 	seqTs.SetSeq (qp->snd_nxt);
 	seqTs.SetPG (qp->m_pg);
 	p->AddHeader (seqTs);
@@ -614,11 +677,45 @@ Ptr<Packet> RdmaHw::GetNxtPacket(Ptr<RdmaQueuePair> qp) {
 	return p;
 }
 
+// same frame as GetNxtPacket, but the headers stay parsed in RdmaSegmentPool
+Ptr<Packet> RdmaHw::GetNxtSegment(Ptr<RdmaQueuePair> qp, uint32_t nic_idx, uint32_t payload_size) {
+	uint32_t l4Size = CustomHeader::GetUdpHeaderSize();
+	Ptr<Packet> p = Create<Packet> (PppHeader().GetSerializedSize() + 20 + l4Size + payload_size);
+	uint32_t sentBytes = qp->m_size - qp->GetBytesLeft();
+	DataRate m_bps = m_nic[nic_idx].dev->GetDataRate();
+	double bdp = m_bps.GetBitRate() * 1 * qp->m_baseRtt * 1e-9 / 8;
+	UnSchedTag unschedtag;
+	unschedtag.SetValue(sentBytes <= bdp ? 1 : 0);
+	p->AddPacketTag(unschedtag);
+
+	CustomHeader &ch = RdmaSegmentPool::Get().Attach(p);
+	ch.getInt = 1;
+	ch.l2Size = PppHeader().GetSerializedSize();
+	ch.l3Size = 20;
+	ch.l4Size = l4Size;
+	ch.pppProto = 0x0021; // EtherToPpp(0x800)
+	ch.m_payloadSize = l4Size + payload_size;
+	ch.ipid = qp->m_ipid;
+	ch.m_tos = 0;
+	ch.m_ttl = 64;
+	ch.l3Prot = 0x11;
+	ch.sip = qp->sip.Get();
+	ch.dip = qp->dip.Get();
+	ch.udp.sport = qp->sport;
+	ch.udp.dport = qp->dport;
+	ch.udp.payload_size = l4Size + payload_size; // UDP length, as UdpHeader computes it
+	ch.udp.pg = qp->m_pg;
+	ch.udp.seq = qp->snd_nxt;
+	ch.udp.ih = IntHeader();
+
+	// update state
+	qp->snd_nxt += payload_size;
+	qp->m_ipid++;
+	return p;
+}
+
 void RdmaHw::PktSent(Ptr<RdmaQueuePair> qp, Ptr<Packet> pkt, Time interframeGap) {
 	qp->lastPktSize = pkt->GetSize();
-//	SeqTsHeader seqTs;
-//	pkt->PeekHeader(seqTs);
-	uint32_t seq = qp->snd_nxt;
 	qp->rates[qp->snd_nxt] = Simulator::Now().GetNanoSeconds();
 	UpdateNextAvail(qp, interframeGap, pkt->GetSize());
 
@@ -644,6 +741,8 @@ void RdmaHw::ChangeRate(Ptr<RdmaQueuePair> qp, DataRate new_rate) {
 #endif
 	// change to new rate
 	qp->m_rate = new_rate;
+	// the window and the next available time depend on the rate
+	m_nic[GetNicIdxOfQp(qp)].dev->m_rdmaEQ->UpdateQp(qp);
 }
 
 #define PRINT_LOG 0
@@ -667,7 +766,10 @@ void RdmaHw::UpdateAlphaMlx(Ptr<RdmaQueuePair> q) {
 	ScheduleUpdateAlphaMlx(q);
 }
 void RdmaHw::ScheduleUpdateAlphaMlx(Ptr<RdmaQueuePair> q) {
-	q->mlx.m_eventUpdateAlpha = Simulator::Schedule(MicroSeconds(m_alpha_resume_interval), &RdmaHw::UpdateAlphaMlx, this, q);
+	// the timers re-arm their own event rather than allocating a new one
+	q->mlx.m_eventUpdateAlpha = Simulator::Reschedule(q->mlx.m_eventUpdateAlpha, MicroSeconds(m_alpha_resume_interval));
+	if (q->mlx.m_eventUpdateAlpha.IsExpired())
+		q->mlx.m_eventUpdateAlpha = Simulator::Schedule(MicroSeconds(m_alpha_resume_interval), &RdmaHw::UpdateAlphaMlx, this, q);
 }
 
 void RdmaHw::cnp_received_mlx(Ptr<RdmaQueuePair> q) {
@@ -682,7 +784,7 @@ void RdmaHw::cnp_received_mlx(Ptr<RdmaQueuePair> q) {
 		// schedule rate decrease
 		ScheduleDecreaseRateMlx(q, 1); // add 1 ns to make sure rate decrease is after alpha update
 		// set rate on first CNP
-		q->mlx.m_targetRate = q->m_rate = m_rateOnFirstCNP * q->m_rate;
+		q->mlx.m_targetRate = q->m_rate = q->m_rate * m_rateOnFirstCNP;
 		q->mlx.m_first_cnp = false;
 	}
 }
@@ -704,19 +806,26 @@ void RdmaHw::CheckRateDecreaseMlx(Ptr<RdmaQueuePair> q) {
 		// reset rate increase related things
 		q->mlx.m_rpTimeStage = 0;
 		q->mlx.m_decrease_cnp_arrived = false;
-		Simulator::Cancel(q->mlx.m_rpTimer);
-		q->mlx.m_rpTimer = Simulator::Schedule(MicroSeconds(m_rpgTimeReset), &RdmaHw::RateIncEventTimerMlx, this, q);
+		// moved in the event list, rather than cancelled and scheduled again
+		q->mlx.m_rpTimer = Simulator::Reschedule(q->mlx.m_rpTimer, MicroSeconds(m_rpgTimeReset));
+		if (q->mlx.m_rpTimer.IsExpired())
+			q->mlx.m_rpTimer = Simulator::Schedule(MicroSeconds(m_rpgTimeReset), &RdmaHw::RateIncEventTimerMlx, this, q);
 #if PRINT_LOG
 		printf("(%.3lf %.3lf)\n", q->mlx.m_targetRate.GetBitRate() * 1e-9, q->m_rate.GetBitRate() * 1e-9);
 #endif
 	}
 }
 void RdmaHw::ScheduleDecreaseRateMlx(Ptr<RdmaQueuePair> q, uint32_t delta) {
-	q->mlx.m_eventDecreaseRate = Simulator::Schedule(MicroSeconds(m_rateDecreaseInterval) + NanoSeconds(delta), &RdmaHw::CheckRateDecreaseMlx, this, q);
+	Time delay = MicroSeconds(m_rateDecreaseInterval) + NanoSeconds(delta);
+	q->mlx.m_eventDecreaseRate = Simulator::Reschedule(q->mlx.m_eventDecreaseRate, delay);
+	if (q->mlx.m_eventDecreaseRate.IsExpired())
+		q->mlx.m_eventDecreaseRate = Simulator::Schedule(delay, &RdmaHw::CheckRateDecreaseMlx, this, q);
 }
 
 void RdmaHw::RateIncEventTimerMlx(Ptr<RdmaQueuePair> q) {
-	q->mlx.m_rpTimer = Simulator::Schedule(MicroSeconds(m_rpgTimeReset), &RdmaHw::RateIncEventTimerMlx, this, q);
+	q->mlx.m_rpTimer = Simulator::Reschedule(q->mlx.m_rpTimer, MicroSeconds(m_rpgTimeReset));
+	if (q->mlx.m_rpTimer.IsExpired())
+		q->mlx.m_rpTimer = Simulator::Schedule(MicroSeconds(m_rpgTimeReset), &RdmaHw::RateIncEventTimerMlx, this, q);
 	RateIncEventMlx(q);
 	q->mlx.m_rpTimeStage++;
 }
@@ -729,13 +838,15 @@ void RdmaHw::RateIncEventMlx(Ptr<RdmaQueuePair> q) {
 	} else { // hyper increase
 		HyperIncreaseMlx(q);
 	}
+	// a higher rate may open a variable window
+	m_nic[GetNicIdxOfQp(q)].dev->m_rdmaEQ->UpdateQp(q);
 }
 
 void RdmaHw::FastRecoveryMlx(Ptr<RdmaQueuePair> q) {
 #if PRINT_LOG
 	printf("%lu fast recovery: %08x %08x %u %u (%0.3lf %.3lf)->", Simulator::Now().GetTimeStep(), q->sip.Get(), q->dip.Get(), q->sport, q->dport, q->mlx.m_targetRate.GetBitRate() * 1e-9, q->m_rate.GetBitRate() * 1e-9);
 #endif
-	q->m_rate = (q->m_rate / 2) + (q->mlx.m_targetRate / 2);
+	q->m_rate = (q->m_rate * 0.5) + (q->mlx.m_targetRate * 0.5);
 #if PRINT_LOG
 	printf("(%.3lf %.3lf)\n", q->mlx.m_targetRate.GetBitRate() * 1e-9, q->m_rate.GetBitRate() * 1e-9);
 #endif
@@ -751,7 +862,7 @@ void RdmaHw::ActiveIncreaseMlx(Ptr<RdmaQueuePair> q) {
 	q->mlx.m_targetRate += m_rai;
 	if (q->mlx.m_targetRate > dev->GetDataRate())
 		q->mlx.m_targetRate = dev->GetDataRate();
-	q->m_rate = (q->m_rate / 2) + (q->mlx.m_targetRate / 2);
+	q->m_rate = (q->m_rate * 0.5) + (q->mlx.m_targetRate * 0.5);
 #if PRINT_LOG
 	printf("(%.3lf %.3lf)\n", q->mlx.m_targetRate.GetBitRate() * 1e-9, q->m_rate.GetBitRate() * 1e-9);
 #endif
@@ -767,7 +878,7 @@ void RdmaHw::HyperIncreaseMlx(Ptr<RdmaQueuePair> q) {
 	q->mlx.m_targetRate += m_rhai;
 	if (q->mlx.m_targetRate > dev->GetDataRate())
 		q->mlx.m_targetRate = dev->GetDataRate();
-	q->m_rate = (q->m_rate / 2) + (q->mlx.m_targetRate / 2);
+	q->m_rate = (q->m_rate * 0.5) + (q->mlx.m_targetRate * 0.5);
 #if PRINT_LOG
 	printf("(%.3lf %.3lf)\n", q->mlx.m_targetRate.GetBitRate() * 1e-9, q->m_rate.GetBitRate() * 1e-9);
 #endif
@@ -795,7 +906,9 @@ void RdmaHw::HandleAckHp(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader &ch)
 
 void RdmaHw::UpdateRateHp(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader &ch, bool fast_react) {
 	uint32_t next_seq = qp->snd_nxt;
+#if PRINT_LOG
 	bool print = !fast_react || true;
+#endif
 
 
 	if (qp->hp.m_lastUpdateSeq == 0) { // first RTT
@@ -819,7 +932,6 @@ void RdmaHw::UpdateRateHp(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader &ch
 		IntHeader &ih = ch.ack.ih;
 		if (ih.nhop <= IntHeader::maxHop) {
 			double max_c = 0;
-			bool inStable = false;
 #if PRINT_LOG
 			if (print)
 				printf("%lu %s %08x %08x %u %u [%u,%u,%u]", Simulator::Now().GetTimeStep(), fast_react ? "fast" : "update", qp->sip.Get(), qp->dip.Get(), qp->sport, qp->dport, qp->hp.m_lastUpdateSeq, ch.ack.seq, next_seq);
@@ -867,7 +979,7 @@ void RdmaHw::UpdateRateHp(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader &ch
 			}
 
 			DataRate new_rate;
-			int32_t new_incStage;
+			int32_t new_incStage = 0;
 			DataRate new_rate_per_hop[IntHeader::maxHop];
 			int32_t new_incStage_per_hop[IntHeader::maxHop];
 			if (!m_multipleRate) {
@@ -881,7 +993,7 @@ void RdmaHw::UpdateRateHp(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader &ch
 					max_c = qp->hp.u / m_targetUtil;
 
 					if (max_c >= 1 || qp->hp.m_incStage >= m_miThresh) {
-						new_rate = qp->hp.m_curRate / max_c + m_rai;
+						new_rate = DataRate(qp->hp.m_curRate.GetBitRate() / max_c) + m_rai;
 						new_incStage = 0;
 					}
 					else {
@@ -909,7 +1021,7 @@ void RdmaHw::UpdateRateHp(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader &ch
 					if (updated[i]) {
 						double c = qp->hp.hopState[i].u / m_targetUtil;
 						if (c >= 1 || qp->hp.hopState[i].incStage >= m_miThresh) {
-							new_rate_per_hop[i] = qp->hp.hopState[i].Rc / c + m_rai;
+							new_rate_per_hop[i] = DataRate(qp->hp.hopState[i].Rc.GetBitRate() / c) + m_rai;
 							new_incStage_per_hop[i] = 0;
 						} else {
 							new_rate_per_hop[i] = qp->hp.hopState[i].Rc + m_rai;
@@ -979,12 +1091,13 @@ void RdmaHw::FastReactHp(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader &ch)
 
 void RdmaHw::UpdateRatePower(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader &ch, bool fast_react) {
 	uint32_t next_seq = qp->snd_nxt;
+#if PRINT_LOG
 	bool print = !fast_react || true;
+#endif
 	double prevRtt = qp->m_baseRtt;
 	double prevCompletion = Simulator::Now().GetNanoSeconds();
 	std::map<uint32_t, double>::iterator it = qp->rates.find(ch.ack.seq);
 	DataRate old ;
-	double rtt;
 
 	if (it != qp->rates.end()) {
 		prevRtt = Simulator::Now().GetNanoSeconds() - it->second;
@@ -1008,18 +1121,17 @@ void RdmaHw::UpdateRatePower(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader
 		IntHeader &ih = ch.ack.ih;
 		if (ih.nhop <= IntHeader::maxHop) {
 			double max_c = 0;
-			bool inStable = false;
 			// check each hop
 			double U = 0;
 			uint64_t dt = 0;
-			bool updated[IntHeader::maxHop] = {false}, updated_any = false;
+			bool updated_any = false;
 			NS_ASSERT(ih.nhop <= IntHeader::maxHop);
 			for (uint32_t i = 0; i < ih.nhop; i++) {
 				if (m_sampleFeedback) {
 					if (ih.hop[i].GetQlen() == 0 and fast_react)
 						continue;
 				}
-				updated[i] = updated_any = true;
+				updated_any = true;
 
 				uint64_t tau = ih.hop[i].GetTimeDelta(qp->hp.hop[i]);
 				double duration = tau * 1e-9;
@@ -1056,9 +1168,7 @@ void RdmaHw::UpdateRatePower(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader
 			}
 
 			DataRate new_rate;
-			int32_t new_incStage;
-			DataRate new_rate_per_hop[IntHeader::maxHop];
-			int32_t new_incStage_per_hop[IntHeader::maxHop];
+			int32_t new_incStage = 0;
 
 			if (updated_any) {
 				if (dt > 1.0 * qp->m_baseRtt)
@@ -1070,12 +1180,12 @@ void RdmaHw::UpdateRatePower(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader
 				qp->hp.u = (qp->hp.u * (1.0 * qp->m_baseRtt - dt) + U * dt) / double(1.0 * qp->m_baseRtt);
 				if (!PowerTCPdelay) {
 					max_c = qp->hp.u / m_targetUtil;
-					new_rate = (0.9 * ( qp->hp.m_curRate / max_c + DataRate("150Mbps") ) + 0.1 * qp->hp.m_curRate);
+					new_rate = (DataRate(qp->hp.m_curRate.GetBitRate() / max_c) + DataRate("150Mbps")) * 0.9 + qp->hp.m_curRate * 0.1;
 
 				}
 				else {
 					max_c = qp->hp.u;
-					new_rate = (0.7 * ( qp->hp.m_curRate / max_c + DataRate("150Mbps") ) + 0.3 * qp->hp.m_curRate);
+					new_rate = (DataRate(qp->hp.m_curRate.GetBitRate() / max_c) + DataRate("150Mbps")) * 0.7 + qp->hp.m_curRate * 0.3;
 				}
 				if (new_rate < m_minRate)
 					new_rate = m_minRate;
@@ -1121,7 +1231,9 @@ void RdmaHw::HandleAckTimely(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader
 void RdmaHw::UpdateRateTimely(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader &ch, bool us) {
 	uint32_t next_seq = qp->snd_nxt;
 	uint64_t rtt = Simulator::Now().GetTimeStep() - ch.ack.ih.ts;
+#if PRINT_LOG
 	bool print = !us;
+#endif
 	if (qp->tmly.m_lastUpdateSeq != 0) { // not first RTT
 		int64_t new_rtt_diff = (int64_t)rtt - (int64_t)qp->tmly.lastRtt;
 		double rtt_diff = (1 - m_tmly_alpha) * qp->tmly.rttDiff + m_tmly_alpha * new_rtt_diff;
@@ -1247,7 +1359,7 @@ void RdmaHw::SetPintSmplThresh(double p) {
 }
 void RdmaHw::HandleAckHpPint(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader &ch) {
 	uint32_t ack_seq = ch.ack.seq;
-	if (rand() % 65536 >= pint_smpl_thresh)
+	if ((uint32_t)(rand() % 65536) >= pint_smpl_thresh)
 		return;
 	// update rate
 	if (ack_seq > qp->hpccPint.m_lastUpdateSeq) { // if full RTT feedback is ready, do full update
@@ -1271,7 +1383,7 @@ void RdmaHw::UpdateRateHpPint(Ptr<RdmaQueuePair> qp, Ptr<Packet> p, CustomHeader
 		double max_c = U / m_targetUtil;
 
 		if (max_c >= 1 || qp->hpccPint.m_incStage >= m_miThresh) {
-			new_rate = qp->hpccPint.m_curRate / max_c + m_rai;
+			new_rate = DataRate(qp->hpccPint.m_curRate.GetBitRate() / max_c) + m_rai;
 			new_incStage = 0;
 		} else {
 			new_rate = qp->hpccPint.m_curRate + m_rai;
@@ -5,6 +5,7 @@
 #include <ns3/rdma-queue-pair.h>
 #include <ns3/node.h>
 #include <ns3/custom-header.h>
+#include <ns3/traced-callback.h>
 #include "qbb-net-device.h"
 #include <unordered_map>
 #include "pint.h"
@@ -37,6 +38,9 @@ public:
 	bool m_backto0;
 	bool m_var_win, m_fast_react;
 	bool m_rateBound;
+	bool m_segmentDescriptors; // data segments carry their headers in RdmaSegmentPool
+	uint32_t m_approxSegment; // largest payload of a coalesced segment, message-level approximation if above m_mtu
+	double m_approxGuard; // head, tail and post rate decrease part sent packet by packet, in base RTTs
 	std::vector<RdmaInterfaceMgr> m_nic; // list of running nic controlled by this RdmaHw
 	std::unordered_map<uint64_t, Ptr<RdmaQueuePair> > m_qpMap; // mapping from uint64_t to qp
 	std::unordered_map<uint64_t, Ptr<RdmaRxQueuePair> > m_rxQpMap; // mapping from uint64_t to rx qp
@@ -46,6 +50,10 @@ public:
 	typedef Callback<void, Ptr<RdmaQueuePair> > QpCompleteCallback;
 	QpCompleteCallback m_qpCompleteCallback;
 
+	// data received in order by a rx qp: remote ip, remote port, local port, payload bytes
+	typedef void (*RxDataTracedCallback)(uint32_t sip, uint16_t sport, uint16_t dport, uint32_t bytes);
+	TracedCallback<uint32_t, uint16_t, uint16_t, uint32_t> m_traceRxData;
+
 	void SetNode(Ptr<Node> node);
 	void Setup(QpCompleteCallback cb); // setup shared data and callbacks with the QbbNetDevice
 	static uint64_t GetQpKey(uint32_t dip, uint16_t sport, uint16_t pg); // get the lookup key for m_qpMap
@@ -78,6 +86,8 @@ public:
 	void RedistributeQp();
 
 	Ptr<Packet> GetNxtPacket(Ptr<RdmaQueuePair> qp); // get next packet to send, inc snd_nxt
+	uint32_t GetPayloadSize(Ptr<RdmaQueuePair> qp, uint32_t nic_idx); // payload of the next data packet
+	Ptr<Packet> GetNxtSegment(Ptr<RdmaQueuePair> qp, uint32_t nic_idx, uint32_t payload_size); // GetNxtPacket with the headers in RdmaSegmentPool
 	void PktSent(Ptr<RdmaQueuePair> qp, Ptr<Packet> pkt, Time interframeGap);
 	void UpdateNextAvail(Ptr<RdmaQueuePair> qp, Time interframeGap, uint32_t pkt_size);
 	void ChangeRate(Ptr<RdmaQueuePair> qp, DataRate new_rate);
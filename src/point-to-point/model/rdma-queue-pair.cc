@@ -1,6 +1,5 @@
 #include <ns3/hash.h>
 #include <ns3/uinteger.h>
-#include <ns3/seq-ts-header.h>
 #include <ns3/udp-header.h>
 #include <ns3/ipv4-header.h>
 #include <ns3/simulator.h>
@@ -37,6 +36,12 @@ RdmaQueuePair::RdmaQueuePair(uint16_t pg, Ipv4Address _sip, Ipv4Address _dip, ui
 	m_var_win = false;
 	m_rate = 0;
 	m_nextAvail = Time(0);
+	m_approxResume = Time(0);
+	m_approxRate = 0;
+	sched.seq = 0;
+	sched.index = 0;
+	sched.state = 0;
+	sched.key = Time(0);
 	mlx.m_alpha = 1;
 	mlx.m_alpha_cnp_arrived = false;
 	mlx.m_first_cnp = true;
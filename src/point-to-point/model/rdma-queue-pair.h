@@ -28,6 +28,8 @@ public:
 	DataRate m_max_rate; // max rate
 	bool m_var_win; // variable window size
 	Time m_nextAvail;	//< Soonest time of next send
+	Time m_approxResume;	//< Coalesced segments are sent again from this time, see RdmaHw::GetPayloadSize
+	DataRate m_approxRate;	//< Rate at the last send, a decrease delays m_approxResume
 	uint32_t wp; // current window of packets
 	uint32_t lastPktSize;
 	Callback<void> m_notifyAppFinish;
@@ -104,6 +106,12 @@ public:
 		DataRate m_curRate;
 		uint32_t m_incStage;
 	}hpccPint;
+	struct {
+		uint64_t seq;	// round-robin position in the egress queue
+		uint32_t index;	// index in the queue pair group
+		uint8_t state;	// RdmaEgressQueue::QpState
+		Time key;	// m_nextAvail when rate limited
+	} sched;
 
 	/***********
 	 * methods
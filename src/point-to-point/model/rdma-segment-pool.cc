@@ -0,0 +1,124 @@
+#include "rdma-segment-pool.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+NS_LOG_COMPONENT_DEFINE("RdmaSegmentPool");
+
+namespace ns3 {
+
+RdmaSegmentPool &RdmaSegmentPool::Get(void) {
+	static thread_local RdmaSegmentPool pool;
+	return pool;
+}
+
+RdmaSegmentPool::RdmaSegmentPool()
+	: m_slots(1024, 0), m_mask(1023), m_n(0)
+{
+}
+
+uint32_t RdmaSegmentPool::Hash(uint64_t uid) {
+	// 64-bit finalizer of MurmurHash3, uids are consecutive
+	uid ^= uid >> 33;
+	uid *= 0xff51afd7ed558ccdULL;
+	uid ^= uid >> 33;
+	return (uint32_t)uid;
+}
+
+uint32_t RdmaSegmentPool::Lookup(uint64_t uid) const {
+	for (uint32_t i = Hash(uid) & m_mask;; i = (i + 1) & m_mask) {
+		uint32_t s = m_slots[i];
+		if (s == 0)
+			return NOT_FOUND;
+		if (m_segments[s - 1].uid == uid)
+			return i;
+	}
+}
+
+CustomHeader &RdmaSegmentPool::Attach(Ptr<const Packet> p) {
+	uint64_t uid = p->GetUid();
+	NS_ASSERT_MSG(Lookup(uid) == NOT_FOUND, "RdmaSegmentPool::Attach: packet already has a descriptor");
+	if ((m_n + 1) * 2 > m_slots.size())
+		Grow();
+	uint32_t idx;
+	if (m_free.empty()) {
+		m_segments.push_back(Segment());
+		idx = m_segments.size() - 1;
+	} else {
+		idx = m_free.back();
+		m_free.pop_back();
+		m_segments[idx].ch = CustomHeader();
+	}
+	m_segments[idx].uid = uid;
+	uint32_t i = Hash(uid) & m_mask;
+	while (m_slots[i] != 0)
+		i = (i + 1) & m_mask;
+	m_slots[i] = idx + 1;
+	m_n++;
+	return m_segments[idx].ch;
+}
+
+CustomHeader *RdmaSegmentPool::Find(Ptr<const Packet> p) {
+	if (m_n == 0)
+		return NULL;
+	uint32_t pos = Lookup(p->GetUid());
+	return pos == NOT_FOUND ? NULL : &m_segments[m_slots[pos] - 1].ch;
+}
+
+bool RdmaSegmentPool::Materialize(Ptr<Packet> p) {
+	if (m_n == 0)
+		return false;
+	uint32_t pos = Lookup(p->GetUid());
+	if (pos == NOT_FOUND)
+		return false;
+	NS_LOG_LOGIC("materialize segment " << p->GetUid());
+	CustomHeader &ch = m_segments[m_slots[pos] - 1].ch;
+	// the packet already has the size of the frame, replace the place holder by the headers
+	p->RemoveAtStart(ch.GetSerializedSize());
+	p->AddHeader(ch);
+	Erase(pos);
+	return true;
+}
+
+void RdmaSegmentPool::Release(Ptr<const Packet> p) {
+	if (m_n == 0)
+		return;
+	uint32_t pos = Lookup(p->GetUid());
+	if (pos != NOT_FOUND)
+		Erase(pos);
+}
+
+uint32_t RdmaSegmentPool::GetN(void) const {
+	return m_n;
+}
+
+void RdmaSegmentPool::Erase(uint32_t pos) {
+	m_free.push_back(m_slots[pos] - 1);
+	m_n--;
+	// shift back the following entries that cannot be found past the hole anymore
+	uint32_t hole = pos;
+	for (uint32_t i = (pos + 1) & m_mask; m_slots[i] != 0; i = (i + 1) & m_mask) {
+		uint32_t home = Hash(m_segments[m_slots[i] - 1].uid) & m_mask;
+		if (((i - home) & m_mask) >= ((i - hole) & m_mask)) {
+			m_slots[hole] = m_slots[i];
+			hole = i;
+		}
+	}
+	m_slots[hole] = 0;
+}
+
+void RdmaSegmentPool::Grow(void) {
+	std::vector<uint32_t> old;
+	old.swap(m_slots);
+	m_slots.assign(old.size() * 2, 0);
+	m_mask = m_slots.size() - 1;
+	for (uint32_t s : old) {
+		if (s == 0)
+			continue;
+		uint32_t i = Hash(m_segments[s - 1].uid) & m_mask;
+		while (m_slots[i] != 0)
+			i = (i + 1) & m_mask;
+		m_slots[i] = s;
+	}
+}
+
+} // namespace ns3
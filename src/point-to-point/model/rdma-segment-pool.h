@@ -0,0 +1,67 @@
+#ifndef RDMA_SEGMENT_POOL_H
+#define RDMA_SEGMENT_POOL_H
+
+#include "ns3/packet.h"
+#include "ns3/custom-header.h"
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup point-to-point
+ * \brief Parsed headers of the RDMA data segments that carry no header bytes.
+ *
+ * With RdmaHw::SegmentDescriptors, GetNxtPacket creates a data segment as
+ * a zero-filled packet of the full frame size and keeps its PPP, IPv4, UDP,
+ * sequence and INT headers here as a CustomHeader, keyed by the packet uid.
+ * The devices, the switch and RdmaHw read and update that descriptor instead
+ * of deserializing and serializing the headers at every hop. A segment is
+ * materialized, i.e. its headers are written into the packet, as soon as a
+ * trace source or a remote rank needs the bytes; the descriptor is released
+ * when the segment is materialized, consumed or dropped.
+ *
+ * Descriptors are stored densely and reused; the uid index is an
+ * open-addressed table with backward shift deletion. One pool per thread:
+ * a segment never leaves the thread of its node without being materialized.
+ */
+class RdmaSegmentPool {
+public:
+	static const uint32_t NOT_FOUND = 0xffffffff;
+
+	static RdmaSegmentPool &Get(void);
+
+	RdmaSegmentPool();
+
+	// a fresh descriptor for the packet, which must not have one yet
+	CustomHeader &Attach(Ptr<const Packet> p);
+	// the descriptor of the packet, NULL if its headers are in the packet
+	CustomHeader *Find(Ptr<const Packet> p);
+	// write the headers into the packet and release the descriptor, return false if there is none
+	bool Materialize(Ptr<Packet> p);
+	// forget the descriptor of a consumed or dropped packet, if any
+	void Release(Ptr<const Packet> p);
+	// number of live descriptors
+	uint32_t GetN(void) const;
+
+private:
+	struct Segment {
+		uint64_t uid;
+		CustomHeader ch;
+	};
+
+	static uint32_t Hash(uint64_t uid);
+	uint32_t Lookup(uint64_t uid) const; // position in m_slots, or NOT_FOUND
+	void Erase(uint32_t pos);
+	void Grow(void);
+
+	std::vector<uint32_t> m_slots; // index + 1 into m_segments, 0 means empty
+	std::vector<Segment> m_segments;
+	std::vector<uint32_t> m_free; // unused entries of m_segments
+	uint32_t m_mask;
+	uint32_t m_n;
+};
+
+} // namespace ns3
+
+#endif /* RDMA_SEGMENT_POOL_H */
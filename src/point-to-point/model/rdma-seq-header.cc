@@ -0,0 +1,88 @@
+#include <stdint.h>
+#include <iostream>
+#include "rdma-seq-header.h"
+#include "ns3/log.h"
+
+NS_LOG_COMPONENT_DEFINE("RdmaSeqHeader");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED(RdmaSeqHeader);
+
+RdmaSeqHeader::RdmaSeqHeader()
+	: m_seq(0), m_pg(0)
+{
+}
+
+RdmaSeqHeader::~RdmaSeqHeader()
+{
+}
+
+void RdmaSeqHeader::SetSeq(uint32_t seq) {
+	m_seq = seq;
+}
+
+void RdmaSeqHeader::SetPG(uint16_t pg) {
+	m_pg = pg;
+}
+
+uint32_t RdmaSeqHeader::GetSeq(void) const {
+	return m_seq;
+}
+
+uint16_t RdmaSeqHeader::GetPG(void) const {
+	return m_pg;
+}
+
+IntHeader &RdmaSeqHeader::GetIntHeader(void) {
+	return ih;
+}
+
+TypeId RdmaSeqHeader::GetTypeId(void)
+{
+	static TypeId tid = TypeId("ns3::RdmaSeqHeader")
+		.SetParent<Header>()
+		.AddConstructor<RdmaSeqHeader>()
+		;
+	return tid;
+}
+
+TypeId RdmaSeqHeader::GetInstanceTypeId(void) const
+{
+	return GetTypeId();
+}
+
+void RdmaSeqHeader::Print(std::ostream &os) const
+{
+	os << "seq=" << m_seq << ",pg=" << m_pg;
+}
+
+uint32_t RdmaSeqHeader::GetSerializedSize(void) const
+{
+	return GetBaseSize() + IntHeader::GetStaticSize();
+}
+
+uint32_t RdmaSeqHeader::GetBaseSize() {
+	return sizeof(uint32_t) + sizeof(uint16_t);
+}
+
+void RdmaSeqHeader::Serialize(Buffer::Iterator start) const
+{
+	Buffer::Iterator i = start;
+	i.WriteHtonU32(m_seq);
+	i.WriteHtonU16(m_pg);
+	// write IntHeader
+	ih.Serialize(i);
+}
+
+uint32_t RdmaSeqHeader::Deserialize(Buffer::Iterator start)
+{
+	Buffer::Iterator i = start;
+	m_seq = i.ReadNtohU32();
+	m_pg = i.ReadNtohU16();
+	// read IntHeader
+	ih.Deserialize(i);
+	return GetSerializedSize();
+}
+
+} // namespace ns3
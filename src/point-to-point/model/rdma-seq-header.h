@@ -0,0 +1,47 @@
+#ifndef RDMA_SEQ_HEADER_H
+#define RDMA_SEQ_HEADER_H
+
+#include <stdint.h>
+#include "ns3/header.h"
+#include "ns3/buffer.h"
+#include "ns3/int-header.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup point-to-point
+ * \brief Header of the RDMA data segments, placed right after the UDP header
+ *
+ * It carries the byte sequence number of the segment, the priority group of
+ * its queue pair and the INT stack the switches fill on the way. The layout
+ * is the one CustomHeader parses for UDP packets.
+ */
+class RdmaSeqHeader : public Header
+{
+public:
+  RdmaSeqHeader ();
+  virtual ~RdmaSeqHeader ();
+
+  void SetSeq (uint32_t seq);
+  void SetPG (uint16_t pg);
+  uint32_t GetSeq (void) const;
+  uint16_t GetPG (void) const;
+  IntHeader &GetIntHeader (void);
+
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual void Print (std::ostream &os) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+  static uint32_t GetBaseSize (); // size without INT
+
+private:
+  uint32_t m_seq;
+  uint16_t m_pg;
+  IntHeader ih;
+};
+
+} // namespace ns3
+
+#endif /* RDMA_SEQ_HEADER_H */
@@ -0,0 +1,162 @@
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+#include "ns3/simulator.h"
+#include "ns3/log.h"
+#include "switch-mmu.h"
+
+NS_LOG_COMPONENT_DEFINE("SwitchMmu");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED(SwitchMmu);
+
+TypeId SwitchMmu::GetTypeId(void) {
+	static TypeId tid = TypeId("ns3::SwitchMmu")
+		.SetParent<Object>()
+		.AddConstructor<SwitchMmu>()
+		;
+	return tid;
+}
+
+SwitchMmu::SwitchMmu(void) {
+	node_id = 0;
+	buffer_size = 12 * 1024 * 1024;
+	reserve = 4 * 1024;
+	resume_offset = 3 * 1024;
+	total_hdrm = 0;
+	total_rsrv = 0;
+	ecn_unit = 0;
+
+	// headroom
+	shared_used_bytes = 0;
+	memset(pfc_a_shift, 0, sizeof(pfc_a_shift));
+	memset(headroom, 0, sizeof(headroom));
+	memset(kmin, 0, sizeof(kmin));
+	memset(kmax, 0, sizeof(kmax));
+	memset(pmax, 0, sizeof(pmax));
+	memset(hdrm_bytes, 0, sizeof(hdrm_bytes));
+	memset(ingress_bytes, 0, sizeof(ingress_bytes));
+	memset(paused, 0, sizeof(paused));
+	memset(egress_bytes, 0, sizeof(egress_bytes));
+
+	m_uniform = CreateObject<UniformRandomVariable>();
+}
+
+bool SwitchMmu::CheckIngressAdmission(uint32_t port, uint32_t qIndex, uint32_t psize) {
+	if (psize + hdrm_bytes[port][qIndex] > headroom[port] && psize + GetSharedUsed(port, qIndex) > GetPfcThreshold(port)) {
+		NS_LOG_WARN(Simulator::Now().GetTimeStep() << " " << node_id << " Drop: queue:" << port << "," << qIndex << ": Headroom full");
+		return false;
+	}
+	return true;
+}
+
+bool SwitchMmu::CheckEgressAdmission(uint32_t port, uint32_t qIndex, uint32_t psize) {
+	return true;
+}
+
+void SwitchMmu::UpdateIngressAdmission(uint32_t port, uint32_t qIndex, uint32_t psize) {
+	uint32_t new_bytes = ingress_bytes[port][qIndex] + psize;
+	if (new_bytes <= reserve) {
+		ingress_bytes[port][qIndex] += psize;
+	} else {
+		uint32_t thresh = GetPfcThreshold(port);
+		if (new_bytes - reserve > thresh) {
+			hdrm_bytes[port][qIndex] += psize;
+		} else {
+			ingress_bytes[port][qIndex] += psize;
+			shared_used_bytes += std::min(psize, new_bytes - reserve);
+		}
+	}
+}
+
+void SwitchMmu::UpdateEgressAdmission(uint32_t port, uint32_t qIndex, uint32_t psize) {
+	egress_bytes[port][qIndex] += psize;
+}
+
+void SwitchMmu::RemoveFromIngressAdmission(uint32_t port, uint32_t qIndex, uint32_t psize) {
+	uint32_t from_hdrm = std::min(hdrm_bytes[port][qIndex], psize);
+	uint32_t from_shared = std::min(psize - from_hdrm, ingress_bytes[port][qIndex] > reserve ? ingress_bytes[port][qIndex] - reserve : 0);
+	hdrm_bytes[port][qIndex] -= from_hdrm;
+	ingress_bytes[port][qIndex] -= psize - from_hdrm;
+	shared_used_bytes -= from_shared;
+}
+
+void SwitchMmu::RemoveFromEgressAdmission(uint32_t port, uint32_t qIndex, uint32_t psize) {
+	egress_bytes[port][qIndex] -= psize;
+}
+
+bool SwitchMmu::CheckShouldPause(uint32_t port, uint32_t qIndex) {
+	return !paused[port][qIndex] && (hdrm_bytes[port][qIndex] > 0 || GetSharedUsed(port, qIndex) >= GetPfcThreshold(port));
+}
+
+bool SwitchMmu::CheckShouldResume(uint32_t port, uint32_t qIndex) {
+	if (!paused[port][qIndex])
+		return false;
+	uint32_t shared_used = GetSharedUsed(port, qIndex);
+	return hdrm_bytes[port][qIndex] == 0 && (shared_used == 0 || shared_used + resume_offset <= GetPfcThreshold(port));
+}
+
+void SwitchMmu::SetPause(uint32_t port, uint32_t qIndex) {
+	paused[port][qIndex] = true;
+}
+
+void SwitchMmu::SetResume(uint32_t port, uint32_t qIndex) {
+	paused[port][qIndex] = false;
+}
+
+uint32_t SwitchMmu::GetPfcThreshold(uint32_t port) {
+	return (buffer_size - total_hdrm - total_rsrv - shared_used_bytes) >> pfc_a_shift[port];
+}
+
+uint32_t SwitchMmu::GetSharedUsed(uint32_t port, uint32_t qIndex) {
+	uint32_t used = ingress_bytes[port][qIndex];
+	return used > reserve ? used - reserve : 0;
+}
+
+bool SwitchMmu::ShouldSendCN(uint32_t ifindex, uint32_t qIndex, uint32_t psize) {
+	if (qIndex == 0)
+		return false;
+	if (egress_bytes[ifindex][qIndex] > kmax[ifindex])
+		return true;
+	if (egress_bytes[ifindex][qIndex] > kmin[ifindex]) {
+		double p = pmax[ifindex] * double(egress_bytes[ifindex][qIndex] - kmin[ifindex]) / (kmax[ifindex] - kmin[ifindex]);
+		// a coalesced segment is marked if any of the packets it stands for would be
+		if (ecn_unit > 0 && psize > ecn_unit)
+			p = 1 - pow(1 - p, double(psize) / ecn_unit);
+		if (m_uniform->GetValue(0, 1) < p)
+			return true;
+	}
+	return false;
+}
+
+// kmin and kmax are given in KB
+void SwitchMmu::ConfigEcn(uint32_t port, uint32_t _kmin, uint32_t _kmax, double _pmax) {
+	kmin[port] = _kmin * 1000;
+	kmax[port] = _kmax * 1000;
+	pmax[port] = _pmax;
+}
+
+void SwitchMmu::ConfigEcnUnit(uint32_t size) {
+	ecn_unit = size;
+}
+
+void SwitchMmu::ConfigHdrm(uint32_t port, uint32_t size) {
+	headroom[port] = size;
+}
+
+// must be called after the headroom of every port is configured
+void SwitchMmu::ConfigNPort(uint32_t n_port) {
+	total_hdrm = 0;
+	total_rsrv = 0;
+	for (uint32_t i = 1; i <= n_port; i++) {
+		total_hdrm += headroom[i];
+		total_rsrv += reserve;
+	}
+}
+
+void SwitchMmu::ConfigBufferSize(uint32_t size) {
+	buffer_size = size;
+}
+
+} // namespace ns3
@@ -0,0 +1,80 @@
+#ifndef SWITCH_MMU_H
+#define SWITCH_MMU_H
+
+#include <ns3/node.h>
+#include <ns3/random-variable-stream.h>
+
+namespace ns3 {
+
+class Packet;
+
+/**
+ * \ingroup point-to-point
+ * \brief Shared buffer memory management unit of a switch
+ *
+ * Every ingress (port, priority) owns a small reserved buffer; beyond that
+ * it draws from the shared pool up to a dynamic threshold, and then from
+ * its PFC headroom. A queue whose shared usage reaches the threshold or
+ * which uses headroom is paused, and resumed once it drained below the
+ * threshold by resume_offset. Egress bytes drive the RED-like ECN marking.
+ */
+class SwitchMmu: public Object {
+public:
+	static const uint32_t pCnt = 257;	// Number of ports used
+	static const uint32_t qCnt = 8;	// Number of queues/priorities used
+
+	static TypeId GetTypeId (void);
+
+	SwitchMmu(void);
+
+	bool CheckIngressAdmission(uint32_t port, uint32_t qIndex, uint32_t psize);
+	bool CheckEgressAdmission(uint32_t port, uint32_t qIndex, uint32_t psize);
+	void UpdateIngressAdmission(uint32_t port, uint32_t qIndex, uint32_t psize);
+	void UpdateEgressAdmission(uint32_t port, uint32_t qIndex, uint32_t psize);
+	void RemoveFromIngressAdmission(uint32_t port, uint32_t qIndex, uint32_t psize);
+	void RemoveFromEgressAdmission(uint32_t port, uint32_t qIndex, uint32_t psize);
+
+	bool CheckShouldPause(uint32_t port, uint32_t qIndex);
+	bool CheckShouldResume(uint32_t port, uint32_t qIndex);
+	void SetPause(uint32_t port, uint32_t qIndex);
+	void SetResume(uint32_t port, uint32_t qIndex);
+
+	uint32_t GetPfcThreshold(uint32_t port);
+	uint32_t GetSharedUsed(uint32_t port, uint32_t qIndex);
+
+	// psize larger than the ECN unit counts as that many packets
+	bool ShouldSendCN(uint32_t ifindex, uint32_t qIndex, uint32_t psize = 0);
+
+	void ConfigEcn(uint32_t port, uint32_t _kmin, uint32_t _kmax, double _pmax);
+	void ConfigHdrm(uint32_t port, uint32_t size);
+	void ConfigNPort(uint32_t n_port);
+	void ConfigBufferSize(uint32_t size);
+	void ConfigEcnUnit(uint32_t size);
+
+	// config
+	uint32_t node_id;
+	uint32_t buffer_size;
+	uint32_t pfc_a_shift[pCnt];
+	uint32_t reserve;
+	uint32_t headroom[pCnt];
+	uint32_t resume_offset;
+	uint32_t kmin[pCnt], kmax[pCnt];
+	double pmax[pCnt];
+	uint32_t ecn_unit; // frame size of a packet for the marking of coalesced segments, 0 to mark per frame
+	uint32_t total_hdrm;
+	uint32_t total_rsrv;
+
+	// runtime
+	uint32_t shared_used_bytes;
+	uint32_t hdrm_bytes[pCnt][qCnt];
+	uint32_t ingress_bytes[pCnt][qCnt];
+	uint32_t paused[pCnt][qCnt];
+	uint32_t egress_bytes[pCnt][qCnt];
+
+private:
+	Ptr<UniformRandomVariable> m_uniform; // ECN marking decision
+};
+
+} /* namespace ns3 */
+
+#endif /* SWITCH_MMU_H */
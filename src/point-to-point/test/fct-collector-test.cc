@@ -0,0 +1,198 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/config.h"
+#include "ns3/fct-collector.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/test.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \brief Test the accuracy and the merge of the quantile sketch
+ */
+class QuantileSketchTest : public TestCase
+{
+  public:
+    QuantileSketchTest();
+
+  private:
+    void DoRun() override;
+};
+
+QuantileSketchTest::QuantileSketchTest()
+    : TestCase("Sketch quantiles stay within the relative accuracy and merge exactly")
+{
+}
+
+void
+QuantileSketchTest::DoRun()
+{
+    const double alpha = 0.01;
+    QuantileSketch all(alpha);
+    QuantileSketch even(alpha);
+    QuantileSketch odd(alpha);
+    std::vector<double> values;
+    for (uint32_t i = 0; i < 20000; i++)
+    {
+        // a heavy tailed stream between 1 and about 1000
+        double u = i * 0.618034 - std::floor(i * 0.618034);
+        double v = 1 / (1 - u * 0.999);
+        values.push_back(v);
+        all.Add(v);
+        (i % 2 ? odd : even).Add(v);
+    }
+    std::sort(values.begin(), values.end());
+    for (double q : {0.0, 0.5, 0.9, 0.99, 0.999, 1.0})
+    {
+        double exact = values[static_cast<uint32_t>(q * (values.size() - 1))];
+        double error = std::fabs(all.GetQuantile(q) - exact) / exact;
+        NS_TEST_ASSERT_MSG_LT_OR_EQ(error, alpha * 1.0001, "quantile " << q << " too far");
+    }
+    NS_TEST_ASSERT_MSG_EQ(all.GetCount(), values.size(), "wrong count");
+
+    even.Merge(odd);
+    NS_TEST_ASSERT_MSG_EQ(even.GetCount(), all.GetCount(), "wrong merged count");
+    NS_TEST_ASSERT_MSG_EQ((even.GetBins() == all.GetBins()), true, "merge is not exact");
+    NS_TEST_ASSERT_MSG_EQ_TOL(even.GetSum(), all.GetSum(), 1e-6, "wrong merged sum");
+
+    QuantileSketch copy(alpha);
+    copy.SetBins(all.GetBins(), all.GetSum());
+    NS_TEST_ASSERT_MSG_EQ(copy.GetCount(), all.GetCount(), "wrong count after SetBins");
+    NS_TEST_ASSERT_MSG_EQ(copy.GetQuantile(0.99),
+                          all.GetQuantile(0.99),
+                          "wrong p99 after SetBins");
+
+    QuantileSketch empty(alpha);
+    NS_TEST_ASSERT_MSG_EQ(empty.GetQuantile(0.5), 0, "empty sketch has a quantile");
+}
+
+/**
+ * \brief Test the buffering, the size buckets and the report of the collector
+ */
+class FctCollectorTest : public TestCase
+{
+  public:
+    FctCollectorTest();
+
+  private:
+    void DoRun() override;
+};
+
+FctCollectorTest::FctCollectorTest()
+    : TestCase("Record flows into size buckets and report their slowdown")
+{
+}
+
+void
+FctCollectorTest::DoRun()
+{
+    NS_TEST_ASSERT_MSG_EQ(FctCollector::IsEnabled(), false, "collector exists too early");
+    std::string fileName = CreateTempDirFilename("fct_summary.txt");
+    Config::SetDefault("ns3::FctCollector::FileName", StringValue(fileName));
+    Config::SetDefault("ns3::FctCollector::SizeBuckets", StringValue("1000,100000"));
+    Config::SetDefault("ns3::FctCollector::Capacity", UintegerValue(7));
+    Ptr<FctCollector> c = FctCollector::Get();
+    NS_TEST_ASSERT_MSG_EQ(FctCollector::IsEnabled(), true, "collector not enabled");
+
+    // 100 small flows of slowdown 1 to 100, 10 medium flows of slowdown 2
+    for (uint32_t i = 1; i <= 100; i++)
+    {
+        c->Record(1000, 1000 + 500 * i, 1000, 500);
+    }
+    // the medium flows are recorded by another thread, into its own buffer
+    std::thread thread([c]() {
+        for (uint32_t i = 0; i < 10; i++)
+        {
+            c->Record(0, 20000, 50000, 10000);
+        }
+    });
+    thread.join();
+
+    // a UDP flow of 3000 bytes, recorded by the sink trace once complete
+    Ipv4Address src("10.0.0.1");
+    Ipv4Address dst("10.0.1.1");
+    c->ExpectFlow(src, dst, 9, 3000, NanoSeconds(0), NanoSeconds(1000));
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        FctCollector::SinkRx(Create<Packet>(1000),
+                             InetSocketAddress(src, 49153),
+                             InetSocketAddress(dst, 9));
+    }
+    // not expected, ignored
+    FctCollector::SinkRx(Create<Packet>(1000),
+                         InetSocketAddress(src, 49153),
+                         InetSocketAddress(dst, 10));
+
+    std::vector<FctCollector::Bucket> buckets = c->Merge();
+    NS_TEST_ASSERT_MSG_EQ(buckets.size(), 3, "wrong number of buckets");
+    NS_TEST_ASSERT_MSG_EQ(buckets[0].maxSize, 1000, "wrong first bucket");
+    NS_TEST_ASSERT_MSG_EQ(buckets[2].maxSize, 0, "wrong last bucket");
+    NS_TEST_ASSERT_MSG_EQ(buckets[0].slowdown.GetCount(), 100, "wrong small flows");
+    NS_TEST_ASSERT_MSG_EQ(buckets[1].slowdown.GetCount(), 11, "wrong medium flows");
+    NS_TEST_ASSERT_MSG_EQ(buckets[2].slowdown.GetCount(), 0, "wrong large flows");
+    NS_TEST_ASSERT_MSG_EQ_TOL(buckets[0].slowdown.GetQuantile(0.5), 50, 0.5, "wrong p50");
+    NS_TEST_ASSERT_MSG_EQ_TOL(buckets[0].slowdown.GetQuantile(0.99), 99, 1, "wrong p99");
+    NS_TEST_ASSERT_MSG_EQ_TOL(buckets[0].slowdown.GetSum() / 100, 50.5, 1e-9, "wrong mean");
+    NS_TEST_ASSERT_MSG_EQ_TOL(buckets[1].fctSum, 10 * 20000.0, 1e-9, "wrong FCT sum");
+
+    c->Report();
+    std::ifstream file(fileName);
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        lines.push_back(line);
+    }
+    NS_TEST_ASSERT_MSG_EQ(lines.size(), 3, "wrong report length");
+    NS_TEST_ASSERT_MSG_EQ(lines[1].substr(0, 24), "0 1000 100 25250 50.500 ", "wrong first line");
+    NS_TEST_ASSERT_MSG_EQ(lines[2].substr(0, 21), "1001 100000 11 18182 ", "wrong second line");
+
+    NS_TEST_ASSERT_MSG_EQ(FctCollector::GetIdealFct(1250, DataRate("1Gbps"), MicroSeconds(2)),
+                          NanoSeconds(12000),
+                          "wrong ideal FCT");
+
+    Simulator::Destroy();
+    NS_TEST_ASSERT_MSG_EQ(FctCollector::IsEnabled(), false, "collector survives Destroy");
+    Config::Reset();
+}
+
+/**
+ * \brief TestSuite for the flow completion time collector
+ */
+class FctCollectorTestSuite : public TestSuite
+{
+  public:
+    FctCollectorTestSuite();
+};
+
+FctCollectorTestSuite::FctCollectorTestSuite()
+    : TestSuite("point-to-point-fct-collector", UNIT)
+{
+    AddTestCase(new QuantileSketchTest, TestCase::QUICK);
+    AddTestCase(new FctCollectorTest, TestCase::QUICK);
+}
+
+static FctCollectorTestSuite g_fctCollectorTestSuite; //!< The testsuite
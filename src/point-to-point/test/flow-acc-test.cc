@@ -0,0 +1,214 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/config.h"
+#include "ns3/flow-acc.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/test.h"
+
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \brief Test the open-addressed flow statistics table
+ */
+class FlowStatsTableTest : public TestCase
+{
+  public:
+    FlowStatsTableTest();
+
+  private:
+    void DoRun() override;
+};
+
+FlowStatsTableTest::FlowStatsTableTest()
+    : TestCase("Insert and find flows across table growth")
+{
+}
+
+void
+FlowStatsTableTest::DoRun()
+{
+    FlowStatsTable table;
+    const uint32_t n = 5000;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        uint64_t key = FlowStatsTable::MakeKey(i % 128, (i * 7) % 128, i, i + 1);
+        NS_TEST_ASSERT_MSG_EQ(table.Find(key), FlowStatsTable::NOT_FOUND, "flow found too early");
+        NS_TEST_ASSERT_MSG_EQ(table.Insert(FlowStat(key, i, 0)), i, "unexpected record index");
+    }
+    NS_TEST_ASSERT_MSG_EQ(table.GetN(), n, "wrong number of flows");
+    for (uint32_t i = 0; i < n; i++)
+    {
+        uint64_t key = FlowStatsTable::MakeKey(i % 128, (i * 7) % 128, i, i + 1);
+        uint32_t idx = table.Find(key);
+        NS_TEST_ASSERT_MSG_EQ(idx, i, "flow lost after growth");
+        NS_TEST_ASSERT_MSG_EQ(table.Get(idx).byteCount, i, "wrong record");
+    }
+    NS_TEST_ASSERT_MSG_EQ(FlowStatsTable::KeyToString(FlowStatsTable::MakeKey(1, 2, 100, 200)),
+                          "1-2-100-200",
+                          "wrong flow id");
+}
+
+/**
+ * \brief Test rate reporting and steady state detection of the monitor
+ *
+ * One flow receives 1000 bytes every microsecond. Its first period also
+ * counts the seeding packet, every later one reports 8 Gbps, so the system
+ * enters steady state at the tenth report.
+ */
+class FlowStatsMonitorTest : public TestCase
+{
+  public:
+    FlowStatsMonitorTest();
+
+  private:
+    void DoRun() override;
+    void Receive(uint64_t key);
+
+    FlowStatsTable m_table;                     //!< table of the simulated device
+    std::vector<uint64_t> m_enterTimes;         //!< steady state entry times (ns)
+};
+
+FlowStatsMonitorTest::FlowStatsMonitorTest()
+    : TestCase("Buffered rate and steady state report")
+{
+}
+
+void
+FlowStatsMonitorTest::Receive(uint64_t key)
+{
+    if (FlowStatsMonitor::Get()->Record(m_table, key, 1000) == FlowStatsMonitor::STEADY_ENTER)
+    {
+        m_enterTimes.push_back(Simulator::Now().GetNanoSeconds());
+    }
+}
+
+void
+FlowStatsMonitorTest::DoRun()
+{
+    std::string fileName = CreateTempDirFilename("flow_stats.txt");
+    Config::SetDefault("ns3::FlowStatsMonitor::FileName", StringValue(fileName));
+
+    uint64_t key = FlowStatsTable::MakeKey(1, 2, 100, 200);
+    for (uint32_t i = 0; i <= 120; i++)
+    {
+        Simulator::Schedule(NanoSeconds(1000 * i), &FlowStatsMonitorTest::Receive, this, key);
+    }
+    Simulator::Run();
+    // the buffered report does not keep the simulation running
+    NS_TEST_ASSERT_MSG_EQ(Simulator::Now(), MicroSeconds(120), "report scheduled an event");
+    FlowStatsMonitor::Get()->Unregister(&m_table);
+    Simulator::Destroy();
+
+    NS_TEST_ASSERT_MSG_EQ(m_enterTimes.size(), 1, "steady state entered once");
+    NS_TEST_ASSERT_MSG_EQ(m_enterTimes[0], 100000, "wrong steady state entry time");
+
+    std::ifstream in(fileName);
+    NS_TEST_ASSERT_MSG_EQ(in.is_open(), true, "report not written");
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(in, line))
+    {
+        lines.push_back(line);
+    }
+    NS_TEST_ASSERT_MSG_GT(lines.size(), 10, "report too short");
+    NS_TEST_ASSERT_MSG_EQ(lines[0],
+                          "Flow ID: 1-2-100-200 - Rate: 8.8 Gbps currentTime: 10000",
+                          "wrong first report");
+    NS_TEST_ASSERT_MSG_EQ(lines[1],
+                          "Flow ID: 1-2-100-200 - Rate: 8 Gbps currentTime: 20000",
+                          "wrong second report");
+    NS_TEST_ASSERT_MSG_EQ(lines[10],
+                          "System entered steady state at time: 100000 ns",
+                          "wrong steady state report");
+}
+
+/**
+ * \brief Test the monitors of two threads
+ *
+ * Another thread gets its own monitor, whose lines end in the file of the
+ * monitor of the main thread at Simulator::Destroy.
+ */
+class FlowStatsMonitorThreadTest : public TestCase
+{
+  public:
+    FlowStatsMonitorThreadTest();
+
+  private:
+    void DoRun() override;
+};
+
+FlowStatsMonitorThreadTest::FlowStatsMonitorThreadTest()
+    : TestCase("One monitor per thread, merged at Destroy")
+{
+}
+
+void
+FlowStatsMonitorThreadTest::DoRun()
+{
+    std::string fileName = CreateTempDirFilename("flow_stats_threads.txt");
+    Config::SetDefault("ns3::FlowStatsMonitor::FileName", StringValue(fileName));
+    Config::SetDefault("ns3::FlowStatsMonitor::FlushInterval", TimeValue(Time(0)));
+
+    Ptr<FlowStatsMonitor> monitor = FlowStatsMonitor::Get();
+    NS_TEST_ASSERT_MSG_EQ(FlowStatsMonitor::Get(), monitor, "new monitor for the same thread");
+    Ptr<FlowStatsMonitor> other;
+    std::thread thread([&other]() {
+        other = FlowStatsMonitor::Get();
+        other->ReportMinTime(2);
+    });
+    thread.join();
+    NS_TEST_ASSERT_MSG_NE(other, monitor, "monitor shared by two threads");
+    monitor->ReportMinTime(1);
+    Simulator::Destroy();
+    Config::Reset();
+
+    std::ifstream in(fileName);
+    NS_TEST_ASSERT_MSG_EQ(in.is_open(), true, "report not written");
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(in, line))
+    {
+        lines.push_back(line);
+    }
+    NS_TEST_ASSERT_MSG_EQ(lines.size(), 2, "lines of a thread lost");
+    NS_TEST_ASSERT_MSG_EQ(lines[0], "最小流完成时间: 2.000000", "wrong line of the other thread");
+    NS_TEST_ASSERT_MSG_EQ(lines[1], "最小流完成时间: 1.000000", "wrong line of the main thread");
+}
+
+/**
+ * \brief TestSuite for the receiver flow statistics
+ */
+class FlowStatsTestSuite : public TestSuite
+{
+  public:
+    FlowStatsTestSuite();
+};
+
+FlowStatsTestSuite::FlowStatsTestSuite()
+    : TestSuite("point-to-point-flow-stats", UNIT)
+{
+    AddTestCase(new FlowStatsTableTest, TestCase::QUICK);
+    AddTestCase(new FlowStatsMonitorTest, TestCase::QUICK);
+    AddTestCase(new FlowStatsMonitorThreadTest, TestCase::QUICK);
+}
+
+static FlowStatsTestSuite g_flowStatsTestSuite; //!< The testsuite
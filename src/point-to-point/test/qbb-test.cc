@@ -0,0 +1,573 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/boolean.h"
+#include "ns3/broadcom-egress-queue.h"
+#include "ns3/cn-header.h"
+#include "ns3/custom-header.h"
+#include "ns3/int-header.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/packet.h"
+#include "ns3/pause-header.h"
+#include "ns3/ppp-header.h"
+#include "ns3/qbb-header.h"
+#include "ns3/qbb-net-device.h"
+#include "ns3/rdma-hw.h"
+#include "ns3/rdma-queue-pair.h"
+#include "ns3/rdma-segment-pool.h"
+#include "ns3/rdma-seq-header.h"
+#include "ns3/simulator.h"
+#include "ns3/switch-mmu.h"
+#include "ns3/test.h"
+#include "ns3/udp-header.h"
+
+#ifdef NS3_MPI
+#include "ns3/qbb-remote-channel.h"
+#endif
+
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \brief Test that CustomHeader parses and rewrites an RDMA data packet
+ */
+class CustomHeaderTest : public TestCase
+{
+  public:
+    CustomHeaderTest();
+
+  private:
+    void DoRun() override;
+};
+
+CustomHeaderTest::CustomHeaderTest()
+    : TestCase("Parse and rewrite the headers of an RDMA data packet")
+{
+}
+
+void
+CustomHeaderTest::DoRun()
+{
+    Ptr<Packet> p = Create<Packet>(1000);
+    RdmaSeqHeader seqTs;
+    seqTs.SetSeq(123456);
+    seqTs.SetPG(3);
+    p->AddHeader(seqTs);
+    UdpHeader udp;
+    udp.SetSourcePort(1000);
+    udp.SetDestinationPort(100);
+    p->AddHeader(udp);
+    Ipv4Header ip;
+    ip.SetSource(Ipv4Address("11.0.1.1"));
+    ip.SetDestination(Ipv4Address("11.0.2.1"));
+    ip.SetProtocol(0x11);
+    ip.SetPayloadSize(p->GetSize());
+    ip.SetTtl(64);
+    p->AddHeader(ip);
+    PppHeader ppp;
+    ppp.SetProtocol(0x0021);
+    p->AddHeader(ppp);
+    uint32_t size = p->GetSize();
+
+    CustomHeader ch(CustomHeader::L2_Header | CustomHeader::L3_Header | CustomHeader::L4_Header);
+    ch.getInt = 1;
+    p->PeekHeader(ch);
+    NS_TEST_ASSERT_MSG_EQ(ch.l3Prot, 0x11, "wrong L3 protocol");
+    NS_TEST_ASSERT_MSG_EQ(ch.sip, Ipv4Address("11.0.1.1").Get(), "wrong source");
+    NS_TEST_ASSERT_MSG_EQ(ch.dip, Ipv4Address("11.0.2.1").Get(), "wrong destination");
+    NS_TEST_ASSERT_MSG_EQ(ch.udp.sport, 1000, "wrong source port");
+    NS_TEST_ASSERT_MSG_EQ(ch.udp.dport, 100, "wrong destination port");
+    NS_TEST_ASSERT_MSG_EQ(ch.udp.seq, 123456, "wrong sequence number");
+    NS_TEST_ASSERT_MSG_EQ(ch.udp.pg, 3, "wrong priority group");
+    NS_TEST_ASSERT_MSG_EQ(ch.GetIpv4EcnBits(), 0, "ECN marked too early");
+
+    // mark ECN the way SwitchNode does on dequeue, then parse with the
+    // regular headers again
+    p->RemoveHeader(ch);
+    NS_TEST_ASSERT_MSG_EQ(p->GetSize(), size - ch.GetSerializedSize(), "wrong header size");
+    ch.m_tos |= Ipv4Header::ECN_CE;
+    p->AddHeader(ch);
+    NS_TEST_ASSERT_MSG_EQ(p->GetSize(), size, "packet size changed");
+
+    p->RemoveHeader(ppp);
+    NS_TEST_ASSERT_MSG_EQ(ppp.GetProtocol(), 0x0021, "wrong PPP protocol");
+    p->RemoveHeader(ip);
+    NS_TEST_ASSERT_MSG_EQ(ip.GetEcn(), Ipv4Header::ECN_CE, "ECN not marked");
+    NS_TEST_ASSERT_MSG_EQ(ip.GetTtl(), 64, "wrong TTL");
+    p->RemoveHeader(udp);
+    NS_TEST_ASSERT_MSG_EQ(udp.GetDestinationPort(), 100, "wrong destination port");
+    p->RemoveHeader(seqTs);
+    NS_TEST_ASSERT_MSG_EQ(seqTs.GetSeq(), 123456, "wrong sequence number");
+    NS_TEST_ASSERT_MSG_EQ(seqTs.GetPG(), 3, "wrong priority group");
+    NS_TEST_ASSERT_MSG_EQ(p->GetSize(), 1000, "wrong payload size");
+}
+
+#ifdef NS3_MPI
+/**
+ * \brief Test the encoding of the control frames sent to other ranks
+ */
+class QbbControlEncodingTest : public TestCase
+{
+  public:
+    QbbControlEncodingTest();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Add the IPv4 and PPP headers of a control frame.
+     *
+     * \param p the frame
+     * \param protocol the IPv4 protocol
+     * \param tos the TOS
+     * \param ttl the TTL
+     */
+    static void AddHeaders(Ptr<Packet> p, uint8_t protocol, uint8_t tos, uint8_t ttl);
+
+    /**
+     * Check that a frame is encoded, smaller, and decoded byte for byte.
+     *
+     * \param p the frame
+     * \param name the kind of frame
+     */
+    void CheckRoundTrip(Ptr<Packet> p, const std::string& name);
+
+    /**
+     * \param p a packet
+     * \return the bytes of the packet
+     */
+    static std::vector<uint8_t> GetBytes(Ptr<const Packet> p);
+};
+
+QbbControlEncodingTest::QbbControlEncodingTest()
+    : TestCase("Encode the control frames sent to other ranks")
+{
+}
+
+void
+QbbControlEncodingTest::AddHeaders(Ptr<Packet> p, uint8_t protocol, uint8_t tos, uint8_t ttl)
+{
+    Ipv4Header ip;
+    ip.SetSource(Ipv4Address("11.0.2.1"));
+    ip.SetDestination(Ipv4Address("11.0.1.1"));
+    ip.SetProtocol(protocol);
+    ip.SetPayloadSize(p->GetSize());
+    ip.SetTos(tos);
+    ip.SetTtl(ttl);
+    ip.SetIdentification(4321);
+    p->AddHeader(ip);
+    PppHeader ppp;
+    ppp.SetProtocol(0x0021);
+    p->AddHeader(ppp);
+}
+
+std::vector<uint8_t>
+QbbControlEncodingTest::GetBytes(Ptr<const Packet> p)
+{
+    std::vector<uint8_t> bytes(p->GetSize());
+    p->CopyData(bytes.data(), bytes.size());
+    return bytes;
+}
+
+void
+QbbControlEncodingTest::CheckRoundTrip(Ptr<Packet> p, const std::string& name)
+{
+    Ptr<Packet> encoded = QbbRemoteChannel::EncodeControl(p);
+    NS_TEST_ASSERT_MSG_NE(encoded, nullptr, name << " not encoded");
+    NS_TEST_EXPECT_MSG_LT(encoded->GetSize(), p->GetSize(), name << " encoding not smaller");
+    Ptr<Packet> decoded = QbbRemoteChannel::DecodeControl(encoded);
+    NS_TEST_EXPECT_MSG_EQ((GetBytes(decoded) == GetBytes(p)), true, name << " changed");
+}
+
+void
+QbbControlEncodingTest::DoRun()
+{
+    IntHeader::Mode mode = IntHeader::mode;
+
+    Ptr<Packet> pfc = Create<Packet>(0);
+    pfc->AddHeader(PauseHeader(65535, 123456, 3));
+    AddHeaders(pfc, 0xFE, 0, 1);
+    CheckRoundTrip(pfc, "PFC");
+
+    Ptr<Packet> cnp = Create<Packet>(0);
+    cnp->AddHeader(CnHeader(7, 3, Ipv4Header::ECN_CE, 12, 34));
+    AddHeaders(cnp, 0xFF, 0, 64);
+    CheckRoundTrip(cnp, "CNP");
+
+    // ACK and NACK with the INT hops of HPCC, and padded to 60 bytes
+    // without INT
+    for (IntHeader::Mode intMode : {IntHeader::NORMAL, IntHeader::NONE})
+    {
+        IntHeader::mode = intMode;
+        for (uint8_t protocol : {0xFC, 0xFD})
+        {
+            qbbHeader seqh;
+            seqh.SetSeq(1000000);
+            seqh.SetPG(3);
+            seqh.SetSport(100);
+            seqh.SetDport(1000);
+            IntHeader ih;
+            ih.PushHop(1000, 2000000, 16000, 100000000000lu);
+            ih.PushHop(2000, 3000000, 0, 100000000000lu);
+            seqh.SetIntHeader(ih);
+            seqh.SetCnp();
+            Ptr<Packet> ack =
+                Create<Packet>(std::max(60 - 14 - 20 - (int)seqh.GetSerializedSize(), 0));
+            ack->AddHeader(seqh);
+            AddHeaders(ack, protocol, Ipv4Header::ECN_ECT1, 64);
+            CheckRoundTrip(ack, protocol == 0xFC ? "ACK" : "NACK");
+
+            CustomHeader ch(CustomHeader::L2_Header | CustomHeader::L3_Header |
+                            CustomHeader::L4_Header);
+            ch.getInt = 1;
+            QbbRemoteChannel::DecodeControl(QbbRemoteChannel::EncodeControl(ack))->PeekHeader(ch);
+            NS_TEST_EXPECT_MSG_EQ(ch.ack.seq, 1000000, "wrong sequence number");
+            if (intMode == IntHeader::NORMAL)
+            {
+                NS_TEST_EXPECT_MSG_EQ(ch.ack.ih.nhop, 2, "wrong INT hops");
+                NS_TEST_EXPECT_MSG_EQ(ch.ack.ih.hop[1].GetTime(), 2000, "wrong INT hop");
+            }
+        }
+    }
+    IntHeader::mode = mode;
+
+    // data frames and frames the encoding would not restore go as they are
+    Ptr<Packet> data = Create<Packet>(100);
+    AddHeaders(data, 0x11, 0, 64);
+    NS_TEST_EXPECT_MSG_EQ(QbbRemoteChannel::EncodeControl(data), nullptr, "data encoded");
+    uint8_t padding[4] = {0, 0, 1, 0};
+    Ptr<Packet> padded = Create<Packet>(padding, sizeof(padding));
+    padded->AddHeader(PauseHeader(0, 0, 3));
+    AddHeaders(padded, 0xFE, 0, 1);
+    NS_TEST_EXPECT_MSG_EQ(QbbRemoteChannel::EncodeControl(padded),
+                          nullptr,
+                          "padding with data encoded");
+}
+#endif
+
+/**
+ * \brief Test the PFC pause and resume thresholds of the switch MMU
+ */
+class SwitchMmuPfcTest : public TestCase
+{
+  public:
+    SwitchMmuPfcTest();
+
+  private:
+    void DoRun() override;
+};
+
+SwitchMmuPfcTest::SwitchMmuPfcTest()
+    : TestCase("Pause an ingress queue once its shared buffer is used up and resume it")
+{
+}
+
+void
+SwitchMmuPfcTest::DoRun()
+{
+    Ptr<SwitchMmu> mmu = CreateObject<SwitchMmu>();
+    mmu->ConfigBufferSize(1000000);
+    for (uint32_t port = 1; port <= 2; port++)
+    {
+        mmu->ConfigHdrm(port, 100000);
+        mmu->pfc_a_shift[port] = 3;
+    }
+    mmu->ConfigNPort(2);
+
+    const uint32_t port = 1;
+    const uint32_t qIndex = 3;
+    const uint32_t psize = 1000;
+    uint32_t n = 0;
+    while (!mmu->CheckShouldPause(port, qIndex))
+    {
+        NS_TEST_ASSERT_MSG_EQ(mmu->CheckIngressAdmission(port, qIndex, psize),
+                              true,
+                              "packet dropped before pause");
+        mmu->UpdateIngressAdmission(port, qIndex, psize);
+        n++;
+    }
+    NS_TEST_ASSERT_MSG_GT(n * psize, mmu->reserve, "paused within the reserved buffer");
+    NS_TEST_ASSERT_MSG_EQ(mmu->CheckShouldPause(port, 2), false, "other queue paused");
+
+    mmu->SetPause(port, qIndex);
+    NS_TEST_ASSERT_MSG_EQ(mmu->CheckShouldPause(port, qIndex), false, "paused twice");
+    NS_TEST_ASSERT_MSG_EQ(mmu->CheckShouldResume(port, qIndex), false, "resumed too early");
+
+    // packets in flight before the pause reaches the sender use the headroom
+    uint32_t hdrm = mmu->hdrm_bytes[port][qIndex];
+    mmu->UpdateIngressAdmission(port, qIndex, psize);
+    NS_TEST_ASSERT_MSG_EQ(mmu->hdrm_bytes[port][qIndex], hdrm + psize, "headroom not used");
+
+    for (uint32_t i = 0; i <= n; i++)
+    {
+        mmu->RemoveFromIngressAdmission(port, qIndex, psize);
+    }
+    NS_TEST_ASSERT_MSG_EQ(mmu->shared_used_bytes, 0, "shared buffer not released");
+    NS_TEST_ASSERT_MSG_EQ(mmu->CheckShouldResume(port, qIndex), true, "not resumed");
+    mmu->SetResume(port, qIndex);
+    NS_TEST_ASSERT_MSG_EQ(mmu->CheckShouldResume(port, qIndex), false, "resumed twice");
+}
+
+/**
+ * \brief Test the round robin of the RDMA egress queue over ready, paused,
+ * rate limited and finished queue pairs
+ */
+class RdmaEgressQueueSchedulerTest : public TestCase
+{
+  public:
+    RdmaEgressQueueSchedulerTest();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Build the next packet of a qp, like RdmaHw::GetNxtPacket.
+     *
+     * \param qp the queue pair
+     * \return a packet of up to 1000 bytes
+     */
+    Ptr<Packet> NextPacket(Ptr<RdmaQueuePair> qp);
+
+    /**
+     * Dequeue from the queue pair picked by the egress queue.
+     *
+     * \return the queue pair, or 0 if none can send
+     */
+    Ptr<RdmaQueuePair> Dequeue();
+
+    /**
+     * Check that the rate limited qp is served once available.
+     */
+    void CheckRateLimited();
+
+    Ptr<RdmaEgressQueue> m_queue;          //!< the queue under test
+    std::vector<Ptr<RdmaQueuePair>> m_qps; //!< the queue pairs
+    bool m_paused[8];                      //!< the paused priorities
+};
+
+RdmaEgressQueueSchedulerTest::RdmaEgressQueueSchedulerTest()
+    : TestCase("Serve the queue pairs that can send in round-robin order")
+{
+}
+
+Ptr<Packet>
+RdmaEgressQueueSchedulerTest::NextPacket(Ptr<RdmaQueuePair> qp)
+{
+    uint32_t size = std::min<uint64_t>(qp->GetBytesLeft(), 1000);
+    qp->snd_nxt += size;
+    return Create<Packet>(size);
+}
+
+Ptr<RdmaQueuePair>
+RdmaEgressQueueSchedulerTest::Dequeue()
+{
+    int qIndex = m_queue->GetNextQindex(m_paused);
+    if (qIndex < 0)
+    {
+        return nullptr;
+    }
+    Ptr<RdmaQueuePair> qp = m_queue->GetQp(qIndex);
+    m_queue->DequeueQindex(qIndex);
+    m_queue->UpdateQp(qp);
+    return qp;
+}
+
+void
+RdmaEgressQueueSchedulerTest::CheckRateLimited()
+{
+    NS_TEST_EXPECT_MSG_EQ(Dequeue(), m_qps[2], "rate limited qp not served in time");
+    NS_TEST_EXPECT_MSG_EQ(m_queue->GetFlowCount(), 1, "finished qps not cleared");
+    NS_TEST_EXPECT_MSG_EQ(m_queue->GetQp(0), m_qps[2], "wrong index after clearing");
+}
+
+void
+RdmaEgressQueueSchedulerTest::DoRun()
+{
+    Ptr<QbbNetDevice> dev = CreateObject<QbbNetDevice>();
+    dev->SetQueue(CreateObject<BEgressQueue>());
+    m_queue = dev->GetRdmaQueue();
+    m_queue->m_qpGrp = CreateObject<RdmaQueuePairGroup>();
+    m_queue->m_rdmaGetNxtPkt = MakeCallback(&RdmaEgressQueueSchedulerTest::NextPacket, this);
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        m_paused[i] = false;
+    }
+
+    // qps 0 and 1 share priority 3, qp 2 uses priority 5
+    const uint16_t pg[] = {3, 3, 5};
+    const uint64_t size[] = {3000, 1000, 3000};
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        Ptr<RdmaQueuePair> qp =
+            CreateObject<RdmaQueuePair>(pg[i], Ipv4Address(), Ipv4Address(), 1000 + i, 100);
+        qp->SetSize(size[i]);
+        m_queue->m_qpGrp->AddQp(qp);
+        m_queue->AddQp(qp);
+        m_qps.push_back(qp);
+    }
+
+    NS_TEST_EXPECT_MSG_EQ(Dequeue(), m_qps[0], "wrong first qp");
+    NS_TEST_EXPECT_MSG_EQ(Dequeue(), m_qps[1], "wrong second qp");
+    NS_TEST_EXPECT_MSG_EQ(Dequeue(), m_qps[2], "wrong third qp");
+    // qp 1 has sent everything and waits for its ack
+    NS_TEST_EXPECT_MSG_EQ(Dequeue(), m_qps[0], "round robin does not wrap");
+    m_paused[5] = true;
+    NS_TEST_EXPECT_MSG_EQ(Dequeue(), m_qps[0], "paused qp served");
+    NS_TEST_EXPECT_MSG_EQ(Dequeue(), nullptr, "qp served without data");
+    m_paused[5] = false;
+
+    m_qps[2]->m_nextAvail = Seconds(1);
+    m_queue->UpdateQp(m_qps[2]);
+    NS_TEST_EXPECT_MSG_EQ(Dequeue(), nullptr, "rate limited qp served early");
+    NS_TEST_EXPECT_MSG_EQ(m_queue->GetNextAvail(), Seconds(1), "wrong next available time");
+
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        m_qps[i]->Acknowledge(size[i]);
+        m_queue->UpdateQp(m_qps[i]);
+    }
+    Simulator::Schedule(Seconds(1), &RdmaEgressQueueSchedulerTest::CheckRateLimited, this);
+    Simulator::Run();
+    Simulator::Destroy();
+}
+
+/**
+ * \brief Test that a data segment kept in RdmaSegmentPool materializes into
+ * the bytes GetNxtPacket serializes
+ */
+class RdmaSegmentPoolTest : public TestCase
+{
+  public:
+    RdmaSegmentPoolTest();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \param p a packet
+     * \return the bytes of the packet
+     */
+    static std::vector<uint8_t> Bytes(Ptr<const Packet> p);
+};
+
+RdmaSegmentPoolTest::RdmaSegmentPoolTest()
+    : TestCase("Materialize a data segment into the bytes of the serialized headers")
+{
+}
+
+std::vector<uint8_t>
+RdmaSegmentPoolTest::Bytes(Ptr<const Packet> p)
+{
+    std::vector<uint8_t> bytes(p->GetSize());
+    p->CopyData(bytes.data(), bytes.size());
+    return bytes;
+}
+
+void
+RdmaSegmentPoolTest::DoRun()
+{
+    RdmaSegmentPool& pool = RdmaSegmentPool::Get();
+    uint32_t live = pool.GetN();
+    Ipv4Address sip("11.0.1.1");
+    Ipv4Address dip("11.0.2.1");
+    Ptr<RdmaHw> hw = CreateObject<RdmaHw>();
+    hw->m_nic.push_back(RdmaInterfaceMgr(CreateObject<QbbNetDevice>()));
+    hw->m_rtTable[dip.Get()].push_back(0);
+    Ptr<RdmaQueuePair> qp = CreateObject<RdmaQueuePair>(3, sip, dip, 1000, 100);
+    qp->SetSize(2500);
+    qp->snd_nxt = 1000;
+    qp->m_ipid = 7;
+
+    Ptr<Packet> plain = hw->GetNxtPacket(qp);
+    NS_TEST_ASSERT_MSG_EQ(pool.GetN(), live, "descriptor without SegmentDescriptors");
+    qp->snd_nxt = 1000;
+    qp->m_ipid = 7;
+    hw->SetAttribute("SegmentDescriptors", BooleanValue(true));
+    Ptr<Packet> segment = hw->GetNxtPacket(qp);
+    NS_TEST_ASSERT_MSG_EQ(segment->GetSize(), plain->GetSize(), "wrong segment size");
+    NS_TEST_ASSERT_MSG_EQ(qp->snd_nxt, 2000, "wrong next sequence number");
+    CustomHeader* ch = pool.Find(segment);
+    NS_TEST_ASSERT_MSG_NE(ch, nullptr, "no descriptor");
+    NS_TEST_EXPECT_MSG_EQ(ch->udp.seq, 1000, "wrong sequence number");
+    NS_TEST_EXPECT_MSG_EQ(ch->udp.pg, 3, "wrong priority group");
+
+    // the switch marks ECN in the descriptor, it shows up in the bytes
+    ch->m_tos |= Ipv4Header::ECN_CE;
+    NS_TEST_ASSERT_MSG_EQ(pool.Materialize(segment), true, "cannot materialize");
+    NS_TEST_EXPECT_MSG_EQ(pool.Find(segment), nullptr, "descriptor not released");
+    NS_TEST_EXPECT_MSG_EQ(pool.Materialize(segment), false, "materialized twice");
+    NS_TEST_ASSERT_MSG_EQ(segment->GetSize(), plain->GetSize(), "size changed");
+    CustomHeader parsed(CustomHeader::L2_Header | CustomHeader::L3_Header);
+    segment->PeekHeader(parsed);
+    NS_TEST_EXPECT_MSG_EQ(parsed.GetIpv4EcnBits(), Ipv4Header::ECN_CE, "ECN mark lost");
+    segment->RemoveHeader(parsed);
+    parsed.m_tos = 0;
+    segment->AddHeader(parsed);
+    NS_TEST_EXPECT_MSG_EQ((Bytes(segment) == Bytes(plain)), true, "bytes differ");
+
+    // the uid index survives growing and removal in any order
+    std::vector<Ptr<Packet>> packets;
+    for (uint32_t i = 0; i < 5000; i++)
+    {
+        packets.push_back(Create<Packet>(0));
+        pool.Attach(packets.back()).udp.seq = i;
+    }
+    for (uint32_t i = 0; i < packets.size(); i += 2)
+    {
+        pool.Release(packets[i]);
+    }
+    for (uint32_t i = 0; i < packets.size(); i++)
+    {
+        ch = pool.Find(packets[i]);
+        if (i % 2 == 0)
+        {
+            NS_TEST_ASSERT_MSG_EQ(ch, nullptr, "released descriptor found");
+        }
+        else
+        {
+            NS_TEST_ASSERT_MSG_NE(ch, nullptr, "descriptor lost");
+            NS_TEST_ASSERT_MSG_EQ(ch->udp.seq, i, "wrong descriptor");
+        }
+    }
+    for (Ptr<Packet> p : packets)
+    {
+        pool.Release(p);
+    }
+    NS_TEST_EXPECT_MSG_EQ(pool.GetN(), live, "descriptors leaked");
+}
+
+/**
+ * \brief TestSuite for the lossless (qbb) stack
+ */
+class QbbTestSuite : public TestSuite
+{
+  public:
+    QbbTestSuite();
+};
+
+QbbTestSuite::QbbTestSuite()
+    : TestSuite("point-to-point-qbb", UNIT)
+{
+    AddTestCase(new CustomHeaderTest, TestCase::QUICK);
+#ifdef NS3_MPI
+    AddTestCase(new QbbControlEncodingTest, TestCase::QUICK);
+#endif
+    AddTestCase(new SwitchMmuPfcTest, TestCase::QUICK);
+    AddTestCase(new RdmaEgressQueueSchedulerTest, TestCase::QUICK);
+    AddTestCase(new RdmaSegmentPoolTest, TestCase::QUICK);
+}
+
+static QbbTestSuite g_qbbTestSuite; //!< The testsuite
@@ -197,6 +197,12 @@ VisualSimulatorImpl::Cancel(const EventId& id)
     m_simulator->Cancel(id);
 }
 
+EventId
+VisualSimulatorImpl::Reschedule(const EventId& id, const Time& delay)
+{
+    return m_simulator->Reschedule(id, delay);
+}
+
 bool
 VisualSimulatorImpl::IsExpired(const EventId& id) const
 {
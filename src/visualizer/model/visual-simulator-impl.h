@@ -63,6 +63,7 @@ class VisualSimulatorImpl : public SimulatorImpl
     EventId ScheduleDestroy(EventImpl* event) override;
     void Remove(const EventId& id) override;
     void Cancel(const EventId& id) override;
+    EventId Reschedule(const EventId& id, const Time& delay) override;
     bool IsExpired(const EventId& id) const override;
     void Run() override;
     Time Now() const override;
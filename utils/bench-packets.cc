@@ -237,6 +237,37 @@ benchD(uint32_t n)
     }
 }
 
+static void
+benchTagPipeline(uint32_t n)
+{
+    BenchHeader<25> ipv4;
+    BenchHeader<8> udp;
+    // the sizes of the tags of the qbb devices
+    BenchTag<1> unsched;
+    BenchTag<4> flowId;
+    BenchTag<5> interface;
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        Ptr<Packet> p = Create<Packet>(1000);
+        p->AddHeader(udp);
+        p->AddHeader(ipv4);
+        p->AddPacketTag(unsched);
+        p->AddPacketTag(flowId);
+        Ptr<Packet> o = p->Copy();
+        // each hop tags the packet with its ingress interface on receive,
+        // and removes it on transmit
+        for (uint32_t hop = 0; hop < 4; hop++)
+        {
+            o->AddPacketTag(interface);
+            o->PeekPacketTag(flowId);
+            o->RemovePacketTag(interface);
+        }
+        o->RemovePacketTag(unsched);
+        o->RemoveHeader(ipv4);
+    }
+}
+
 static void
 benchA(uint32_t n)
 {
@@ -405,6 +436,7 @@ main(int argc, char* argv[])
     runBench(&benchB, n, minIterations, "Just add headers");
     runBench(&benchC, n, minIterations, "Remove by func call");
     runBench(&benchD, n, minIterations, "Intermixed add/remove headers and tags");
+    runBench(&benchTagPipeline, n, minIterations, "Tags added and removed at each hop");
     runBench(&benchFragment, n, minIterations, "Fragmentation and concatenation");
     runBench(&benchByteTags, n, minIterations, "Benchmark byte tags");
 
@@ -0,0 +1,446 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program validates the message-level approximation of RdmaHw
+// (ApproxSegmentSize): it runs one phase of RDMA flows on a qbb leaf-spine
+// fabric packet by packet and with coalesced segments, and reports the
+// flow completion time error of the approximation and its speedup. A second
+// packet-level run with other random streams shows the noise floor of the
+// comparison. The topologies are the leaf-spine ones of
+// scratch/mpi-simulation/cut-mpi.cc.
+// Sample usage:
+//   ./ns3 run 'bench-rdma-approx --topo=1 --segment=64000'
+//   ./ns3 run 'bench-rdma-approx --flows=scratch/rdma_operate.txt --topo=1'
+
+#include "ns3/abort.h"
+#include "ns3/boolean.h"
+#include "ns3/command-line.h"
+#include "ns3/config.h"
+#include "ns3/double.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/int-header.h"
+#include "ns3/ipv4.h"
+#include "ns3/qbb-helper.h"
+#include "ns3/rdma-driver.h"
+#include "ns3/rdma-hw.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/switch-node.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+using namespace ns3;
+
+/** Spines, leaves and servers per leaf of the leaf-spine topologies. */
+const uint16_t g_topologies[][3] = {{4, 8, 8},
+                                    {4, 16, 8},
+                                    {8, 32, 8},
+                                    {16, 64, 8},
+                                    {32, 128, 8},
+                                    {64, 256, 8}};
+
+/** A flow of the phase. */
+struct Flow
+{
+    uint32_t src;  //!< the sending server
+    uint32_t dst;  //!< the receiving server
+    uint64_t size; //!< the message size in bytes
+};
+
+/** The outcome of one run. */
+struct Result
+{
+    std::vector<double> fct; //!< completion time of every flow (ns), 0 if not finished
+    uint64_t events;         //!< number of simulated events
+    double seconds;          //!< wall clock time
+};
+
+/** Parameters of the fabric. */
+struct Fabric
+{
+    uint32_t spines;  //!< number of spine switches
+    uint32_t leaves;  //!< number of leaf switches
+    uint32_t servers; //!< servers per leaf
+    DataRate rate;    //!< link rate
+    Time delay;       //!< link delay
+    uint32_t ccMode;  //!< RdmaHw::CcMode
+};
+
+/** Flow completion times of the current run. */
+static std::vector<double> g_fct;
+
+/**
+ * \param id a server node id
+ * \return the address RdmaHw derives the node id from
+ */
+static Ipv4Address
+ServerAddress(uint32_t id)
+{
+    return Ipv4Address(0x0b000001 + ((id / 256) * 0x00010000) + ((id % 256) * 0x00000100));
+}
+
+/**
+ * Record the completion of a flow, sent from port 1000 + flow index.
+ *
+ * \param qp the queue pair of the flow
+ */
+static void
+QpComplete(Ptr<RdmaQueuePair> qp)
+{
+    g_fct[qp->sport - 1000] = (Simulator::Now() - qp->startTime).GetNanoSeconds();
+}
+
+/** Nothing to notify, the flows have no application. */
+static void
+AppFinish()
+{
+}
+
+/**
+ * Read the first phase of a flow file in the rdma_operate.txt format.
+ *
+ * \param file the flow file
+ * \param nServers the number of servers of the topology
+ * \return the flows
+ */
+static std::vector<Flow>
+ReadFlows(const std::string& file, uint32_t nServers)
+{
+    std::vector<Flow> flows;
+    std::ifstream input(file);
+    NS_ABORT_MSG_IF(!input.is_open(), "cannot open " << file);
+    std::string line;
+    uint32_t phases = 0;
+    while (std::getline(input, line))
+    {
+        if (line.find("phase") != std::string::npos && ++phases > 1)
+        {
+            break;
+        }
+        std::istringstream ss(line);
+        std::string type;
+        std::string key;
+        Flow flow;
+        ss >> key >> type >> key >> flow.src >> key >> key >> key >> flow.dst >> key >> key >>
+            key >> key >> key >> flow.size;
+        if (ss && type == "rdma_send" && flow.src < nServers && flow.dst < nServers)
+        {
+            flows.push_back(flow);
+        }
+    }
+    return flows;
+}
+
+/**
+ * Run the flows to completion.
+ *
+ * \param fabric the fabric
+ * \param flows the flows, all started at time 0
+ * \param segment the RdmaHw::ApproxSegmentSize, 0 for packet mode
+ * \param guard the RdmaHw::ApproxGuard
+ * \return the flow completion times and the cost of the run
+ */
+static Result
+Run(const Fabric& fabric, const std::vector<Flow>& flows, uint32_t segment, double guard)
+{
+    const uint32_t nServers = fabric.leaves * fabric.servers;
+    const uint32_t mtu = 1000;
+    // HPCC is window based, the window is one BDP
+    const bool windowed = fabric.ccMode == 3 || fabric.ccMode == 10;
+    g_fct.assign(flows.size(), 0);
+
+    // servers first so their node id is their index
+    NodeContainer servers;
+    servers.Create(nServers);
+    std::vector<Ptr<SwitchNode>> leaves;
+    std::vector<Ptr<SwitchNode>> spines;
+    NodeContainer switches;
+    for (uint32_t i = 0; i < fabric.leaves + fabric.spines; i++)
+    {
+        Ptr<SwitchNode> sw = CreateObject<SwitchNode>();
+        sw->SetAttribute("EcnEnabled", BooleanValue(true));
+        sw->SetAttribute("CcMode", UintegerValue(fabric.ccMode));
+        (i < fabric.leaves ? leaves : spines).push_back(sw);
+        switches.Add(sw);
+    }
+    // the switches need an IPv4 address on every port to send PFC frames
+    InternetStackHelper stack;
+    stack.Install(switches);
+
+    QbbHelper qbb;
+    qbb.SetDeviceAttribute("DataRate", DataRateValue(fabric.rate));
+    qbb.SetChannelAttribute("Delay", TimeValue(fabric.delay));
+    std::vector<uint32_t> serverPort(nServers);                   // leaf port of every server
+    std::vector<std::vector<uint32_t>> leafUplinks(fabric.leaves); // spine ports of every leaf
+    std::vector<std::vector<uint32_t>> spinePorts(fabric.spines);  // leaf ports of every spine
+    for (uint32_t l = 0; l < fabric.leaves; l++)
+    {
+        for (uint32_t s = 0; s < fabric.servers; s++)
+        {
+            NetDeviceContainer d = qbb.Install(servers.Get(l * fabric.servers + s), leaves[l]);
+            serverPort[l * fabric.servers + s] = d.Get(1)->GetIfIndex();
+        }
+        for (uint32_t s = 0; s < fabric.spines; s++)
+        {
+            NetDeviceContainer d = qbb.Install(leaves[l], spines[s]);
+            leafUplinks[l].push_back(d.Get(0)->GetIfIndex());
+            spinePorts[s].push_back(d.Get(1)->GetIfIndex());
+        }
+    }
+
+    // buffers, ECN thresholds scaled from 100/400 KB at 100 Gbps, PFC headroom for
+    // the largest frame; segments are marked like the packets they stand for
+    double scale = fabric.rate.GetBitRate() / 100e9;
+    for (uint32_t i = 0; i < switches.GetN(); i++)
+    {
+        Ptr<SwitchNode> sw = DynamicCast<SwitchNode>(switches.Get(i));
+        Ptr<Ipv4> ipv4 = sw->GetObject<Ipv4>();
+        for (uint32_t j = 1; j < sw->GetNDevices(); j++)
+        {
+            ipv4->AddInterface(sw->GetDevice(j));
+            ipv4->AddAddress(j,
+                             Ipv4InterfaceAddress(Ipv4Address(0x0a000000 + (sw->GetId() << 8) + j),
+                                                  Ipv4Mask("255.255.255.0")));
+            sw->m_mmu->ConfigEcn(j, 100 * scale, 400 * scale, 0.2);
+            sw->m_mmu->ConfigHdrm(j,
+                                  fabric.rate.GetBitRate() * fabric.delay.GetSeconds() * 3 / 8 +
+                                      3 * std::max(mtu, segment));
+        }
+        sw->m_mmu->ConfigEcnUnit(mtu + 48);
+        sw->m_mmu->ConfigNPort(sw->GetNDevices() - 1);
+        sw->m_mmu->ConfigBufferSize(32 * 1024 * 1024);
+    }
+
+    // RDMA on the servers, one NIC each
+    for (uint32_t i = 0; i < nServers; i++)
+    {
+        Ptr<RdmaHw> rdmaHw = CreateObject<RdmaHw>();
+        rdmaHw->SetAttribute("Mtu", UintegerValue(mtu));
+        rdmaHw->SetAttribute("CcMode", UintegerValue(fabric.ccMode));
+        rdmaHw->SetAttribute("L2ChunkSize", UintegerValue(4000));
+        rdmaHw->SetAttribute("L2AckInterval", UintegerValue(1));
+        rdmaHw->SetAttribute("ApproxSegmentSize", UintegerValue(segment));
+        rdmaHw->SetAttribute("ApproxGuard", DoubleValue(guard));
+        rdmaHw->SetAttribute("VarWin", BooleanValue(windowed));
+        Ptr<RdmaDriver> rdma = CreateObject<RdmaDriver>();
+        rdma->SetNode(servers.Get(i));
+        rdma->SetRdmaHw(rdmaHw);
+        servers.Get(i)->AggregateObject(rdma);
+        rdma->Init();
+        rdma->TraceConnectWithoutContext("QpComplete", MakeCallback(&QpComplete));
+        for (uint32_t j = 0; j < nServers; j++)
+        {
+            Ipv4Address dst = ServerAddress(j);
+            if (j != i)
+            {
+                rdmaHw->AddTableEntry(dst, 0);
+            }
+        }
+    }
+
+    // shortest paths, ECMP over the spines
+    for (uint32_t j = 0; j < nServers; j++)
+    {
+        Ipv4Address dst = ServerAddress(j);
+        uint32_t leaf = j / fabric.servers;
+        for (uint32_t l = 0; l < fabric.leaves; l++)
+        {
+            if (l == leaf)
+            {
+                leaves[l]->AddTableEntry(dst, serverPort[j]);
+                continue;
+            }
+            for (uint32_t port : leafUplinks[l])
+            {
+                leaves[l]->AddTableEntry(dst, port);
+            }
+        }
+        for (uint32_t s = 0; s < fabric.spines; s++)
+        {
+            spines[s]->AddTableEntry(dst, spinePorts[s][leaf]);
+        }
+    }
+
+    // base RTT of a path through a spine: propagation, a data packet and an ACK per hop
+    const uint32_t hops = 4;
+    uint64_t baseRtt = (fabric.delay * (2 * hops) +
+                        hops * fabric.rate.CalculateBytesTxTime(mtu + 48) +
+                        hops * fabric.rate.CalculateBytesTxTime(60))
+                           .GetNanoSeconds();
+    for (uint32_t i = 0; i < flows.size(); i++)
+    {
+        const Flow& flow = flows[i];
+        servers.Get(flow.src)->GetObject<RdmaDriver>()->AddQueuePair(
+            flow.size,
+            3,
+            ServerAddress(flow.src),
+            ServerAddress(flow.dst),
+            1000 + i,
+            100,
+            windowed ? 1 : 0,
+            baseRtt,
+            MakeCallback(&AppFinish),
+            Simulator::GetMaximumSimulationTime());
+    }
+
+    SystemWallClockMs clock;
+    clock.Start();
+    Simulator::Run();
+    Result result;
+    result.seconds = clock.End() / 1000.0;
+    result.events = Simulator::GetEventCount();
+    result.fct = g_fct;
+    Simulator::Destroy();
+    return result;
+}
+
+/**
+ * Print a run and its errors against the packet-level run.
+ *
+ * The flow error is the relative error of every flow completion time, the
+ * quantile errors compare the distributions of the completion times, and
+ * the phase error compares the completion time of the last flow.
+ *
+ * \param name the mode of the run
+ * \param run the run
+ * \param reference the packet-level run
+ * \return the number of flows that did not finish in either run
+ */
+static uint32_t
+Report(const std::string& name, const Result& run, const Result& reference)
+{
+    double flowError = 0;
+    std::vector<double> fct;
+    std::vector<double> referenceFct;
+    uint32_t unfinished = 0;
+    for (uint32_t i = 0; i < run.fct.size(); i++)
+    {
+        if (run.fct[i] == 0 || reference.fct[i] == 0)
+        {
+            unfinished++;
+            continue;
+        }
+        flowError += std::fabs(run.fct[i] - reference.fct[i]) / reference.fct[i];
+        fct.push_back(run.fct[i]);
+        referenceFct.push_back(reference.fct[i]);
+    }
+    if (fct.empty())
+    {
+        std::cout << name << ": no flow finished" << std::endl;
+        return unfinished;
+    }
+    std::sort(fct.begin(), fct.end());
+    std::sort(referenceFct.begin(), referenceFct.end());
+    auto quantileError = [&fct, &referenceFct](double q) {
+        size_t i = std::min<size_t>(fct.size() * q, fct.size() - 1);
+        return std::fabs(fct[i] - referenceFct[i]) / referenceFct[i] * 100;
+    };
+    double phaseError = std::fabs(fct.back() - referenceFct.back()) / referenceFct.back() * 100;
+    std::cout << std::left << std::setw(9) << name << std::right << std::setw(10) << run.events
+              << "  " << std::setw(7) << run.seconds << "  " << std::setw(9) << fct.back() / 1000
+              << "  " << std::setw(12) << flowError / fct.size() * 100 << "%  " << std::setw(10)
+              << quantileError(0.5) << "%  " << std::setw(10) << quantileError(0.99) << "%  "
+              << std::setw(8) << phaseError << "%" << std::endl;
+    return unfinished;
+}
+
+int
+main(int argc, char* argv[])
+{
+    uint32_t topo = 0;
+    uint64_t size = 1000000;
+    std::string flowFile;
+    uint32_t segment = 16000;
+    double guard = 1.0;
+    Fabric fabric;
+    fabric.rate = DataRate("100Gbps");
+    fabric.delay = MicroSeconds(1);
+    fabric.ccMode = 1;
+    std::string stats = "/dev/null";
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("topo", "leaf-spine topology, as in cut-mpi", topo);
+    cmd.AddValue("flows", "flow file in the rdma_operate.txt format, first phase only", flowFile);
+    cmd.AddValue("size", "message size of the default cross-leaf permutation", size);
+    cmd.AddValue("segment", "ApproxSegmentSize of the approximate run (bytes)", segment);
+    cmd.AddValue("guard", "ApproxGuard of the approximate run (base RTTs)", guard);
+    cmd.AddValue("rate", "link rate", fabric.rate);
+    cmd.AddValue("delay", "link delay", fabric.delay);
+    cmd.AddValue("cc", "congestion control, see RdmaHw::CcMode", fabric.ccMode);
+    cmd.AddValue("stats", "receiver flow statistics file", stats);
+    cmd.Parse(argc, argv);
+
+    NS_ABORT_MSG_IF(topo >= sizeof(g_topologies) / sizeof(g_topologies[0]), "unknown topology");
+    fabric.spines = g_topologies[topo][0];
+    fabric.leaves = g_topologies[topo][1];
+    fabric.servers = g_topologies[topo][2];
+    uint32_t nServers = fabric.leaves * fabric.servers;
+    Config::SetDefault("ns3::FlowStatsMonitor::FileName", StringValue(stats));
+    if (fabric.ccMode == 3)
+    {
+        IntHeader::mode = IntHeader::NORMAL;
+    }
+    else if (fabric.ccMode == 7)
+    {
+        IntHeader::mode = IntHeader::TS;
+    }
+    else if (fabric.ccMode == 10)
+    {
+        IntHeader::mode = IntHeader::PINT;
+    }
+
+    std::vector<Flow> flows;
+    if (!flowFile.empty())
+    {
+        flows = ReadFlows(flowFile, nServers);
+    }
+    else
+    {
+        // every server sends to the same server of the leaf half the fabric away
+        for (uint32_t i = 0; i < nServers; i++)
+        {
+            flows.push_back({i, (i + nServers / 2) % nServers, size});
+        }
+    }
+    std::cout << "topology " << fabric.spines << " spines, " << fabric.leaves << " leaves, "
+              << nServers << " servers, " << flows.size() << " flows" << std::endl;
+
+    // a second packet-level run with other random streams gives the noise floor
+    // of the comparison, the ECN marking of DCQCN and co is random
+    Result packet = Run(fabric, flows, 0, guard);
+    Result noise = Run(fabric, flows, 0, guard);
+    Result approx = Run(fabric, flows, segment, guard);
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "mode     events      wall(s)  phase(us)  flow err mean  p50 fct err  "
+                 "p99 fct err  phase err"
+              << std::endl;
+    uint32_t unfinished = Report("packet", packet, packet) + Report("noise", noise, packet) +
+                          Report("approx", approx, packet);
+    std::cout << "segment " << segment << " B, guard " << guard << " RTT, speedup "
+              << packet.seconds / std::max(approx.seconds, 1e-3) << "x" << std::endl;
+    if (unfinished)
+    {
+        std::cout << unfinished << " flows did not finish" << std::endl;
+    }
+    return unfinished ? 1 : 0;
+}
@@ -19,6 +19,7 @@
 
 #include "ns3/core-module.h"
 
+#include <algorithm>
 #include <cmath> // sqrt
 #include <fstream>
 #include <iomanip>
@@ -31,6 +32,20 @@ using namespace ns3;
 /** Flag to write debugging output. */
 bool g_debug = false;
 
+/** Flag to compare the runs with the event pool off and on. */
+bool g_pool = false;
+
+/** How the timers of the timer churn are moved. */
+enum TimerMode
+{
+    CANCEL_NO_COMPACTION, //!< Cancel and Schedule, cancelled events left in the list
+    CANCEL,               //!< Cancel and Schedule, cancelled events removed from the list
+    RESCHEDULE,           //!< Simulator::Reschedule
+};
+
+/** How the timers of the current suite are moved. */
+TimerMode g_timerMode = CANCEL;
+
 /** Name of this program. */
 std::string g_me;
 /** Log to std::cout */
@@ -100,6 +115,18 @@ class Bench
         m_total = total;
     }
 
+    /**
+     * Set the timer churn: each event executed moves one of the timers
+     * later, in turn, as a congestion control timer reset on every packet.
+     * \param [in] timers The number of timers, 0 for none.
+     * \param [in] delay The delay of a timer from its last move.
+     */
+    void SetTimers(const uint64_t timers, const Time delay)
+    {
+        m_timers.resize(timers);
+        m_timerDelay = delay;
+    }
+
     /** The output. */
     struct Result
     {
@@ -107,6 +134,7 @@ class Bench
         double simu;     /**< Time (s) for simulation. */
         uint64_t pop;    /**< Event population. */
         uint64_t events; /**< Number of events executed. */
+        uint64_t peak;   /**< Peak size of the event list, 0 if unknown. */
     };
 
     /**
@@ -122,11 +150,22 @@ class Bench
      *  executed) and schedules a new event if not complete.
      */
     void Cb();
+    /**
+     *  Timer function, which does nothing: a timer expires only if it
+     *  was not moved for its delay.
+     */
+    void Timer();
+    /** Move the next timer, as selected by g_timerMode. */
+    void MoveTimer();
 
     Ptr<RandomVariableStream> m_rand; /**< Stream for event delays. */
     uint64_t m_population;            /**< Event population size. */
     uint64_t m_total;                 /**< Total number of events to execute. */
     uint64_t m_count;                 /**< Count of events executed so far. */
+    std::vector<EventId> m_timers;    /**< The timers of the churn. */
+    Time m_timerDelay;                /**< Delay of a timer. */
+    uint64_t m_nextTimer{0};          /**< Index of the next timer to move. */
+    uint64_t m_peak{0};               /**< Peak size of the event list. */
 
 }; // class Bench
 
@@ -139,6 +178,7 @@ Bench::Run()
 
     DEB("initializing");
     m_count = 0;
+    m_peak = 0;
 
     timer.Start();
     for (uint64_t i = 0; i < m_population; ++i)
@@ -146,6 +186,10 @@ Bench::Run()
         Time at = NanoSeconds(m_rand->GetValue());
         Simulator::Schedule(at, &Bench::Cb, this);
     }
+    for (auto& id : m_timers)
+    {
+        id = Simulator::Schedule(m_timerDelay, &Bench::Timer, this);
+    }
     init = timer.End() / 1000.0;
     DEB("initialization took " << init << "s");
 
@@ -157,7 +201,7 @@ Bench::Run()
 
     Simulator::Destroy();
 
-    return Result{init, simu, m_population, m_count};
+    return Result{init, simu, m_population, m_count, m_peak};
 }
 
 void
@@ -173,6 +217,44 @@ Bench::Cb()
     Time after = NanoSeconds(m_rand->GetValue());
     Simulator::Schedule(after, &Bench::Cb, this);
     ++m_count;
+
+    if (!m_timers.empty())
+    {
+        MoveTimer();
+    }
+    if (m_count % 1024 == 0)
+    {
+        auto impl = DynamicCast<DefaultSimulatorImpl>(Simulator::GetImplementation());
+        if (impl)
+        {
+            m_peak = std::max<uint64_t>(m_peak, impl->GetEventListSize());
+        }
+    }
+}
+
+void
+Bench::Timer()
+{
+}
+
+void
+Bench::MoveTimer()
+{
+    EventId& id = m_timers[m_nextTimer];
+    m_nextTimer = (m_nextTimer + 1) % m_timers.size();
+    if (g_timerMode == RESCHEDULE)
+    {
+        id = Simulator::Reschedule(id, m_timerDelay);
+        if (!id.IsExpired())
+        {
+            return;
+        }
+    }
+    else
+    {
+        id.Cancel();
+    }
+    id = Simulator::Schedule(m_timerDelay, &Bench::Timer, this);
 }
 
 /** Benchmark which performs an ensemble of runs. */
@@ -193,13 +275,17 @@ class BenchSuite
      * \param [in] runs The number of replications.
      * \param [in] eventStream The random stream of event delays.
      * \param [in] calRev For the CalendarScheduler, whether the Reverse attribute was set.
+     * \param [in] timers The number of timers of the timer churn.
+     * \param [in] timerDelay The delay of the timers.
      */
     BenchSuite(ObjectFactory& factory,
                uint64_t pop,
                uint64_t total,
                uint64_t runs,
                Ptr<RandomVariableStream> eventStream,
-               bool calRev);
+               bool calRev,
+               uint64_t timers,
+               Time timerDelay);
 
     /** Write the results to \c LOG() */
     void Log() const;
@@ -241,6 +327,7 @@ class BenchSuite
 
     std::string m_scheduler;       /**< Descriptive string for the scheduler. */
     std::vector<Result> m_results; /**< Store for the run results. */
+    uint64_t m_peak{0};            /**< Peak size of the event list over the runs. */
 
 }; // BenchSuite
 
@@ -269,7 +356,9 @@ BenchSuite::BenchSuite(ObjectFactory& factory,
                        uint64_t total,
                        uint64_t runs,
                        Ptr<RandomVariableStream> eventStream,
-                       bool calRev)
+                       bool calRev,
+                       uint64_t timers,
+                       Time timerDelay)
 {
     Simulator::SetScheduler(factory);
 
@@ -282,11 +371,21 @@ BenchSuite::BenchSuite(ObjectFactory& factory,
     {
         m_scheduler += " (default)";
     }
+    if (g_pool)
+    {
+        m_scheduler += EventPool::IsEnabled() ? ": event pool: on" : ": event pool: off";
+    }
+    if (timers > 0)
+    {
+        const char* modes[] = {"cancel, no compaction", "cancel", "reschedule"};
+        m_scheduler += std::string(": timers: ") + modes[g_timerMode];
+    }
 
     Bench bench(pop, total);
     bench.SetRandomStream(eventStream);
     bench.SetPopulation(pop);
     bench.SetTotal(total);
+    bench.SetTimers(timers, timerDelay);
 
     m_results.reserve(runs);
     Header();
@@ -299,9 +398,12 @@ BenchSuite::BenchSuite(ObjectFactory& factory,
     // Perform the actual runs
     for (uint64_t i = 0; i < runs; i++)
     {
+        // the previous run destroyed the simulator implementation, and its scheduler
+        Simulator::SetScheduler(factory);
         auto run = bench.Run();
         m_results.push_back(Result::Bench(run));
         m_results.back().Log(i);
+        m_peak = std::max(m_peak, run.peak);
     }
 
     Simulator::Destroy();
@@ -331,6 +433,10 @@ BenchSuite::Header() const
 void
 BenchSuite::Log() const
 {
+    if (m_peak > 0)
+    {
+        LOG("Peak event list size: " << m_peak);
+    }
     if (m_results.size() < 2)
     {
         LOG("");
@@ -451,12 +557,50 @@ GetRandomStream(std::string filename)
     return stream;
 }
 
+/**
+ *  Create a RandomVariableStream to generate next event delays like
+ *  those of an RDMA run over qbb devices.
+ *
+ *  Every packet schedules the end of its serialization, then its arrival
+ *  one propagation delay later.  The packets come in bursts of short or
+ *  full-size frames, in turn; the burst lengths are drawn with the
+ *  RngSeed and RngRun, so a run replays the same delays.
+ *
+ *  \returns The RandomVariableStream.
+ */
+Ptr<RandomVariableStream>
+GetQbbStream()
+{
+    LOG("  Event time distribution:      qbb bursts");
+
+    // serialization of a short and of a full-size frame, and propagation (ns)
+    const double serialization[] = {4, 83};
+    const double propagation = 1000;
+    const uint32_t count = 2000;
+
+    auto burst = CreateObject<UniformRandomVariable>();
+    std::vector<double> nsValues;
+    for (uint32_t frame = 0; nsValues.size() < count; frame ^= 1)
+    {
+        for (uint32_t n = burst->GetInteger(8, 16); n > 0 && nsValues.size() < count; --n)
+        {
+            nsValues.push_back(serialization[frame]);
+            nsValues.push_back(serialization[frame] + propagation);
+        }
+    }
+    LOG("    Generated " << nsValues.size() << " entries");
+    auto drv = CreateObject<DeterministicRandomVariable>();
+    drv->SetValueArray(&nsValues[0], nsValues.size());
+    return drv;
+}
+
 int
 main(int argc, char* argv[])
 {
     bool allSched = false;
     bool schedCal = false;
     bool schedHeap = false;
+    bool schedLadder = false;
     bool schedList = false;
     bool schedMap = false; // default scheduler
     bool schedPQ = false;
@@ -465,13 +609,17 @@ main(int argc, char* argv[])
     uint64_t total = 1000000;
     uint64_t runs = 1;
     std::string filename = "";
+    bool qbb = false;
     bool calRev = false;
+    uint64_t timers = 0;
+    Time timerDelay = MicroSeconds(10);
 
     CommandLine cmd(__FILE__);
     cmd.Usage("Benchmark the simulator scheduler.\n"
               "\n"
               "Event intervals are taken from one of:\n"
               "  an exponential distribution, with mean 100 ns,\n"
+              "  the packet bursts of a qbb RDMA run, by the --qbb argument,\n"
               "  an ascii file, given by the --file=\"<filename>\" argument,\n"
               "  or standard input, by the argument --file=\"-\"\n"
               "In the case of either --file form, the input is expected\n"
@@ -482,13 +630,20 @@ main(int argc, char* argv[])
     cmd.AddValue("cal", "use CalendarSheduler", schedCal);
     cmd.AddValue("calrev", "reverse ordering in the CalendarScheduler", calRev);
     cmd.AddValue("heap", "use HeapScheduler", schedHeap);
+    cmd.AddValue("ladder", "use LadderScheduler", schedLadder);
     cmd.AddValue("list", "use ListSheduler", schedList);
     cmd.AddValue("map", "use MapScheduler (default)", schedMap);
     cmd.AddValue("pri", "use PriorityQueue", schedPQ);
+    cmd.AddValue("pool", "compare the event rates with the event pool off and on", g_pool);
+    cmd.AddValue("timers",
+                 "number of timers moved in turn by the events, to compare cancel and reschedule",
+                 timers);
+    cmd.AddValue("timerdelay", "delay of the timers", timerDelay);
     cmd.AddValue("debug", "enable debugging output", g_debug);
     cmd.AddValue("pop", "event population size", pop);
     cmd.AddValue("total", "total number of events to run", total);
     cmd.AddValue("runs", "number of runs", runs);
+    cmd.AddValue("qbb", "generate the event times of qbb packet bursts", qbb);
     cmd.AddValue("file", "file of relative event times", filename);
     cmd.AddValue("prec", "printed output precision", g_fwidth);
     cmd.Parse(argc, argv);
@@ -501,36 +656,74 @@ main(int argc, char* argv[])
     LOG("  Event population size:        " << pop);
     LOG("  Total events per run:         " << total);
     LOG("  Number of runs per scheduler: " << runs);
+    if (timers > 0)
+    {
+        LOG("  Timers:                       " << timers << " of " << timerDelay.As(Time::US));
+    }
     DEB("debugging is ON");
 
     if (allSched)
     {
-        schedCal = schedHeap = schedList = schedMap = schedPQ = true;
+        schedCal = schedHeap = schedLadder = schedList = schedMap = schedPQ = true;
     }
     // Set the default case if nothing else is set
-    if (!(schedCal || schedHeap || schedList || schedMap || schedPQ))
+    if (!(schedCal || schedHeap || schedLadder || schedList || schedMap || schedPQ))
     {
         schedMap = true;
     }
 
-    auto eventStream = GetRandomStream(filename);
+    auto eventStream = qbb ? GetQbbStream() : GetRandomStream(filename);
 
     ObjectFactory factory("ns3::MapScheduler");
+    // run the suites of the current scheduler, with the event pool off and on if asked,
+    // and each way of moving the timers if any
+    auto runTimerSuites = [&](uint64_t events, bool rev) {
+        if (timers == 0)
+        {
+            BenchSuite(factory, pop, events, runs, eventStream, rev, 0, timerDelay).Log();
+            return;
+        }
+        for (TimerMode mode : {CANCEL_NO_COMPACTION, CANCEL, RESCHEDULE})
+        {
+            g_timerMode = mode;
+            uint32_t threshold = mode == CANCEL_NO_COMPACTION ? 0 : 1024;
+            Config::SetDefault("ns3::DefaultSimulatorImpl::CompactionThreshold",
+                               UintegerValue(threshold));
+            BenchSuite(factory, pop, events, runs, eventStream, rev, timers, timerDelay).Log();
+        }
+    };
+    auto runSuites = [&](uint64_t events, bool rev) {
+        if (!g_pool)
+        {
+            runTimerSuites(events, rev);
+            return;
+        }
+        for (bool enabled : {false, true})
+        {
+            GlobalValue::Bind("EventPoolEnabled", BooleanValue(enabled));
+            runTimerSuites(events, rev);
+        }
+    };
     if (schedCal)
     {
         factory.SetTypeId("ns3::CalendarScheduler");
         factory.Set("Reverse", BooleanValue(calRev));
-        BenchSuite(factory, pop, total, runs, eventStream, calRev).Log();
+        runSuites(total, calRev);
         if (allSched)
         {
             factory.Set("Reverse", BooleanValue(!calRev));
-            BenchSuite(factory, pop, total, runs, eventStream, !calRev).Log();
+            runSuites(total, !calRev);
         }
     }
     if (schedHeap)
     {
         factory.SetTypeId("ns3::HeapScheduler");
-        BenchSuite(factory, pop, total, runs, eventStream, calRev).Log();
+        runSuites(total, calRev);
+    }
+    if (schedLadder)
+    {
+        factory.SetTypeId("ns3::LadderScheduler");
+        runSuites(total, calRev);
     }
     if (schedList)
     {
@@ -541,17 +734,17 @@ main(int argc, char* argv[])
             LOG("Running List scheduler with 1/10 total events");
             listTotal /= 10;
         }
-        BenchSuite(factory, pop, listTotal, runs, eventStream, calRev).Log();
+        runSuites(listTotal, calRev);
     }
     if (schedMap)
     {
         factory.SetTypeId("ns3::MapScheduler");
-        BenchSuite(factory, pop, total, runs, eventStream, calRev).Log();
+        runSuites(total, calRev);
     }
     if (schedPQ)
     {
         factory.SetTypeId("ns3::PriorityQueueScheduler");
-        BenchSuite(factory, pop, total, runs, eventStream, calRev).Log();
+        runSuites(total, calRev);
     }
 
     return 0;